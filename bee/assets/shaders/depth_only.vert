@@ -8,6 +8,6 @@ layout (location = POSITION_LOCATION) in vec3 a_position;
 
 void main()
 {
-    mat4 wvp = bee_transforms[gl_InstanceID].wvp;
+    mat4 wvp = bee_transforms[gl_BaseInstance + gl_InstanceID].wvp;
     gl_Position = wvp * vec4(a_position, 1.0);
 }
\ No newline at end of file
@@ -13,10 +13,13 @@
 #define PER_MATERIAL_LOCATION               2
 #define PER_OBJECT_LOCATION                 3
 #define CAMERA_UBO_LOCATION                 4
-#define LIGHTS_UBO_LOCATION                 5
-#define TRANSFORMS_UBO_LOCATION             6
+#define POINT_LIGHTS_SSBO_LOCATION          5
+#define TRANSFORMS_SSBO_LOCATION            6
 #define DIRECTIONAL_LIGHTS_UBO_LOCATION     7
-#define UBO_LOCATION_COUNT                  8
+#define DRAWS_SSBO_LOCATION                 8
+#define CLUSTERS_SSBO_LOCATION              9
+#define PARTICLES_SSBO_LOCATION             10
+#define UBO_LOCATION_COUNT                  11
 
 // G-buffer
 #define GBUFFER_POSITION_LOCATION   0
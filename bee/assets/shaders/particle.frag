@@ -0,0 +1,14 @@
+#version 460 core
+
+in vec2 v_corner;
+in vec4 v_color;
+
+out vec4 frag_color;
+
+void main()
+{
+    // A soft round puff. Additive types blend with alpha as well, so it fades their edges too.
+    float falloff = 1.0 - smoothstep(0.0, 1.0, dot(v_corner, v_corner));
+    if (falloff <= 0.0) discard;
+    frag_color = vec4(v_color.rgb, v_color.a * falloff);
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#version 460 core
+#extension GL_GOOGLE_include_directive : require
+
+#include "locations.glsl"
+#include "uniforms.glsl"
+
+out vec2 v_corner;
+out vec4 v_color;
+
+void main()
+{
+    // A quad that faces the camera, as a triangle strip of 4 vertices without a vertex buffer
+    particle_struct particle = bee_particles[gl_BaseInstance + gl_InstanceID];
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    vec3 right = vec3(bee_view[0][0], bee_view[1][0], bee_view[2][0]);
+    vec3 up = vec3(bee_view[0][1], bee_view[1][1], bee_view[2][1]);
+    vec3 position = particle.position + (right * corner.x + up * corner.y) * particle.size;
+    gl_Position = bee_viewProjection * vec4(position, 1.0);
+    v_corner = corner;
+    v_color = particle.color;
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 460 core
+
+in float v_side;
+in float v_alpha;
+
+out vec4 frag_color;
+
+void main()
+{
+    // Rubber on the road, darkest in the middle of the tread and soft towards its edges
+    float edge = 1.0 - smoothstep(0.6, 1.0, abs(v_side));
+    float alpha = v_alpha * edge;
+    if (alpha <= 0.0) discard;
+    frag_color = vec4(vec3(0.03), alpha);
+}
\ No newline at end of file
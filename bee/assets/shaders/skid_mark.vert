@@ -0,0 +1,23 @@
+#version 460 core
+#extension GL_GOOGLE_include_directive : require
+
+#include "locations.glsl"
+#include "uniforms.glsl"
+
+layout (location = 0) in vec4 a_position_time;
+layout (location = 1) in vec2 a_side_intensity;
+
+uniform float u_time;
+uniform float u_fade_time;
+
+out float v_side;
+out float v_alpha;
+
+void main()
+{
+    // Older marks fade out linearly, slots that were never written have no area and no intensity
+    float age = u_time - a_position_time.w;
+    v_alpha = a_side_intensity.y * clamp(1.0 - age / max(u_fade_time, 1e-3), 0.0, 1.0);
+    v_side = a_side_intensity.x;
+    gl_Position = bee_viewProjection * vec4(a_position_time.xyz, 1.0);
+}
\ No newline at end of file
@@ -10,6 +10,7 @@ in vec3 v_normal;
 in vec3 v_tangent;
 in vec2 v_texture0;
 in vec2 v_texture1;
+flat in int v_draw;
 
 layout(location = BASE_COLOR_SAMPLER_LOCATION) uniform sampler2D s_base_color;
 layout(location = NORMAL_SAMPLER_LOCATION)     uniform sampler2D s_normal;
@@ -19,26 +20,14 @@ layout(location = OCCLUSION_SAMPLER_LOCATION)  uniform sampler2D s_occulsion;
 layout(location = LUT_SAMPER_LOCATION)         uniform sampler2D s_ibl_lut;
 layout(location = DIFFUSE_SAMPER_LOCATION)     uniform samplerCube s_ibl_diffuse;
 layout(location = SPECULAR_SAMPER_LOCATION)    uniform samplerCube s_ibl_specular;
-layout(location = SHADOWMAP_LOCATION)          uniform sampler2DShadow[4] s_shadowmaps;
+layout(location = SHADOWMAP_LOCATION)          uniform sampler2DArrayShadow[4] s_shadowmaps;
 
 out vec4 frag_color;
 
-uniform bool is_unlit;
 uniform vec2 u_resolution;
-uniform bool u_recieve_shadows;
 uniform int u_ibl_specular_mip_count;
-
-uniform bool use_base_texture;
-uniform bool use_metallic_roughness_texture;
-uniform bool use_emissive_texture;
-uniform bool use_normal_texture;
-uniform bool use_occlusion_texture;
 uniform bool use_alpha_blending;
 
-uniform vec4 base_color_factor;
-uniform float metallic_factor;
-uniform float roughness_factor;
-
 uniform bool debug_base_color;
 uniform bool debug_normals;
 uniform bool debug_normal_map;
@@ -47,7 +36,6 @@ uniform bool debug_roughness;
 uniform bool debug_emissive;
 uniform bool debug_occlusion;
 
-const float c_zbias = 0.003;
 const float c_gamma = 2.2;
 const float c_inv_gamma = 1.0 / c_gamma;
 const float u_EnvIntensity = 1.0;
@@ -230,6 +218,30 @@ float attenuation(float distance, float range)
     return max(min(1.0 - pow(distance/range, 4), 1), 0) / distance2;
 }
 
+// The light cluster that the fragment is in
+int get_cluster(float view_depth)
+{
+    float depth = bee_clusterLogarithmic != 0 ? log(max(view_depth, 1e-4)) : view_depth;
+    int slice = clamp(int(floor(depth * bee_clusterScale - bee_clusterBias)), 0, CLUSTER_SLICES - 1);
+    ivec2 tile = ivec2((gl_FragCoord.xy - bee_viewportOffset) / bee_resolution * vec2(CLUSTER_TILES_X, CLUSTER_TILES_Y));
+    tile = clamp(tile, ivec2(0), ivec2(CLUSTER_TILES_X - 1, CLUSTER_TILES_Y - 1));
+    return (slice * CLUSTER_TILES_Y + tile.y) * CLUSTER_TILES_X + tile.x;
+}
+
+// Samples the cascade that the fragment is in, fragments beyond the last cascade are lit
+float get_shadow(int light, vec3 position, float view_depth)
+{
+    vec4 splits = bee_directional_lights[light].cascade_splits;
+    int cascade = int(dot(vec4(greaterThanEqual(vec4(view_depth), splits)), vec4(1.0)));
+    if(cascade >= MAX_SHADOW_CASCADES)
+        return 1.0;
+
+    vec4 pos_light_coor = bee_directional_lights[light].shadow_matrices[cascade] * vec4(position, 1.0);
+    vec3 proj_coords = pos_light_coor.xyz / pos_light_coor.w;
+    proj_coords = proj_coords * 0.5 + 0.5;
+    return texture(s_shadowmaps[light], vec4(proj_coords.xy, float(cascade), proj_coords.z));
+}
+
 void apply_fog(inout vec3 pixel_color, in vec3 fog_color, float fog_near, float fog_far, float distance)
 {
     float fog_amount = saturate((distance - fog_near) / (fog_far - fog_near));
@@ -238,6 +250,19 @@ void apply_fog(inout vec3 pixel_color, in vec3 fog_color, float fog_near, float
 
 void main()
 {       
+    // The material of the draw
+    material_struct draw = bee_draws[v_draw];
+    bool is_unlit = (draw.flags & MATERIAL_UNLIT) != 0;
+    bool u_recieve_shadows = (draw.flags & MATERIAL_RECEIVE_SHADOWS) != 0;
+    bool use_base_texture = (draw.flags & MATERIAL_BASE_TEXTURE) != 0;
+    bool use_metallic_roughness_texture = (draw.flags & MATERIAL_METALLIC_ROUGHNESS_TEXTURE) != 0;
+    bool use_emissive_texture = (draw.flags & MATERIAL_EMISSIVE_TEXTURE) != 0;
+    bool use_normal_texture = (draw.flags & MATERIAL_NORMAL_TEXTURE) != 0;
+    bool use_occlusion_texture = (draw.flags & MATERIAL_OCCLUSION_TEXTURE) != 0;
+    vec4 base_color_factor = draw.base_color_factor;
+    float metallic_factor = draw.metallic_factor;
+    float roughness_factor = draw.roughness_factor;
+
     // Collect all the properties in this struct (like g-buffer) 
     fragment_material mat;
 
@@ -306,6 +331,7 @@ void main()
 
     vec3 specular = vec3(0.0);
     vec3 diffuse = vec3(0.0);
+    float view_depth = -(bee_view * vec4(v_position, 1.0)).z;
 
     specular += getIBLRadianceGGX(N, V, mat.roughness, mat.f0);
     diffuse += getIBLRadianceLambertian(N, V, mat.roughness, mat.diffuse, mat.f0);
@@ -326,11 +352,7 @@ void main()
         
         if(u_recieve_shadows)
         {
-            vec4 pos_light_coor = bee_directional_lights[i].shadow_matrix * vec4(v_position, 1.0);
-            vec3 proj_coords = pos_light_coor.xyz / pos_light_coor.w;
-            proj_coords = proj_coords * 0.5 + 0.5;
-            proj_coords.z -= c_zbias;        
-            float shadow = texture(s_shadowmaps[i], proj_coords);
+            float shadow = get_shadow(i, v_position, view_depth);
             dif *= shadow;
             spc *= shadow;
         }
@@ -339,15 +361,16 @@ void main()
         specular += spc;
     }
 
-    for(int i = 0; i < bee_pointLightsCount; i++) // Point lights
+    uvec2 cluster = bee_clusters[get_cluster(view_depth)];
+    for(uint c = cluster.x; c < cluster.x + cluster.y; c++) // Point lights that reach the cluster
     {        
+        point_light_struct point = bee_point_lights[bee_cluster_lights[c]];
         fragment_light light;        
-        light.direction = bee_point_lights[i].position - v_position;
+        light.direction = point.position - v_position;
         float distance = length(light.direction);
         light.direction /= distance;
-        light.color_intensity = vec4(   bee_point_lights[i].color,
-                                        bee_point_lights[i].intensity);
-        light.attenuation = attenuation(distance, bee_point_lights[i].range);
+        light.color_intensity = vec4(point.color, point.intensity);
+        light.attenuation = attenuation(distance, point.range);
         light.attenuation *= c_point_light_tweak;
         vec3 dif = vec3(0.0);
         vec3 spc = vec3(0.0);
@@ -15,16 +15,20 @@ out vec3 v_normal;
 out vec3 v_tangent;
 out vec2 v_texture0;
 out vec2 v_texture1;
+flat out int v_draw;
+
+uniform int u_draw_offset;  // of the first command of the multi-draw call in bee_draws
 
 void main()
 {       
-    mat4 world = bee_transforms[gl_InstanceID].world;
+    mat4 world = bee_transforms[gl_BaseInstance + gl_InstanceID].world;
     mat4 wv = bee_view * world;
     v_position = (world * vec4(a_position, 1.0)).xyz;
     v_normal = normalize((world * vec4(a_normal, 0.0)).xyz);
     v_tangent = normalize((world * vec4(a_tangent.xyz, 0.0)).xyz);
     v_texture0 = a_texture0;
     v_texture1 = a_texture1;
-    mat4 wvp = bee_transforms[gl_InstanceID].wvp;
+    v_draw = u_draw_offset + gl_DrawID;
+    mat4 wvp = bee_transforms[gl_BaseInstance + gl_InstanceID].wvp;
     gl_Position = wvp * vec4(a_position, 1.0);
 }
\ No newline at end of file
@@ -11,15 +11,23 @@ layout (std140, binding = CAMERA_UBO_LOCATION) uniform CameraUBO
     vec4 bee_FogColor;                // 16
     float bee_FogFar;                 // 4
     float bee_FogNear;                // 4
+    float bee_clusterScale;           // 4, the slice of a depth is (log) depth * scale - bias, see LightClusters
+    float bee_clusterBias;            // 4
+    int bee_clusterLogarithmic;       // 4
+    int _camera_padding;              // 4, so that the vec2 below is aligned in C++ as in std140
+    vec2 bee_viewportOffset;          // 8, where the view starts on screen, in pixels
 };
 
+#define MAX_SHADOW_CASCADES 4
+
 struct directional_light_struct
 {
     vec3    direction;   
     float   _dir_padding;               // 16
     vec3    color;
     float   intensity;                  // 16
-    mat4    shadow_matrix;              // 64
+    mat4    shadow_matrices[MAX_SHADOW_CASCADES];   // 256, to shadow map space with the depth bias applied
+    vec4    cascade_splits;             // 16, where each cascade ends along the view direction, 0 without shadows
 };
 
 #define MAX_DIRECTIONAL_LIGHTS 4
@@ -29,7 +37,7 @@ layout(std140, binding = DIRECTIONAL_LIGHTS_UBO_LOCATION) uniform DirectionalLig
     directional_light_struct bee_directional_lights[4];
 };
 
-#define MAX_POINT_LIGHT_INSTANCES 128
+#define MAX_POINT_LIGHT_INSTANCES 4096
 
 struct point_light_struct
 {
@@ -39,12 +47,27 @@ struct point_light_struct
     float   intensity;  // 16
 };
 
-layout(std140, binding = LIGHTS_UBO_LOCATION) uniform PointLightsUBO
+#ifdef GL_core_profile
+layout(std430, binding = POINT_LIGHTS_SSBO_LOCATION) readonly buffer PointLightsSSBO
 {
-    point_light_struct bee_point_lights[MAX_POINT_LIGHT_INSTANCES];
+    point_light_struct bee_point_lights[];
 };
+#endif
 
-#define MAX_TRANSFORM_INSTANCES 256
+// The view frustum is divided into clusters, tiles on screen times slices in depth, see LightClusters
+#define CLUSTER_TILES_X 16
+#define CLUSTER_TILES_Y 9
+#define CLUSTER_SLICES 24
+#define CLUSTER_COUNT (CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_SLICES)
+
+// Per cluster the offset and count of its point lights in bee_cluster_lights, which holds indices in bee_point_lights
+#ifdef GL_core_profile
+layout(std430, binding = CLUSTERS_SSBO_LOCATION) readonly buffer ClustersSSBO
+{
+    uvec2 bee_clusters[CLUSTER_COUNT];
+    uint bee_cluster_lights[];
+};
+#endif
 
 struct transform_struct
 {    
@@ -52,7 +75,52 @@ struct transform_struct
     mat4    wvp;        // 64
 };
 
-layout(std140, binding = TRANSFORMS_UBO_LOCATION) uniform TransformsUBO
+// All instances of a frame, in draw order. Draws start at their first instance with a base instance, so index with
+// gl_BaseInstance + gl_InstanceID. Only declared for shaders, C++ has no arrays without a size.
+#ifdef GL_core_profile
+layout(std430, binding = TRANSFORMS_SSBO_LOCATION) readonly buffer TransformsSSBO
+{
+    transform_struct bee_transforms[];
+};
+#endif
+
+#define MATERIAL_BASE_TEXTURE                   1
+#define MATERIAL_METALLIC_ROUGHNESS_TEXTURE     2
+#define MATERIAL_EMISSIVE_TEXTURE               4
+#define MATERIAL_NORMAL_TEXTURE                 8
+#define MATERIAL_OCCLUSION_TEXTURE              16
+#define MATERIAL_UNLIT                          32
+#define MATERIAL_RECEIVE_SHADOWS                64
+
+struct material_struct
+{
+    vec4    base_color_factor;  // 16
+    float   metallic_factor;
+    float   roughness_factor;
+    int     flags;              // MATERIAL_ bits
+    int     _material_padding;  // 16
+};
+
+// The material of every draw command of a frame. A multi-draw call reads the material of its commands at the index of
+// its first command + gl_DrawID.
+#ifdef GL_core_profile
+layout(std430, binding = DRAWS_SSBO_LOCATION) readonly buffer DrawsSSBO
+{
+    material_struct bee_draws[];
+};
+#endif
+
+struct particle_struct
+{
+    vec3    position;   // 12
+    float   size;       // 4, half the width of its quad
+    vec4    color;      // 16
+};
+
+// The particles of a frame, every instanced draw starts at its first particle with a base instance
+#ifdef GL_core_profile
+layout(std430, binding = PARTICLES_SSBO_LOCATION) readonly buffer ParticlesSSBO
 {
-    transform_struct bee_transforms[MAX_TRANSFORM_INSTANCES];
+    particle_struct bee_particles[];
 };
+#endif
@@ -23,14 +23,13 @@ struct NavmeshElement
 class NavigationSystem : public bee::System
 {
 public:
+    /// <param name="fixedDeltaTime">The time step (in seconds) for AI-related code, rounded to a whole number of engine
+    /// ticks.</param>
     NavigationSystem(float fixedDeltaTime, float agentRadius);
+    void FixedUpdate(float dt) override;
     void Update(float dt) override;
 
 private:
     std::unique_ptr<Navmesh> m_navmesh;
-
-    /// The fixed timestep (in seconds) for AI-related code.
-    float m_fixedDeltaTime = 0.1f;
-    float m_timeSinceLastFrame = 0.0f;
 };
 }  // namespace bee::ai
\ No newline at end of file
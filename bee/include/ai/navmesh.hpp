@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory_resource>
+
 #include "graph/euclidean_graph.hpp"
 
 namespace bee::ai
@@ -29,6 +31,14 @@ public:
     /// </summary>
     Path ComputePath(const glm::vec2& start, const glm::vec2& goal) const;
 
+    /// <summary>
+    /// Like ComputePath(), but allocates the path and all intermediate data from the given memory resource, e.g. a
+    /// scratch arena.
+    /// </summary>
+    std::pmr::vector<glm::vec2> ComputePath(const glm::vec2& start,
+                                            const glm::vec2& goal,
+                                            std::pmr::memory_resource* memory) const;
+
     inline const geometry2d::PolygonList& GetPolygons() const { return m_polygons; }
     inline const graph::EuclideanGraph& GetGraph() const { return m_graph; }
 
@@ -38,8 +48,14 @@ private:
 
     int GetContainingPolygon(const glm::vec2& pos) const;
     int GetNearestPolygon(const glm::vec2& pos) const;
-    Path ComputeShortestPath(const glm::vec2& start, const glm::vec2& goal, const std::vector<int>& cells) const;
-    Path ComputeMidpointPath(const glm::vec2& start, const glm::vec2& goal, const std::vector<int>& cells) const;
+    std::pmr::vector<glm::vec2> ComputeShortestPath(const glm::vec2& start,
+                                                    const glm::vec2& goal,
+                                                    const std::vector<int>& cells,
+                                                    std::pmr::memory_resource* memory) const;
+    std::pmr::vector<glm::vec2> ComputeMidpointPath(const glm::vec2& start,
+                                                    const glm::vec2& goal,
+                                                    const std::vector<int>& cells,
+                                                    std::pmr::memory_resource* memory) const;
 
     /// <summary>
     /// Converts a raw set of (possibly overlapping) polygons and holes to a non-overlapping set of simple polygons with holes.
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "core/ecs.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// Collects the entities whose component of type T was created or changed, so that a system can process only those
+/// instead of every entity, and Clear() them when done.
+/// Built on an entt reactive storage that listens to the registry's construct and update signals. Update signals are
+/// only sent by Registry.patch() and Registry.replace(), so code that modifies a component in place must call
+/// EntityComponentSystem::MarkChanged() afterwards. Destroyed entities are removed automatically.
+/// A tracker follows a single component type, so that systems writing different component types never insert into the
+/// same set at the same time.
+/// </summary>
+template <typename T>
+class ChangeTracker
+{
+public:
+    explicit ChangeTracker(entt::registry& registry) : m_storage(registry.storage<entt::reactive>(NextID()))
+    {
+        m_storage.template on_construct<T>().template on_update<T>();
+    }
+
+    ~ChangeTracker()
+    {
+        m_storage.reset();
+        m_storage.clear();
+    }
+
+    ChangeTracker(const ChangeTracker&) = delete;
+    ChangeTracker& operator=(const ChangeTracker&) = delete;
+    ChangeTracker(ChangeTracker&&) = delete;
+    ChangeTracker& operator=(ChangeTracker&&) = delete;
+
+    auto begin() const { return m_storage.begin(); }
+    auto end() const { return m_storage.end(); }
+    size_t Size() const { return m_storage.size(); }
+    bool IsEmpty() const { return m_storage.empty(); }
+    bool Contains(Entity entity) const { return m_storage.contains(entity); }
+
+    /// <summary>
+    /// Forgets all changes, call this once they have been processed.
+    /// </summary>
+    void Clear() { m_storage.clear(); }
+
+private:
+    // Every tracker needs its own storage, even if it follows the same component type as another one
+    static entt::id_type NextID()
+    {
+        static std::atomic<entt::id_type> next{0};
+        return entt::type_hash<ChangeTracker>::value() + next++;
+    }
+
+    entt::storage_for_t<entt::reactive>& m_storage;
+};
+
+}  // namespace bee
@@ -1,5 +1,7 @@
 #pragma once
 
-#if defined(BEE_PLATFORM_PC) && defined(BEE_GRAPHICS_OPENGL)
+#if defined(BEE_GRAPHICS_NULL)
+#include "platform/null/device_null.hpp"
+#elif defined(BEE_PLATFORM_PC) && defined(BEE_GRAPHICS_OPENGL)
 #include "platform/opengl/device_gl.hpp"
 #endif
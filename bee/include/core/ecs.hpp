@@ -1,8 +1,12 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
+#include "core/engine.hpp"
 #include "tools/warnings.hpp"
 
 BEE_DISABLE_WARNING_PUSH
@@ -14,13 +18,65 @@ namespace bee
 {
 using Entity = entt::entity;
 
+class SystemScheduler;
+
+/// <summary>
+/// Tag component for entities that never move or change after they have been created, such as track geometry.
+/// Systems can skip per-frame work for them, e.g. the renderer extracts them once and the 2D physics world only computes
+/// the collider points of static bodies when they change. To change a static entity anyway, call
+/// EntityComponentSystem::MarkChanged() on the modified component. Changes are not found by themselves: writing to a
+/// component through a reference or a setter such as Transform::SetTranslation() is not seen until MarkChanged() is
+/// called, and marking a Transform does not mark the transforms of its children. The inspector marks what it edits.
+/// </summary>
+struct Static
+{
+};
+
+/// <summary>
+/// A component type that a system reads or writes, as declared through System::Reads() and System::Writes().
+/// </summary>
+struct ComponentAccess
+{
+    entt::id_type ID = 0;
+    std::string_view Name = {};
+    void (*Assure)(entt::registry&) = nullptr;  // creates the storage for the component type
+
+    template <typename T>
+    static ComponentAccess Of();
+};
+
 class System
 {
 public:
     virtual ~System() = default;
     virtual void Update(float) {}
+
+    /// <summary>
+    /// Called at the engine's fixed tick rate (see EngineClass::SetFixedTickRate), before Update(). Runs once every
+    /// FixedUpdateInterval ticks, and dt is always the time between two calls. Simulation belongs here, Update() can
+    /// interpolate its results with EngineClass::GetFixedAlpha(). Uses the same declared access as Update().
+    /// </summary>
+    virtual void FixedUpdate(float) {}
+
+    /// <summary>
+    /// Copies whatever Submit() needs out of the registry. Called on the main thread once all systems have been updated
+    /// and deleted entities have been destroyed.
+    /// </summary>
+    virtual void Extract() {}
+
+    /// <summary>
+    /// Submits the data captured by Extract() to the GPU. Always called on the main thread, but possibly while the next
+    /// frame is already being updated, so this must not access the registry.
+    /// </summary>
+    virtual void Submit() {}
+
+    /// <summary>
+    /// Called on the main thread after Submit(), when no system is updating. Can read the registry, e.g. for debug drawing.
+    /// </summary>
     virtual void Render() {}
+
     int Priority = 0;
+    int FixedUpdateInterval = 1;  // in engine ticks, for simulations that run slower than the tick rate
     std::string Title = {};
 
     System(const System&) = delete;
@@ -28,8 +84,63 @@ public:
     System(System&&) = delete;
     System& operator=(System&&) = delete;
 
+    /// <summary>
+    /// Returns whether this system declared which components its FixedUpdate() and Update() read and write.
+    /// Systems that did not are never run in parallel with any other system. They still run on whichever thread updates
+    /// the systems, which is a job worker with a frame latency of 1 (see EngineClass::SetFrameLatency), so they must not
+    /// call the graphics API either.
+    /// </summary>
+    bool HasDeclaredAccess() const { return m_declaredAccess; }
+    const std::vector<ComponentAccess>& GetReads() const { return m_reads; }
+    const std::vector<ComponentAccess>& GetWrites() const { return m_writes; }
+
+    /// <summary>
+    /// Returns the time between two calls to FixedUpdate().
+    /// </summary>
+    float GetFixedDeltaTime() const { return Engine.GetFixedDeltaTime() * static_cast<float>(FixedUpdateInterval); }
+
 protected:
     System() = default;
+
+    /// <summary>
+    /// Sets FixedUpdateInterval to the number of engine ticks closest to the given time step (at least one tick).
+    /// </summary>
+    void SetFixedDeltaTime(float fixedDeltaTime);
+
+    /// <summary>
+    /// Declares that Update() reads components of the given types. Call this from the constructor.
+    /// </summary>
+    template <typename... T>
+    void Reads();
+
+    /// <summary>
+    /// Declares that Update() writes components of the given types. Call this from the constructor.
+    /// Note that Transform::World() updates cached matrices, so a system calling it writes Transform.
+    /// </summary>
+    template <typename... T>
+    void Writes();
+
+    /// <summary>
+    /// Returns a registry view over the given component types. Components that are not const are treated as written.
+    /// In debug builds, access that was not declared through Reads() or Writes() is reported.
+    /// </summary>
+    template <typename... T>
+    decltype(auto) View();
+
+    /// <summary>
+    /// Returns a pointer to the component of the given entity, or nullptr. Access is checked like in View().
+    /// </summary>
+    template <typename T>
+    T* TryGet(Entity entity);
+
+private:
+    std::vector<ComponentAccess> m_reads;
+    std::vector<ComponentAccess> m_writes;
+    bool m_declaredAccess = false;
+#ifdef BEE_DEBUG
+    void CheckAccess(const ComponentAccess& access, bool write);
+    std::vector<entt::id_type> m_reported;
+#endif
 };
 
 class EntityComponentSystem
@@ -38,17 +149,31 @@ public:
     entt::registry Registry;
     Entity CreateEntity() { return Registry.create(); }
     void DeleteEntity(Entity);
+    void FixedUpdateSystems(float dt, uint64_t tick);
     void UpdateSystems(float);
+    void ExtractSystems();
+    void SubmitSystems();
     void RenderSystems();
     void RemovedDeleted();
     template <typename T, typename... Args>
     decltype(auto) CreateComponent(Entity entity, Args&&... args);
+
+    /// <summary>
+    /// Tells change trackers (see ChangeTracker) that a component was modified in place.
+    /// Registry.patch() and Registry.replace() do this as well.
+    /// </summary>
+    template <typename T>
+    void MarkChanged(Entity entity)
+    {
+        Registry.patch<T>(entity);
+    }
     template <typename T, typename... Args>
     T& CreateSystem(Args&&... args);
     template <typename T>
     T& GetSystem();
     template <typename T>
     std::vector<T*> GetSystems();
+    SystemScheduler& Scheduler() { return *m_scheduler; }
 
 private:
     friend class EngineClass;
@@ -62,9 +187,56 @@ private:
     struct Delete
     {
     };  // Tag component for entities to be deleted
+    void SortSystems();
+
     std::vector<std::unique_ptr<System>> m_systems;
+    std::unique_ptr<SystemScheduler> m_scheduler;
+    bool m_systemsDirty = false;
 };
 
+template <typename T>
+ComponentAccess ComponentAccess::Of()
+{
+    using Type = std::remove_const_t<T>;
+    ComponentAccess access;
+    access.ID = entt::type_hash<Type>::value();
+    access.Name = entt::type_name<Type>::value();
+    access.Assure = [](entt::registry& registry) { static_cast<void>(registry.storage<Type>()); };
+    return access;
+}
+
+template <typename... T>
+void System::Reads()
+{
+    (m_reads.push_back(ComponentAccess::Of<T>()), ...);
+    m_declaredAccess = true;
+}
+
+template <typename... T>
+void System::Writes()
+{
+    (m_writes.push_back(ComponentAccess::Of<T>()), ...);
+    m_declaredAccess = true;
+}
+
+template <typename... T>
+decltype(auto) System::View()
+{
+#ifdef BEE_DEBUG
+    (CheckAccess(ComponentAccess::Of<T>(), !std::is_const_v<T>), ...);
+#endif
+    return Engine.ECS().Registry.view<T...>();
+}
+
+template <typename T>
+T* System::TryGet(Entity entity)
+{
+#ifdef BEE_DEBUG
+    CheckAccess(ComponentAccess::Of<T>(), !std::is_const_v<T>);
+#endif
+    return Engine.ECS().Registry.try_get<T>(entity);
+}
+
 template <typename T, typename... Args>
 decltype(auto) EntityComponentSystem::CreateComponent(Entity entity, Args&&... args)
 {
@@ -76,9 +248,7 @@ T& EntityComponentSystem::CreateSystem(Args&&... args)
 {
     T* system = new T(std::forward<Args>(args)...);
     m_systems.push_back(std::unique_ptr<System>(system));
-    std::sort(m_systems.begin(),
-              m_systems.end(),
-              [](const std::unique_ptr<System>& sl, const std::unique_ptr<System>& sr) { return sl->Priority > sr->Priority; });
+    m_systemsDirty = true;  // sorted and scheduled on the next update
     return *system;
 }
 
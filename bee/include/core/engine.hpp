@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 
 #define BEE_VERSION "2526.B.1"
@@ -15,7 +16,8 @@ class Audio;
 class DebugRenderer;
 class Inspector;
 class Profiler;
-class ThreadPool;
+class JobSystem;
+class FrameArena;
 
 class EngineClass
 {
@@ -36,15 +38,63 @@ public:
     Inspector& Inspector() { return *m_inspector; }
     Profiler& Profiler() { return *m_profiler; }
     EntityComponentSystem& ECS() { return *m_ECS; }
-    ThreadPool& ThreadPool();  // Thread pool does lazy initialization
+    JobSystem& JobSystem() { return *m_jobSystem; }
+    FrameArena& FrameArena() { return *m_frameArena; }
     inline const std::string& GetVersionString() { return m_versionString; }
 
+    /// <summary>
+    /// Sets how many frames rendering lags behind simulation, either 0 or 1.
+    /// With 0, every frame is submitted right after it was updated. With 1, the main thread submits the previous frame
+    /// while the next one is updated on the job system. This overlaps simulation with rendering, at the cost of one frame
+    /// of extra latency, and with all systems (also those without declared access) running on job workers rather than on
+    /// the main thread. Defaults to 0 until systems declare their access, since an undeclared system may touch the
+    /// device or GL state while the main thread submits. Deleted entities are destroyed and the frame is extracted on
+    /// the main thread in both cases, since destroying an entity can release GPU resources. The frame that switches
+    /// from 0 to 1 is not submitted, because its previous frame already was.
+    /// </summary>
+    void SetFrameLatency(int latency) { m_frameLatency = latency > 0 ? 1 : 0; }
+    int GetFrameLatency() const { return m_frameLatency; }
+
+    /// <summary>
+    /// Returns the number of frames that have been completed. Systems can use this to double buffer their extracted data.
+    /// </summary>
+    uint64_t GetFrameIndex() const { return m_frameIndex; }
+
+    /// <summary>
+    /// Sets how many times per second System::FixedUpdate() is called. Systems derive their FixedUpdateInterval from
+    /// the tick rate when they are created, so set this before creating them.
+    /// </summary>
+    void SetFixedTickRate(float ticksPerSecond);
+    float GetFixedTickRate() const { return 1.0f / m_fixedDeltaTime; }
+    float GetFixedDeltaTime() const { return m_fixedDeltaTime; }
+
+    /// <summary>
+    /// Sets how many fixed ticks a single frame may run to catch up with real time. When a frame takes longer than
+    /// that many ticks, the remaining time is dropped and the simulation runs slower than real time, instead of every
+    /// next frame having more ticks to catch up on.
+    /// </summary>
+    void SetMaxFixedTicksPerFrame(int ticks) { m_maxFixedTicksPerFrame = ticks > 1 ? ticks : 1; }
+    int GetMaxFixedTicksPerFrame() const { return m_maxFixedTicksPerFrame; }
+
+    /// <summary>
+    /// Returns how far the current frame is between the last fixed tick and the next one, in [0, 1).
+    /// Use it to interpolate between the two most recent simulation states when rendering.
+    /// </summary>
+    float GetFixedAlpha() const { return m_fixedAlpha; }
+
+    /// <summary>Returns the number of fixed ticks that have run since the engine started.</summary>
+    uint64_t GetFixedTick() const { return m_fixedTick; }
+    int GetFixedTicksThisFrame() const { return m_fixedTicksThisFrame; }
+    uint64_t GetDroppedFixedTicks() const { return m_droppedFixedTicks; }
+
 private:
     EngineClass(const EngineClass&) = delete;
     EngineClass& operator=(const EngineClass&) = delete;
     EngineClass(EngineClass&&) = delete;
     EngineClass& operator=(EngineClass&&) = delete;
 
+    void Simulate(float dt);
+
     bee::FileIO* m_fileIO = nullptr;
     bee::Resources* m_resources = nullptr;
     bee::Device* m_device = nullptr;
@@ -53,10 +103,21 @@ private:
     bee::Audio* m_audio = nullptr;
     bee::Inspector* m_inspector = nullptr;
     bee::Profiler* m_profiler = nullptr;
-    bee::ThreadPool* m_pool = nullptr;
+    bee::JobSystem* m_jobSystem = nullptr;
+    bee::FrameArena* m_frameArena = nullptr;
     EntityComponentSystem* m_ECS = nullptr;
 
     std::string m_versionString = BEE_VERSION;
+    uint64_t m_frameIndex = 0;
+    int m_frameLatency = 0;
+    int m_previousFrameLatency = 0;
+    float m_fixedDeltaTime = 1.0f / 60.0f;
+    float m_fixedAccumulator = 0.0f;
+    float m_fixedAlpha = 0.0f;
+    uint64_t m_fixedTick = 0;
+    uint64_t m_droppedFixedTicks = 0;
+    int m_fixedTicksThisFrame = 0;
+    int m_maxFixedTicksPerFrame = 4;
 };
 
 extern EngineClass Engine;
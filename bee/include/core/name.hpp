@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace bee
+{
+
+/// <summary>
+/// Global table of interned strings. Every distinct string is stored exactly once and identified by a small integer ID.
+/// ID 0 is reserved for the empty string. Strings are never removed, so references returned by Lookup() stay valid
+/// for the lifetime of the program. Interning is thread-safe.
+/// </summary>
+class StringTable
+{
+public:
+    /// <summary>
+    /// Returns the ID of the given string, adding it to the table if it was not interned before.
+    /// </summary>
+    static uint32_t Intern(std::string_view string);
+
+    /// <summary>
+    /// Returns the string with the given ID. Asserts (and returns the empty string) on an unknown ID.
+    /// </summary>
+    static const std::string& Lookup(uint32_t id);
+
+    /// <summary>
+    /// Returns the number of distinct strings in the table, including the empty string.
+    /// </summary>
+    static size_t Size();
+};
+
+/// <summary>
+/// Name component. Used for debugging and editor purposes.
+/// Kept out of the Transform so that systems iterating over transforms do not pull names through the cache.
+/// The name itself lives in the global StringTable; the component only stores its ID.
+/// </summary>
+struct Name
+{
+    Name() = default;
+    Name(std::string_view name) : m_id(StringTable::Intern(name)) {}
+
+    /// <summary>Gets the name as a string.</summary>
+    const std::string& Get() const { return StringTable::Lookup(m_id); }
+
+    /// <summary>Gets the name as a null-terminated C string.</summary>
+    const char* CStr() const { return Get().c_str(); }
+
+    /// <summary>Gets the interned string ID. Two names are equal if and only if their IDs are equal.</summary>
+    uint32_t GetID() const { return m_id; }
+
+    /// <summary>Returns whether or not this is the empty name.</summary>
+    bool Empty() const { return m_id == 0; }
+
+    bool operator==(const Name& other) const { return m_id == other.m_id; }
+    bool operator!=(const Name& other) const { return m_id != other.m_id; }
+
+private:
+    uint32_t m_id = 0;
+};
+
+}  // namespace bee
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+#include <imgui/IconsFontAwesome.h>
+
+#include "core/ecs.hpp"
+#include "tools/inspectable.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// Runs the FixedUpdate() and Update() of all ECS systems, in parallel where their declared component access allows it.
+/// The systems are turned into a dependency graph once (and again whenever a system is added): a system depends on every
+/// higher-priority system it conflicts with, i.e. one of the two writes a component type the other reads or writes.
+/// Systems that did not declare their access conflict with everything and run serially on the thread that calls Update(),
+/// so the original priority order is kept wherever it matters. That is not the main thread when the engine updates on
+/// the job system, see EngineClass::SetFrameLatency. All other systems run on the engine job system as soon as their
+/// dependencies are done.
+/// </summary>
+class SystemScheduler : public IPanel
+{
+public:
+    SystemScheduler();
+    ~SystemScheduler();
+
+    SystemScheduler(const SystemScheduler&) = delete;
+    SystemScheduler& operator=(const SystemScheduler&) = delete;
+    SystemScheduler(SystemScheduler&&) = delete;
+    SystemScheduler& operator=(SystemScheduler&&) = delete;
+
+    /// <summary>
+    /// Rebuilds the dependency graph for the given systems, which must be sorted by descending priority.
+    /// Also creates the storage of every declared component type up front, so that worker threads never insert into
+    /// the registry's storage map.
+    /// </summary>
+    void Build(const std::vector<std::unique_ptr<System>>& systems, entt::registry& registry);
+
+    /// <summary>
+    /// Updates all systems and returns when every one of them has finished.
+    /// </summary>
+    void Update(float dt);
+
+    /// <summary>
+    /// Runs one fixed tick: calls FixedUpdate() on every system whose FixedUpdateInterval divides the tick number, and
+    /// returns when every one of them has finished. Uses the same dependency graph as Update().
+    /// </summary>
+    void FixedUpdate(float dt, uint64_t tick);
+
+    /// <summary>When false, all systems run one after another on the calling thread in priority order.</summary>
+    bool Parallel = true;
+
+#ifdef BEE_DEBUG
+    /// <summary>
+    /// When true, systems report component access through System::View() and System::TryGet() that they did not
+    /// declare, and the scheduler checks that no two conflicting systems ever run at the same time.
+    /// </summary>
+    bool DetectRaces = true;
+#endif
+
+#ifdef BEE_INSPECTOR
+    void OnPanel() override;
+    std::string GetName() const override { return "Systems"; }
+    std::string GetIcon() const override { return ICON_FA_SITEMAP; }
+#endif
+
+private:
+    struct Node
+    {
+        System* Instance = nullptr;
+        std::vector<size_t> Dependents = {};
+        int NumDependencies = 0;
+        bool Exclusive = false;  // runs alone, on the thread that calls Run()
+        float LastMs = 0.0f;
+        float AverageMs = 0.0f;
+        float FixedAverageMs = 0.0f;
+    };
+
+    enum class Phase
+    {
+        Update,
+        FixedUpdate
+    };
+
+    static bool Conflicts(const System& a, const System& b);
+    void Run(Phase phase, float dt, uint64_t tick);
+    void Dispatch(size_t node);
+    void Execute(size_t node);
+
+    std::vector<Node> m_nodes;
+    std::vector<size_t> m_roots;
+    std::unique_ptr<std::atomic<int>[]> m_pending;
+    std::queue<size_t> m_exclusiveQueue;
+    size_t m_remaining = 0;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    Phase m_phase = Phase::Update;
+    float m_dt = 0.0f;
+    uint64_t m_tick = 0;
+    float m_lastFrameMs = 0.0f;
+    float m_lastTickMs = 0.0f;
+#ifdef BEE_DEBUG
+    std::vector<size_t> m_running;
+#endif
+};
+
+}  // namespace bee
@@ -2,7 +2,6 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
-#include <string>
 
 #include "core/ecs.hpp"
 
@@ -11,15 +10,12 @@ namespace bee
 /// <summary>
 /// Transform component. Contains the position, rotation and scale of the entity.
 /// Implemented on top of the entity-component-system (entt).
+/// Only hot data lives here; names and other editor data are stored in separate components (see bee::Name).
+/// The members are ordered so that the matrix and the quaternion start on 16-byte boundaries, and the whole component
+/// fits in two cache lines.
 /// </summary>
-struct Transform
+struct alignas(16) Transform
 {
-    /// <summary>
-    /// The name of the entity. Used for debugging and editor purposes.
-    /// If small, it can benefit from the small string optimization.
-    /// </summary>
-    std::string Name = {};
-
     /// <summary>
     /// Creates a Transform with default translation (0,0,0), scale (1,1,1), and rotation (identity quaternion).
     /// </summary>
@@ -29,7 +25,7 @@ struct Transform
     /// Creates a Transform with the given translation, scale, and rotation.
     /// </summary>
     Transform(const glm::vec3& translation, const glm::vec3& scale, const glm::quat& rotation)
-        : m_translation(translation), m_scale(scale), m_rotation(rotation)
+        : m_rotation(rotation), m_translation(translation), m_scale(scale)
     {
     }
 
@@ -97,17 +93,16 @@ struct Transform
     void SetFromMatrix(const glm::mat4& transform);
 
 private:
-    glm::vec3 m_translation = glm::vec3(0.0f, 0.0f, 0.0f);
-    glm::vec3 m_scale = glm::vec3(1.0f, 1.0f, 1.0f);
-    glm::quat m_rotation = glm::identity<glm::quat>();
-
-    glm::mat4 m_worldMatrix = glm::identity<glm::mat4>();
-    bool m_worldMatrixDirty = true;
+    glm::mat4 m_worldMatrix = glm::identity<glm::mat4>();   // 64
+    glm::quat m_rotation = glm::identity<glm::quat>();      // 16
+    glm::vec3 m_translation = glm::vec3(0.0f, 0.0f, 0.0f);  // 12
 
     // The hierarchy is implemented as a linked list.
-    Entity m_parent{entt::null};
-    Entity m_first{entt::null};
-    Entity m_next{entt::null};
+    Entity m_parent{entt::null};                      // 4
+    glm::vec3 m_scale = glm::vec3(1.0f, 1.0f, 1.0f);  // 12
+    Entity m_first{entt::null};                       // 4
+    Entity m_next{entt::null};                        // 4
+    bool m_worldMatrixDirty = true;                   // 1 (+ padding)
 
     /// Adds a given entity to this transform's list of children. Called by SetParent().
     /// Note: this function does not add any entities to the scene; it only updates parent-child administration.
@@ -149,4 +144,6 @@ public:
     static Iterator end() { return Iterator(); }
 };
 
+static_assert(sizeof(Transform) <= 128, "Transform should fit in two cache lines");
+
 }  // namespace bee
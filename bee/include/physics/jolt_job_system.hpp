@@ -0,0 +1,43 @@
+#pragma once
+
+#ifdef BEE_JOLT_PHYSICS
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+
+namespace bee
+{
+
+class JobSystem;
+
+/// <summary>
+/// Implementation of Jolt's job system interface on top of the Bee job system, so that physics runs on the same worker
+/// threads as the rest of the engine instead of on a thread pool of its own.
+/// Jolt jobs are kept in a fixed size free list, and every queued Jolt job is a single Bee job.
+/// </summary>
+class JoltJobSystem final : public JPH::JobSystemWithBarrier
+{
+public:
+    JoltJobSystem(bee::JobSystem& jobSystem, JPH::uint maxJobs, JPH::uint maxBarriers);
+    ~JoltJobSystem() override = default;
+
+    int GetMaxConcurrency() const override;
+    JobHandle CreateJob(const char* name,
+                        JPH::ColorArg color,
+                        const JobFunction& function,
+                        JPH::uint32 numDependencies = 0) override;
+
+protected:
+    void QueueJob(Job* job) override;
+    void QueueJobs(Job** jobs, JPH::uint numJobs) override;
+    void FreeJob(Job* job) override;
+
+private:
+    bee::JobSystem& m_jobSystem;  // qualified, JobSystem alone names the Jolt base class
+    JPH::FixedSizeFreeList<Job> m_jobs;
+};
+
+}  // namespace bee
+
+#endif  // BEE_JOLT_PHYSICS
@@ -67,6 +67,7 @@ public:
     JoltSystem(JoltSystem&&) = delete;
     JoltSystem& operator=(JoltSystem&&) = delete;
 
+    void FixedUpdate(float dt) override;
     void Update(float dt) override;
 #ifdef BEE_DEBUG
     void Render() override;
@@ -76,8 +77,8 @@ public:
 #endif
 
     static JPH::PhysicsSystem* GetInternalSystem() { return m_physicsSystem; }
-    inline bool HasExecutedFrame() const { return m_hasExecutedFrame; }
-    inline float GetFixedDeltaTime() const { return m_fixedDeltaTime; }
+    /// <summary>Returns whether at least one simulation step ran during the current frame.</summary>
+    inline bool HasExecutedFrame() const { return m_lastSteppedFrame == bee::Engine.GetFrameIndex(); }
 
     /// <summary>
     /// Tries to add a physics body to Jolt, and returns whether or not that succeeded.
@@ -106,9 +107,7 @@ private:
     static JPH::TempAllocatorImpl* m_tempAllocator;
     static JPH::JobSystem* m_jobSystem;
 
-    float m_fixedDeltaTime;
-    float m_timeSinceLastUpdate{0.f};
-    bool m_hasExecutedFrame{false};
+    uint64_t m_lastSteppedFrame{UINT64_MAX};
 };
 
 template <typename T>
@@ -183,6 +183,10 @@ public:
     inline float GetRotation() const { return m_angle; }
     inline float GetAngularVelocity() const { return m_angularVelocity; }
 
+    /// <summary>
+    /// Moves the body. Moving a static body also requires Engine.ECS().MarkChanged&lt;Body&gt;(entity), so that the
+    /// world recomputes its collider.
+    /// </summary>
     inline void SetPosition(const glm::vec2& pos, bool interpolate = false)
     {
         m_position = pos;
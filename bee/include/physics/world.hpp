@@ -1,8 +1,10 @@
 #pragma once
 
 #include <glm/vec2.hpp>
+#include <memory_resource>
 #include <optional>
 #include "tools/inspectable.hpp"
+#include "core/change_tracker.hpp"
 #include "core/ecs.hpp"
 
 namespace bee::physics
@@ -46,12 +48,14 @@ struct RaycastResult
 class World : public bee::System, bee::IEntityInspector
 {
 public:
-    World(const float fixedDeltaTime) : m_fixedDeltaTime(fixedDeltaTime) {}
+    /// <param name="fixedDeltaTime">The time step of the simulation, rounded to a whole number of engine ticks.</param>
+    World(const float fixedDeltaTime);
 
 #ifdef BEE_INSPECTOR
     void OnEntity(bee::Entity entity) override;
 #endif
 
+    void FixedUpdate(float dt) override;
     void Update(float dt) override;
 
     /// <summary>
@@ -61,8 +65,8 @@ public:
     /// <param name="gravity">The desired acceleration vector, in meters per second squared.</param>
     void SetGravity(const glm::vec2& gravity) { m_gravity = gravity; }
 
-    inline bool HasExecutedFrame() const { return m_hasExecutedFrame; }
-    inline float GetFixedDeltaTime() const { return m_fixedDeltaTime; }
+    /// <summary>Returns whether at least one simulation step ran during the current frame.</summary>
+    inline bool HasExecutedFrame() const { return m_lastSteppedFrame == bee::Engine.GetFrameIndex(); }
 
     /// <summary>
     /// Finds all physics objects that overlap with a given disk, and returns their entity IDs.
@@ -72,6 +76,14 @@ public:
     /// <returns>The IDs of all ECS entities that have a body+collider that overlaps with the given disk.</returns>
     static std::vector<bee::Entity> GetAllObjectsInRange(const glm::vec2& pos, float radius);
 
+    /// <summary>
+    /// Like GetAllObjectsInRange(), but allocates the result from the given memory resource, e.g. the frame arena or a
+    /// scratch arena.
+    /// </summary>
+    static std::pmr::vector<bee::Entity> GetAllObjectsInRange(const glm::vec2& pos,
+                                                              float radius,
+                                                              std::pmr::memory_resource* memory);
+
     /// <summary>
     /// Casts a 2D ray, and computes and returns information about the first physics object boundary that it hits.
     /// </summary>
@@ -91,13 +103,23 @@ public:
     /// origin.</returns>
     static std::vector<RaycastResult> RaycastGetAll(const glm::vec2& origin, const glm::vec2& direction);
 
+    /// <summary>
+    /// Like RaycastGetAll(), but allocates the result from the given memory resource, e.g. the frame arena or a scratch
+    /// arena.
+    /// </summary>
+    static std::pmr::vector<RaycastResult> RaycastGetAll(const glm::vec2& origin,
+                                                         const glm::vec2& direction,
+                                                         std::pmr::memory_resource* memory);
+
 private:
-    /// The fixed timestep (in seconds) for physics-related code.
-    float m_fixedDeltaTime;
-    float m_timeSinceLastFrame{0.f};
-    bool m_hasExecutedFrame{false};
+    uint64_t m_lastSteppedFrame{UINT64_MAX};
     glm::vec2 m_gravity{0, 0};
 
+    // Static bodies never move, so their polygon world points are only computed when they are created or changed
+    bee::ChangeTracker<Body> m_changedBodies;
+    bee::ChangeTracker<PolygonCollider> m_changedPolygons;
+    void UpdateStaticPolygons();
+
     static void ResolveCollision(const CollisionData& collision,
                                  Body& body1,
                                  Body& body2,
@@ -109,5 +131,11 @@ private:
                                   const bee::Entity& entity2,
                                   Body& body2);
     static void UpdateCollisionDetection();
+
+    // Shared by the overloads that return a std::vector and a std::pmr::vector
+    template <typename Results>
+    static void RaycastAll(const glm::vec2& origin, const glm::vec2& direction, Results& results);
+    template <typename Results>
+    static void CollectObjectsInRange(const glm::vec2& pos, float radius, Results& results);
 };
 }  // namespace bee::physics
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "platform/null/null_gl.hpp"
+
+struct GLFWwindow;
+
+// We cannot make some member functions static due to different implementations per platform. Ignore this linter warning.
+// NOLINTBEGIN(readability-convert-member-functions-to-static)
+namespace bee
+{
+
+/// <summary>
+/// A device without a window or a GPU, for measuring the CPU cost of the renderer on machines that have neither. The
+/// OpenGL renderer runs against the null GL driver, see LoadNullGL, and the device reports what it was asked to do per
+/// frame when it closes.
+/// </summary>
+class Device
+{
+public:
+    bool CanClose() { return true; }
+    void RequestClose() { m_shouldClose = true; }
+    bool ShouldClose() { return m_shouldClose; }
+    GLFWwindow* GetWindow() { return nullptr; }
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    float GetAspectRatio() const { return static_cast<float>(m_width) / static_cast<float>(m_height); }
+    void SetWindowSize(int width, int height);
+    void BeginFrame() {}
+    void EndFrame() {}
+    float GetMonitorUIScale() const { return 1.0f; }
+
+    /// <summary>
+    /// Closes the device after a number of frames, so that a benchmark runs for a fixed amount of work. 0 keeps running
+    /// until RequestClose.
+    /// </summary>
+    void SetFrameLimit(uint64_t frames) { m_frameLimit = frames; }
+
+    /// <summary>What the renderer asked of the null GL driver in the last frame.</summary>
+    const NullGLStats& GetFrameStats() const { return m_frameStats; }
+
+private:
+    friend class EngineClass;
+    Device();
+    ~Device();
+    Device(const Device&) = delete;
+    Device& operator=(const Device&) = delete;
+    Device(Device&&) = delete;
+    Device& operator=(Device&&) = delete;
+
+    void Update();
+
+    bool m_shouldClose = false;
+    int m_width = 1920;
+    int m_height = 1080;
+    uint64_t m_frameLimit = 0;
+    uint64_t m_frames = 0;
+    NullGLStats m_frameStats;
+    NullGLStats m_totalStats;
+    std::chrono::high_resolution_clock::time_point m_start;
+};
+}  // namespace bee
+
+// NOLINTEND(readability-convert-member-functions-to-static)
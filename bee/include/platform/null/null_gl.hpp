@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+namespace bee
+{
+
+/// <summary>
+/// What the engine asked of the null GL driver, see LoadNullGL.
+/// </summary>
+struct NullGLStats
+{
+    uint64_t DrawCalls = 0;       // draw and multi-draw calls
+    uint64_t Draws = 0;           // counting every command of a multi-draw call
+    uint64_t StateChanges = 0;    // binds, enables, blend state, viewports and programs
+    uint64_t UniformUpdates = 0;  // glUniform calls
+    uint64_t BytesUploaded = 0;   // buffer and texture data, writes to mapped buffers are not seen by the driver
+
+    NullGLStats& operator+=(const NullGLStats& other);
+};
+
+/// <summary>
+/// Points the GL functions that the engine calls at a driver that does nothing but count, so that the OpenGL renderer
+/// runs its whole CPU path without a GPU or a window. Objects get names, shaders compile and link, framebuffers are
+/// complete, fences are signaled, and mapped buffers are backed by memory. Functions that the engine does not call stay
+/// null, so calling one fails right away instead of silently doing nothing. GL is only called from the main thread.
+/// </summary>
+void LoadNullGL();
+
+/// <summary>
+/// Returns the counters since the last call, and resets them. Call once per frame.
+/// </summary>
+NullGLStats EndNullGLFrame();
+
+}  // namespace bee
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "rendering/indirect_draw.hpp"
+
+namespace bee
+{
+
+class Mesh;
+
+/// <summary>
+/// The geometry of many meshes in shared vertex and index buffers with one vertex array, so that draws of different
+/// meshes can be submitted with one multi-draw call. The attributes of a vertex are interleaved in one buffer, so that a
+/// vertex is fetched from one place. Attributes that a mesh does not have are zero, with a tangent w of one, which is
+/// what shaders read for a Mesh without them.
+/// Meshes are copied in from their CPU data when they are first drawn, and again when their data changed, together with
+/// the indices of their levels of detail, which share the vertices. The space of meshes that no longer exist is reused,
+/// and the buffers grow when they are full.
+/// </summary>
+class MeshArena
+{
+public:
+    /// <param name="quantize">Stores normals and tangents as 10 bit and texture coordinates as 16 bit floats, which
+    /// makes a vertex 40 instead of 68 bytes.</param>
+    explicit MeshArena(bool quantize = false);
+    ~MeshArena();
+    MeshArena(const MeshArena&) = delete;
+    MeshArena& operator=(const MeshArena&) = delete;
+    MeshArena(MeshArena&&) = delete;
+    MeshArena& operator=(MeshArena&&) = delete;
+
+    /// <summary>
+    /// Copies the geometry of the mesh in when it is not there yet, or when it changed.
+    /// </summary>
+    void Add(const std::shared_ptr<Mesh>& mesh);
+
+    /// <summary>
+    /// The ranges of all levels of detail of all meshes that were added, at Mesh::GetId() * DrawKey::c_maxLods + level.
+    /// Levels that a mesh does not have repeat its simplest one. Only valid for meshes passed to Add().
+    /// </summary>
+    const std::vector<MeshRange>& GetRanges() const { return m_ranges; }
+
+    unsigned int GetVAO() const { return m_vao; }
+    bool IsQuantized() const { return m_quantize; }
+    uint32_t GetVertexCapacity() const { return m_vertexCapacity; }
+    uint32_t GetIndexCapacity() const { return m_indexCapacity; }
+    uint32_t GetUsedVertices() const { return m_usedVertices; }
+    uint32_t GetUsedIndices() const { return m_usedIndices; }
+
+    /// <summary>A range of vertices or indices.</summary>
+    struct Block
+    {
+        uint32_t Offset = 0;
+        uint32_t Count = 0;
+    };
+
+private:
+    struct Entry
+    {
+        std::weak_ptr<Mesh> Mesh;
+        const bee::Mesh* Owner = nullptr;  // to tell meshes apart that got the same id
+        uint32_t Version = 0;
+        Block Vertices;
+        Block Indices;
+    };
+
+    void Insert(const std::shared_ptr<Mesh>& mesh, Entry& entry);
+    void Remove(Entry& entry);
+    void CollectGarbage();
+    void Grow(uint32_t vertexCapacity, uint32_t indexCapacity);
+
+    static constexpr int c_attributes = 6;
+
+    bool m_quantize = false;
+    uint32_t m_stride = 0;  // bytes per vertex
+    unsigned int m_vao = 0;
+    unsigned int m_vbo = 0;
+    unsigned int m_ebo = 0;
+    uint32_t m_vertexCapacity = 0;
+    uint32_t m_indexCapacity = 0;
+    uint32_t m_usedVertices = 0;
+    uint32_t m_usedIndices = 0;
+    std::vector<Block> m_freeVertices;  // sorted by offset
+    std::vector<Block> m_freeIndices;   // sorted by offset
+    std::vector<Entry> m_entries;       // indexed by Mesh::GetId()
+    std::vector<MeshRange> m_ranges;    // DrawKey::c_maxLods per mesh, indexed by Mesh::GetId()
+    std::vector<uint8_t> m_staging;     // the interleaved vertices of the mesh that is copied in
+};
+
+}  // namespace bee
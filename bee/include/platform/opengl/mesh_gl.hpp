@@ -4,6 +4,8 @@
 #include <glm/glm.hpp>
 #include "core/resource.hpp"
 #include "platform/opengl/render_gl.hpp"
+#include "rendering/draw_list.hpp"
+#include "rendering/mesh_data.hpp"
 
 namespace bee
 {
@@ -23,11 +25,26 @@ public:
     Mesh(Mesh&&) = delete;
     Mesh& operator=(Mesh&&) = delete;
 
-    inline const std::vector<glm::vec3>& GetPositions() const { return m_positions; }
+    inline const std::vector<glm::vec3>& GetPositions() const { return m_data.Positions; }
+
+    /// <summary>
+    /// The CPU copy of all vertex attributes and indices, as they were uploaded.
+    /// </summary>
+    inline const MeshData& GetData() const { return m_data; }
+
+    /// <summary>The bounding box of the positions, in the space of the mesh.</summary>
+    inline const glm::vec3& GetMin() const { return m_min; }
+    inline const glm::vec3& GetMax() const { return m_max; }
     inline unsigned int GetVAO() const { return m_vao; }
     inline uint32_t GetCount() const { return m_count; }
     inline uint32_t GetIndexType() const { return m_indexType; }
 
+    /// <summary>A small number that is unique among all meshes that exist, for sort keys (see DrawKey).</summary>
+    inline uint32_t GetId() const { return m_id.Get(); }
+
+    /// <summary>Changes whenever an attribute or the indices are set, for copies of the data to know they are old.</summary>
+    inline uint32_t GetVersion() const { return m_version; }
+
     enum class Attribute
     {
         Position,
@@ -42,10 +59,30 @@ public:
     void SetAttribute(Attribute attribute, std::vector<DataT>& data);
 
     void SetIndices(std::vector<uint16_t>& data);
+    void SetIndices(std::vector<uint32_t>& data);
+
+    /// <summary>
+    /// Uploads all attributes and the indices of the given geometry, and keeps its levels of detail.
+    /// </summary>
+    void SetData(const MeshData& data);
+
+    /// <summary>
+    /// Simplifies the indices into levels of detail that share the vertices, see bee::GenerateLods. Meshes loaded from
+    /// a model do this when they are loaded. Setting the indices removes the levels.
+    /// </summary>
+    void GenerateLods();
+
+    /// <summary>
+    /// Reorders the triangles and vertices of the mesh and its levels of detail for the vertex cache, overdraw and
+    /// vertex fetch, see bee::OptimizeMesh, uploads them again and logs the vertex cache stats before and after. Meshes
+    /// loaded from a model do this when they are loaded, after GenerateLods.
+    /// </summary>
+    void Optimize();
 
 protected:
-    void SetAttribute(Attribute attribute, size_t count, void* data);
-    void ComputeTangents(const Model& model, size_t meshIndex, size_t primitiveIndex);
+    void SetAttribute(Attribute attribute, size_t count, const void* data);
+    void SetIndices(size_t count, const void* data, uint32_t type);
+    void ComputeTangents();
     static std::string GetPath(const Model& model, size_t meshIndex, size_t primitiveIndex);
     static std::vector<glm::vec4> ComputeTangents(const std::vector<glm::vec3>& positions,
                                                   const std::vector<glm::vec3>& normals,
@@ -56,7 +93,11 @@ protected:
     std::array<unsigned int, 9> m_vbo = {0, 0, 0, 0, 0, 0, 0, 0, 0};
     uint32_t m_count = 0;
     uint32_t m_indexType = 0;
-    std::vector<glm::vec3> m_positions;
+    MeshData m_data;
+    glm::vec3 m_min = glm::vec3(0.0f);
+    glm::vec3 m_max = glm::vec3(0.0f);
+    RenderId<Mesh> m_id;
+    uint32_t m_version = 0;
 };
 
 template <typename DataT>
@@ -65,11 +106,4 @@ inline void Mesh::SetAttribute(Attribute attribute, std::vector<DataT>& data)
     SetAttribute(attribute, data.size() * sizeof(data[0]), &data[0]);
 }
 
-template <>
-inline void Mesh::SetAttribute(Attribute attribute, std::vector<glm::vec3>& data)
-{
-    SetAttribute(attribute, data.size() * sizeof(data[0]), data.data());
-    if (attribute == Attribute::Position) m_positions = data;
-}
-
 }  // namespace bee
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bee
+{
+
+/// <summary>
+/// A GPU buffer that stays mapped for as long as it exists, for data that the CPU writes every frame. It is split into
+/// c_regions regions that frames write to in turn. A frame first waits on the fence of the frame that used its region
+/// before, so the CPU never overwrites data that the GPU still reads, and with three regions it hardly ever has to wait.
+/// The mapping is coherent, so draws see everything that was written before they were issued.
+/// When a frame needs more than a region holds, the buffer is replaced by a larger one. Draws that were already issued
+/// keep the old buffer alive until they finished.
+/// </summary>
+class PersistentBuffer
+{
+public:
+    static constexpr int c_regions = 3;
+    static constexpr uint32_t c_noBinding = ~0u;
+
+    /// <summary>
+    /// Creates the buffer and binds it to an indexed binding point of the target, such as GL_SHADER_STORAGE_BUFFER.
+    /// Targets without indexed binding points, such as GL_DRAW_INDIRECT_BUFFER, pass c_noBinding and bind GetBuffer()
+    /// before use.
+    /// </summary>
+    PersistentBuffer(uint32_t target, uint32_t binding, size_t regionSize, std::string label);
+    ~PersistentBuffer();
+    PersistentBuffer(const PersistentBuffer&) = delete;
+    PersistentBuffer& operator=(const PersistentBuffer&) = delete;
+    PersistentBuffer(PersistentBuffer&&) = delete;
+    PersistentBuffer& operator=(PersistentBuffer&&) = delete;
+
+    /// <summary>
+    /// Moves to the next region, after waiting until the GPU finished the frame that used it before.
+    /// </summary>
+    void BeginFrame();
+
+    /// <summary>
+    /// Fences the region of this frame. Call after issuing the last draw that reads it.
+    /// </summary>
+    void EndFrame();
+
+    /// <summary>
+    /// Reserves size bytes in the region of this frame, at an offset from the start of the buffer that is a multiple
+    /// of alignment. Returns the memory to write to, and the offset in offset.
+    /// </summary>
+    void* Allocate(size_t size, size_t alignment, size_t& offset);
+
+    /// <summary>
+    /// Reserves count elements of type T. first is the index of the first one from the start of the buffer, which is
+    /// the base instance for draws that read them as an array.
+    /// </summary>
+    template <typename T>
+    T* Allocate(size_t count, uint32_t& first)
+    {
+        size_t offset = 0;
+        auto* data = static_cast<T*>(Allocate(sizeof(T) * count, sizeof(T), offset));
+        first = static_cast<uint32_t>(offset / sizeof(T));
+        return data;
+    }
+
+    unsigned int GetBuffer() const { return m_buffer; }
+    size_t GetRegionSize() const { return m_regionSize; }
+    size_t GetUsed() const { return m_used; }  // in the region of this frame, in bytes
+
+    /// <summary>The number of frames that had to wait for the GPU before they could write.</summary>
+    int GetStalls() const { return m_stalls; }
+
+private:
+    void Create(size_t regionSize);
+    void Delete();
+
+    uint32_t m_target = 0;
+    uint32_t m_binding = 0;
+    std::string m_label;
+    unsigned int m_buffer = 0;
+    std::byte* m_mapped = nullptr;
+    size_t m_regionSize = 0;
+    size_t m_used = 0;
+    int m_region = 0;
+    void* m_fences[c_regions] = {};  // GLsync of the last frame that wrote each region
+    int m_stalls = 0;
+};
+
+}  // namespace bee
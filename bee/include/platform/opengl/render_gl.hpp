@@ -1,13 +1,25 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <glm/glm.hpp>
+#include <map>
 #include <memory>
 
 #include "core/ecs.hpp"
 #include "core/fileio.hpp"
 #include "imgui/IconsFontAwesome.h"
 #include "platform/opengl/shader_gl.hpp"
+#include "rendering/command_buffer.hpp"
+#include "rendering/draw_list.hpp"
+#include "rendering/dynamic_resolution.hpp"
+#include "rendering/frame_packet.hpp"
+#include "rendering/indirect_draw.hpp"
+#include "rendering/light_clusters.hpp"
+#include "rendering/mesh_data.hpp"
+#include "rendering/occlusion_culler.hpp"
 #include "rendering/render_components.hpp"
+#include "rendering/shadow_cascades.hpp"
 #include "tools/inspectable.hpp"
 #include "tools/visitable.hpp"
 
@@ -15,11 +27,11 @@ namespace bee
 {
 
 struct CameraUBO;
-struct PointLightsUBO;
-struct TransformsUBO;
 struct DirectionalLightsUBO;
 struct MeshRenderer;
 struct Transform;
+class PersistentBuffer;
+class MeshArena;
 
 struct DebugData
 {
@@ -42,7 +54,8 @@ public:
     Renderer(Renderer&&) = delete;
     Renderer& operator=(Renderer&&) = delete;
 
-    void Render() override;
+    void Extract() override;
+    void Submit() override;
     void LoadEnvironment(FileIO::Directory directory, const std::string& filename);
     void SetFog(glm::vec4 fogColor, float forNear, float fogFar);
 
@@ -61,23 +74,191 @@ public:
     /// maximum intensity.</param>
     void SetVignette(float value);
 
+    /// <summary>
+    /// Merges the meshes of all Static entities that share a material into pre-transformed batches, one per chunk of a
+    /// world-space grid, so that they are drawn with a few draw calls instead of one instance each (see
+    /// BuildStaticBatches). Replaces the batches of an earlier call. Meant to be called once a level has been loaded,
+    /// from the main thread and outside of Extract(). Static entities created later are drawn one by one until this
+    /// is called again.
+    /// </summary>
+    /// <param name="chunkSize">The size of a chunk in world units. Smaller chunks cull better but need more draws.</param>
+    void BakeStaticGeometry(float chunkSize = 100.0f);
+
+    /// <summary>
+    /// Stores normals, tangents and texture coordinates of the meshes that are drawn in fewer bits, see MeshArena.
+    /// Changing it empties the mesh arena, and meshes are copied in again when they are drawn next.
+    /// </summary>
+    void SetVertexQuantization(bool value);
+
+    /// <summary>
+    /// Enables or disables culling meshes that are hidden behind the meshes that are largest on screen, see
+    /// CullOccluded. Enabled by default, and never used for 2D games with alpha blending.
+    /// </summary>
+    void SetOcclusionCulling(bool value) { m_occlusionCulling = value; }
+
+    /// <summary>
+    /// Enables or disables rendering the scene at a lower resolution, and with fewer MSAA samples, while the GPU takes
+    /// longer than the target of the controller (see DynamicResolution). The post pass scales the scene up to the
+    /// screen. Enabled by default, disabling it goes back to the full resolution.
+    /// </summary>
+    void SetDynamicResolution(bool value);
+    DynamicResolution& GetDynamicResolution() { return m_dynamicResolution; }
+
 private:
-    void ProcessObjectForRendering(const bee::MeshRenderer& renderer, bee::Transform& transform, int& instances);
-    void RenderCurrentInstances(int instances);
-    void CreateFrameBuffers();
+    /// <summary>
+    /// The level of detail of a mesh of the packet in a view, kept from frame to frame for hysteresis.
+    /// </summary>
+    struct LodState
+    {
+        const Mesh* Mesh = nullptr;  // only to tell whether the level was selected for the same mesh
+        uint8_t Lod = 0;
+    };
+
+    /// <summary>
+    /// Selects a level of detail for every mesh of the packet in every view, from the screen size of its bounds, see
+    /// SelectLod. Runs on the job system.
+    /// </summary>
+    void SelectLods(const FramePacket& packet);
+
+    /// <summary>
+    /// Numbers the texture sets of the materials in the packet and builds the part of the sort key of every mesh that
+    /// does not depend on the view, into m_sharedKeys. Once per frame, views only add their level of detail and depth.
+    /// </summary>
+    void BuildSharedKeys(const FramePacket& packet);
+
+    /// <summary>
+    /// What a view of the packet draws, built by CullView. Kept from frame to frame for its memory, except for Visible,
+    /// which is filled on a job and read until the views are drawn, so it lives in the engine's frame arena.
+    /// </summary>
+    struct ViewState
+    {
+        uint8_t* Visible = nullptr;  // by mesh in the packet, until the end of the frame
+        size_t NumVisible = 0;
+        DrawList Draws;
+        OcclusionCuller Occlusion;
+        std::vector<std::pair<float, uint32_t>> Occluders;  // screen size and index of the meshes that may occlude
+        std::vector<DrawList> Particles;  // by particle batch of the packet, back to front, only of blended batches
+#ifdef BEE_INSPECTOR
+        int OccluderMeshes = 0;
+        int OccluderTriangles = 0;
+        int OccludedMeshes = 0;
+        float OcclusionTime = 0.0f;  // in milliseconds
+#endif
+    };
+
+    /// <summary>
+    /// Culls every view of the packet, builds its draw list and sorts its blended particles, into m_views. The views run
+    /// in parallel on the job system. Only reads the renderer and the packet, after SelectLods and BuildSharedKeys.
+    /// </summary>
+    void CullViews(const FramePacket& packet);
+    void CullView(const FramePacket& packet, size_t view);
+
+    /// <summary>
+    /// Rasterizes the meshes of a view that are largest on screen into its occlusion culler, at their simplest level of
+    /// detail and up to c_maxOccluderTriangles, and clears Visible[i] for the meshes that are hidden behind them.
+    /// Rasterizing and testing run on the job system. Returns the number of meshes that were culled.
+    /// </summary>
+    size_t CullOccluded(const FramePacket& packet, const FramePacket::ViewInstance& view, ViewState& state) const;
+
+    /// <summary>
+    /// Fills a draw list with the visible meshes of a packet and sorts it, so that meshes that share state are next to
+    /// each other, and instances of a mesh at the same level of detail (from lods) can be drawn together. Keys are built
+    /// on the job system, opaque ones from m_sharedKeys. Materials that bind the same textures are sorted next to each
+    /// other, see GetTextureSet. Only reads the renderer, so lists of different views can be built at the same time.
+    /// </summary>
+    void BuildDrawList(const FramePacket& packet,
+                       const uint8_t* visible,
+                       size_t numVisible,
+                       DrawKey::Pass pass,
+                       const glm::vec3& eye,
+                       const std::vector<LodState>& lods,
+                       DrawList& drawList) const;
+    /// <summary>
+    /// Draws a draw list with one glMultiDrawElementsIndirect per bucket of materials with the same textures. Splits the
+    /// list into a slice per thread, which write the transforms of their instances and record their commands in
+    /// parallel (see RecordDraws), and then replays the command buffers in order. Copies meshes into the mesh arena
+    /// when they are not in it yet.
+    /// </summary>
+    void DrawIndirect(const FramePacket& packet, const DrawList& drawList, const glm::mat4& viewProjection, bool shade);
+
+    /// <summary>
+    /// Records the indirect commands of draws [begin, end) of a draw list, with shade the material of every command, and
+    /// a multi-draw per bucket. Only reads the renderer, so slices can be recorded on different threads.
+    /// </summary>
+    void RecordDraws(const FramePacket& packet,
+                     const DrawList& drawList,
+                     size_t begin,
+                     size_t end,
+                     uint32_t firstInstance,
+                     bool shade,
+                     CommandBuffer& buffer,
+                     IndirectCommands& commands) const;
+
+    /// <summary>
+    /// Uploads what a command buffer recorded to the persistent buffers and issues its draws. Calls GL, so it runs on
+    /// the main thread.
+    /// </summary>
+    void ReplayCommands(const CommandBuffer& buffer);
+
+    /// <summary>
+    /// Draws every particle batch of the packet with one instanced draw of camera-facing quads, after the meshes of a
+    /// view. Particles are tested against the depth of the meshes but do not write it. Blended batches are written to
+    /// the particle buffer in the order that CullView sorted them in, additive ones in any order.
+    /// </summary>
+    void DrawParticles(const FramePacket& packet, const ViewState& state);
+
+    /// <summary>
+    /// Copies the skid mark quads that changed into m_skidMarkVBO, which mirrors the whole SkidMarkRing, once per frame.
+    /// </summary>
+    void UploadSkidMarks(const FramePacket& packet);
+
+    /// <summary>
+    /// Draws all skid marks with one glDrawElements over every slot of the ring that holds a quad, after the meshes of
+    /// a view. The shader fades marks by age, so old quads do not have to be uploaded again.
+    /// </summary>
+    void DrawSkidMarks(const FramePacket& packet);
+
+    /// <summary>
+    /// A small number for the textures that a material binds, the same for all materials with the same textures in
+    /// this pass. Everything else of a material is fetched per draw, so these can share a multi-draw call.
+    /// </summary>
+    uint32_t GetTextureSet(const Material& material);
+    void ExtractStaticMeshes(FramePacket& packet);
+    void OnStaticEntityChanged(entt::registry& registry, Entity entity);
+    void OnComponentChanged(entt::registry& registry, Entity entity);
+    void CreateFrameBuffers();  // at the scale and samples of m_dynamicResolution
     void DeleteFrameBuffers();
-    void CreateShadowMaps();
+    void CreateShadowMap(int light);
     void DeleteShadowMaps();
-    void RenderShadowMaps();
+
+    /// <summary>
+    /// Fits the cascades of every directional light that casts shadows to the first view, and draws the ones that are
+    /// not cached, see ShadowMap.
+    /// </summary>
+    void RenderShadowMaps(const FramePacket& packet);
+    void RenderShadowCascade(const FramePacket& packet, int light, int cascade, bool staticOnly);
+    void UploadLightClusters();  // of the view that m_lightClusters was built for
     void DeleteUBOs();
-    void ApplyMaterial(const std::shared_ptr<bee::Material>& material);
 
-    int m_width = -1;
+    /// <summary>
+    /// Passes the GPU times of earlier frames that are available to m_dynamicResolution, and recreates the frame
+    /// buffers when its scale or samples changed.
+    /// </summary>
+    void UpdateResolution();
+    void ApplyMaterial(const Material& material);
+
+    int m_width = -1;         // of the screen and the final frame buffer
     int m_height = -1;
+    int m_renderWidth = -1;   // of the scene, which the post pass scales up to the screen
+    int m_renderHeight = -1;
     int m_msaa = 4;
     static const int m_max_dir_lights = 4;                   // In sync with Uniformsl.glsl
     static const unsigned int c_invalid_index = 4294967295;  // Just -1 casted to unsigned int
-    const int m_shadowResolution = 2048;
+    const int m_shadowResolution = 2048;                     // of every cascade
+    static const int c_shadowCascades = 4;                   // In sync with MAX_SHADOW_CASCADES in uniforms.glsl
+    static const int c_firstCachedCascade = 2;
+    static constexpr float c_cascadeSplitLambda = 0.75f;     // logarithmic rather than uniform cascade splits
+    static constexpr float c_cachedCascadeMargin = 1.3f;     // how much more a cached cascade covers than its slice
 
     unsigned int m_msaaFramebuffer = 0;
     unsigned int m_msaaColorbuffer = 0;
@@ -87,8 +268,23 @@ private:
     unsigned int m_resolvedDepthbuffer = 0;
     unsigned int m_finalFramebuffer = 0;
     unsigned int m_finalColorbuffer = 0;
-    unsigned int m_shadowFBOs[m_max_dir_lights];
-    unsigned int m_shadowMaps[m_max_dir_lights];
+
+    /// <summary>
+    /// The cascaded shadow map of a directional light, a texture array with a layer per cascade, created when the light
+    /// first casts shadows. Cascades from c_firstCachedCascade on are far away, so they only hold static meshes and
+    /// cover a bit more than their slice. They are only drawn again when the light turns, the static meshes change, or
+    /// their slice of the view moves out of them.
+    /// </summary>
+    struct ShadowMap
+    {
+        unsigned int Texture = 0;
+        unsigned int FBO = 0;
+        ShadowCascade Cascades[c_shadowCascades];
+        float Splits[c_shadowCascades] = {};  // where each cascade ends along the view direction, 0 without shadows
+        bool Cached[c_shadowCascades] = {};   // whether the layer of a cached cascade holds its static meshes
+        std::weak_ptr<const FramePacket::MeshList> StaticMeshes;  // that the cached cascades hold
+    };
+    ShadowMap m_shadowMaps[m_max_dir_lights];
 
     std::shared_ptr<Shader> m_toneMappingPass = nullptr;
     std::shared_ptr<Shader> m_envDebugPass = nullptr;
@@ -99,18 +295,49 @@ private:
     CameraUBO* m_cameraData = nullptr;
     unsigned int m_cameraUBO = c_invalid_index;
 
-    PointLightsUBO* m_pointLightsData = nullptr;
-    unsigned int m_pointLightsUBO = c_invalid_index;
+    unsigned int m_pointLightsSSBO = c_invalid_index;  // all point lights of a frame, uploaded once
+    unsigned int m_clustersSSBO = c_invalid_index;     // the point lights of every cluster of a view
+    LightClusters m_lightClusters;
+
+    bool m_occlusionCulling = true;
+    static constexpr float c_minOccluderSize = 0.1f;  // see GetScreenSize
+    static const size_t c_maxOccluderTriangles = 16384;  // per view
 
-    TransformsUBO* m_transformsData = nullptr;
-    unsigned int m_transformsUBO = c_invalid_index;
+    std::unique_ptr<PersistentBuffer> m_instances;         // transforms of every instance in a frame
+    std::unique_ptr<PersistentBuffer> m_indirectCommands;  // of every multi-draw call in a frame
+    std::unique_ptr<PersistentBuffer> m_drawMaterials;     // of every indirect command in a frame
+    std::unique_ptr<PersistentBuffer> m_particles;         // of every particle batch in every view of a frame
+    std::unique_ptr<MeshArena> m_meshArena;
+    unsigned int m_particleVAO = 0;  // without attributes, particles read everything from m_particles
+    unsigned int m_skidMarkVAO = 0;
+    unsigned int m_skidMarkVBO = 0;  // 4 vertices per slot of the SkidMarkRing
+    unsigned int m_skidMarkIBO = 0;  // 6 indices per slot, which never change
+    uint32_t m_skidMarkCapacity = 0;  // slots that the buffers were allocated for
+    int m_skidMarkLatency = -1;       // the frame latency at the last extraction, see Extract
+    static const size_t c_initialInstances = 16384;
+    static const size_t c_initialParticles = 65536;
+    static const size_t c_minDrawsPerCommandBuffer = 256;  // fewer are not worth a job of their own
 
-    std::shared_ptr<Material> m_currentMaterial;
-    std::shared_ptr<Mesh> m_currentMesh;
+    FramePacket m_packets[2];  // extracted and submitted alternately, see EngineClass::SetFrameLatency
+    std::shared_ptr<const FramePacket::MeshList> m_staticMeshes;
+    std::atomic<bool> m_staticMeshesDirty{true};  // set by registry signals, possibly from worker threads
+    std::vector<FramePacket::MeshInstance> m_staticBatches;  // baked by BakeStaticGeometry, in world space
+    size_t m_staticBatchedMeshes = 0;
+
+    std::vector<std::vector<LodState>> m_lods;  // of every view, by mesh in the packet
+    std::vector<uint64_t> m_sharedKeys;        // of the opaque pass, by mesh in the packet, see BuildSharedKeys
+    std::vector<ViewState> m_views;            // of every view of the packet
+    DrawList m_drawList;  // of the shadow cascade that is being drawn
+    std::vector<CommandBuffer> m_commandBuffers;   // of every slice of m_drawList, replayed in order
+    std::vector<IndirectCommands> m_sliceCommands;  // built by the slices while recording
+    std::vector<uint32_t> m_textureSets;  // by material id, of the materials in the packet that is being drawn
+    std::map<std::array<const Texture*, 5>, uint32_t> m_textureSetIds;
 
     std::shared_ptr<Shader> m_forwardPass = nullptr;
     std::shared_ptr<Shader> m_post = nullptr;
     std::shared_ptr<Shader> m_shadowPass = nullptr;
+    std::shared_ptr<Shader> m_particlePass = nullptr;
+    std::shared_ptr<Shader> m_skidMarkPass = nullptr;
 
     unsigned int m_hdrTexture = 0;
     unsigned int m_envCubemap = 0;
@@ -124,6 +351,14 @@ private:
 
     bool m_useAlphaBlending = false;
 
+    DynamicResolution m_dynamicResolution;
+    bool m_dynamicResolutionEnabled = true;
+    static const int c_gpuTimers = 4;  // GL_TIME_ELAPSED queries of the frames whose times were not read yet
+    unsigned int m_gpuTimers[c_gpuTimers] = {};
+    uint64_t m_gpuTimersBegun = 0;
+    uint64_t m_gpuTimersRead = 0;
+    float m_gpuTime = 0.0f;  // in milliseconds, of the last frame that was read
+
 #ifdef BEE_INSPECTOR
 public:
     void Reload();
@@ -131,6 +366,23 @@ public:
     bool m_reload = false;
     int m_drawCalls = 0;
     int m_drawInstances = 0;
+    int m_materialChanges = 0;
+    int m_visibleMeshes = 0;   // in the last view
+    int m_totalMeshes = 0;     // that were tested against the last view
+    int m_shadowCasters = 0;   // visible to any shadow cascade, summed over cascades and lights
+    int m_shadowCascadesDrawn = 0;
+    int m_shadowCascadesCached = 0;
+    int m_pointLights = 0;
+    int m_maxClusterLights = 0;  // of any view
+    int m_commandBuffersRecorded = 0;
+    int m_lodInstances[MeshData::c_maxLods] = {};  // drawn in any view
+    int m_occluderMeshes = 0;     // in the last view
+    int m_occluderTriangles = 0;  // in the last view
+    int m_occludedMeshes = 0;     // in the last view
+    float m_occlusionTime = 0.0f;  // in milliseconds, of the last view
+    float m_cullTime = 0.0f;       // in milliseconds, of all views together
+    int m_particleInstances = 0;   // drawn in any view
+    int m_skidMarkQuads = 0;       // in the last view, including faded ones
 
     void OnPanel() override;
     std::string GetName() const override { return "Render"; }
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "rendering/culling.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// A bounding volume hierarchy over axis-aligned boxes, for queries that only visit the part of a scene they overlap.
+/// Build() creates the tree with the surface area heuristic, which gives the best trees but takes O(n log n). When
+/// boxes move, SetBounds() and Refit() (or Update() for a few of them) grow and shrink the existing nodes instead,
+/// which is fast but makes the tree worse the further the boxes move. Compare GetCost() with GetBuildCost() to decide
+/// when to build again.
+/// Items are identified by their index in the boxes that the tree was built from.
+/// </summary>
+class BoundingVolumeHierarchy
+{
+public:
+    /// <summary>
+    /// Builds the tree for the given boxes, with at most maxLeafSize items per leaf.
+    /// </summary>
+    void Build(const BoundingBoxes& bounds, uint32_t maxLeafSize = 4);
+    void Clear();
+
+    size_t GetItemCount() const { return m_itemMin.size(); }
+    size_t GetNodeCount() const { return m_nodes.size(); }
+    const glm::vec3& GetItemMin(uint32_t item) const { return m_itemMin[item]; }
+    const glm::vec3& GetItemMax(uint32_t item) const { return m_itemMax[item]; }
+
+    /// <summary>
+    /// Changes the box of an item and updates the nodes above it right away. Best when only a few items moved.
+    /// </summary>
+    void Update(uint32_t item, const glm::vec3& min, const glm::vec3& max);
+
+    /// <summary>
+    /// Changes the box of an item without updating the tree, call Refit() once all items are set.
+    /// </summary>
+    void SetBounds(uint32_t item, const glm::vec3& min, const glm::vec3& max);
+
+    /// <summary>
+    /// Updates the boxes of all nodes from the boxes of the items, bottom-up in O(n).
+    /// </summary>
+    void Refit();
+
+    /// <summary>
+    /// The surface area heuristic cost of the tree: the expected number of nodes and items that a random ray visits.
+    /// </summary>
+    float GetCost() const;
+    float GetBuildCost() const { return m_buildCost; }
+
+    /// <summary>
+    /// Calls function(item) for every item whose box overlaps the given box.
+    /// </summary>
+    template <typename F>
+    void QueryAABB(const glm::vec3& min, const glm::vec3& max, F&& function) const;
+
+    /// <summary>
+    /// Calls function(item) for every item whose box intersects the frustum. Items in nodes that are completely inside
+    /// the frustum are not tested on their own.
+    /// </summary>
+    template <typename F>
+    void QueryFrustum(const Frustum& frustum, F&& function) const;
+
+    /// <summary>
+    /// Calls function(item, distance) for every item whose box the ray hits within maxDistance, where distance is where
+    /// the ray enters the box. Nearer nodes are visited first. The function returns the new maxDistance, so a search
+    /// for the nearest hit returns the distance of its hit, and a search for all hits returns maxDistance.
+    /// </summary>
+    /// <param name="direction">The direction of the ray, does not need to be normalized; distances are in its
+    /// length.</param>
+    template <typename F>
+    void QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, F&& function) const;
+
+private:
+    struct Node
+    {
+        glm::vec3 Min = glm::vec3(0.0f);
+        uint32_t First = 0;  // the left child, the right child is First + 1. For leaves, the first in m_items.
+        glm::vec3 Max = glm::vec3(0.0f);
+        uint32_t Count = 0;  // the number of items in a leaf, 0 for other nodes
+
+        bool IsLeaf() const { return Count > 0; }
+    };
+
+    static constexpr int c_stackSize = 64;
+
+    void Subdivide(uint32_t node, uint32_t maxLeafSize, int depth);
+    void UpdateLeafBounds(uint32_t node);
+    static float RayBox(const glm::vec3& origin,
+                        const glm::vec3& inverseDirection,
+                        const glm::vec3& min,
+                        const glm::vec3& max,
+                        float maxDistance);
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_parents;  // of every node, the root is its own parent
+    std::vector<uint32_t> m_items;    // item indices, leaves refer to ranges of this
+    std::vector<uint32_t> m_leaves;   // the leaf of every item
+    std::vector<glm::vec3> m_itemMin;
+    std::vector<glm::vec3> m_itemMax;
+    float m_buildCost = 0.0f;
+};
+
+template <typename F>
+void BoundingVolumeHierarchy::QueryAABB(const glm::vec3& min, const glm::vec3& max, F&& function) const
+{
+    if (m_nodes.empty()) return;
+
+    uint32_t stack[c_stackSize];
+    int size = 0;
+    stack[size++] = 0;
+    while (size > 0)
+    {
+        const Node& node = m_nodes[stack[--size]];
+        if (glm::any(glm::lessThan(node.Max, min)) || glm::any(glm::greaterThan(node.Min, max))) continue;
+
+        if (node.IsLeaf())
+        {
+            for (uint32_t i = node.First; i < node.First + node.Count; i++)
+            {
+                const uint32_t item = m_items[i];
+                if (glm::all(glm::lessThanEqual(m_itemMin[item], max)) &&
+                    glm::all(glm::greaterThanEqual(m_itemMax[item], min)))
+                    function(item);
+            }
+        }
+        else
+        {
+            stack[size++] = node.First;
+            stack[size++] = node.First + 1;
+        }
+    }
+}
+
+template <typename F>
+void BoundingVolumeHierarchy::QueryFrustum(const Frustum& frustum, F&& function) const
+{
+    if (m_nodes.empty()) return;
+
+    struct Entry
+    {
+        uint32_t Node;
+        bool Inside;  // the parent is completely inside the frustum
+    };
+
+    Entry stack[c_stackSize];
+    int size = 0;
+    stack[size++] = {0, false};
+    while (size > 0)
+    {
+        const Entry entry = stack[--size];
+        const Node& node = m_nodes[entry.Node];
+
+        bool inside = entry.Inside;
+        if (!inside)
+        {
+            if (!frustum.Intersects(node.Min, node.Max)) continue;
+            inside = frustum.Contains(node.Min, node.Max);
+        }
+
+        if (node.IsLeaf())
+        {
+            for (uint32_t i = node.First; i < node.First + node.Count; i++)
+            {
+                const uint32_t item = m_items[i];
+                if (inside || frustum.Intersects(m_itemMin[item], m_itemMax[item])) function(item);
+            }
+        }
+        else
+        {
+            stack[size++] = {node.First, inside};
+            stack[size++] = {node.First + 1, inside};
+        }
+    }
+}
+
+template <typename F>
+void BoundingVolumeHierarchy::QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, F&& function)
+    const
+{
+    if (m_nodes.empty()) return;
+
+    const glm::vec3 inverseDirection = 1.0f / direction;
+
+    uint32_t stack[c_stackSize];
+    int size = 0;
+    if (RayBox(origin, inverseDirection, m_nodes[0].Min, m_nodes[0].Max, maxDistance) >= 0.0f) stack[size++] = 0;
+    while (size > 0)
+    {
+        const Node& node = m_nodes[stack[--size]];
+        if (node.IsLeaf())
+        {
+            for (uint32_t i = node.First; i < node.First + node.Count; i++)
+            {
+                const uint32_t item = m_items[i];
+                const float distance = RayBox(origin, inverseDirection, m_itemMin[item], m_itemMax[item], maxDistance);
+                if (distance >= 0.0f) maxDistance = function(item, distance);
+            }
+            continue;
+        }
+
+        // Push the nearer child last, so that it is visited first and can shorten the ray for the other one
+        const Node& left = m_nodes[node.First];
+        const Node& right = m_nodes[node.First + 1];
+        const float leftDistance = RayBox(origin, inverseDirection, left.Min, left.Max, maxDistance);
+        const float rightDistance = RayBox(origin, inverseDirection, right.Min, right.Max, maxDistance);
+        const bool leftFirst = leftDistance >= 0.0f && (rightDistance < 0.0f || leftDistance <= rightDistance);
+        if (leftFirst)
+        {
+            if (rightDistance >= 0.0f) stack[size++] = node.First + 1;
+            stack[size++] = node.First;
+        }
+        else
+        {
+            if (leftDistance >= 0.0f) stack[size++] = node.First;
+            if (rightDistance >= 0.0f) stack[size++] = node.First + 1;
+        }
+    }
+}
+
+}  // namespace bee
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace bee
+{
+
+/// <summary>
+/// A list of bind, upload and draw commands that is recorded on any thread and replayed later on the thread that owns
+/// the graphics context, so that the work of preparing draws can be split over worker threads while the graphics API is
+/// only called from one. Commands are plain data and only name their target by a number: the backend that replays them
+/// decides what a target is. Several buffers that recorded consecutive parts of a pass are replayed one after another,
+/// in the order of the pass.
+/// Buffers keep their memory when they are cleared, so recording does not allocate in the steady state.
+/// </summary>
+class CommandBuffer
+{
+public:
+    enum class Type : uint8_t
+    {
+        Bind,    // Object to a target, for example a material
+        Upload,  // Size bytes of GetData(), from Offset on, to a target
+        Draw,    // Count elements of a target, from First on, relative to the last upload to that target
+    };
+
+    struct Command
+    {
+        CommandBuffer::Type Type = CommandBuffer::Type::Bind;
+        uint32_t Target = 0;
+        uint32_t First = 0;  // or Offset
+        uint32_t Count = 0;  // or Size
+        const void* Object = nullptr;
+    };
+
+    void Clear()
+    {
+        m_commands.clear();
+        m_data.clear();
+    }
+
+    void Bind(uint32_t target, const void* object) { m_commands.push_back({Type::Bind, target, 0, 0, object}); }
+
+    /// <summary>
+    /// Reserves room for count elements of T to upload to a target. Returns where to write them, which is only valid
+    /// until the next upload to this buffer.
+    /// </summary>
+    template <typename T>
+    T* Upload(uint32_t target, size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "uploads are copied as bytes");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "uploads are only aligned to what new aligns to");
+        const size_t offset = (m_data.size() + alignof(T) - 1) / alignof(T) * alignof(T);
+        const size_t size = sizeof(T) * count;
+        m_data.resize(offset + size);
+        m_commands.push_back({Type::Upload, target, static_cast<uint32_t>(offset), static_cast<uint32_t>(size)});
+        return reinterpret_cast<T*>(m_data.data() + offset);
+    }
+
+    void Draw(uint32_t target, uint32_t first, uint32_t count)
+    {
+        m_commands.push_back({Type::Draw, target, first, count, nullptr});
+    }
+
+    const std::vector<Command>& GetCommands() const { return m_commands; }
+    const std::byte* GetData(const Command& upload) const { return m_data.data() + upload.First; }
+    bool Empty() const { return m_commands.empty(); }
+
+private:
+    std::vector<Command> m_commands;
+    std::vector<std::byte> m_data;
+};
+
+}  // namespace bee
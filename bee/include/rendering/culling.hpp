@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace bee
+{
+
+/// <summary>
+/// The six planes of a view volume, pointing inwards: a point p is inside a plane when dot(plane.xyz, p) + plane.w >= 0.
+/// </summary>
+struct Frustum
+{
+    /// <summary>
+    /// Extracts the planes from a (view) projection matrix with OpenGL clip space, so -w <= x, y, z <= w.
+    /// </summary>
+    static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+    /// <summary>
+    /// Returns false when the box is completely outside one of the planes. Boxes that intersect the volume, and a few
+    /// near its corners that do not, return true.
+    /// </summary>
+    bool Intersects(const glm::vec3& min, const glm::vec3& max) const;
+
+    /// <summary>
+    /// Returns true when the box is completely inside the frustum.
+    /// </summary>
+    bool Contains(const glm::vec3& min, const glm::vec3& max) const;
+
+    glm::vec4 Planes[6];
+};
+
+/// <summary>
+/// Axis-aligned bounding boxes stored as a structure of arrays, so that they can be culled several at a time with SIMD.
+/// </summary>
+class BoundingBoxes
+{
+public:
+    void Add(const glm::vec3& min, const glm::vec3& max);
+    void Clear();
+    void Reserve(size_t count);
+    size_t Size() const { return m_minX.size(); }
+    glm::vec3 GetMin(size_t index) const { return {m_minX[index], m_minY[index], m_minZ[index]}; }
+    glm::vec3 GetMax(size_t index) const { return {m_maxX[index], m_maxY[index], m_maxZ[index]}; }
+
+    /// <summary>
+    /// Writes 1 to visible[i] for every box i that intersects the frustum and 0 for all others, and returns the number
+    /// of visible boxes. visible must have room for Size() entries. Tests 8 boxes at a time with AVX, 4 with SSE, and
+    /// one at a time on other platforms.
+    /// </summary>
+    size_t Cull(const Frustum& frustum, uint8_t* visible) const;
+
+private:
+    std::vector<float> m_minX, m_minY, m_minZ;
+    std::vector<float> m_maxX, m_maxY, m_maxZ;
+};
+
+/// <summary>
+/// Returns the axis-aligned box around a box after transforming it, as {min, max}.
+/// </summary>
+std::pair<glm::vec3, glm::vec3> TransformAABB(const glm::vec3& min, const glm::vec3& max, const glm::mat4& transform);
+
+/// <summary>
+/// Returns the distances to the near and far plane of a perspective or orthographic projection with OpenGL clip space,
+/// as {near, far}.
+/// </summary>
+std::pair<float, float> GetDepthRange(const glm::mat4& projection);
+
+}  // namespace bee
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace bee
 {
@@ -28,7 +33,10 @@ struct DebugCategory
 };
 
 /// <summary>
-/// Renders debug lines and shapes. It can be called from any place in the code.
+/// Renders debug lines and shapes. It can be called from any place in the code, and from any thread: every thread adds
+/// to a buffer of its own, and Render merges them on the main thread. Shapes are instances of unit shapes with a
+/// transform each, so adding one costs about as much as adding a line. Buffers grow as needed, with a warning when a
+/// frame goes over c_lineBudget or c_primitiveBudget.
 /// </summary>
 class DebugRenderer
 {
@@ -40,18 +48,19 @@ public:
     DebugRenderer(DebugRenderer&&) = delete;
     DebugRenderer& operator=(DebugRenderer&&) = delete;
 
+    static constexpr size_t c_lineBudget = 1 << 18;       // per frame, over all threads
+    static constexpr size_t c_primitiveBudget = 1 << 16;  // per frame, over all threads
+
     /// <summary>
-    /// Initialize the debug renderer.
+    /// Renders everything that was added since the last call, for every camera, and empties the buffers. Called from
+    /// the main thread, when no other thread adds to the debug renderer.
     /// </summary>
-    void Render();
+    void Render();  // Implemented per platform.
 
     /// <summary>
     /// Add a line to be rendered.
     /// </summary>
-    void AddLine(DebugCategory::Enum category,
-                 const glm::vec3& from,
-                 const glm::vec3& to,
-                 const glm::vec4& color);  // Implemented per platform.
+    void AddLine(DebugCategory::Enum category, const glm::vec3& from, const glm::vec3& to, const glm::vec4& color);
 
     /// <summary>
     /// Add a circle to be rendered.
@@ -60,7 +69,7 @@ public:
                    const glm::vec3& center,
                    float radius,
                    const glm::vec3& normal,
-                   const glm::vec4& color);  // Implemented for all platforms.
+                   const glm::vec4& color);
 
     /// <summary>
     /// Add a square to be rendered.
@@ -69,7 +78,21 @@ public:
                    const glm::vec3& center,
                    float size,
                    const glm::vec3& normal,
-                   const glm::vec4& color);  // Implemented for all platforms.
+                   const glm::vec4& color);
+
+    /// <summary>
+    /// Add a box to be rendered, from its center, half of its size along every axis and rotation.
+    /// </summary>
+    void AddBox(DebugCategory::Enum category,
+                const glm::vec3& center,
+                const glm::vec3& halfExtents,
+                const glm::quat& rotation,
+                const glm::vec4& color);
+
+    /// <summary>
+    /// Add a sphere to be rendered, as a circle around every axis.
+    /// </summary>
+    void AddSphere(DebugCategory::Enum category, const glm::vec3& center, float radius, const glm::vec4& color);
 
     /// <summary>
     /// Add a cylinder to be rendered.
@@ -80,6 +103,20 @@ public:
                      float radius,
                      const glm::vec4& color);
 
+    /// <summary>
+    /// Add a capsule to be rendered, the cylinder between two centers with a half sphere at either end.
+    /// </summary>
+    void AddCapsule(DebugCategory::Enum category,
+                    const glm::vec3& center1,
+                    const glm::vec3& center2,
+                    float radius,
+                    const glm::vec4& color);
+
+    /// <summary>
+    /// Add an arrow to be rendered, with a head that is a quarter of its length.
+    /// </summary>
+    void AddArrow(DebugCategory::Enum category, const glm::vec3& from, const glm::vec3& to, const glm::vec4& color);
+
     /// <summary>
     /// Turn on/off the debug renderer per category.
     /// </summary>
@@ -91,9 +128,59 @@ public:
     unsigned int GetCategoryFlags() const { return m_categoryFlags; }
 
 private:
+    /// <summary>
+    /// The unit shapes that shapes are instances of, see GetUnitShape.
+    /// </summary>
+    enum class Primitive : uint8_t
+    {
+        Circle,      // radius 1 around the z axis
+        Square,      // size 1 around the z axis
+        Box,         // from -1 to 1
+        Sphere,      // radius 1
+        Cylinder,    // radius 1 around the z axis, from z 0 to 1
+        Hemisphere,  // radius 1, towards z
+        ArrowHead,   // length 1 and width 1, with its tip at the origin, pointing towards z
+        Count
+    };
+    static constexpr size_t c_primitiveCount = static_cast<size_t>(Primitive::Count);
+
+    struct LineVertex
+    {
+        glm::vec3 Position;
+        glm::vec4 Color;
+    };
+
+    struct Instance
+    {
+        glm::mat4 Transform;
+        glm::vec4 Color;
+    };
+
+    /// <summary>
+    /// What one thread added since the last Render. Kept from frame to frame for its memory.
+    /// </summary>
+    struct Buffer
+    {
+        std::vector<LineVertex> Lines;  // two vertices per line
+        std::vector<Instance> Instances[c_primitiveCount];
+    };
+
+    /// <summary>
+    /// The lines of a unit shape, two vertices per line.
+    /// </summary>
+    static std::vector<glm::vec3> GetUnitShape(Primitive primitive);
+    static uint64_t NextId();
+
+    Buffer& GetThreadBuffer();
+    void AddInstance(Primitive primitive, const glm::mat4& transform, const glm::vec4& color);  // after checking the category
+
     class Impl;
     std::unique_ptr<Impl> m_impl;
     unsigned int m_categoryFlags;
+    const uint64_t m_id = NextId();  // tells the buffers of threads for different debug renderers apart
+    std::mutex m_buffersMutex;
+    std::vector<std::unique_ptr<Buffer>> m_buffers;  // of every thread that added something
+    bool m_overBudget = false;                       // only warned about once
 };
 
 namespace Colors
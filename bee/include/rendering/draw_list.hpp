@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace bee
+{
+
+/// <summary>
+/// A small number that identifies a live object of type T, for sort keys. Numbers of destroyed objects are reused, so
+/// they stay below the number of objects that exist at the same time, and objects that are created and destroyed in the
+/// same order get the same numbers on every run. Copies get a number of their own.
+/// </summary>
+template <typename T>
+class RenderId
+{
+public:
+    RenderId() : m_value(Acquire()) {}
+    RenderId(const RenderId&) : m_value(Acquire()) {}
+    RenderId& operator=(const RenderId&) { return *this; }  // keeps its own number
+    ~RenderId() { Release(m_value); }
+
+    uint32_t Get() const { return m_value; }
+
+private:
+    struct Pool
+    {
+        std::mutex Mutex;
+        std::vector<uint32_t> Free;
+        uint32_t Next = 0;
+    };
+
+    static Pool& GetPool()
+    {
+        static Pool* pool = new Pool();  // never destroyed, objects with static lifetime may outlive it otherwise
+        return *pool;
+    }
+
+    static uint32_t Acquire()
+    {
+        auto& pool = GetPool();
+        std::lock_guard lock(pool.Mutex);
+        if (pool.Free.empty()) return pool.Next++;
+        const uint32_t value = pool.Free.back();
+        pool.Free.pop_back();
+        return value;
+    }
+
+    static void Release(uint32_t value)
+    {
+        auto& pool = GetPool();
+        std::lock_guard lock(pool.Mutex);
+        pool.Free.push_back(value);
+    }
+
+    uint32_t m_value;
+};
+
+/// <summary>
+/// Packs everything that decides the order of draws into one 64-bit key, so that sorting the keys groups draws that
+/// share state and changing state only has to compare key fields. From the most to the least significant bits:
+/// pass (4), shader (8), material (16), mesh (16), level of detail (2), depth (18). Blended passes move depth up, right
+/// below the pass, so that they draw in depth order and only batch draws that are next to each other.
+/// </summary>
+namespace DrawKey
+{
+
+enum class Pass : uint8_t
+{
+    Shadow = 0,
+    Opaque = 1,
+    Blended = 2,
+};
+
+constexpr int c_passBits = 4;
+constexpr int c_shaderBits = 8;
+constexpr int c_materialBits = 16;
+constexpr int c_meshBits = 16;
+constexpr int c_lodBits = 2;
+constexpr int c_depthBits = 18;
+
+constexpr uint32_t c_maxShaders = 1u << c_shaderBits;
+constexpr uint32_t c_maxMaterials = 1u << c_materialBits;
+constexpr uint32_t c_maxMeshes = 1u << c_meshBits;
+constexpr uint32_t c_maxLods = 1u << c_lodBits;
+constexpr uint32_t c_maxDepth = (1u << c_depthBits) - 1;
+
+/// <summary>
+/// Key for a pass that draws front to back and batches by state: pass, shader, material, mesh, lod, depth.
+/// </summary>
+uint64_t Make(Pass pass, uint32_t shader, uint32_t material, uint32_t mesh, uint32_t lod, uint32_t depth);
+
+/// <summary>
+/// The part of a Make key that is the same in every view: pass, shader, material and mesh, with lod and depth 0. Built
+/// once per frame and completed per view with AddView.
+/// </summary>
+uint64_t MakeShared(Pass pass, uint32_t shader, uint32_t material, uint32_t mesh);
+
+/// <summary>
+/// Adds the fields of a view to a key from MakeShared, the same as Make with all fields.
+/// </summary>
+uint64_t AddView(uint64_t shared, uint32_t lod, uint32_t depth);
+
+/// <summary>
+/// Key for a pass that must draw in depth order: pass, depth, shader, material, mesh, lod.
+/// </summary>
+uint64_t MakeOrdered(Pass pass, uint32_t depth, uint32_t shader, uint32_t material, uint32_t mesh, uint32_t lod);
+
+/// <summary>
+/// Turns a non-negative distance into a depth field that sorts in the same order, without a fixed far plane: the
+/// exponent and upper mantissa bits of a positive float grow with its value.
+/// </summary>
+uint32_t QuantizeDepth(float distance);
+
+}  // namespace DrawKey
+
+/// <summary>
+/// One draw in a DrawList. Index refers to the instance that the caller built the key for. Material, Mesh and Lod repeat
+/// the key fields, so that state changes can be found without knowing which key layout was used.
+/// </summary>
+struct DrawPacket
+{
+    uint64_t Key = 0;
+    uint32_t Index = 0;
+    uint16_t Material = 0;
+    uint16_t Mesh = 0;
+    uint8_t Lod = 0;  // the level of detail of the mesh
+};
+
+/// <summary>
+/// Draw packets sorted by key with a least significant digit radix sort. The sort is stable and takes O(n) per pass
+/// over one byte of the key; bytes that are the same in every key are skipped. The list keeps its memory, so building
+/// it every frame does not allocate in the steady state. Does not depend on the graphics backend, so key building and
+/// sorting can be measured on their own.
+/// Fill it by calling Resize() and then writing to every packet, from any number of threads.
+/// </summary>
+class DrawList
+{
+public:
+    void Clear() { m_packets.clear(); }
+    void Resize(size_t count) { m_packets.resize(count); }
+    size_t Size() const { return m_packets.size(); }
+    bool Empty() const { return m_packets.empty(); }
+
+    DrawPacket& operator[](size_t index) { return m_packets[index]; }
+    const DrawPacket& operator[](size_t index) const { return m_packets[index]; }
+    std::vector<DrawPacket>::const_iterator begin() const { return m_packets.begin(); }
+    std::vector<DrawPacket>::const_iterator end() const { return m_packets.end(); }
+
+    void Sort();
+
+private:
+    std::vector<DrawPacket> m_packets;
+    std::vector<DrawPacket> m_scratch;
+};
+
+}  // namespace bee
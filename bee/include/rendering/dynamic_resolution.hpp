@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+namespace bee
+{
+
+/// <summary>
+/// Picks the scale of the resolution that the scene is rendered at, and the number of MSAA samples, from how long the
+/// GPU took for recent frames, so that frames stay within TargetTime when the scene gets heavier. Frame times go through
+/// a median of 3, which drops hitches of a single frame, and are then smoothed. A PID controller in velocity form moves
+/// a continuous scale by the relative error from the target: the integral term does most of the work, and clamping the
+/// scale cannot wind it up. The scale that is used moves in steps of ScaleStep, down as soon as the controller is a
+/// step below it, and up only after UpFrames frames with headroom, so that the frame buffers are not reallocated for
+/// noise. Samples are halved when even MinScale is over budget, and restored when MaxScale has plenty of headroom. Does
+/// not depend on the graphics backend, so it can be driven by recorded frame times.
+/// </summary>
+class DynamicResolution
+{
+public:
+    DynamicResolution() { Reset(); }
+
+    /// <summary>
+    /// Adds the GPU time of a frame in milliseconds. Returns whether GetScale or GetSamples changed, after which frames
+    /// are ignored for SettleFrames, since their times are measured a few frames late.
+    /// </summary>
+    bool AddFrame(float gpuTime);
+
+    /// <summary>
+    /// Goes back to MaxScale and MaxSamples and forgets the frames so far, for example after changing the settings.
+    /// </summary>
+    void Reset();
+
+    float GetScale() const { return m_scale; }                // of the width and the height, in [MinScale, MaxScale]
+    int GetSamples() const { return m_samples; }              // a power of 2 in [MinSamples, MaxSamples]
+    float GetDesiredScale() const { return m_desiredScale; }  // before hysteresis
+    float GetFilteredTime() const { return m_filteredTime; }  // in milliseconds
+
+    float TargetTime = 14.0f;  // GPU milliseconds per frame, with some margin below 60 Hz
+    float MinScale = 0.5f;
+    float MaxScale = 1.0f;
+    float ScaleStep = 0.05f;
+    int MinSamples = 1;
+    int MaxSamples = 4;
+
+    float Proportional = 0.1f;  // gains on the relative error, (TargetTime - time) / TargetTime
+    float Integral = 0.05f;
+    float Derivative = 0.02f;
+    float Smoothing = 0.25f;  // weight of the newest time in the filtered time
+    float Deadband = 0.05f;   // relative errors smaller than this count as 0, so the scale rests near the target
+
+    uint32_t UpFrames = 30;       // frames with headroom before the scale goes up a step
+    uint32_t SampleFrames = 60;   // frames at a limit of the scale before the samples change
+    float SampleHeadroom = 0.2f;  // the relative error at MaxScale that restores samples
+    uint32_t SettleFrames = 4;    // ignored after a change, more than the frames that GPU times lag behind
+
+private:
+    float m_scale = 1.0f;
+    int m_samples = 4;
+    float m_desiredScale = 1.0f;
+    float m_filteredTime = 0.0f;
+    float m_recent[3] = {};  // the last times, for the median
+    float m_errors[2] = {};  // of the last two frames, for the proportional and derivative terms
+    uint32_t m_frames = 0;   // since the last change
+    uint32_t m_upFrames = 0;
+    uint32_t m_overFrames = 0;   // over budget at MinScale
+    uint32_t m_underFrames = 0;  // with SampleHeadroom at MaxScale
+};
+
+}  // namespace bee
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "rendering/bvh.hpp"
+#include "rendering/culling.hpp"
+#include "rendering/render_components.hpp"
+#include "rendering/skid_marks.hpp"
+
+namespace bee
+{
+
+class Mesh;
+
+/// <summary>
+/// Everything the renderer needs to draw one frame, copied out of the ECS registry during extraction.
+/// Submitting a packet never touches the registry, so a frame can be submitted while the next one is being simulated.
+/// The packet holds references to meshes and materials, so they stay alive until the frame has been submitted even if
+/// their entities are deleted in the meantime.
+/// </summary>
+struct FramePacket
+{
+    struct MeshInstance
+    {
+        std::shared_ptr<Mesh> Mesh;
+        std::shared_ptr<Material> Material;
+        glm::mat4 World;
+    };
+
+    struct LightInstance
+    {
+        Light Light;
+        glm::mat4 World;
+    };
+
+    struct ViewInstance
+    {
+        glm::mat4 View;
+        glm::mat4 Projection;
+        glm::vec3 Position;
+        glm::vec4 Viewport;  // see Camera::Viewport
+    };
+
+    /// <summary>
+    /// A particle as the particle shaders read it, see particle_struct in uniforms.glsl.
+    /// </summary>
+    struct ParticleInstance
+    {
+        glm::vec3 Position;
+        float Size;
+        glm::vec4 Color;
+    };
+
+    /// <summary>
+    /// All particles of one ParticleType, drawn with a single instanced draw.
+    /// </summary>
+    struct ParticleBatch
+    {
+        bool AlphaBlended = false;  // sorted back to front per view, otherwise added in any order
+        std::vector<ParticleInstance> Instances;
+    };
+
+    /// <summary>
+    /// The slots of the SkidMarkRing that were written since the last packet, so the renderer only uploads those.
+    /// </summary>
+    struct SkidMarkChanges
+    {
+        uint32_t Capacity = 0;  // of the ring, 0 without skid marks
+        uint32_t Count = 0;     // slots that hold a quad, see SkidMarkRing::GetQuadCount
+        float Time = 0.0f;      // see SkidMarkSystem::GetTime
+        float FadeTime = 0.0f;
+        std::vector<uint32_t> Slots;           // ascending, so runs of slots are uploaded together
+        std::vector<SkidMarkVertex> Vertices;  // 4 per slot, in the order of Slots
+    };
+
+    /// <summary>
+    /// Meshes with their world-space bounds, which are in the same order, and a tree over those bounds.
+    /// </summary>
+    struct MeshList
+    {
+        std::vector<MeshInstance> Meshes;
+        BoundingBoxes Bounds;
+        BoundingVolumeHierarchy Tree;
+    };
+
+    std::vector<MeshInstance> Meshes;
+    BoundingBoxes Bounds;  // of Meshes, in the same order
+    std::vector<LightInstance> Lights;
+    std::vector<ViewInstance> Views;
+    std::vector<ParticleBatch> Particles;  // by particle type, see ParticleSystem
+    SkidMarkChanges SkidMarks;
+
+    /// <summary>
+    /// Meshes of Static entities. Extracted once and shared by all packets until one of them changes.
+    /// </summary>
+    std::shared_ptr<const MeshList> StaticMeshes;
+
+    /// <summary>
+    /// The previous StaticMeshes when they were re-extracted, released by Clear() on the main thread, because releasing
+    /// the last reference to a mesh deletes its GPU buffers.
+    /// </summary>
+    std::shared_ptr<const MeshList> RetiredStaticMeshes;
+
+    size_t GetMeshCount() const { return (StaticMeshes ? StaticMeshes->Meshes.size() : 0) + Meshes.size(); }
+
+    /// <summary>
+    /// The mesh at the given position in the order of ForEachMesh().
+    /// </summary>
+    const MeshInstance& GetMesh(size_t index) const
+    {
+        const size_t numStatic = StaticMeshes ? StaticMeshes->Meshes.size() : 0;
+        return index < numStatic ? StaticMeshes->Meshes[index] : Meshes[index - numStatic];
+    }
+
+    /// <summary>
+    /// The world-space bounds of the mesh at the given position in the order of ForEachMesh(), as {min, max}.
+    /// </summary>
+    std::pair<glm::vec3, glm::vec3> GetBounds(size_t index) const
+    {
+        const size_t numStatic = StaticMeshes ? StaticMeshes->Meshes.size() : 0;
+        if (index < numStatic) return {StaticMeshes->Bounds.GetMin(index), StaticMeshes->Bounds.GetMax(index)};
+        return {Bounds.GetMin(index - numStatic), Bounds.GetMax(index - numStatic)};
+    }
+
+    /// <summary>
+    /// Calls function(const MeshInstance&) for the static meshes and then for all other meshes.
+    /// </summary>
+    template <typename F>
+    void ForEachMesh(F&& function) const
+    {
+        if (StaticMeshes)
+            for (const auto& mesh : StaticMeshes->Meshes) function(mesh);
+        for (const auto& mesh : Meshes) function(mesh);
+    }
+
+    /// <summary>
+    /// Tests the bounds of all meshes against a frustum, in the order of ForEachMesh(). visible must have room for
+    /// GetMeshCount() entries. Returns the number of visible meshes.
+    /// The static meshes are culled through their tree, so that large parts of the level are rejected at once.
+    /// </summary>
+    size_t Cull(const Frustum& frustum, uint8_t* visible) const
+    {
+        size_t numVisible = 0;
+        if (StaticMeshes)
+        {
+            std::fill(visible, visible + StaticMeshes->Meshes.size(), uint8_t(0));
+            StaticMeshes->Tree.QueryFrustum(frustum,
+                                            [&](uint32_t item)
+                                            {
+                                                visible[item] = 1;
+                                                numVisible++;
+                                            });
+            visible += StaticMeshes->Meshes.size();
+        }
+        return numVisible + Bounds.Cull(frustum, visible);
+    }
+
+    /// <summary>
+    /// Empties the packet but keeps its memory, so extraction does not allocate in the steady state.
+    /// </summary>
+    void Clear()
+    {
+        Meshes.clear();
+        Bounds.Clear();
+        Lights.clear();
+        Views.clear();
+        for (auto& batch : Particles) batch.Instances.clear();
+        SkidMarks.Capacity = 0;
+        SkidMarks.Count = 0;
+        SkidMarks.Slots.clear();
+        SkidMarks.Vertices.clear();
+        StaticMeshes.reset();
+        RetiredStaticMeshes.reset();
+    }
+};
+
+}  // namespace bee
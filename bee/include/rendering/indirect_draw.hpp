@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "rendering/draw_list.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// A draw command in the layout that glMultiDrawElementsIndirect reads.
+/// </summary>
+struct DrawElementsIndirectCommand
+{
+    uint32_t Count = 0;  // indices per instance
+    uint32_t InstanceCount = 0;
+    uint32_t FirstIndex = 0;
+    int32_t BaseVertex = 0;
+    uint32_t BaseInstance = 0;
+};
+
+/// <summary>
+/// Where the geometry of a mesh is in vertex and index buffers that are shared by many meshes.
+/// </summary>
+struct MeshRange
+{
+    uint32_t FirstIndex = 0;
+    uint32_t IndexCount = 0;
+    int32_t BaseVertex = 0;
+};
+
+/// <summary>
+/// Commands that share all state that is not fetched per draw, so they are submitted with one multi-draw call.
+/// </summary>
+struct IndirectBucket
+{
+    uint32_t FirstCommand = 0;
+    uint32_t CommandCount = 0;
+};
+
+/// <summary>
+/// The indirect commands of a draw list, split into buckets.
+/// </summary>
+struct IndirectCommands
+{
+    std::vector<DrawElementsIndirectCommand> Commands;
+    std::vector<uint32_t> FirstDraws;  // of every command, the index of its first packet in the draw list
+    std::vector<IndirectBucket> Buckets;
+
+    void Clear()
+    {
+        Commands.clear();
+        FirstDraws.clear();
+        Buckets.clear();
+    }
+};
+
+/// <summary>
+/// Turns packets [begin, end) of a sorted draw list into indirect commands. Consecutive packets with the same mesh, level
+/// of detail and material become one command with several instances, where packet i of the list is instance
+/// firstInstance + i, so consecutive ranges of a list can be turned into commands on different threads. A new bucket
+/// starts whenever the bucket key of the material changes, so materials that only differ in what shaders fetch per draw
+/// share a bucket when they are next to each other.
+/// </summary>
+/// <param name="meshRanges">Indexed by DrawPacket::Mesh * DrawKey::c_maxLods + DrawPacket::Lod.</param>
+/// <param name="bucketKeys">Indexed by DrawPacket::Material. When empty, all commands are in one bucket.</param>
+void BuildIndirectCommands(const DrawList& list,
+                           size_t begin,
+                           size_t end,
+                           uint32_t firstInstance,
+                           const std::vector<MeshRange>& meshRanges,
+                           const std::vector<uint32_t>& bucketKeys,
+                           IndirectCommands& result);
+
+}  // namespace bee
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace bee
+{
+
+/// <summary>
+/// Divides the frustum of a view into a grid of clusters, c_tilesX by c_tilesY tiles on screen and c_slices slices in
+/// depth, and bins point lights into the clusters that their sphere touches. A fragment then only has to loop over the
+/// lights of its own cluster, instead of over every light in the scene.
+/// Slices are spaced logarithmically for perspective projections, so that clusters stay about as deep as they are wide,
+/// and uniformly for orthographic ones. Binning runs a slice at a time, and slices can be binned on different threads:
+///
+///     clusters.SetView(view, projection, lights, count);
+///     parallelFor(LightClusters::c_slices, [&](size_t first, size_t last) { clusters.BinSlices(first, last); });
+///     clusters.Compact();
+///
+/// Build does all three on the calling thread.
+/// </summary>
+class LightClusters
+{
+public:
+    static constexpr int c_tilesX = 16;
+    static constexpr int c_tilesY = 9;
+    static constexpr int c_slices = 24;
+    static constexpr int c_count = c_tilesX * c_tilesY * c_slices;
+
+    /// <summary>
+    /// The lights of a cluster, as a range of GetLightIndices().
+    /// </summary>
+    struct Cluster
+    {
+        uint32_t Offset = 0;
+        uint32_t Count = 0;
+    };
+
+    LightClusters();
+
+    /// <summary>
+    /// Starts binning lights for a view. Lights are a world-space position in xyz and a range in w, lights with a range
+    /// of 0 or less light nothing and are skipped. The lights are copied, so the array does not have to outlive binning.
+    /// </summary>
+    void SetView(const glm::mat4& view, const glm::mat4& projection, const glm::vec4* lights, size_t count);
+
+    /// <summary>
+    /// Bins the lights into the clusters of slices [first, last). Different threads can bin different slices at the
+    /// same time, between SetView and Compact.
+    /// </summary>
+    void BinSlices(size_t first, size_t last);
+
+    /// <summary>
+    /// Gathers the lights that every slice found into GetLightIndices(), after all slices were binned.
+    /// </summary>
+    void Compact();
+
+    /// <summary>
+    /// SetView, BinSlices for all slices and Compact on the calling thread.
+    /// </summary>
+    void Build(const glm::mat4& view, const glm::mat4& projection, const glm::vec4* lights, size_t count);
+
+    static int GetIndex(int x, int y, int slice) { return (slice * c_tilesY + y) * c_tilesX + x; }
+
+    /// <summary>
+    /// The slice of a view-space depth, the distance in front of the camera, clamped to the grid. Shaders compute it in
+    /// the same way: floor((logarithmic ? log(depth) : depth) * scale - bias).
+    /// </summary>
+    int GetSlice(float depth) const;
+
+    float GetSliceScale() const { return m_sliceScale; }
+    float GetSliceBias() const { return m_sliceBias; }
+    bool IsLogarithmic() const { return m_logarithmic; }
+
+    /// <summary>
+    /// The view-space box around a cluster, as {min, max}.
+    /// </summary>
+    std::pair<glm::vec3, glm::vec3> GetBounds(int index) const;
+
+    const std::vector<Cluster>& GetClusters() const { return m_clusters; }
+    const std::vector<uint32_t>& GetLightIndices() const { return m_lightIndices; }
+    size_t GetLightCount() const { return m_lightX.size(); }  // that can light anything, of the last view
+    uint32_t GetMaxClusterLights() const { return m_maxClusterLights; }
+
+private:
+    void ComputeBounds(const glm::mat4& projection);
+
+    // The lights that may touch a slice, and the lights that every cluster of it found
+    struct Slice
+    {
+        std::vector<float> X, Y, Z, Radius2;  // view-space position and squared range
+        std::vector<uint32_t> Lights;
+        std::vector<uint32_t> Indices;
+    };
+
+    glm::mat4 m_projection = glm::mat4(0.0f);  // that the bounds are for
+    bool m_logarithmic = true;
+    float m_sliceScale = 0.0f;
+    float m_sliceBias = 0.0f;
+    float m_sliceDepths[c_slices + 1] = {};  // where each slice starts, and where the last one ends
+
+    // View-space cluster bounds, as a structure of arrays to test several lights against a cluster with SIMD
+    std::vector<float> m_minX, m_minY, m_minZ;
+    std::vector<float> m_maxX, m_maxY, m_maxZ;
+
+    // The lights of the view in view space, and their index in the lights passed to SetView
+    std::vector<float> m_lightX, m_lightY, m_lightZ, m_lightRadius;
+    std::vector<uint32_t> m_lightIndex;
+
+    Slice m_slices[c_slices];
+    std::vector<Cluster> m_clusters;
+    std::vector<uint32_t> m_lightIndices;
+    uint32_t m_maxClusterLights = 0;
+};
+
+}  // namespace bee
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace bee
+{
+
+/// <summary>
+/// CPU copy of the geometry of a mesh, in the same layout as the vertex buffers: one entry per vertex in every
+/// attribute that the mesh has, and an empty vector for every attribute it does not have.
+/// Kept by bee::Mesh so that geometry can be processed without reading it back from the GPU, e.g. by static batching.
+/// </summary>
+struct MeshData
+{
+    std::vector<glm::vec3> Positions;
+    std::vector<glm::vec3> Normals;
+    std::vector<glm::vec4> Tangents;  // w is the handedness of the bitangent
+    std::vector<glm::vec3> Colors;
+    std::vector<glm::vec2> TexCoords0;
+    std::vector<glm::vec2> TexCoords1;
+    std::vector<uint32_t> Indices;  // triangle list
+
+    /// <summary>
+    /// A simpler version of the mesh, as a triangle list into the same vertices.
+    /// </summary>
+    struct Lod
+    {
+        std::vector<uint32_t> Indices;
+        float Error = 0.0f;  // distance to the original surface, relative to the diagonal of the bounds
+    };
+
+    static constexpr int c_maxLods = 4;  // levels of detail, including the mesh itself
+    std::vector<Lod> Lods;               // from the most detailed, see GenerateLods
+
+    size_t GetVertexCount() const { return Positions.size(); }
+    int GetLodCount() const { return 1 + static_cast<int>(Lods.size()); }
+    const std::vector<uint32_t>& GetLodIndices(int lod) const { return lod == 0 ? Indices : Lods[lod - 1].Indices; }
+    bool IsEmpty() const { return Positions.empty() || Indices.empty(); }
+};
+
+}  // namespace bee
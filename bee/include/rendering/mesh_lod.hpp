@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "rendering/mesh_data.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// Simplifies a triangle list by collapsing edges in the order of the error they add, measured with quadrics: the sum
+/// of squared distances to the planes of the triangles that were merged into a vertex. Vertices only move onto other
+/// vertices, so the result indexes the same vertex buffer. Vertices on open borders do not move, and a vertex on an
+/// attribute seam (a position that several vertices share) only moves along edges that every side of the seam has, so
+/// seams stay closed. Collapses that would flip a triangle are skipped.
+/// Stops when the list has at most targetIndexCount indices, or when every collapse left would add more than maxError.
+/// </summary>
+/// <param name="maxError">The largest root mean square distance to the original surface, in the units of the
+/// positions.</param>
+/// <param name="resultError">Optional, receives the error of the result in the same units.</param>
+std::vector<uint32_t> SimplifyMesh(const std::vector<glm::vec3>& positions,
+                                   const std::vector<uint32_t>& indices,
+                                   size_t targetIndexCount,
+                                   float maxError,
+                                   float* resultError = nullptr);
+
+/// <summary>
+/// Fills data.Lods with up to MeshData::c_maxLods - 1 simplified versions of the mesh, each with about half the
+/// triangles of the one before. Stops early for small meshes, and when simplifying no longer removes enough triangles
+/// without changing the shape too much. Runs on the CPU only.
+/// </summary>
+void GenerateLods(MeshData& data);
+
+/// <summary>
+/// The projected size of a bounding sphere, as its radius divided by half the height of the view at its distance. About
+/// 1 when the sphere fills the view, for perspective and orthographic projections alike.
+/// </summary>
+float GetScreenSize(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& center, float radius);
+
+/// <summary>
+/// The level of detail for a screen size (see GetScreenSize), given the level that was used before. A level is kept
+/// until the size moved c_lodHysteresis past the threshold between the levels, so that objects near a threshold do not
+/// switch back and forth every frame.
+/// </summary>
+/// <param name="lodCount">The levels that the mesh has, including the mesh itself.</param>
+int SelectLod(float screenSize, int previous, int lodCount);
+
+/// <summary>The screen sizes below which levels 1, 2 and 3 are used.</summary>
+constexpr float c_lodScreenSizes[MeshData::c_maxLods - 1] = {0.25f, 0.1f, 0.04f};
+constexpr float c_lodHysteresis = 0.15f;
+
+}  // namespace bee
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "rendering/mesh_data.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// The number of vertices that AnalyzeVertexCache and OptimizeVertexCache assume the post-transform cache of the GPU
+/// holds, as a first in, first out queue.
+/// </summary>
+constexpr uint32_t c_vertexCacheSize = 16;
+
+/// <summary>
+/// How often the vertex shader runs for a triangle list. ACMR is the average cache miss ratio, transformed vertices per
+/// triangle, between 0.5 for a perfect regular grid and 3. ATVR is the average transform to vertex ratio, transformed
+/// vertices per vertex that the list uses, 1 when every vertex is only transformed once.
+/// </summary>
+struct VertexCacheStats
+{
+    float Acmr = 0.0f;
+    float Atvr = 0.0f;
+};
+
+/// <summary>
+/// Simulates a first in, first out post-transform cache of cacheSize vertices.
+/// </summary>
+VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices,
+                                    size_t vertexCount,
+                                    uint32_t cacheSize = c_vertexCacheSize);
+
+/// <summary>
+/// Reorders the triangles of a list for the post-transform cache with Tipsify (Sander, Nehab and Barczak, "Fast
+/// Triangle Reordering for Vertex Locality and Reduced Overdraw"), which fans around one vertex at a time and moves on
+/// to the neighbour that is still in the cache. The order is then split into clusters where the cache is flushed, or
+/// where the cluster already has a good ACMR, and the clusters are sorted so that the ones that face away from the
+/// center of the mesh come first: they are likely in front of the others, so fewer pixels get shaded twice.
+/// </summary>
+/// <param name="positions">For the overdraw order. When empty, the clusters keep their order.</param>
+std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t>& indices,
+                                          const std::vector<glm::vec3>& positions,
+                                          size_t vertexCount);
+
+/// <summary>
+/// Reorders the vertices of a mesh in the order that its indices first use them, so that vertices that are drawn
+/// together are next to each other in memory. Every attribute and the indices of all levels of detail are remapped.
+/// Vertices that no index uses are removed.
+/// </summary>
+void OptimizeVertexFetch(MeshData& data);
+
+struct MeshOptimizationStats
+{
+    VertexCacheStats Before;
+    VertexCacheStats After;
+};
+
+/// <summary>
+/// Optimizes a mesh at import: OptimizeVertexCache on the indices and on every level of detail, and then
+/// OptimizeVertexFetch. Returns the vertex cache stats of the indices before and after. Runs on the CPU only.
+/// </summary>
+MeshOptimizationStats OptimizeMesh(MeshData& data);
+
+}  // namespace bee
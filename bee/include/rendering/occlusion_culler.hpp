@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace bee
+{
+
+/// <summary>
+/// Culls boxes that are hidden behind occluders, with a depth buffer of c_width by c_height pixels that is rasterized
+/// on the CPU. Occluders are triangle lists, usually the simplest level of detail of large meshes close to the camera.
+/// A pixel gets the nearest depth of the triangles that cover its center, at the far side of the triangle in that pixel.
+/// A box is occluded when its nearest point is behind the farthest depth of every pixel it covers and of the pixels
+/// around those. A pyramid of the farthest depth of 2x2 blocks answers that for most boxes with at most 4 reads, and
+/// only looks at the finer levels where a coarser one is not far enough. The pixels around the box make the test
+/// conservative at the edges of occluders, which may cover a pixel center without covering the whole pixel. Gaps
+/// between occluders that are narrower than a pixel do get closed, so occluders should not be placed that close.
+/// Triangles are set up an occluder at a time, and rasterized a band of rows at a time, 4 pixels at once with SSE. Both
+/// can run on different threads, and the result does not depend on the order:
+///
+///     culler.SetView(viewProjection);
+///     culler.AddOccluder(positions, indices, world);
+///     parallelFor(culler.GetOccluderCount(), [&](size_t first, size_t last) { culler.SetupOccluders(first, last); });
+///     parallelFor(OcclusionCuller::c_bands, [&](size_t first, size_t last) { culler.RasterizeBands(first, last); });
+///     culler.BuildHierarchy();
+///
+/// Rasterize does the last three on the calling thread. IsOccluded can then be called from any thread.
+/// </summary>
+class OcclusionCuller
+{
+public:
+    static constexpr int c_width = 256;
+    static constexpr int c_height = 128;
+    static constexpr int c_bands = 16;  // of c_height / c_bands rows each
+    static constexpr int c_bandHeight = c_height / c_bands;
+
+    /// <summary>
+    /// Starts a new depth buffer for a view, with OpenGL clip space, and removes all occluders.
+    /// </summary>
+    void SetView(const glm::mat4& viewProjection);
+
+    /// <summary>
+    /// Adds a triangle list in the space of world. Front faces are counter-clockwise, back faces are not rasterized.
+    /// The vertices and indices are not copied and must stay alive until the occluder was set up.
+    /// </summary>
+    void AddOccluder(const std::vector<glm::vec3>& positions,
+                     const std::vector<uint32_t>& indices,
+                     const glm::mat4& world);
+
+    /// <summary>
+    /// Transforms occluders [first, last) into screen space, clips them against the near plane and computes the edges
+    /// of their triangles. Different threads can set up different occluders at the same time.
+    /// </summary>
+    void SetupOccluders(size_t first, size_t last);
+
+    /// <summary>
+    /// Rasterizes the triangles of all occluders into bands of rows [first, last), after all occluders were set up.
+    /// Different threads can rasterize different bands at the same time.
+    /// </summary>
+    void RasterizeBands(size_t first, size_t last);
+
+    /// <summary>
+    /// Builds the pyramid of farthest depths, after all bands were rasterized.
+    /// </summary>
+    void BuildHierarchy();
+
+    /// <summary>
+    /// SetupOccluders, RasterizeBands and BuildHierarchy for everything on the calling thread.
+    /// </summary>
+    void Rasterize();
+
+    /// <summary>
+    /// Returns true when the world-space box is completely behind the occluders. Boxes that cross the near plane or
+    /// are outside the screen are never occluded, frustum culling takes care of those.
+    /// </summary>
+    bool IsOccluded(const glm::vec3& min, const glm::vec3& max) const;
+
+    /// <summary>
+    /// The depth of a pixel of a level of the pyramid, from 0 at the near plane to 1 at the far plane. Level 0 is the
+    /// depth buffer itself, every next level has half the width and height.
+    /// </summary>
+    float GetDepth(int x, int y, int level = 0) const;
+
+    int GetLevelCount() const { return static_cast<int>(m_levels.size()); }
+    int GetLevelWidth(int level) const { return m_levels[level].Width; }
+    int GetLevelHeight(int level) const { return m_levels[level].Height; }
+    size_t GetOccluderCount() const { return m_occluderCount; }
+    size_t GetTriangleCount() const;  // that are front-facing and on screen, after the occluders were set up
+
+private:
+    // Inside when A * x + B * y + C >= 0 for all edges, at pixel centers
+    struct Triangle
+    {
+        float A[3], B[3], C[3];
+        float ZA, ZB, ZC;  // depth plane
+        float ZMax;        // the depth plane may be extrapolated beyond the triangle
+        int MinX, MaxX, MinY, MaxY;
+    };
+
+    struct Occluder
+    {
+        const std::vector<glm::vec3>* Positions = nullptr;
+        const std::vector<uint32_t>* Indices = nullptr;
+        glm::mat4 Transform = glm::mat4(1.0f);  // to clip space
+        std::vector<Triangle> Triangles;        // kept from frame to frame for their memory
+    };
+
+    struct Level
+    {
+        int Width = 0;
+        int Height = 0;
+        std::vector<float> Depth;
+    };
+
+    void AddTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2, std::vector<Triangle>& triangles);
+    void RasterizeTriangle(const Triangle& triangle, int minY, int maxY);
+
+    // Whether depth is behind the part of a pixel of a level that is inside the box [x0, x1] x [y0, y1] of level 0
+    bool IsBehind(float depth, int x, int y, int level, int x0, int y0, int x1, int y1) const;
+
+    glm::mat4 m_viewProjection = glm::mat4(1.0f);
+    std::vector<Occluder> m_occluders;
+    size_t m_occluderCount = 0;
+    std::vector<Level> m_levels;
+};
+
+}  // namespace bee
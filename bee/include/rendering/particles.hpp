@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "core/ecs.hpp"
+
+namespace bee
+{
+
+class JobSystem;
+
+/// <summary>
+/// What all particles of a kind look like and how they move, such as tire smoke or sparks. Registered once with
+/// ParticleSystem::AddType, which returns the number that emitters refer to.
+/// </summary>
+struct ParticleType
+{
+    std::string Name;
+    float MinLifetime = 1.0f;  // in seconds, every particle picks one in [MinLifetime, MaxLifetime]
+    float MaxLifetime = 1.0f;
+    float StartSize = 0.1f;  // half the width of the quad in world units, interpolated over the life of a particle
+    float EndSize = 0.1f;
+    glm::vec4 StartColor = glm::vec4(1.0f);
+    glm::vec4 EndColor = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+    glm::vec3 Gravity = glm::vec3(0.0f);  // acceleration in world units per second squared
+    float Drag = 0.0f;                    // the fraction of its velocity that a particle loses per second, roughly
+    float Spread = 0.0f;                  // largest random speed that is added in every direction at emission
+
+    // Blended types are sorted back to front in every view and drawn over what is behind them. Additive types are
+    // added to what is behind them, which does not depend on the order, so they are never sorted.
+    bool AlphaBlended = false;
+
+    // The most particles of this type that can be alive at the same time. Emission stops while the pool is full.
+    uint32_t MaxParticles = 4096;
+};
+
+/// <summary>
+/// The particles of one type, as a structure of arrays so that Simulate can move 4 particles at once with SSE. Particles
+/// do not keep their order: RemoveDead fills the gaps with particles from the end. Does not depend on the ECS or the
+/// graphics backend, so the simulation can be tested and measured on its own.
+/// </summary>
+class ParticlePool
+{
+public:
+    static constexpr size_t c_lanes = 4;  // particles per SSE register, ranges that are not a multiple end in scalar code
+
+    explicit ParticlePool(size_t capacity = 0);
+
+    /// <summary>
+    /// Adds a particle at the age of 0, unless the pool is full. Returns whether it was added.
+    /// </summary>
+    bool Emit(const glm::vec3& position, const glm::vec3& velocity, float lifetime);
+
+    /// <summary>
+    /// Moves particles [first, last) by dt seconds and ages them. Different threads can simulate different ranges at
+    /// the same time, and the result does not depend on how the pool is split.
+    /// </summary>
+    void Simulate(float dt, const glm::vec3& gravity, float drag, size_t first, size_t last);
+
+    /// <summary>
+    /// Removes the particles that outlived their lifetime, after all ranges were simulated.
+    /// </summary>
+    void RemoveDead();
+
+    void Clear() { m_count = 0; }
+    size_t GetCount() const { return m_count; }
+    size_t GetCapacity() const { return m_capacity; }
+    bool IsFull() const { return m_count == m_capacity; }
+
+    glm::vec3 GetPosition(size_t i) const { return glm::vec3(m_positionX[i], m_positionY[i], m_positionZ[i]); }
+    glm::vec3 GetVelocity(size_t i) const { return glm::vec3(m_velocityX[i], m_velocityY[i], m_velocityZ[i]); }
+
+    /// <summary>
+    /// How far a particle is through its life, from 0 when it was emitted to 1 when it dies.
+    /// </summary>
+    float GetAge(size_t i) const { return m_age[i]; }
+
+private:
+    std::vector<float> m_positionX, m_positionY, m_positionZ;
+    std::vector<float> m_velocityX, m_velocityY, m_velocityZ;
+    std::vector<float> m_age;      // see GetAge
+    std::vector<float> m_ageRate;  // 1 / lifetime
+    size_t m_count = 0;
+    size_t m_capacity = 0;
+};
+
+/// <summary>
+/// Emits particles of a type from the position of its entity, which needs a Transform. Gameplay usually only changes
+/// the intensity, every frame. Particles are spread along the path that the entity moved during the frame, so fast
+/// emitters leave a trail instead of clumps.
+/// </summary>
+struct ParticleEmitter
+{
+    uint32_t Type = 0;                     // returned by ParticleSystem::AddType
+    float Rate = 0.0f;                     // particles per second at an intensity of 1
+    float Intensity = 0.0f;                // scales the rate, 0 stops the emitter
+    glm::vec3 Velocity = glm::vec3(0.0f);  // of new particles in world space, before the spread of their type
+    uint32_t MaxPerFrame = 32;             // the most particles that this emitter adds in one frame
+
+    float Accumulated = 0.0f;  // the fraction of a particle that was due but not emitted yet, the rest over budget is lost
+    glm::vec3 PreviousPosition = glm::vec3(0.0f);
+    bool HasPreviousPosition = false;
+};
+
+/// <summary>
+/// Owns a ParticlePool per registered type. Every frame it moves all particles in chunks on the job system, and then
+/// emits from all ParticleEmitter components, within the budget of the emitter, of the frame (MaxEmittedPerFrame) and
+/// of the pool. The renderer copies the particles into its frame packet (see Renderer::Extract) and draws every type
+/// with a single instanced draw.
+/// </summary>
+class ParticleSystem : public System
+{
+public:
+    static constexpr size_t c_simulateBatch = 4096;  // particles per job, a multiple of ParticlePool::c_lanes
+
+    ParticleSystem();
+
+    /// <summary>
+    /// Registers a type of particles and creates its pool. Returns the number that emitters refer to it by.
+    /// </summary>
+    uint32_t AddType(const ParticleType& type);
+
+    /// <summary>
+    /// Moves all particles by dt seconds and removes the ones that died, with the given job system, and starts a new
+    /// frame for MaxEmittedPerFrame.
+    /// </summary>
+    void Simulate(float dt, JobSystem& jobs);
+    void Simulate(float dt);  // with the engine's job system
+
+    /// <summary>
+    /// Emits the particles that are due from an emitter that is now at position, dt seconds after the last call, within
+    /// the budgets of the emitter, of the frame and of the pool. Returns how many were emitted. Update calls this for
+    /// every ParticleEmitter after Simulate.
+    /// </summary>
+    uint32_t Emit(ParticleEmitter& emitter, const glm::vec3& position, float dt);
+
+    void Update(float dt) override;
+
+    size_t GetTypeCount() const { return m_types.size(); }
+    const ParticleType& GetType(uint32_t type) const { return m_types[type]; }
+    const ParticlePool& GetPool(uint32_t type) const { return m_pools[type]; }
+    size_t GetParticleCount() const;
+    size_t GetEmittedCount() const { return m_emitted; }  // since the last Simulate
+
+    uint32_t MaxEmittedPerFrame = 16384;  // over all emitters together
+
+private:
+    // Emits count particles spread evenly over the segment [from, to], returns how many fit in the pool
+    uint32_t Emit(uint32_t type, const glm::vec3& from, const glm::vec3& to, const glm::vec3& velocity, uint32_t count);
+    float Random();  // uniform in [0, 1)
+
+    std::vector<ParticleType> m_types;
+    std::vector<ParticlePool> m_pools;
+    size_t m_emitted = 0;
+    uint32_t m_random = 0x9e3779b9u;
+};
+
+}  // namespace bee
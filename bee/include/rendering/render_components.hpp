@@ -4,6 +4,7 @@
 #include <memory>
 #include <utility>
 #include "tools/visitable.hpp"
+#include "rendering/draw_list.hpp"
 #include "rendering/image.hpp"
 
 namespace bee
@@ -42,6 +43,8 @@ struct Material
     std::shared_ptr<Texture> NormalTexture;
     std::shared_ptr<Texture> OcclusionTexture;
     std::shared_ptr<Texture> MetallicRoughnessTexture;
+
+    RenderId<Material> Id;  // unique among all materials that exist, for sort keys (see DrawKey)
 };
 
 struct Light
@@ -61,7 +64,7 @@ struct Light
     glm::vec3 Color = {};
     float Intensity = 0;
     float Range = 0;
-    float ShadowExtent = 30.0f;
+    float ShadowDistance = 150.0f;  // how far from the camera a directional light casts shadows
     bool CastShadows = true;
     Type Type = Type::Point;
 };
@@ -69,6 +72,13 @@ struct Light
 struct Camera
 {
     glm::mat4 Projection;
+
+    /// <summary>
+    /// The part of the screen that the camera draws to, as x, y, width and height from 0 to 1 with y up, for split-screen
+    /// and views on top of others such as a rear-view mirror. Cameras draw in the order of the registry, over the ones
+    /// before them.
+    /// </summary>
+    glm::vec4 Viewport = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
 };
 
 struct MeshRenderer
@@ -84,6 +94,15 @@ struct MeshRenderer
     }
 };
 
+/// <summary>
+/// Tag component that Renderer::BakeStaticGeometry() adds to Static entities whose mesh was merged into a static batch.
+/// The renderer draws the batch instead of these entities, so changing their mesh or transform has no visible effect
+/// until the geometry is baked again.
+/// </summary>
+struct StaticBatched
+{
+};
+
 struct Sampler
 {
     Sampler(const Model& model, int index);
@@ -129,4 +148,4 @@ struct Texture
 
 }  // namespace bee
 
-BEE_VISITABLE_STRUCT(bee::Light, Type, Color, Intensity, Range, CastShadows, ShadowExtent);
+BEE_VISITABLE_STRUCT(bee::Light, Type, Color, Intensity, Range, CastShadows, ShadowDistance);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include <vector>
+#include <glm/glm.hpp>
+#include <imgui/IconsFontAwesome.h>
+
+#include "core/ecs.hpp"
+#include "rendering/bvh.hpp"
+#include "tools/inspectable.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// Keeps the world-space bounds of every entity with a MeshRenderer in bounding volume hierarchies, for spatial queries
+/// whose cost grows with the log of the scene size. Static entities are in a tree that is built with the surface area
+/// heuristic whenever the static set changes. All other entities are in a tree that is refit to their transforms every
+/// frame and built again when an entity is added or removed, or when refitting made it too slow.
+/// The trees are updated in Update() with a high priority, before the other systems. Systems that query them should
+/// read Transform, so that the scheduler never runs them at the same time.
+/// Created by the Renderer, get it with Engine.ECS().GetSystem&lt;SceneTree&gt;().
+/// </summary>
+class SceneTree : public System, public IPanel
+{
+public:
+    struct RayHit
+    {
+        Entity Entity = entt::null;
+        float Distance = std::numeric_limits<float>::max();
+    };
+
+    SceneTree();
+    ~SceneTree() override;
+
+    void Update(float dt) override;
+
+    /// <summary>Appends every entity whose bounds overlap the given box to result.</summary>
+    void QueryAABB(const glm::vec3& min, const glm::vec3& max, std::vector<Entity>& result) const;
+
+    /// <summary>Appends every entity whose bounds intersect the frustum to result.</summary>
+    void QueryFrustum(const Frustum& frustum, std::vector<Entity>& result) const;
+
+    /// <summary>
+    /// Finds the nearest entity that the ray hits within maxDistance. When precise is true, the triangles of the mesh
+    /// are tested, otherwise only its bounds.
+    /// </summary>
+    /// <param name="direction">The normalized direction of the ray.</param>
+    bool QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& hit, bool precise = true)
+        const;
+
+#ifdef BEE_INSPECTOR
+    void OnPanel() override;
+    std::string GetName() const override { return "Scene Tree"; }
+    std::string GetIcon() const override { return ICON_FA_TREE; }
+#endif
+
+private:
+    void BuildStatic();
+    void UpdateDynamic();
+    void OnStaticChanged(entt::registry& registry, Entity entity);
+    void OnMembershipChanged(entt::registry& registry, Entity entity);
+    void OnTransformChanged(entt::registry& registry, Entity entity);
+
+    BoundingVolumeHierarchy m_static;
+    BoundingVolumeHierarchy m_dynamic;
+    std::vector<Entity> m_staticEntities;   // of every item in m_static
+    std::vector<Entity> m_dynamicEntities;  // of every item in m_dynamic
+    std::vector<uint32_t> m_moved;          // items of m_dynamic that moved this frame
+    std::atomic<bool> m_staticDirty{true};  // set by registry signals, possibly from worker threads
+    std::atomic<bool> m_dynamicDirty{true};
+    int m_staticBuilds = 0;
+    int m_dynamicBuilds = 0;
+};
+
+}  // namespace bee
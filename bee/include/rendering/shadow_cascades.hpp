@@ -0,0 +1,72 @@
+#pragma once
+
+#include <utility>
+#include <glm/glm.hpp>
+
+#include "rendering/culling.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// An orthographic shadow projection of a directional light around one slice of the camera frustum.
+/// Light space is world space rotated so that the light shines along -z, so larger z is closer to the light.
+/// </summary>
+struct ShadowCascade
+{
+    glm::mat4 View = glm::mat4(1.0f);    // the rotation from world to light space
+    glm::vec2 Center = glm::vec2(0.0f);  // of the projection in light space, on a whole texel
+    float HalfSize = 0.0f;               // of the projection in x and y, in world units
+    float MinZ = 0.0f;                   // the depth range of the projection in light space
+    float MaxZ = 0.0f;
+
+    glm::mat4 GetViewProjection() const;
+
+    /// <summary>
+    /// Everything that can cast a shadow into the cascade: its box, extended towards the light without limit.
+    /// </summary>
+    Frustum GetCasterFrustum() const;
+
+    /// <summary>
+    /// Moves the near plane towards the light until it includes the world-space box of a caster.
+    /// </summary>
+    void IncludeCaster(const glm::vec3& min, const glm::vec3& max);
+
+    /// <summary>
+    /// Whether the cascade still covers a world-space sphere, so that a cached shadow map of it can be reused.
+    /// </summary>
+    bool Covers(const glm::vec3& center, float radius) const;
+
+    float GetTexelSize(int resolution) const { return 2.0f * HalfSize / static_cast<float>(resolution); }
+};
+
+/// <summary>
+/// Splits the part of the view frustum up to a distance into count slices, and writes where each one ends along the
+/// view direction to splits. Mixes logarithmic splits, which keep the texel density even, with uniform splits by
+/// lambda, so that the first slice does not get too small.
+/// </summary>
+void ComputeCascadeSplits(const glm::mat4& projection, float distance, float lambda, int count, float* splits);
+
+/// <summary>
+/// The sphere around the part of a view frustum between two distances along the view direction, in world space, as
+/// {center, radius}. It only depends on the shape of the frustum, so the cascade around it does not change size when
+/// the camera turns.
+/// </summary>
+std::pair<glm::vec3, float> GetFrustumSliceSphere(const glm::mat4& view,
+                                                  const glm::mat4& projection,
+                                                  float sliceNear,
+                                                  float sliceFar);
+
+/// <summary>
+/// The rotation from world space to the light space of a light with the given world transform, see ShadowCascade.
+/// </summary>
+glm::mat4 GetLightView(const glm::mat4& lightWorld);
+
+/// <summary>
+/// Fits a cascade around a world-space sphere, for a light with the given world transform. The size is rounded up to
+/// a few steps per power of two and the center snapped to whole texels, so that the shadow map does not shimmer when
+/// the camera moves. The depth range only covers the sphere, see ShadowCascade::IncludeCaster.
+/// </summary>
+ShadowCascade FitShadowCascade(const glm::mat4& lightWorld, const glm::vec3& center, float radius, int resolution);
+
+}  // namespace bee
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "core/ecs.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// A corner of a skid mark quad, as the skid mark shaders read it.
+/// </summary>
+struct SkidMarkVertex
+{
+    glm::vec3 Position = glm::vec3(0.0f);
+    float Time = 0.0f;       // when it was laid, in the seconds of SkidMarkSystem::GetTime, for fading
+    float Side = 0.0f;       // -1 on the left edge and 1 on the right edge of the strip, for soft edges
+    float Intensity = 0.0f;  // opacity before fading
+};
+
+/// <summary>
+/// Where a strip of skid marks ends, kept by the contact that lays it between calls to SkidMarkRing::Add.
+/// </summary>
+struct SkidMarkStrip
+{
+    bool Active = false;                    // false until the next point starts a new strip
+    bool HasQuad = false;                   // whether Quad is the last quad of this strip
+    glm::vec3 End = glm::vec3(0.0f);        // the last point that was laid
+    glm::vec3 QuadStart = glm::vec3(0.0f);  // the center of the start edge of the last quad
+    uint64_t Quad = 0;                      // number of the last quad, see SkidMarkRing
+};
+
+/// <summary>
+/// All skid marks in a fixed number of quads, which are reused oldest first once all of them were written. Strips are
+/// built from the points that contacts pass, a quad from the last point to the next, which starts at the end edge of
+/// the quad before it so that strips have no gaps. When the next point continues the last quad in nearly the same
+/// direction, the last quad is stretched instead, so straight marks take a few long quads. Quads are numbered in the
+/// order they were written, and the quad with number n is in slot n % capacity, so a strip can tell whether its last
+/// quad was reused. Does not depend on the ECS or the graphics backend: the renderer mirrors the slots that changed.
+/// </summary>
+class SkidMarkRing
+{
+public:
+    static constexpr float c_minSegmentLength = 0.15f;  // shorter steps wait for the contact to move further
+    static constexpr float c_maxSegmentLength = 4.0f;   // quads are not stretched beyond this, so fading stays smooth
+    static constexpr float c_mergeCosine = 0.9994f;     // cos(2 degrees), the largest bend that stretches the last quad
+    static constexpr float c_mergeIntensity = 0.1f;     // the largest change in intensity that stretches the last quad
+
+    explicit SkidMarkRing(uint32_t capacity);
+
+    /// <summary>
+    /// Continues a strip to a point, laying a mark width wide across the direction of travel in the plane of the
+    /// ground, which has the normal up. An intensity of 0 or less ends the strip, the next point starts a new one.
+    /// </summary>
+    void Add(SkidMarkStrip& strip, const glm::vec3& position, const glm::vec3& up, float width, float intensity, float time);
+
+    uint32_t GetCapacity() const { return m_capacity; }
+    uint64_t GetWrittenCount() const { return m_next; }  // quads, including the ones that were reused since
+    uint64_t GetMergedCount() const { return m_merged; }  // points that stretched a quad instead of adding one
+
+    /// <summary>
+    /// The number of slots that hold a quad. Slots fill in order, so these are [0, GetQuadCount()).
+    /// </summary>
+    uint32_t GetQuadCount() const { return static_cast<uint32_t>(std::min<uint64_t>(m_next, m_capacity)); }
+
+    /// <summary>
+    /// The 4 vertices of the quad in a slot: the left and right of its start edge and the left and right of its end edge.
+    /// </summary>
+    const SkidMarkVertex* GetQuad(uint32_t slot) const { return &m_vertices[static_cast<size_t>(slot) * 4]; }
+
+    /// <summary>
+    /// The slots that were written since the last call to ClearChanges, every slot once, in no particular order.
+    /// </summary>
+    const std::vector<uint32_t>& GetChangedSlots() const { return m_changed; }
+    void ClearChanges();
+
+private:
+    bool IsAlive(uint64_t quad) const { return m_next - quad <= m_capacity; }
+    SkidMarkVertex* GetVertices(uint64_t quad) { return &m_vertices[static_cast<size_t>(quad % m_capacity) * 4]; }
+    void MarkChanged(uint64_t quad);
+
+    uint32_t m_capacity = 0;
+    std::vector<SkidMarkVertex> m_vertices;  // 4 per slot, all zero until written, which draws nothing
+    std::vector<uint32_t> m_changed;
+    std::vector<uint8_t> m_isChanged;  // by slot
+    uint64_t m_next = 0;               // number of the next quad
+    uint64_t m_merged = 0;
+};
+
+/// <summary>
+/// Lays skid marks where its entity is, which needs a Transform whose z axis is the normal of the ground. Gameplay
+/// sets the intensity every frame, usually from how much a tire slides.
+/// </summary>
+struct SkidMarkEmitter
+{
+    float Width = 0.2f;      // of the mark
+    float Intensity = 0.0f;  // opacity of new marks, 0 ends the current strip
+    SkidMarkStrip Strip;
+};
+
+/// <summary>
+/// Owns the SkidMarkRing of the game, and continues the strip of every SkidMarkEmitter every frame. The renderer takes
+/// the quads that changed into its frame packet (see Renderer::Extract), keeps the whole ring in one vertex buffer, and
+/// draws all marks of all emitters with a single draw call, fading them by age.
+/// </summary>
+class SkidMarkSystem : public System
+{
+public:
+    static constexpr uint32_t c_defaultCapacity = 16384;
+
+    explicit SkidMarkSystem(uint32_t capacity = c_defaultCapacity);
+
+    void Update(float dt) override;
+
+    SkidMarkRing& GetRing() { return m_ring; }
+    const SkidMarkRing& GetRing() const { return m_ring; }
+    float GetTime() const { return m_time; }  // seconds since the system was created, see SkidMarkVertex::Time
+
+    float FadeTime = 60.0f;  // marks fade out over this many seconds, or disappear earlier when their quad is reused
+
+private:
+    SkidMarkRing m_ring;
+    float m_time = 0.0f;
+};
+
+}  // namespace bee
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "rendering/mesh_data.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// One static mesh instance to merge: the geometry of its mesh and where it is in the world.
+/// </summary>
+struct StaticBatchSource
+{
+    const MeshData* Mesh = nullptr;
+    glm::mat4 World = glm::mat4(1.0f);
+    uint32_t Material = 0;  // only sources with the same material end up in the same batch
+};
+
+/// <summary>
+/// Geometry of many static mesh instances merged into one mesh, already transformed to world space.
+/// </summary>
+struct StaticBatch
+{
+    uint32_t Material = 0;
+    glm::ivec3 Chunk = glm::ivec3(0);  // the cell of the chunk grid that the sources are in
+    glm::vec3 Min = glm::vec3(0.0f);   // world-space bounds of Data
+    glm::vec3 Max = glm::vec3(0.0f);
+    uint32_t SourceCount = 0;
+    MeshData Data;
+};
+
+/// <summary>
+/// Merges static mesh instances that share a material into one batch per chunk of a world-space grid, so that they can
+/// be drawn with a few draw calls, without a transform per instance, while chunks far away can still be culled.
+/// A source belongs to the chunk that the center of its bounds is in; its triangles are never split, so a batch can
+/// extend beyond its chunk. Positions, normals and tangents are transformed to world space and the winding order is
+/// flipped for mirrored instances. An attribute is included in a batch when any of its sources has it; sources without
+/// it get a default value. Sources without a mesh or without geometry are skipped.
+/// Runs on the CPU only and does not need a graphics context. The batches are sorted by material and then by chunk.
+/// </summary>
+/// <param name="sources">The mesh instances to merge.</param>
+/// <param name="chunkSize">The size of a grid cell in world units, must be larger than 0.</param>
+std::vector<StaticBatch> BuildStaticBatches(const std::vector<StaticBatchSource>& sources, float chunkSize);
+
+}  // namespace bee
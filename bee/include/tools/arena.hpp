@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+#include <imgui/IconsFontAwesome.h>
+
+#include "tools/inspectable.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// A linear (bump) allocator for short-lived memory. Allocating only moves an offset forward and deallocating does
+/// nothing: memory is released all at once with Rewind() or Reset(). Grows by adding blocks, which are kept for reuse.
+/// Not thread-safe; every thread has its own arena, see GetScratchArena().
+/// Arenas are std::pmr memory resources, so standard containers can use them: std::pmr::vector<int> v(&arena);
+/// Objects in an arena are never destroyed, so only store trivially destructible types or pmr containers that live
+/// no longer than the memory.
+/// </summary>
+class Arena final : public std::pmr::memory_resource
+{
+public:
+    struct Marker
+    {
+        size_t Block = 0;
+        size_t Offset = 0;
+    };
+
+    explicit Arena(size_t blockSize = 64 * 1024);
+    ~Arena() override;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&&) = delete;
+    Arena& operator=(Arena&&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /// <summary>
+    /// Allocates uninitialized memory for count objects of type T.
+    /// </summary>
+    template <typename T>
+    T* Allocate(size_t count)
+    {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /// <summary>
+    /// Returns the current position, to Rewind() to later. Everything allocated after the marker is released then.
+    /// </summary>
+    Marker GetMarker() const { return {m_block, m_offset}; }
+    void Rewind(const Marker& marker);
+    void Reset() { Rewind({}); }
+
+    size_t GetCapacity() const;
+    uint64_t GetAllocations() const { return m_allocations.load(std::memory_order_relaxed); }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override { return Allocate(bytes, alignment); }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> Memory;
+        size_t Size = 0;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_block = 0;   // the block that is being allocated from
+    size_t m_offset = 0;  // in bytes, into that block
+    size_t m_blockSize = 0;
+    std::atomic<uint64_t> m_allocations{0};  // only written by the owning thread, read by the stats bar
+};
+
+/// <summary>
+/// Returns the scratch arena of the calling thread. Use it through a ScratchScope, so that the memory is released when
+/// the work is done.
+/// </summary>
+Arena& GetScratchArena();
+
+/// <summary>
+/// Releases everything that was allocated from the calling thread's scratch arena during its lifetime.
+/// Scopes can be nested, but memory from a scope must not be used after it ends:
+/// <code>
+/// ScratchScope scratch;
+/// std::pmr::vector&lt;Entity&gt; entities(&amp;scratch.GetArena());
+/// </code>
+/// </summary>
+class ScratchScope
+{
+public:
+    ScratchScope() : m_arena(GetScratchArena()), m_marker(m_arena.GetMarker()) {}
+    ~ScratchScope() { m_arena.Rewind(m_marker); }
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+    ScratchScope(ScratchScope&&) = delete;
+    ScratchScope& operator=(ScratchScope&&) = delete;
+
+    Arena& GetArena() { return m_arena; }
+
+private:
+    Arena& m_arena;
+    Arena::Marker m_marker;
+};
+
+/// <summary>
+/// A linear allocator for memory that lives until the end of the current frame, when the engine calls Reset().
+/// Can be used from any thread. When the arena runs out of memory, allocations fall back to the heap, and the arena
+/// grows at the next Reset() so that the next frame fits.
+/// Extracted frame data (see FramePacket) outlives the frame it was extracted in, so it cannot use this arena.
+/// </summary>
+class FrameArena final : public std::pmr::memory_resource, public IStatsBar
+{
+public:
+    explicit FrameArena(size_t capacity = 4 * 1024 * 1024);
+    ~FrameArena() override;
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    FrameArena(FrameArena&&) = delete;
+    FrameArena& operator=(FrameArena&&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* Allocate(size_t count)
+    {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /// <summary>
+    /// Releases all memory of this frame. Must not be called while other threads are allocating.
+    /// </summary>
+    void Reset();
+
+    size_t GetCapacity() const { return m_capacity; }
+
+    /// <summary>Allocations from this arena during the last frame.</summary>
+    uint64_t GetFrameAllocations() const { return m_lastFrame.Allocations; }
+    /// <summary>Allocations from the scratch arenas of all threads during the last frame.</summary>
+    uint64_t GetFrameScratchAllocations() const { return m_lastFrame.ScratchAllocations; }
+    /// <summary>Allocations of the last frame that did not fit and went to the heap.</summary>
+    uint64_t GetFrameHeapAllocations() const { return m_lastFrame.HeapAllocations; }
+    size_t GetFrameBytes() const { return m_lastFrame.Bytes; }
+
+#ifdef BEE_INSPECTOR
+    void OnStatsBar() override;
+#endif
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override { return Allocate(bytes, alignment); }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    struct HeapAllocation
+    {
+        void* Memory = nullptr;
+        size_t Alignment = 0;
+    };
+
+    struct Stats
+    {
+        uint64_t Allocations = 0;
+        uint64_t ScratchAllocations = 0;
+        uint64_t HeapAllocations = 0;
+        size_t Bytes = 0;
+    };
+
+    std::unique_ptr<std::byte[]> m_memory;
+    size_t m_capacity = 0;
+    std::atomic<size_t> m_offset{0};
+    std::atomic<uint64_t> m_allocations{0};
+    std::mutex m_heapMutex;
+    std::vector<HeapAllocation> m_heapAllocations;
+    size_t m_heapBytes = 0;
+    uint64_t m_scratchAllocations = 0;  // of all scratch arenas, at the last reset
+    Stats m_lastFrame;
+};
+
+}  // namespace bee
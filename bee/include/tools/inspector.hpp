@@ -39,6 +39,12 @@ public:
     void ManipToolbar(ImVec2 pos);
     void Gizmo(const glm::mat4& view, const glm::mat4& projection);
 
+    /// <summary>
+    /// Selects the entity under the mouse when the scene is clicked outside of any window or gizmo. Casts a ray
+    /// against the triangles of all meshes, through the SceneTree system.
+    /// </summary>
+    void Pick(const glm::mat4& view, const glm::mat4& projection);
+
 protected:
     void Inspect(Entity entity, Transform& transform, std::set<Entity>& inspected);
     static bool DragFloat3(const char* label,
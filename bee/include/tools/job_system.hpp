@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bee
+{
+
+/// <summary>
+/// A work-stealing job system. Every worker thread (and the thread that created the job system, usually the main thread)
+/// owns a deque of jobs: it pushes and pops jobs at the back of its own deque and, when that is empty, steals from the
+/// front of the deques of other threads. Jobs are taken from per-thread pools that are allocated once, and job functions
+/// are stored inside the job itself, so scheduling a job never allocates memory.
+/// Jobs can depend on other jobs, and only start when all their dependencies have finished.
+/// </summary>
+class JobSystem
+{
+    struct Job;
+
+public:
+    /// <summary>
+    /// Handle to a scheduled job. Stays valid (and reports the job as done) after the job's memory has been reused.
+    /// </summary>
+    class JobHandle
+    {
+    public:
+        JobHandle() = default;
+        bool IsValid() const { return m_job != nullptr; }
+
+    private:
+        friend class JobSystem;
+        JobHandle(Job* job, uint32_t generation) : m_job(job), m_generation(generation) {}
+        Job* m_job = nullptr;
+        uint32_t m_generation = 0;
+    };
+
+    /// <summary>
+    /// Creates the job system with the given number of worker threads.
+    /// If negative, one worker is created for every hardware thread except the one that creates the job system.
+    /// </summary>
+    explicit JobSystem(int numberOfWorkers = -1);
+    ~JobSystem();  // joins all threads
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+
+    /// <summary>
+    /// Schedules a function to run on any thread, as soon as all the given jobs have finished.
+    /// The function is stored inside the job, so it must fit in kMaxFunctionSize bytes (capture pointers, not containers).
+    /// </summary>
+    template <typename F>
+    JobHandle Schedule(F&& function, std::initializer_list<JobHandle> dependencies = {});
+
+    /// <summary>
+    /// Calls function(begin, end) for consecutive ranges of [0, count) in parallel, and returns when all ranges are done.
+    /// Ranges are at least batchSize elements long. The calling thread works on the ranges as well.
+    /// </summary>
+    template <typename F>
+    void ParallelFor(size_t count, size_t batchSize, const F& function);
+
+    /// <summary>
+    /// Executes other jobs until the given job has finished.
+    /// </summary>
+    void Wait(const JobHandle& handle);
+
+    /// <summary>
+    /// Returns whether the given job has finished. Invalid handles count as finished.
+    /// </summary>
+    bool IsDone(const JobHandle& handle) const;
+
+    /// <summary>
+    /// Takes a single job from the queues and executes it on the calling thread.
+    /// Returns false if no job was available.
+    /// </summary>
+    bool ExecuteOne();
+
+    int NumberOfWorkers() const { return static_cast<int>(m_workers.size()); }
+
+    /// <summary>The number of threads that can execute jobs at the same time: all workers plus the owning thread.</summary>
+    int GetMaxConcurrency() const { return NumberOfWorkers() + 1; }
+
+    uint64_t GetJobsExecuted() const { return m_jobsExecuted.load(std::memory_order_relaxed); }
+    uint64_t GetJobsStolen() const { return m_jobsStolen.load(std::memory_order_relaxed); }
+
+    static constexpr size_t kMaxFunctionSize = 48;
+    static constexpr size_t kMaxContinuations = 6;
+    static constexpr size_t kJobsPerThread = 1024;  // power of two
+
+private:
+    struct alignas(64) Job
+    {
+        void (*Invoke)(Job& job) = nullptr;  // runs and destroys the stored function
+        Job* Parent = nullptr;
+        std::atomic<int> Unfinished{0};    // this job plus its unfinished children
+        std::atomic<int> Dependencies{0};  // unfinished jobs this job waits for
+        std::atomic<uint32_t> Generation{0};
+        std::atomic<bool> InUse{false};
+        std::atomic_flag Lock = ATOMIC_FLAG_INIT;  // guards Continuations and completion
+        uint8_t NumContinuations = 0;
+        Job* Continuations[kMaxContinuations] = {};
+        alignas(16) unsigned char Function[kMaxFunctionSize];
+    };
+
+    // Fixed capacity deque, the owning thread works at the back and other threads steal from the front
+    struct alignas(64) Queue
+    {
+        std::mutex Mutex;
+        Job* Jobs[kJobsPerThread] = {};
+        size_t Front = 0;
+        size_t Back = 0;
+    };
+
+    // Jobs are allocated round-robin from a ring that belongs to one thread
+    struct JobPool
+    {
+        std::unique_ptr<Job[]> Jobs;
+        size_t Next = 0;
+    };
+
+    template <typename F>
+    Job* CreateJob(F&& function, Job* parent);
+    Job* AllocateJob();
+    void Submit(Job* job, std::initializer_list<JobHandle> dependencies);
+    void Push(Job* job);
+    Job* Pop();
+    void Execute(Job* job);
+    void Finish(Job* job);
+    void WorkerMain(int threadIndex);
+    int GetThreadIndex() const;
+
+    std::vector<std::thread> m_workers;
+    std::unique_ptr<Queue[]> m_queues;     // one per thread, index 0 belongs to the owning thread
+    std::unique_ptr<JobPool[]> m_pools;    // one per thread, plus a shared one for all other threads
+    std::mutex m_sharedPoolMutex;
+    std::atomic<int> m_pendingJobs{0};
+    std::atomic<int> m_sleepingWorkers{0};
+    std::atomic<bool> m_stopped{false};
+    std::atomic<uint64_t> m_jobsExecuted{0};
+    std::atomic<uint64_t> m_jobsStolen{0};
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
+    int m_numberOfThreads = 0;
+};
+
+template <typename F>
+JobSystem::Job* JobSystem::CreateJob(F&& function, Job* parent)
+{
+    using Function = std::decay_t<F>;
+    static_assert(sizeof(Function) <= kMaxFunctionSize, "Job function is too large, capture less or capture by pointer");
+    static_assert(alignof(Function) <= 16, "Job function is over-aligned");
+
+    Job* job = AllocateJob();
+    new (job->Function) Function(std::forward<F>(function));
+    job->Invoke = [](Job& j)
+    {
+        auto* f = std::launder(reinterpret_cast<Function*>(j.Function));
+        (*f)();
+        f->~Function();
+    };
+    job->Parent = parent;
+    if (parent) parent->Unfinished.fetch_add(1, std::memory_order_relaxed);
+    return job;
+}
+
+template <typename F>
+JobSystem::JobHandle JobSystem::Schedule(F&& function, std::initializer_list<JobHandle> dependencies)
+{
+    Job* job = CreateJob(std::forward<F>(function), nullptr);
+    const JobHandle handle(job, job->Generation.load(std::memory_order_relaxed));
+    Submit(job, dependencies);
+    return handle;
+}
+
+template <typename F>
+void JobSystem::ParallelFor(size_t count, size_t batchSize, const F& function)
+{
+    if (count == 0) return;
+    batchSize = std::max<size_t>(batchSize, 1);
+
+    // Split into a few ranges per thread, so that stealing can even out the load
+    const size_t maxRanges = static_cast<size_t>(GetMaxConcurrency()) * 4;
+    const size_t numRanges = std::min((count + batchSize - 1) / batchSize, maxRanges);
+    if (numRanges <= 1)
+    {
+        function(size_t(0), count);
+        return;
+    }
+
+    // The parent job does nothing itself, but only finishes when all ranges have finished
+    Job* parent = CreateJob([] {}, nullptr);
+    const JobHandle handle(parent, parent->Generation.load(std::memory_order_relaxed));
+    const F* f = &function;
+    for (size_t i = 0; i < numRanges; i++)
+    {
+        const size_t begin = count * i / numRanges;
+        const size_t end = count * (i + 1) / numRanges;
+        Push(CreateJob([f, begin, end] { (*f)(begin, end); }, parent));
+    }
+    Push(parent);
+    Wait(handle);
+}
+
+}  // namespace bee
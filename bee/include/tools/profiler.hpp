@@ -4,6 +4,7 @@
 #include <string>
 #include <deque>
 #include <chrono>
+#include <mutex>
 #include <imgui/IconsFontAwesome.h>
 #include "inspectable.hpp"
 #include "tools/warnings.hpp"
@@ -107,6 +108,7 @@ private:
         std::deque<float> History;
     };
     std::unordered_map<std::string, Entry> m_times;
+    std::mutex m_mutex;  // sections can be opened from systems running on worker threads
 };
 
 }  // namespace bee
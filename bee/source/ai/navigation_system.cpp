@@ -14,8 +14,9 @@ using namespace bee::ai;
 using namespace glm;
 
 NavigationSystem::NavigationSystem(float fixedDeltaTime, float agentRadius)
-    : m_fixedDeltaTime(fixedDeltaTime), m_timeSinceLastFrame(0)
 {
+    SetFixedDeltaTime(fixedDeltaTime);
+
     // get all navmesh input
     geometry2d::PolygonList navmeshObstacles;
     geometry2d::PolygonList navmeshWalkableAreas;
@@ -39,26 +40,22 @@ NavigationSystem::NavigationSystem(float fixedDeltaTime, float agentRadius)
     m_navmesh = std::make_unique<ai::Navmesh>(navmeshWalkableAreas, navmeshObstacles, agentRadius);
 }
 
-void NavigationSystem::Update(float dt)
+void NavigationSystem::FixedUpdate(float dt)
 {
-    m_timeSinceLastFrame += dt;
-
-    const auto& view = Engine.ECS().Registry.view<ai::NavmeshAgent, physics::Body>();
-
-    if (m_timeSinceLastFrame >= m_fixedDeltaTime)
+    // handle navmesh agent control
+    for (const auto& [entity, agent, body] : Engine.ECS().Registry.view<ai::NavmeshAgent, physics::Body>().each())
     {
-        // handle navmesh agent control
-        for (const auto& [entity, agent, body] : view.each())
-        {
-            // recompute path?
-            if (agent.ShouldRecomputePath()) agent.ComputePath(*m_navmesh, body.GetPosition());
+        // recompute path?
+        if (agent.ShouldRecomputePath()) agent.ComputePath(*m_navmesh, body.GetPosition());
 
-            // update velocity
-            agent.ComputePreferredVelocity(body.GetPosition(), m_fixedDeltaTime);
-        }
-
-        m_timeSinceLastFrame -= m_fixedDeltaTime;
+        // update velocity
+        agent.ComputePreferredVelocity(body.GetPosition(), dt);
     }
+}
+
+void NavigationSystem::Update(float)
+{
+    const auto& view = Engine.ECS().Registry.view<ai::NavmeshAgent, physics::Body>();
 
     // link agents to physics
     for (const auto& [entity, agent, body] : view.each())
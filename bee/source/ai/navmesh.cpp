@@ -3,12 +3,14 @@
 #include <clipper/include/clipper2/clipper.h>
 
 #include <glm/glm.hpp>
+#include <deque>
 #include <glm/gtx/norm.hpp>
 #include <queue>
 
 #include "core/engine.hpp"
 #include "core/geometry2d.hpp"
 #include "graph/graph_search.hpp"
+#include "tools/arena.hpp"
 
 using namespace bee::ai;
 using namespace bee::graph;
@@ -90,9 +92,9 @@ glm::vec2 GetMidpointOfSharedEdge(const Polygon& p1, const Polygon& p2)
 }
 
 void FunnelAlgorithmStepLeft(const glm::vec2& newPoint,
-                             std::deque<glm::vec2>& leftFunnel,
-                             std::deque<glm::vec2>& rightFunnel,
-                             Path& path)
+                             std::pmr::deque<glm::vec2>& leftFunnel,
+                             std::pmr::deque<glm::vec2>& rightFunnel,
+                             std::pmr::vector<glm::vec2>& path)
 {
     const glm::vec2& lastPoint = leftFunnel.empty() ? path.back() : leftFunnel.back();
     if (newPoint != lastPoint)
@@ -121,9 +123,9 @@ void FunnelAlgorithmStepLeft(const glm::vec2& newPoint,
 }
 
 void FunnelAlgorithmStepRight(const glm::vec2& newPoint,
-                              std::deque<glm::vec2>& leftFunnel,
-                              std::deque<glm::vec2>& rightFunnel,
-                              Path& path)
+                              std::pmr::deque<glm::vec2>& leftFunnel,
+                              std::pmr::deque<glm::vec2>& rightFunnel,
+                              std::pmr::vector<glm::vec2>& path)
 {
     const glm::vec2& lastPoint = rightFunnel.empty() ? path.back() : rightFunnel.back();
     if (newPoint != lastPoint)
@@ -152,14 +154,17 @@ void FunnelAlgorithmStepRight(const glm::vec2& newPoint,
     }
 }
 
-Path Navmesh::ComputeShortestPath(const glm::vec2& start, const glm::vec2& goal, const std::vector<int>& cells) const
+std::pmr::vector<glm::vec2> Navmesh::ComputeShortestPath(const glm::vec2& start,
+                                                         const glm::vec2& goal,
+                                                         const std::vector<int>& cells,
+                                                         std::pmr::memory_resource* memory) const
 {
     // Based on this explanation: https://medium.com/@reza.teshnizi/the-funnel-algorithm-explained-visually-41e374172d2d
     // This version of the funnel algorithm only works with convex navmesh cells.
 
-    Path path = {start};
+    std::pmr::vector<glm::vec2> path({start}, memory);
 
-    std::deque<glm::vec2> leftFunnel, rightFunnel;
+    std::pmr::deque<glm::vec2> leftFunnel(memory), rightFunnel(memory);
 
     size_t n = cells.size();
     for (size_t i = 0; i < n; ++i)
@@ -183,9 +188,12 @@ Path Navmesh::ComputeShortestPath(const glm::vec2& start, const glm::vec2& goal,
     return path;
 }
 
-Path Navmesh::ComputeMidpointPath(const glm::vec2& start, const glm::vec2& goal, const std::vector<int>& cells) const
+std::pmr::vector<glm::vec2> Navmesh::ComputeMidpointPath(const glm::vec2& start,
+                                                         const glm::vec2& goal,
+                                                         const std::vector<int>& cells,
+                                                         std::pmr::memory_resource* memory) const
 {
-    Path result = {start};
+    std::pmr::vector<glm::vec2> result({start}, memory);
 
     const size_t n = cells.size();
     for (size_t i = 0; i + 1 < n; ++i)
@@ -196,22 +204,31 @@ Path Navmesh::ComputeMidpointPath(const glm::vec2& start, const glm::vec2& goal,
 }
 
 Path Navmesh::ComputePath(const glm::vec2& start, const glm::vec2& goal) const
+{
+    ScratchScope scratch;
+    const auto& path = ComputePath(start, goal, &scratch.GetArena());
+    return Path(path.begin(), path.end());
+}
+
+std::pmr::vector<glm::vec2> Navmesh::ComputePath(const glm::vec2& start,
+                                                 const glm::vec2& goal,
+                                                 std::pmr::memory_resource* memory) const
 {
     // find the nearest cell to the start point
     int startID = GetNearestPolygon(start);
-    if (startID == -1) return {};
+    if (startID == -1) return std::pmr::vector<glm::vec2>(memory);
 
     // find the nearest cell to the goal point
     int goalID = GetNearestPolygon(goal);
-    if (goalID == -1) return {};
+    if (goalID == -1) return std::pmr::vector<glm::vec2>(memory);
 
     // do an A* search
     const std::vector<int>& cells = graph::AStar(m_graph, startID, goalID, graph::AStarHeuristic_EuclideanDistance);
-    if (cells.empty()) return {};
+    if (cells.empty()) return std::pmr::vector<glm::vec2>(memory);
 
     // convert sequence of cells to a nice path
-    return ComputeShortestPath(start, goal, cells);  // shortest path, based on funnel algorithm
-    // return ComputeMidpointPath(start, goal, cells); // a path that connects the triangle edge midpoints
+    return ComputeShortestPath(start, goal, cells, memory);  // shortest path, based on funnel algorithm
+    // return ComputeMidpointPath(start, goal, cells, memory); // a path that connects the triangle edge midpoints
 }
 
 template <typename T1, typename T2, typename T3>
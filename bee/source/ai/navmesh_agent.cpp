@@ -1,5 +1,7 @@
 #include "ai/navmesh_agent.hpp"
 
+#include "tools/arena.hpp"
+
 using namespace bee::ai;
 
 void NavmeshAgent::SetGoal(const glm::vec2& goal, bool recomputePath)
@@ -10,8 +12,10 @@ void NavmeshAgent::SetGoal(const glm::vec2& goal, bool recomputePath)
 
 void NavmeshAgent::ComputePath(const Navmesh& navmesh, const glm::vec2& currentPos)
 {
-    // compute a new path to the goal
-    m_path = navmesh.ComputePath(currentPos, m_goal);
+    // compute a new path to the goal, in scratch memory so that m_path can reuse its own
+    ScratchScope scratch;
+    const auto& path = navmesh.ComputePath(currentPos, m_goal, &scratch.GetArena());
+    m_path.assign(path.begin(), path.end());
     m_recomputePath = false;
 
     // reset the agent's path references
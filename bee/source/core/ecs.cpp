@@ -1,6 +1,12 @@
 #include "core/ecs.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
+
+#include "core/system_scheduler.hpp"
 #include "core/transform.hpp"
+#include "tools/log.hpp"
 
 using namespace bee;
 using namespace std;
@@ -8,7 +14,7 @@ using namespace entt;
 
 constexpr float kMaxDeltaTime = 1.0f / 30.0f;
 
-EntityComponentSystem::EntityComponentSystem() = default;
+EntityComponentSystem::EntityComponentSystem() : m_scheduler(make_unique<SystemScheduler>()) {}
 
 bee::EntityComponentSystem::~EntityComponentSystem() = default;
 
@@ -34,17 +40,59 @@ void EntityComponentSystem::DeleteEntity(Entity e)
     }
 }
 
+void System::SetFixedDeltaTime(float fixedDeltaTime)
+{
+    const float ticks = round(fixedDeltaTime / Engine.GetFixedDeltaTime());
+    FixedUpdateInterval = max(1, static_cast<int>(ticks));
+    if (abs(ticks * Engine.GetFixedDeltaTime() - fixedDeltaTime) > 0.0001f)
+        Log::Warn("Fixed time step of {} s is not a multiple of the engine tick, using {} s",
+                  fixedDeltaTime,
+                  GetFixedDeltaTime());
+}
+
+void EntityComponentSystem::FixedUpdateSystems(float dt, uint64_t tick)
+{
+    SortSystems();
+    m_scheduler->FixedUpdate(dt, tick);
+}
+
 void EntityComponentSystem::UpdateSystems(float dt)
 {
     dt = min(dt, kMaxDeltaTime);
-    for (auto& s : m_systems) s->Update(dt);
+    SortSystems();
+    m_scheduler->Update(dt);
+}
+
+void EntityComponentSystem::ExtractSystems()
+{
+    SortSystems();
+    for (auto& s : m_systems) s->Extract();
+}
+
+void EntityComponentSystem::SubmitSystems()
+{
+    // Not sorting here, this can run while the next frame is being updated
+    for (auto& s : m_systems) s->Submit();
 }
 
 void EntityComponentSystem::RenderSystems()
 {
+    SortSystems();
     for (auto& s : m_systems) s->Render();
 }
 
+void EntityComponentSystem::SortSystems()
+{
+    if (!m_systemsDirty) return;
+
+    // Stable, so that systems with the same priority keep their creation order
+    stable_sort(m_systems.begin(),
+                m_systems.end(),
+                [](const unique_ptr<System>& sl, const unique_ptr<System>& sr) { return sl->Priority > sr->Priority; });
+    m_scheduler->Build(m_systems, Registry);
+    m_systemsDirty = false;
+}
+
 void EntityComponentSystem::RemovedDeleted()
 {
     bool isDeleteQueueEmpty = false;
@@ -57,3 +105,24 @@ void EntityComponentSystem::RemovedDeleted()
         isDeleteQueueEmpty = del.empty();
     }
 }
+
+#ifdef BEE_DEBUG
+
+void System::CheckAccess(const ComponentAccess& access, bool write)
+{
+    if (!m_declaredAccess || !Engine.ECS().Scheduler().DetectRaces) return;
+
+    const auto declared = [&access](const vector<ComponentAccess>& list)
+    { return find_if(list.begin(), list.end(), [&access](const ComponentAccess& a) { return a.ID == access.ID; }) != list.end(); };
+    if (declared(m_writes) || (!write && declared(m_reads))) return;
+
+    // Report every type only once, this is called for every view
+    if (find(m_reported.begin(), m_reported.end(), access.ID) != m_reported.end()) return;
+    m_reported.push_back(access.ID);
+    Log::Error("System {} {} {} without declaring it, it may race with other systems",
+               Title.empty() ? typeid(*this).name() : Title,
+               write ? "writes" : "reads",
+               access.Name);
+}
+
+#endif
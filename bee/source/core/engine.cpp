@@ -1,5 +1,6 @@
 #include "core/engine.hpp"
 
+#include <cassert>
 #include <chrono>
 #include <iostream>
 
@@ -10,10 +11,11 @@
 #include "core/audio.hpp"
 #include "core/resources.hpp"
 #include "rendering/debug_render.hpp"
+#include "tools/arena.hpp"
 #include "tools/inspector.hpp"
+#include "tools/job_system.hpp"
 #include "tools/profiler.hpp"
 #include "tools/log.hpp"
-#include "tools/thread_pool.hpp"
 
 using namespace bee;
 
@@ -24,6 +26,8 @@ void EngineClass::Initialize()
 {
     BEE_PROFILE_SCOPE("Engine Initialize");
     Log::Initialize();
+    m_jobSystem = new bee::JobSystem();  // one worker per core, the main thread joins in when waiting
+    m_frameArena = new bee::FrameArena();
     m_fileIO = new bee::FileIO();
     m_resources = new bee::Resources();
     m_device = new bee::Device();
@@ -37,7 +41,6 @@ void EngineClass::Initialize()
 
 void EngineClass::Shutdown()
 {
-    delete m_pool;
     delete m_ECS;
     delete m_profiler;
     delete m_inspector;
@@ -47,6 +50,8 @@ void EngineClass::Shutdown()
     delete m_device;
     delete m_resources;
     delete m_fileIO;
+    delete m_frameArena;
+    delete m_jobSystem;
 }
 
 void EngineClass::Run()
@@ -60,9 +65,32 @@ void EngineClass::Run()
 
         m_input->Update();
         m_audio->Update();
-        m_ECS->UpdateSystems(dt);
-        m_ECS->RemovedDeleted();
-        m_device->BeginFrame();
+
+        // The inspector can change the latency halfway through the frame, so use the one the frame started with
+        const int latency = m_frameLatency;
+        if (latency == 0)
+        {
+            Simulate(dt);
+            m_ECS->RemovedDeleted();
+            m_ECS->ExtractSystems();
+            m_device->BeginFrame();
+            m_ECS->SubmitSystems();
+        }
+        else
+        {
+            // Update the next frame on the job system, while the main thread submits the previous one
+            const auto simulation = m_jobSystem->Schedule([this, dt] { Simulate(dt); });
+            m_device->BeginFrame();
+
+            // Coming from latency 0, the previous frame was already submitted and its packet cleared
+            if (m_previousFrameLatency == 1) m_ECS->SubmitSystems();
+            m_jobSystem->Wait(simulation);
+
+            // Destroying entities can release GPU resources, which only the main thread may do
+            m_ECS->RemovedDeleted();
+            m_ECS->ExtractSystems();
+        }
+
         m_ECS->RenderSystems();
         m_debugRenderer->Render();
         m_inspector->Inspect(dt);
@@ -70,11 +98,40 @@ void EngineClass::Run()
         m_device->Update();
 
         time = ctime;
+        m_previousFrameLatency = latency;
+        m_frameArena->Reset();
+        m_frameIndex++;
     }
 }
 
-ThreadPool& bee::EngineClass::ThreadPool()
+void EngineClass::Simulate(float dt)
+{
+    m_fixedAccumulator += dt;
+    m_fixedTicksThisFrame = 0;
+    while (m_fixedAccumulator >= m_fixedDeltaTime)
+    {
+        if (m_fixedTicksThisFrame == m_maxFixedTicksPerFrame)
+        {
+            // Too far behind, drop the time instead of spiralling into ever longer frames
+            const auto dropped = static_cast<uint64_t>(m_fixedAccumulator / m_fixedDeltaTime);
+            m_droppedFixedTicks += dropped;
+            m_fixedAccumulator -= static_cast<float>(dropped) * m_fixedDeltaTime;
+            break;
+        }
+
+        m_ECS->FixedUpdateSystems(m_fixedDeltaTime, m_fixedTick);
+        m_fixedAccumulator -= m_fixedDeltaTime;
+        m_fixedTick++;
+        m_fixedTicksThisFrame++;
+    }
+    m_fixedAlpha = m_fixedAccumulator / m_fixedDeltaTime;
+
+    m_ECS->UpdateSystems(dt);
+}
+
+void EngineClass::SetFixedTickRate(float ticksPerSecond)
 {
-    if (!m_pool) m_pool = new bee::ThreadPool(4);
-    return *m_pool;
+    assert(ticksPerSecond > 0.0f);
+    m_fixedDeltaTime = 1.0f / ticksPerSecond;
+    m_fixedAccumulator = 0.0f;
 }
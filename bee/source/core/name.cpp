@@ -0,0 +1,59 @@
+#include "core/name.hpp"
+
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+using namespace bee;
+
+namespace
+{
+
+struct StringTableData
+{
+    // A deque never moves its elements, so the string_view keys into it stay valid.
+    std::deque<std::string> Strings{std::string()};
+    std::unordered_map<std::string_view, uint32_t> Ids{{std::string_view(), 0}};
+    std::mutex Mutex;
+};
+
+StringTableData& GetData()
+{
+    static StringTableData data;
+    return data;
+}
+
+}  // namespace
+
+uint32_t StringTable::Intern(std::string_view string)
+{
+    if (string.empty()) return 0;
+
+    auto& data = GetData();
+    std::lock_guard<std::mutex> lock(data.Mutex);
+
+    const auto itr = data.Ids.find(string);
+    if (itr != data.Ids.end()) return itr->second;
+
+    const auto id = static_cast<uint32_t>(data.Strings.size());
+    const auto& stored = data.Strings.emplace_back(string);
+    data.Ids.emplace(std::string_view(stored), id);
+    return id;
+}
+
+const std::string& StringTable::Lookup(uint32_t id)
+{
+    auto& data = GetData();
+    std::lock_guard<std::mutex> lock(data.Mutex);
+    assert(id < data.Strings.size());
+    if (id >= data.Strings.size()) return data.Strings.front();
+    return data.Strings[id];
+}
+
+size_t StringTable::Size()
+{
+    auto& data = GetData();
+    std::lock_guard<std::mutex> lock(data.Mutex);
+    return data.Strings.size();
+}
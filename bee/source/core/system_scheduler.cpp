@@ -0,0 +1,272 @@
+#include "core/system_scheduler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <typeinfo>
+
+#include "core/engine.hpp"
+#include "tools/log.hpp"
+#include "tools/job_system.hpp"
+
+#ifdef BEE_INSPECTOR
+#include <imgui/imgui.h>
+#endif
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+bool Overlaps(const vector<ComponentAccess>& a, const vector<ComponentAccess>& b)
+{
+    for (const auto& i : a)
+        for (const auto& j : b)
+            if (i.ID == j.ID) return true;
+    return false;
+}
+
+string GetSystemName(const System& system) { return system.Title.empty() ? typeid(system).name() : system.Title; }
+
+}  // namespace
+
+SystemScheduler::SystemScheduler() = default;
+
+SystemScheduler::~SystemScheduler() = default;
+
+bool SystemScheduler::Conflicts(const System& a, const System& b)
+{
+    if (!a.HasDeclaredAccess() || !b.HasDeclaredAccess()) return true;
+    return Overlaps(a.GetWrites(), b.GetWrites()) || Overlaps(a.GetWrites(), b.GetReads()) ||
+           Overlaps(a.GetReads(), b.GetWrites());
+}
+
+void SystemScheduler::Build(const vector<unique_ptr<System>>& systems, entt::registry& registry)
+{
+    m_nodes.clear();
+    m_roots.clear();
+    m_nodes.resize(systems.size());
+    m_pending = make_unique<atomic<int>[]>(systems.size());
+
+    for (size_t i = 0; i < systems.size(); i++)
+    {
+        auto& node = m_nodes[i];
+        node.Instance = systems[i].get();
+        node.Exclusive = !node.Instance->HasDeclaredAccess();
+
+        for (const auto& access : node.Instance->GetReads()) access.Assure(registry);
+        for (const auto& access : node.Instance->GetWrites()) access.Assure(registry);
+
+        // Depend on every conflicting system with a higher priority. Systems with the same priority keep their
+        // creation order, just like they would when running sequentially.
+        for (size_t j = 0; j < i; j++)
+        {
+            if (!Conflicts(*m_nodes[j].Instance, *node.Instance)) continue;
+            m_nodes[j].Dependents.push_back(i);
+            node.NumDependencies++;
+        }
+
+        if (node.NumDependencies == 0) m_roots.push_back(i);
+    }
+}
+
+void SystemScheduler::Update(float dt)
+{
+    const auto start = chrono::high_resolution_clock::now();
+    Run(Phase::Update, dt, 0);
+    m_lastFrameMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+void SystemScheduler::FixedUpdate(float dt, uint64_t tick)
+{
+    const auto start = chrono::high_resolution_clock::now();
+    Run(Phase::FixedUpdate, dt, tick);
+    m_lastTickMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+void SystemScheduler::Run(Phase phase, float dt, uint64_t tick)
+{
+    // Set before any job is scheduled, so every job sees them
+    m_phase = phase;
+    m_dt = dt;
+    m_tick = tick;
+
+    if (!Parallel)
+    {
+        // The nodes are in priority order, which is always a valid order to run them in
+        for (size_t i = 0; i < m_nodes.size(); i++) Execute(i);
+    }
+    else if (!m_nodes.empty())
+    {
+        for (size_t i = 0; i < m_nodes.size(); i++) m_pending[i] = m_nodes[i].NumDependencies;
+        m_remaining = m_nodes.size();
+        for (size_t root : m_roots) Dispatch(root);
+
+        // This thread runs the exclusive systems, and helps with the others in the meantime
+        unique_lock<mutex> lock(m_mutex);
+        while (m_remaining > 0)
+        {
+            if (m_exclusiveQueue.empty())
+            {
+                lock.unlock();
+                const bool executed = Engine.JobSystem().ExecuteOne();
+                lock.lock();
+                if (!executed) m_condition.wait(lock, [this] { return !m_exclusiveQueue.empty() || m_remaining == 0; });
+                continue;
+            }
+
+            const size_t node = m_exclusiveQueue.front();
+            m_exclusiveQueue.pop();
+            lock.unlock();
+            Execute(node);
+            lock.lock();
+        }
+    }
+}
+
+void SystemScheduler::Dispatch(size_t node)
+{
+    if (m_nodes[node].Exclusive)
+    {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_exclusiveQueue.push(node);
+        }
+        m_condition.notify_all();
+    }
+    else
+    {
+        Engine.JobSystem().Schedule([this, node] { Execute(node); });
+    }
+}
+
+void SystemScheduler::Execute(size_t index)
+{
+    auto& node = m_nodes[index];
+
+#ifdef BEE_DEBUG
+    if (DetectRaces && Parallel)
+    {
+        lock_guard<mutex> lock(m_mutex);
+        for (size_t running : m_running)
+        {
+            if (!Conflicts(*m_nodes[running].Instance, *node.Instance)) continue;
+            Log::Error("Systems {} and {} have conflicting component access but are running at the same time",
+                       GetSystemName(*m_nodes[running].Instance),
+                       GetSystemName(*node.Instance));
+            assert(false);
+        }
+        m_running.push_back(index);
+    }
+#endif
+
+    const auto start = chrono::high_resolution_clock::now();
+    if (m_phase == Phase::Update)
+    {
+        node.Instance->Update(m_dt);
+        node.LastMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+        node.AverageMs = node.AverageMs * 0.95f + node.LastMs * 0.05f;
+    }
+    else if (m_tick % static_cast<uint64_t>(node.Instance->FixedUpdateInterval) == 0)
+    {
+        // A system with an interval of N ticks gets the time of N ticks
+        node.Instance->FixedUpdate(m_dt * static_cast<float>(node.Instance->FixedUpdateInterval));
+        const float ms = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+        node.FixedAverageMs = node.FixedAverageMs * 0.95f + ms * 0.05f;
+    }
+
+#ifdef BEE_DEBUG
+    if (DetectRaces && Parallel)
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_running.erase(find(m_running.begin(), m_running.end(), index));
+    }
+#endif
+
+    if (!Parallel) return;
+
+    for (size_t dependent : node.Dependents)
+        if (--m_pending[dependent] == 0) Dispatch(dependent);
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_remaining--;
+    }
+    m_condition.notify_all();
+}
+
+#ifdef BEE_INSPECTOR
+
+void SystemScheduler::OnPanel()
+{
+    ImGui::Checkbox("Parallel", &Parallel);
+    ImGui::SameLine();
+    bool pipelined = Engine.GetFrameLatency() > 0;
+    if (ImGui::Checkbox("Pipelined Rendering", &pipelined)) Engine.SetFrameLatency(pipelined ? 1 : 0);
+#ifdef BEE_DEBUG
+    ImGui::SameLine();
+    ImGui::Checkbox("Detect Races", &DetectRaces);
+#endif
+    ImGui::Text("Update     %.3f ms", m_lastFrameMs);
+    ImGui::Text("Tick       %.3f ms", m_lastTickMs);
+
+    float tickRate = Engine.GetFixedTickRate();
+    if (ImGui::DragFloat("Tick Rate (Hz)", &tickRate, 1.0f, 10.0f, 240.0f, "%.0f")) Engine.SetFixedTickRate(tickRate);
+    int maxTicks = Engine.GetMaxFixedTicksPerFrame();
+    if (ImGui::SliderInt("Max Ticks Per Frame", &maxTicks, 1, 16)) Engine.SetMaxFixedTicksPerFrame(maxTicks);
+    ImGui::Text("Ticks      %d this frame, %llu total, %llu dropped",
+                Engine.GetFixedTicksThisFrame(),
+                static_cast<unsigned long long>(Engine.GetFixedTick()),
+                static_cast<unsigned long long>(Engine.GetDroppedFixedTicks()));
+    ImGui::Text("Alpha      %.2f", Engine.GetFixedAlpha());
+
+    const auto& jobs = Engine.JobSystem();
+    ImGui::Text("Workers    %d", jobs.NumberOfWorkers());
+    ImGui::Text("Jobs       %llu (%llu stolen)",
+                static_cast<unsigned long long>(jobs.GetJobsExecuted()),
+                static_cast<unsigned long long>(jobs.GetJobsStolen()));
+    ImGui::Separator();
+
+    if (ImGui::BeginTable("Systems", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders))
+    {
+        ImGui::TableSetupColumn("System");
+        ImGui::TableSetupColumn("Runs");
+        ImGui::TableSetupColumn("Waits On");
+        ImGui::TableSetupColumn("Every");
+        ImGui::TableSetupColumn("Tick (ms)");
+        ImGui::TableSetupColumn("Update (ms)");
+        ImGui::TableHeadersRow();
+
+        for (size_t i = 0; i < m_nodes.size(); i++)
+        {
+            const auto& node = m_nodes[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(GetSystemName(*node.Instance).c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(node.Exclusive ? "Serial" : "Parallel");
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", node.NumDependencies);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d ticks", node.Instance->FixedUpdateInterval);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", node.FixedAverageMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", node.AverageMs);
+
+            if (ImGui::IsItemHovered() && node.Instance->HasDeclaredAccess())
+            {
+                ImGui::BeginTooltip();
+                for (const auto& access : node.Instance->GetWrites())
+                    ImGui::Text("Writes %.*s", static_cast<int>(access.Name.size()), access.Name.data());
+                for (const auto& access : node.Instance->GetReads())
+                    ImGui::Text("Reads  %.*s", static_cast<int>(access.Name.size()), access.Name.data());
+                ImGui::EndTooltip();
+            }
+        }
+        ImGui::EndTable();
+    }
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifdef BEE_JOLT_PHYSICS
+
+#include "physics/jolt_job_system.hpp"
+
+#include "tools/job_system.hpp"
+#include "tools/log.hpp"
+
+using namespace bee;
+
+JoltJobSystem::JoltJobSystem(bee::JobSystem& jobSystem, JPH::uint maxJobs, JPH::uint maxBarriers)
+    : JPH::JobSystemWithBarrier(maxBarriers), m_jobSystem(jobSystem)
+{
+    m_jobs.Init(maxJobs, maxJobs);
+}
+
+int JoltJobSystem::GetMaxConcurrency() const { return m_jobSystem.GetMaxConcurrency(); }
+
+JPH::JobHandle JoltJobSystem::CreateJob(const char* name,
+                                        JPH::ColorArg color,
+                                        const JobFunction& function,
+                                        JPH::uint32 numDependencies)
+{
+    JPH::uint32 index = m_jobs.ConstructObject(name, color, this, function, numDependencies);
+    if (index == JPH::FixedSizeFreeList<Job>::cInvalidObjectIndex)
+        Log::Warn("Jolt job system ran out of jobs, consider raising the maximum");
+    while (index == JPH::FixedSizeFreeList<Job>::cInvalidObjectIndex)
+    {
+        // Help finishing other jobs before trying again
+        if (!m_jobSystem.ExecuteOne()) std::this_thread::yield();
+        index = m_jobs.ConstructObject(name, color, this, function, numDependencies);
+    }
+    Job* job = &m_jobs.Get(index);
+
+    // Take a reference before queuing, the job may complete right away
+    JobHandle handle(job);
+    if (numDependencies == 0) QueueJob(job);
+    return handle;
+}
+
+void JoltJobSystem::QueueJob(Job* job)
+{
+    // The reference is released when the Bee job is done. If a barrier already executed the Jolt job in the meantime,
+    // Execute() does nothing.
+    job->AddRef();
+    m_jobSystem.Schedule(
+        [job]
+        {
+            job->Execute();
+            job->Release();
+        });
+}
+
+void JoltJobSystem::QueueJobs(Job** jobs, JPH::uint numJobs)
+{
+    for (JPH::uint i = 0; i < numJobs; i++) QueueJob(jobs[i]);
+}
+
+void JoltJobSystem::FreeJob(Job* job) { m_jobs.DestructObject(job); }
+
+#endif  // BEE_JOLT_PHYSICS
@@ -9,6 +9,7 @@
 #include "core/input.hpp"
 #include "core/resources.hpp"
 #include "core/transform.hpp"
+#include "physics/jolt_job_system.hpp"
 #include "rendering/debug_render.hpp"
 #include "rendering/mesh.hpp"
 #include "rendering/model.hpp"
@@ -20,7 +21,6 @@
 
 // Jolt includes
 #include <Jolt/Core/Factory.h>
-#include <Jolt/Core/JobSystemThreadPool.h>
 #include <Jolt/Core/TempAllocator.h>
 #include <Jolt/Geometry/AABox.h>
 #include <Jolt/Physics/Body/BodyActivationListener.h>
@@ -213,8 +213,9 @@ void JoltSystem::OnPhysicsBodyDestroy(entt::registry& registry, entt::entity ent
     }
 }
 
-JoltSystem::JoltSystem(float fixedDeltaTime) : m_fixedDeltaTime(fixedDeltaTime)
+JoltSystem::JoltSystem(float fixedDeltaTime)
 {
+    SetFixedDeltaTime(fixedDeltaTime);
     Engine.ECS().Registry.on_destroy<JoltBody>().connect<&JoltSystem::OnPhysicsBodyDestroy>();
 
     // Register allocation hook. In this example we'll just let Jolt use malloc / free but you can override these if you want
@@ -236,9 +237,7 @@ JoltSystem::JoltSystem(float fixedDeltaTime) : m_fixedDeltaTime(fixedDeltaTime)
     RegisterTypes();
 
     m_tempAllocator = new JPH::TempAllocatorImpl(10 * 1024 * 1024);
-#if defined(BEE_PLATFORM_PC)
-    m_jobSystem = new JPH::JobSystemThreadPool(2048, 8, thread::hardware_concurrency() - 2);
-#endif
+    m_jobSystem = new JoltJobSystem(Engine.JobSystem(), 2048, 8);
     m_physicsSystem = new JPH::PhysicsSystem();
     m_physicsSystem->Init(1024, 0, 1024, 1024, bp, ovbp, ovo);
 
@@ -318,31 +317,27 @@ void JoltSystem::SetBodyVelocity(const JoltBody& body, const vec3& vel)
     GetInternalSystem()->GetBodyInterface().SetLinearVelocity((BodyID)body.m_bodyID, ToJolt<Vec3>(vel));
 }
 
-void JoltSystem::Update(float dt)
+void JoltSystem::FixedUpdate(float dt)
 {
-    m_timeSinceLastUpdate += dt;
-
     const auto& bodyInterface = m_physicsSystem->GetBodyInterface();
-    const auto& bodyView = Engine.ECS().Registry.view<JoltBody, Transform>();
-
-    // execute physics frames?
-    m_hasExecutedFrame = false;
-    while (m_timeSinceLastUpdate >= m_fixedDeltaTime)
+    for (const auto& [entity, joltBody] : Engine.ECS().Registry.view<JoltBody>().each())
     {
-        for (const auto& [entity, joltBody, transform] : bodyView.each())
-        {
-            BodyID bid(joltBody.m_bodyID);
-            joltBody.m_previousPosition = ToGlm(bodyInterface.GetCenterOfMassPosition(bid));
-            joltBody.m_previousRotation = ToGlm(bodyInterface.GetRotation(bid));
-        }
-
-        m_physicsSystem->Update(m_fixedDeltaTime, 5, m_tempAllocator, m_jobSystem);
-        m_timeSinceLastUpdate -= m_fixedDeltaTime;
-        m_hasExecutedFrame = true;
+        BodyID bid(joltBody.m_bodyID);
+        joltBody.m_previousPosition = ToGlm(bodyInterface.GetCenterOfMassPosition(bid));
+        joltBody.m_previousRotation = ToGlm(bodyInterface.GetRotation(bid));
     }
 
+    m_physicsSystem->Update(dt, 5, m_tempAllocator, m_jobSystem);
+    m_lastSteppedFrame = Engine.GetFrameIndex();
+}
+
+void JoltSystem::Update(float)
+{
+    const auto& bodyInterface = m_physicsSystem->GetBodyInterface();
+    const auto& bodyView = Engine.ECS().Registry.view<JoltBody, Transform>();
+
     // Sync Jolt shapes with Bee: make the transforms smoothly interpolate between two physics frames.
-    float alpha = m_timeSinceLastUpdate / m_fixedDeltaTime;
+    float alpha = Engine.GetFixedAlpha();
     for (const auto& [entity, joltBody, transform] : bodyView.each())
     {
         BodyID bid(joltBody.m_bodyID);
@@ -380,22 +375,8 @@ void JoltSystem::OnEntity(bee::Entity entity)
 #ifdef BEE_DEBUG
 void drawBox(const vec3& min, const vec3& max, const vec3& translation, const quat& rotation, const vec4& color)
 {
-    vector<vec3> pts{vec3(min.x, min.y, min.z),
-                     vec3(max.x, min.y, min.z),
-                     vec3(max.x, max.y, min.z),
-                     vec3(min.x, max.y, min.z),
-                     vec3(min.x, min.y, max.z),
-                     vec3(max.x, min.y, max.z),
-                     vec3(max.x, max.y, max.z),
-                     vec3(min.x, max.y, max.z)};
-    for (auto& pt : pts) pt = rotate(rotation, pt) + translation;
-
-    for (int i = 0; i < 4; ++i)
-    {
-        Engine.DebugRenderer().AddLine(DebugCategory::Physics, pts[i], pts[(i + 1) % 4], color);
-        Engine.DebugRenderer().AddLine(DebugCategory::Physics, pts[i + 4], pts[(i + 1) % 4 + 4], color);
-        Engine.DebugRenderer().AddLine(DebugCategory::Physics, pts[i], pts[i + 4], color);
-    }
+    const vec3 center = translation + rotate(rotation, (min + max) * 0.5f);
+    Engine.DebugRenderer().AddBox(DebugCategory::Physics, center, (max - min) * 0.5f, rotation, color);
 }
 
 void JoltSystem::DebugDrawShape(const Shape* shape, const JoltBody& body, const Transform& transform, const vec3& worldOffset)
@@ -451,9 +432,7 @@ void JoltSystem::DebugDrawShape(const Shape* shape, const JoltBody& body, const
         const auto* sphere = reinterpret_cast<const JPH::SphereShape*>(shape);
         float radius = sphere->GetRadius();
 
-        Engine.DebugRenderer().AddCircle(DebugCategory::Physics, posCOM, radius, rotate(rot, vec3(1, 0, 0)), shapeColor);
-        Engine.DebugRenderer().AddCircle(DebugCategory::Physics, posCOM, radius, rotate(rot, vec3(0, 1, 0)), shapeColor);
-        Engine.DebugRenderer().AddCircle(DebugCategory::Physics, posCOM, radius, rotate(rot, vec3(0, 0, 1)), shapeColor);
+        Engine.DebugRenderer().AddSphere(DebugCategory::Physics, posCOM, radius, shapeColor);
     }
 
     else if (shape->GetSubType() == EShapeSubType::ConvexHull)
@@ -610,68 +610,84 @@ void World::UpdateCollisionDetection()
     }
 }
 
-void World::Update(float dt)
+World::World(const float fixedDeltaTime)
+    : m_changedBodies(Engine.ECS().Registry), m_changedPolygons(Engine.ECS().Registry)
 {
-    const auto& view = Engine.ECS().Registry.view<Body>();
+    SetFixedDeltaTime(fixedDeltaTime);
+}
+
+void World::UpdateStaticPolygons()
+{
+    auto& registry = Engine.ECS().Registry;
+    const auto update = [&registry](Entity entity)
+    {
+        auto* body = registry.try_get<Body>(entity);
+        auto* polygon = registry.try_get<PolygonCollider>(entity);
+        if (body && polygon && body->GetType() == Body::Type::Static)
+            polygon->ComputeWorldPoints(body->m_position, body->m_angle);
+    };
 
-    // determine how many frames to simulate
-    m_hasExecutedFrame = false;
-    m_timeSinceLastFrame += dt;
+    for (const auto entity : m_changedBodies) update(entity);
+    for (const auto entity : m_changedPolygons) update(entity);
+    m_changedBodies.Clear();
+    m_changedPolygons.Clear();
+}
 
-    if (m_timeSinceLastFrame >= m_fixedDeltaTime)
+void World::FixedUpdate(float dt)
+{
+    const auto& view = Engine.ECS().Registry.view<Body>();
+
+    // clear collision data from previous frame, collisions of all steps in this frame are kept
+    if (!HasExecutedFrame())
     {
-        // clear collision data from previous frame
         for (const auto& [entity, body] : view.each())
         {
             body.ClearCollisionData();
         }
+        m_lastSteppedFrame = Engine.GetFrameIndex();
     }
 
-    while (m_timeSinceLastFrame >= m_fixedDeltaTime)
+    // update world coordinates of polygons
+    UpdateStaticPolygons();
+    auto polygons = Engine.ECS().Registry.view<Body, PolygonCollider>();
+    for (const auto& [entity, body, polygon] : polygons.each())
     {
-        // update world coordinates of polygons
-        auto polygons = Engine.ECS().Registry.view<Body, PolygonCollider>();
-        for (const auto& [entity, body, polygon] : polygons.each())
-        {
-            polygon.ComputeWorldPoints(body.m_position, body.m_angle);
-        }
-
-        // apply gravity
-        if (m_gravity != vec2(0, 0))
-        {
-            for (const auto& [entity, body] : view.each())
-            {
-                if (body.GetType() == Body::Type::Dynamic) body.AddForce(m_gravity / body.m_invMass);
-            }
-        }
+        if (body.GetType() != Body::Type::Static) polygon.ComputeWorldPoints(body.m_position, body.m_angle);
+    }
 
-        // update velocity and position
+    // apply gravity
+    if (m_gravity != vec2(0, 0))
+    {
         for (const auto& [entity, body] : view.each())
         {
-            if (body.GetType() != Body::Type::Static) body.Update(m_fixedDeltaTime);
-        }
-
-        // update world coordinates of polygons again
-        for (const auto& [entity, body, polygon] : polygons.each())
-        {
-            polygon.ComputeWorldPoints(body.m_position, body.m_angle);
+            if (body.GetType() == Body::Type::Dynamic) body.AddForce(m_gravity / body.m_invMass);
         }
+    }
 
-        // collision detection and resolution
-        UpdateCollisionDetection();
+    // update velocity and position
+    for (const auto& [entity, body] : view.each())
+    {
+        if (body.GetType() != Body::Type::Static) body.Update(dt);
+    }
 
-        // reset data for next frame
-        for (const auto& [entity, body] : view.each())
-        {
-            body.ClearForceAndTorque();
-        }
+    // update world coordinates of polygons again
+    for (const auto& [entity, body, polygon] : polygons.each())
+    {
+        if (body.GetType() != Body::Type::Static) polygon.ComputeWorldPoints(body.m_position, body.m_angle);
+    }
 
-        // update internal timer
-        m_timeSinceLastFrame -= m_fixedDeltaTime;
+    // collision detection and resolution
+    UpdateCollisionDetection();
 
-        m_hasExecutedFrame = true;
+    // reset data for next frame
+    for (const auto& [entity, body] : view.each())
+    {
+        body.ClearForceAndTorque();
     }
+}
 
+void World::Update(float)
+{
     // debug rendering of physics objects
 
     if ((Engine.DebugRenderer().GetCategoryFlags() & bee::DebugCategory::Physics) != 0)
@@ -742,7 +758,7 @@ void World::Update(float dt)
 
     // synchronize transforms with physics bodies.
     // Make the visualization smoothly interpolate between two physics frames.
-    float alpha = m_timeSinceLastFrame / m_fixedDeltaTime;
+    float alpha = Engine.GetFixedAlpha();
 
     for (const auto& [entity, body, transform] : Engine.ECS().Registry.view<Body, Transform>().each())
     {
@@ -804,9 +820,9 @@ std::optional<RaycastResult> World::RaycastGetNearest(const vec2& origin, const
     return result;
 }
 
-std::vector<RaycastResult> World::RaycastGetAll(const glm::vec2& origin, const glm::vec2& direction)
+template <typename Results>
+void World::RaycastAll(const glm::vec2& origin, const glm::vec2& direction, Results& results)
 {
-    std::vector<RaycastResult> results;
     RaycastResult subresult;
 
     for (const auto& [entity, body, disk] : Engine.ECS().Registry.view<Body, DiskCollider>().each())
@@ -838,12 +854,11 @@ std::vector<RaycastResult> World::RaycastGetAll(const glm::vec2& origin, const g
 
     // sort the results by distance
     std::sort(results.begin(), results.end());
-    return results;
 }
 
-std::vector<bee::Entity> World::GetAllObjectsInRange(const glm::vec2& pos, float radius)
+template <typename Results>
+void World::CollectObjectsInRange(const glm::vec2& pos, float radius, Results& results)
 {
-    std::vector<bee::Entity> results;
     CollisionData subresult;
 
     for (const auto& [entity, body, disk] : Engine.ECS().Registry.view<Body, DiskCollider>().each())
@@ -872,10 +887,41 @@ std::vector<bee::Entity> World::GetAllObjectsInRange(const glm::vec2& pos, float
             results.push_back(entity);
         }
     }
+}
+
+std::vector<RaycastResult> World::RaycastGetAll(const glm::vec2& origin, const glm::vec2& direction)
+{
+    std::vector<RaycastResult> results;
+    RaycastAll(origin, direction, results);
+    return results;
+}
+
+std::pmr::vector<RaycastResult> World::RaycastGetAll(const glm::vec2& origin,
+                                                     const glm::vec2& direction,
+                                                     std::pmr::memory_resource* memory)
+{
+    std::pmr::vector<RaycastResult> results(memory);
+    RaycastAll(origin, direction, results);
+    return results;
+}
+
+std::vector<bee::Entity> World::GetAllObjectsInRange(const glm::vec2& pos, float radius)
+{
+    std::vector<bee::Entity> results;
+    CollectObjectsInRange(pos, radius, results);
+    return results;
+}
 
+std::pmr::vector<bee::Entity> World::GetAllObjectsInRange(const glm::vec2& pos,
+                                                          float radius,
+                                                          std::pmr::memory_resource* memory)
+{
+    std::pmr::vector<bee::Entity> results(memory);
+    CollectObjectsInRange(pos, radius, results);
     return results;
 }
 
+
 #ifdef BEE_INSPECTOR
 
 void World::OnEntity(bee::Entity entity)
@@ -885,7 +931,8 @@ void World::OnEntity(bee::Entity entity)
     {
         if (ImGui::CollapsingHeader("Physics Body", ImGuiTreeNodeFlags_DefaultOpen))
         {
-            Engine.Inspector().Inspect("Body Position", body->m_position);
+            // Static bodies only recompute their collider when the Body is marked as changed
+            if (Engine.Inspector().Inspect("Body Position", body->m_position)) Engine.ECS().MarkChanged<Body>(entity);
             Engine.Inspector().Inspect("Inv Mass", body->m_invMass);
             Engine.Inspector().Inspect("Inv Moment of Inertia", body->m_invMomentOfInertia);
             Engine.Inspector().Inspect("Restitution", body->m_restitution);
@@ -0,0 +1,45 @@
+#if defined(BEE_GRAPHICS_NULL)
+
+#include "core/device.hpp"
+#include "tools/log.hpp"
+
+using namespace bee;
+
+Device::Device()
+{
+    LoadNullGL();
+    Log::Info("Null graphics device {}x{}, nothing is drawn", m_width, m_height);
+    m_start = std::chrono::high_resolution_clock::now();
+}
+
+Device::~Device()
+{
+    if (m_frames == 0) return;
+
+    const auto elapsed = std::chrono::high_resolution_clock::now() - m_start;
+    const double milliseconds = std::chrono::duration<double, std::milli>(elapsed).count();
+    const auto perFrame = [this](uint64_t total) { return static_cast<double>(total) / static_cast<double>(m_frames); };
+    Log::Info("Null graphics device ran {} frames, {:.3f} ms per frame", m_frames, milliseconds / m_frames);
+    Log::Info("Per frame: {:.1f} draw calls, {:.1f} draws, {:.1f} state changes, {:.1f} uniform updates, {:.0f} bytes uploaded",
+              perFrame(m_totalStats.DrawCalls),
+              perFrame(m_totalStats.Draws),
+              perFrame(m_totalStats.StateChanges),
+              perFrame(m_totalStats.UniformUpdates),
+              perFrame(m_totalStats.BytesUploaded));
+}
+
+void Device::SetWindowSize(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+}
+
+void Device::Update()
+{
+    m_frameStats = EndNullGLFrame();
+    m_totalStats += m_frameStats;
+    m_frames++;
+    if (m_frameLimit != 0 && m_frames >= m_frameLimit) m_shouldClose = true;
+}
+
+#endif  // BEE_GRAPHICS_NULL
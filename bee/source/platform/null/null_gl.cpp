@@ -0,0 +1,355 @@
+#include "platform/null/null_gl.hpp"
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "platform/opengl/open_gl.hpp"
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+NullGLStats g_stats;
+GLuint g_nextName = 1;
+uintptr_t g_nextSync = 1;
+unordered_map<GLenum, GLuint> g_boundBuffers;        // by target
+unordered_map<GLuint, vector<std::byte>> g_storage;  // of buffers that can be mapped, by name
+
+void GenNames(GLsizei n, GLuint* names)
+{
+    for (GLsizei i = 0; i < n; i++) names[i] = g_nextName++;
+}
+
+size_t GetPixelSize(GLenum format, GLenum type)
+{
+    size_t components = 4;
+    switch (format)
+    {
+        case GL_RED:
+        case GL_DEPTH_COMPONENT:
+            components = 1;
+            break;
+        case GL_RG:
+            components = 2;
+            break;
+        case GL_RGB:
+            components = 3;
+            break;
+        default:
+            break;
+    }
+
+    switch (type)
+    {
+        case GL_UNSIGNED_BYTE:
+            return components;
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return components * 2;
+        default:
+            return components * 4;
+    }
+}
+
+// Objects
+void APIENTRY GenBuffers(GLsizei n, GLuint* buffers) { GenNames(n, buffers); }
+void APIENTRY GenFramebuffers(GLsizei n, GLuint* framebuffers) { GenNames(n, framebuffers); }
+void APIENTRY GenRenderbuffers(GLsizei n, GLuint* renderbuffers) { GenNames(n, renderbuffers); }
+void APIENTRY GenTextures(GLsizei n, GLuint* textures) { GenNames(n, textures); }
+void APIENTRY GenVertexArrays(GLsizei n, GLuint* arrays) { GenNames(n, arrays); }
+void APIENTRY GenQueries(GLsizei n, GLuint* ids) { GenNames(n, ids); }
+GLuint APIENTRY CreateProgram() { return g_nextName++; }
+GLuint APIENTRY CreateShader(GLenum) { return g_nextName++; }
+void APIENTRY DeleteNames(GLsizei, const GLuint*) {}
+void APIENTRY DeleteName(GLuint) {}
+void APIENTRY DeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    for (GLsizei i = 0; i < n; i++) g_storage.erase(buffers[i]);
+}
+void APIENTRY ObjectLabel(GLenum, GLuint, GLsizei, const GLchar*) {}
+
+// Buffers
+void APIENTRY BindBuffer(GLenum target, GLuint buffer)
+{
+    g_boundBuffers[target] = buffer;
+    g_stats.StateChanges++;
+}
+void APIENTRY BindBufferBase(GLenum target, GLuint, GLuint buffer)
+{
+    g_boundBuffers[target] = buffer;
+    g_stats.StateChanges++;
+}
+void APIENTRY BufferData(GLenum, GLsizeiptr size, const void* data, GLenum)
+{
+    if (data) g_stats.BytesUploaded += static_cast<uint64_t>(size);
+}
+void APIENTRY BufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield)
+{
+    g_storage[g_boundBuffers[target]].resize(static_cast<size_t>(size));
+    if (data) g_stats.BytesUploaded += static_cast<uint64_t>(size);
+}
+void APIENTRY BufferSubData(GLenum, GLintptr, GLsizeiptr size, const void*)
+{
+    g_stats.BytesUploaded += static_cast<uint64_t>(size);
+}
+void APIENTRY CopyBufferSubData(GLenum, GLenum, GLintptr, GLintptr, GLsizeiptr) {}
+void* APIENTRY MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr, GLbitfield)
+{
+    auto it = g_storage.find(g_boundBuffers[target]);
+    return it == g_storage.end() ? nullptr : it->second.data() + offset;
+}
+
+// Textures and framebuffers
+void APIENTRY BindTexture(GLenum, GLuint) { g_stats.StateChanges++; }
+void APIENTRY ActiveTexture(GLenum) { g_stats.StateChanges++; }
+void APIENTRY TexImage2D(GLenum,
+                         GLint,
+                         GLint,
+                         GLsizei width,
+                         GLsizei height,
+                         GLint,
+                         GLenum format,
+                         GLenum type,
+                         const void* pixels)
+{
+    if (pixels) g_stats.BytesUploaded += static_cast<uint64_t>(width) * height * GetPixelSize(format, type);
+}
+void APIENTRY TexImage3D(GLenum,
+                         GLint,
+                         GLint,
+                         GLsizei width,
+                         GLsizei height,
+                         GLsizei depth,
+                         GLint,
+                         GLenum format,
+                         GLenum type,
+                         const void* pixels)
+{
+    if (pixels) g_stats.BytesUploaded += static_cast<uint64_t>(width) * height * depth * GetPixelSize(format, type);
+}
+void APIENTRY TexImage2DMultisample(GLenum, GLsizei, GLenum, GLsizei, GLsizei, GLboolean) {}
+void APIENTRY TexParameteri(GLenum, GLenum, GLint) {}
+void APIENTRY TexParameterfv(GLenum, GLenum, const GLfloat*) {}
+void APIENTRY GenerateMipmap(GLenum) {}
+void APIENTRY BindFramebuffer(GLenum, GLuint) { g_stats.StateChanges++; }
+void APIENTRY BindRenderbuffer(GLenum, GLuint) {}
+GLenum APIENTRY CheckFramebufferStatus(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+void APIENTRY FramebufferRenderbuffer(GLenum, GLenum, GLenum, GLuint) {}
+void APIENTRY FramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) {}
+void APIENTRY FramebufferTextureLayer(GLenum, GLenum, GLuint, GLint, GLint) { g_stats.StateChanges++; }
+void APIENTRY RenderbufferStorage(GLenum, GLenum, GLsizei, GLsizei) {}
+void APIENTRY RenderbufferStorageMultisample(GLenum, GLsizei, GLenum, GLsizei, GLsizei) {}
+void APIENTRY DrawBuffer(GLenum) {}
+void APIENTRY DrawBuffers(GLsizei, const GLenum*) {}
+void APIENTRY ReadBuffer(GLenum) {}
+void APIENTRY BlitFramebuffer(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum) {}
+
+// Shaders
+void APIENTRY ShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) {}
+void APIENTRY CompileShader(GLuint) {}
+void APIENTRY AttachShader(GLuint, GLuint) {}
+void APIENTRY LinkProgram(GLuint) {}
+void APIENTRY ValidateProgram(GLuint) {}
+void APIENTRY GetShaderiv(GLuint, GLenum pname, GLint* params) { *params = pname == GL_COMPILE_STATUS ? 1 : 0; }
+void APIENTRY GetProgramiv(GLuint, GLenum pname, GLint* params)
+{
+    // Programs have no active uniforms or attributes, so all shader parameters are invalid and setting them is skipped
+    *params = pname == GL_LINK_STATUS || pname == GL_VALIDATE_STATUS ? 1 : 0;
+}
+void APIENTRY GetInfoLog(GLuint, GLsizei, GLsizei* length, GLchar* infoLog)
+{
+    if (length) *length = 0;
+    if (infoLog) infoLog[0] = '\0';
+}
+void APIENTRY GetActiveVariable(GLuint, GLuint, GLsizei, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    GetInfoLog(0, 0, length, name);
+    *size = 0;
+    *type = 0;
+}
+GLint APIENTRY GetLocation(GLuint, const GLchar*) { return -1; }
+void APIENTRY UseProgram(GLuint) { g_stats.StateChanges++; }
+void APIENTRY Uniform1f(GLint, GLfloat) { g_stats.UniformUpdates++; }
+void APIENTRY Uniform1i(GLint, GLint) { g_stats.UniformUpdates++; }
+void APIENTRY Uniform1ui(GLint, GLuint) { g_stats.UniformUpdates++; }
+void APIENTRY UniformNfv(GLint, GLsizei, const GLfloat*) { g_stats.UniformUpdates++; }
+void APIENTRY UniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) { g_stats.UniformUpdates++; }
+
+// State
+void APIENTRY Enable(GLenum) { g_stats.StateChanges++; }
+void APIENTRY Disable(GLenum) { g_stats.StateChanges++; }
+void APIENTRY BlendFunc(GLenum, GLenum) { g_stats.StateChanges++; }
+void APIENTRY DepthMask(GLboolean) { g_stats.StateChanges++; }
+void APIENTRY PolygonOffset(GLfloat, GLfloat) { g_stats.StateChanges++; }
+void APIENTRY Viewport(GLint, GLint, GLsizei, GLsizei) { g_stats.StateChanges++; }
+void APIENTRY Scissor(GLint, GLint, GLsizei, GLsizei) { g_stats.StateChanges++; }
+void APIENTRY ClearColor(GLfloat, GLfloat, GLfloat, GLfloat) {}
+void APIENTRY Clear(GLbitfield) {}
+void APIENTRY BindVertexArray(GLuint) { g_stats.StateChanges++; }
+void APIENTRY VertexAttribArray(GLuint) {}
+void APIENTRY VertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) {}
+void APIENTRY VertexAttribDivisor(GLuint, GLuint) {}
+const GLubyte* APIENTRY GetString(GLenum) { return reinterpret_cast<const GLubyte*>("Null"); }
+void APIENTRY DebugMessageCallback(GLDEBUGPROC, const void*) {}
+void APIENTRY DebugMessageControl(GLenum, GLenum, GLenum, GLsizei, const GLuint*, GLboolean) {}
+
+// Queries, which finish right away and measure no time
+void APIENTRY BeginQuery(GLenum, GLuint) {}
+void APIENTRY EndQuery(GLenum) {}
+void APIENTRY GetQueryObjectiv(GLuint, GLenum, GLint* params) { *params = 1; }
+void APIENTRY GetQueryObjectui64v(GLuint, GLenum, GLuint64* params) { *params = 0; }
+
+// Synchronization
+GLsync APIENTRY FenceSync(GLenum, GLbitfield) { return reinterpret_cast<GLsync>(g_nextSync++); }
+GLenum APIENTRY ClientWaitSync(GLsync, GLbitfield, GLuint64) { return GL_ALREADY_SIGNALED; }
+void APIENTRY DeleteSync(GLsync) {}
+
+// Drawing
+void APIENTRY DrawArrays(GLenum, GLint, GLsizei)
+{
+    g_stats.DrawCalls++;
+    g_stats.Draws++;
+}
+void APIENTRY DrawElements(GLenum, GLsizei, GLenum, const void*)
+{
+    g_stats.DrawCalls++;
+    g_stats.Draws++;
+}
+void APIENTRY DrawArraysInstancedBaseInstance(GLenum, GLint, GLsizei, GLsizei instancecount, GLuint)
+{
+    g_stats.DrawCalls++;
+    g_stats.Draws += static_cast<uint64_t>(instancecount);
+}
+void APIENTRY MultiDrawElementsIndirect(GLenum, GLenum, const void*, GLsizei drawcount, GLsizei)
+{
+    g_stats.DrawCalls++;
+    g_stats.Draws += static_cast<uint64_t>(drawcount);
+}
+
+}  // namespace
+
+NullGLStats& NullGLStats::operator+=(const NullGLStats& other)
+{
+    DrawCalls += other.DrawCalls;
+    Draws += other.Draws;
+    StateChanges += other.StateChanges;
+    UniformUpdates += other.UniformUpdates;
+    BytesUploaded += other.BytesUploaded;
+    return *this;
+}
+
+void bee::LoadNullGL()
+{
+    glad_glGenBuffers = GenBuffers;
+    glad_glCreateBuffers = GenBuffers;
+    glad_glGenFramebuffers = GenFramebuffers;
+    glad_glGenRenderbuffers = GenRenderbuffers;
+    glad_glGenTextures = GenTextures;
+    glad_glGenVertexArrays = GenVertexArrays;
+    glad_glCreateVertexArrays = GenVertexArrays;
+    glad_glGenQueries = GenQueries;
+    glad_glCreateProgram = CreateProgram;
+    glad_glCreateShader = CreateShader;
+    glad_glDeleteBuffers = DeleteBuffers;
+    glad_glDeleteFramebuffers = DeleteNames;
+    glad_glDeleteRenderbuffers = DeleteNames;
+    glad_glDeleteTextures = DeleteNames;
+    glad_glDeleteVertexArrays = DeleteNames;
+    glad_glDeleteQueries = DeleteNames;
+    glad_glDeleteProgram = DeleteName;
+    glad_glDeleteShader = DeleteName;
+    glad_glObjectLabel = ObjectLabel;
+
+    glad_glBindBuffer = BindBuffer;
+    glad_glBindBufferBase = BindBufferBase;
+    glad_glBufferData = BufferData;
+    glad_glBufferStorage = BufferStorage;
+    glad_glBufferSubData = BufferSubData;
+    glad_glCopyBufferSubData = CopyBufferSubData;
+    glad_glMapBufferRange = MapBufferRange;
+
+    glad_glBindTexture = BindTexture;
+    glad_glActiveTexture = ActiveTexture;
+    glad_glTexImage2D = TexImage2D;
+    glad_glTexImage3D = TexImage3D;
+    glad_glTexImage2DMultisample = TexImage2DMultisample;
+    glad_glTexParameteri = TexParameteri;
+    glad_glTexParameterfv = TexParameterfv;
+    glad_glGenerateMipmap = GenerateMipmap;
+    glad_glBindFramebuffer = BindFramebuffer;
+    glad_glBindRenderbuffer = BindRenderbuffer;
+    glad_glCheckFramebufferStatus = CheckFramebufferStatus;
+    glad_glFramebufferRenderbuffer = FramebufferRenderbuffer;
+    glad_glFramebufferTexture2D = FramebufferTexture2D;
+    glad_glFramebufferTextureLayer = FramebufferTextureLayer;
+    glad_glRenderbufferStorage = RenderbufferStorage;
+    glad_glRenderbufferStorageMultisample = RenderbufferStorageMultisample;
+    glad_glDrawBuffer = DrawBuffer;
+    glad_glDrawBuffers = DrawBuffers;
+    glad_glReadBuffer = ReadBuffer;
+    glad_glBlitFramebuffer = BlitFramebuffer;
+
+    glad_glShaderSource = ShaderSource;
+    glad_glCompileShader = CompileShader;
+    glad_glAttachShader = AttachShader;
+    glad_glLinkProgram = LinkProgram;
+    glad_glValidateProgram = ValidateProgram;
+    glad_glGetShaderiv = GetShaderiv;
+    glad_glGetProgramiv = GetProgramiv;
+    glad_glGetShaderInfoLog = GetInfoLog;
+    glad_glGetProgramInfoLog = GetInfoLog;
+    glad_glGetActiveUniform = GetActiveVariable;
+    glad_glGetActiveAttrib = GetActiveVariable;
+    glad_glGetUniformLocation = GetLocation;
+    glad_glGetAttribLocation = GetLocation;
+    glad_glUseProgram = UseProgram;
+    glad_glUniform1f = Uniform1f;
+    glad_glUniform1i = Uniform1i;
+    glad_glUniform1ui = Uniform1ui;
+    glad_glUniform2fv = UniformNfv;
+    glad_glUniform3fv = UniformNfv;
+    glad_glUniform4fv = UniformNfv;
+    glad_glUniformMatrix4fv = UniformMatrix4fv;
+
+    glad_glEnable = Enable;
+    glad_glDisable = Disable;
+    glad_glBlendFunc = BlendFunc;
+    glad_glDepthMask = DepthMask;
+    glad_glPolygonOffset = PolygonOffset;
+    glad_glViewport = Viewport;
+    glad_glScissor = Scissor;
+    glad_glClearColor = ClearColor;
+    glad_glClear = Clear;
+    glad_glBindVertexArray = BindVertexArray;
+    glad_glEnableVertexAttribArray = VertexAttribArray;
+    glad_glDisableVertexAttribArray = VertexAttribArray;
+    glad_glVertexAttribPointer = VertexAttribPointer;
+    glad_glVertexAttribDivisor = VertexAttribDivisor;
+    glad_glGetString = GetString;
+    glad_glDebugMessageCallback = DebugMessageCallback;
+    glad_glDebugMessageControl = DebugMessageControl;
+
+    glad_glBeginQuery = BeginQuery;
+    glad_glEndQuery = EndQuery;
+    glad_glGetQueryObjectiv = GetQueryObjectiv;
+    glad_glGetQueryObjectui64v = GetQueryObjectui64v;
+
+    glad_glFenceSync = FenceSync;
+    glad_glClientWaitSync = ClientWaitSync;
+    glad_glDeleteSync = DeleteSync;
+
+    glad_glDrawArrays = DrawArrays;
+    glad_glDrawElements = DrawElements;
+    glad_glDrawArraysInstancedBaseInstance = DrawArraysInstancedBaseInstance;
+    glad_glMultiDrawElementsIndirect = MultiDrawElementsIndirect;
+}
+
+NullGLStats bee::EndNullGLFrame()
+{
+    const NullGLStats stats = g_stats;
+    g_stats = {};
+    return stats;
+}
@@ -5,6 +5,7 @@
 #include "core/transform.hpp"
 #include "rendering/render_components.hpp"
 #include "core/engine.hpp"
+#include "core/device.hpp"
 #include "core/ecs.hpp"
 #include "platform/opengl/shader_gl.hpp"
 #include "platform/opengl/open_gl.hpp"
@@ -12,6 +13,72 @@
 using namespace bee;
 using namespace glm;
 
+namespace
+{
+
+// Lines of unit shapes, with a transform and color per instance in locations 3 to 7
+const auto* const c_instancedVertexSource =
+    "#version 460 core\n"
+    "layout (location = 1) in vec3 a_position;\n"
+    "layout (location = 2) in vec4 a_color;\n"
+    "layout (location = 3) in mat4 a_transform;\n"
+    "layout (location = 1) uniform mat4 u_worldviewproj;\n"
+    "out vec4 v_color;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    v_color = a_color;\n"
+    "    gl_Position = u_worldviewproj * a_transform * vec4(a_position, 1.0);\n"
+    "}";
+
+GLuint CreateProgram(const char* vsSource, const char* fsSource, const char* label)
+{
+    GLuint vertShader = 0;
+    GLuint fragShader = 0;
+
+    const GLuint program = glCreateProgram();
+    LabelGL(GL_PROGRAM, program, label);
+
+    if (!Shader::CompileShader(&vertShader, GL_VERTEX_SHADER, vsSource))
+    {
+        Log::Error("DebugRenderer failed to compile vertex shader");
+        return program;
+    }
+
+    if (!Shader::CompileShader(&fragShader, GL_FRAGMENT_SHADER, fsSource))
+    {
+        Log::Error("DebugRenderer failed to compile fragment shader");
+        return program;
+    }
+
+    glAttachShader(program, vertShader);
+    glAttachShader(program, fragShader);
+
+    if (!Shader::LinkProgram(program))
+    {
+        glDeleteShader(vertShader);
+        glDeleteShader(fragShader);
+        glDeleteProgram(program);
+        Log::Error("DebugRenderer failed to link shader program");
+        return 0;
+    }
+
+    glDeleteShader(vertShader);
+    glDeleteShader(fragShader);
+    return program;
+}
+
+// Uploads everything in data, growing the buffer when it is too small and orphaning it otherwise
+template <typename T>
+void UploadBuffer(GLuint buffer, const std::vector<T>& data)
+{
+    if (data.empty()) return;
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(T) * data.size()), data.data(), GL_STREAM_DRAW);
+}
+
+}  // namespace
+
 class bee::DebugRenderer::Impl
 {
 public:
@@ -22,20 +89,23 @@ public:
     Impl& operator=(const Impl&) = delete;
     Impl& operator=(const Impl&&) = delete;
 
-    bool AddLine(const vec3& from, const vec3& to, const vec4& color);
+    /// <summary>
+    /// Merges the buffers of all threads and uploads them, growing the vertex buffers when they are too small.
+    /// </summary>
+    void Upload(const std::vector<std::unique_ptr<Buffer>>& buffers);
     void Render(const mat4& view, const mat4& projection);
 
-    static int const m_maxLines = 32760;
-    int m_linesCount = 0;
-    struct VertexPosition3DColor
-    {
-        glm::vec3 Position;
-        glm::vec4 Color;
-    };
-    VertexPosition3DColor* m_vertexArray = nullptr;
+    std::vector<LineVertex> m_lines;
+    std::vector<Instance> m_instances;                  // of every primitive after another
+    size_t m_firstInstance[c_primitiveCount + 1] = {};  // of every primitive in m_instances
+    GLint m_firstShapeVertex[c_primitiveCount + 1] = {};  // of every unit shape in m_shapesVBO
     unsigned int debug_program = 0;
+    unsigned int m_instancedProgram = 0;
     unsigned int m_linesVAO = 0;
     unsigned int m_linesVBO = 0;
+    unsigned int m_shapesVAO = 0;
+    unsigned int m_shapesVBO = 0;
+    unsigned int m_instancesVBO = 0;
 };
 
 bee::DebugRenderer::DebugRenderer()
@@ -64,23 +134,42 @@ void DebugRenderer::Render()
         }
     }
 
+    std::lock_guard lock(m_buffersMutex);
+    m_impl->Upload(m_buffers);
+    for (auto& buffer : m_buffers)
+    {
+        buffer->Lines.clear();
+        for (auto& instances : buffer->Instances) instances.clear();
+    }
+
+    const size_t lines = m_impl->m_lines.size() / 2;
+    const size_t primitives = m_impl->m_instances.size();
+    if (!m_overBudget && (lines > c_lineBudget || primitives > c_primitiveBudget))
+    {
+        Log::Warn("DebugRenderer drew {} lines and {} shapes in a frame, over its budget of {} and {}",
+                  lines,
+                  primitives,
+                  c_lineBudget,
+                  c_primitiveBudget);
+        m_overBudget = true;
+    }
+
+    const float width = static_cast<float>(Engine.Device().GetWidth());
+    const float height = static_cast<float>(Engine.Device().GetHeight());
     for (const auto& [entity, transform, camera] : Engine.ECS().Registry.view<Transform, Camera>().each())
     {
         // Get the view and projection matrices from the camera
+        glViewport(static_cast<GLint>(camera.Viewport.x * width),
+                   static_cast<GLint>(camera.Viewport.y * height),
+                   static_cast<GLsizei>(camera.Viewport.z * width),
+                   static_cast<GLsizei>(camera.Viewport.w * height));
         m_impl->Render(inverse(transform.World()), camera.Projection);
     }
-}
-
-void DebugRenderer::AddLine(DebugCategory::Enum category, const vec3& from, const vec3& to, const vec4& color)
-{
-    if (!(m_categoryFlags & category)) return;
-    m_impl->AddLine(from, to, color);
+    glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
 }
 
 bee::DebugRenderer::Impl::Impl()
 {
-    m_vertexArray = new VertexPosition3DColor[m_maxLines * 2];
-
     const auto* const vsSource =
         "#version 460 core												\n\
 		layout (location = 1) in vec3 a_position;						\n\
@@ -104,110 +193,136 @@ bee::DebugRenderer::Impl::Impl()
 			frag_color = v_color;										\n\
 		}";
 
-    GLuint vertShader = 0;
-    GLuint fragShader = 0;
-    GLboolean res = GL_FALSE;
-
-    debug_program = glCreateProgram();
-    LabelGL(GL_PROGRAM, debug_program, "Debug Renderer Program");
-
-    res = Shader::CompileShader(&vertShader, GL_VERTEX_SHADER, vsSource);
-    if (!res)
-    {
-        Log::Error("DebugRenderer failed to compile vertex shader");
-        return;
-    }
-
-    res = Shader::CompileShader(&fragShader, GL_FRAGMENT_SHADER, fsSource);
-    if (!res)
-    {
-        Log::Error("DebugRenderer failed to compile fragment shader");
-        return;
-    }
-
-    glAttachShader(debug_program, vertShader);
-    glAttachShader(debug_program, fragShader);
-
-    if (!Shader::LinkProgram(debug_program))
-    {
-        glDeleteShader(vertShader);
-        glDeleteShader(fragShader);
-        glDeleteProgram(debug_program);
-        Log::Error("DebugRenderer failed to link shader program");
-        return;
-    }
-
-    glDeleteShader(vertShader);
-    glDeleteShader(fragShader);
+    debug_program = CreateProgram(vsSource, fsSource, "Debug Renderer Program");
+    m_instancedProgram = CreateProgram(c_instancedVertexSource, fsSource, "Debug Renderer Instanced Program");
 
     glCreateVertexArrays(1, &m_linesVAO);
     glBindVertexArray(m_linesVAO);
     LabelGL(GL_VERTEX_ARRAY, m_linesVAO, "Debug Lines VAO");
 
-    // Allocate VBO
+    // Allocated when lines are first uploaded, and grown when there are more
     glGenBuffers(1, &m_linesVBO);
     glBindBuffer(GL_ARRAY_BUFFER, m_linesVBO);
     LabelGL(GL_BUFFER, m_linesVBO, "Debug Lines VBO");
 
-    // Allocate into VBO
-    const auto size = sizeof(m_vertexArray);
-    glBufferData(GL_ARRAY_BUFFER, size, &m_vertexArray[0], GL_STREAM_DRAW);
-
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1,
                           3,
                           GL_FLOAT,
                           GL_FALSE,
-                          sizeof(VertexPosition3DColor),
-                          reinterpret_cast<void*>(offsetof(VertexPosition3DColor, Position)));
+                          sizeof(LineVertex),
+                          reinterpret_cast<void*>(offsetof(LineVertex, Position)));
 
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2,
                           4,
                           GL_FLOAT,
                           GL_FALSE,
-                          sizeof(VertexPosition3DColor),
-                          reinterpret_cast<void*>(offsetof(VertexPosition3DColor, Color)));
+                          sizeof(LineVertex),
+                          reinterpret_cast<void*>(offsetof(LineVertex, Color)));
+
+    // The unit shapes after another, which never change
+    std::vector<vec3> shapes;
+    for (size_t p = 0; p < c_primitiveCount; p++)
+    {
+        m_firstShapeVertex[p] = static_cast<GLint>(shapes.size());
+        const auto shape = GetUnitShape(static_cast<Primitive>(p));
+        shapes.insert(shapes.end(), shape.begin(), shape.end());
+    }
+    m_firstShapeVertex[c_primitiveCount] = static_cast<GLint>(shapes.size());
+
+    glCreateVertexArrays(1, &m_shapesVAO);
+    glBindVertexArray(m_shapesVAO);
+    LabelGL(GL_VERTEX_ARRAY, m_shapesVAO, "Debug Shapes VAO");
+
+    glGenBuffers(1, &m_shapesVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_shapesVBO);
+    LabelGL(GL_BUFFER, m_shapesVBO, "Debug Shapes VBO");
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(vec3) * shapes.size()), shapes.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), nullptr);
+
+    // Color and transform advance per instance, the transform takes a location per column
+    glGenBuffers(1, &m_instancesVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instancesVBO);
+    LabelGL(GL_BUFFER, m_instancesVBO, "Debug Instances VBO");
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), reinterpret_cast<void*>(offsetof(Instance, Color)));
+    glVertexAttribDivisor(2, 1);
+    for (GLuint column = 0; column < 4; column++)
+    {
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribPointer(3 + column,
+                              4,
+                              GL_FLOAT,
+                              GL_FALSE,
+                              sizeof(Instance),
+                              reinterpret_cast<void*>(offsetof(Instance, Transform) + sizeof(vec4) * column));
+        glVertexAttribDivisor(3 + column, 1);
+    }
 
     glBindVertexArray(0);  // TODO: Only do this when validating OpenGL
 }
 
 bee::DebugRenderer::Impl::~Impl()
 {
-    delete[] m_vertexArray;
     glDeleteVertexArrays(1, &m_linesVAO);
+    glDeleteVertexArrays(1, &m_shapesVAO);
     glDeleteBuffers(1, &m_linesVBO);
+    glDeleteBuffers(1, &m_shapesVBO);
+    glDeleteBuffers(1, &m_instancesVBO);
+    glDeleteProgram(debug_program);
+    glDeleteProgram(m_instancedProgram);
 }
 
-bool bee::DebugRenderer::Impl::AddLine(const vec3& from, const vec3& to, const vec4& color)
+void bee::DebugRenderer::Impl::Upload(const std::vector<std::unique_ptr<Buffer>>& buffers)
 {
-    if (m_linesCount < m_maxLines)
+    m_lines.clear();
+    for (const auto& buffer : buffers) m_lines.insert(m_lines.end(), buffer->Lines.begin(), buffer->Lines.end());
+
+    // Grouped by primitive, so that every primitive is one instanced draw
+    m_instances.clear();
+    for (size_t p = 0; p < c_primitiveCount; p++)
     {
-        m_vertexArray[m_linesCount * 2].Position = from;
-        m_vertexArray[m_linesCount * 2 + 1].Position = to;
-        m_vertexArray[m_linesCount * 2].Color = color;
-        m_vertexArray[m_linesCount * 2 + 1].Color = color;
-        ++m_linesCount;
-        return true;
+        m_firstInstance[p] = m_instances.size();
+        for (const auto& buffer : buffers)
+            m_instances.insert(m_instances.end(), buffer->Instances[p].begin(), buffer->Instances[p].end());
     }
-    return false;
+    m_firstInstance[c_primitiveCount] = m_instances.size();
+
+    UploadBuffer(m_linesVBO, m_lines);
+    UploadBuffer(m_instancesVBO, m_instances);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void bee::DebugRenderer::Impl::Render(const mat4& view, const mat4& projection)
 {
     // Render debug lines
     glm::mat4 vp = projection * view;
-    glUseProgram(debug_program);
-    glUniformMatrix4fv(1, 1, false, value_ptr(vp));
-    glBindVertexArray(m_linesVAO);
-
-    if (m_linesCount > 0)
+    if (!m_lines.empty())
     {
-        glBindBuffer(GL_ARRAY_BUFFER, m_linesVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(VertexPosition3DColor) * (m_maxLines * 2), &m_vertexArray[0], GL_DYNAMIC_DRAW);
-        glDrawArrays(GL_LINES, 0, m_linesCount * 2);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glUseProgram(debug_program);
+        glUniformMatrix4fv(1, 1, false, value_ptr(vp));
+        glBindVertexArray(m_linesVAO);
+        glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(m_lines.size()));
     }
 
-    m_linesCount = 0;
+    // Render the instances of every unit shape
+    if (!m_instances.empty())
+    {
+        glUseProgram(m_instancedProgram);
+        glUniformMatrix4fv(1, 1, false, value_ptr(vp));
+        glBindVertexArray(m_shapesVAO);
+        for (size_t p = 0; p < c_primitiveCount; p++)
+        {
+            const size_t count = m_firstInstance[p + 1] - m_firstInstance[p];
+            if (count == 0) continue;
+            glDrawArraysInstancedBaseInstance(GL_LINES,
+                                              m_firstShapeVertex[p],
+                                              m_firstShapeVertex[p + 1] - m_firstShapeVertex[p],
+                                              static_cast<GLsizei>(count),
+                                              static_cast<GLuint>(m_firstInstance[p]));
+        }
+    }
+    glBindVertexArray(0);
 }
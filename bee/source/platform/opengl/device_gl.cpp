@@ -1,3 +1,5 @@
+#if !defined(BEE_GRAPHICS_NULL)
+
 #include <cassert>
 #include "core/device.hpp"
 #include "platform/opengl/open_gl.hpp"
@@ -119,3 +121,5 @@ void bee::Device::SetWindowSize(int width, int height)
     glfwSetWindowSize(m_window, width, height);
     glViewport(0, 0, width, height);
 }
+
+#endif  // !BEE_GRAPHICS_NULL
@@ -0,0 +1,303 @@
+#include "platform/opengl/mesh_arena_gl.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <glm/gtc/packing.hpp>
+
+#include "platform/opengl/mesh_gl.hpp"
+#include "platform/opengl/open_gl.hpp"
+#include "platform/opengl/uniforms_gl.hpp"
+#include "tools/log.hpp"
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+constexpr uint32_t c_initialVertices = 1 << 18;
+constexpr uint32_t c_initialIndices = 1 << 20;
+constexpr uint32_t c_invalid = numeric_limits<uint32_t>::max();
+
+// Where an attribute is in an interleaved vertex, and how it is stored
+struct AttributeFormat
+{
+    GLint Components;
+    GLenum Type;
+    GLboolean Normalized;
+    uint32_t Offset;
+};
+
+// By attribute location. Missing attributes are stored as (0, 0, 0, 1), which is what disabled vertex arrays read.
+constexpr AttributeFormat c_layout[] = {
+    {3, GL_FLOAT, GL_FALSE, 0},   // position
+    {3, GL_FLOAT, GL_FALSE, 12},  // normal
+    {2, GL_FLOAT, GL_FALSE, 24},  // texture coordinates 0
+    {2, GL_FLOAT, GL_FALSE, 32},  // texture coordinates 1
+    {3, GL_FLOAT, GL_FALSE, 40},  // color
+    {4, GL_FLOAT, GL_FALSE, 52},  // tangent
+};
+constexpr uint32_t c_stride = 68;
+
+// Normals and tangents as signed normalized 10 bit components, and texture coordinates as half floats. Positions and
+// colors, which may be larger than one, stay floats.
+constexpr AttributeFormat c_quantizedLayout[] = {
+    {3, GL_FLOAT, GL_FALSE, 0},
+    {4, GL_INT_2_10_10_10_REV, GL_TRUE, 12},
+    {2, GL_HALF_FLOAT, GL_FALSE, 16},
+    {2, GL_HALF_FLOAT, GL_FALSE, 20},
+    {3, GL_FLOAT, GL_FALSE, 24},
+    {4, GL_INT_2_10_10_10_REV, GL_TRUE, 36},
+};
+constexpr uint32_t c_quantizedStride = 40;
+
+static_assert(MeshData::c_maxLods <= DrawKey::c_maxLods, "every level of detail needs a range");
+static_assert(POSITION_LOCATION == 0 && NORMAL_LOCATION == 1 && TEXTURE0_LOCATION == 2 && TEXTURE1_LOCATION == 3 &&
+                  COLOR_LOCATION == 4 && TANGENT_LOCATION == 5,
+              "the layouts are in the order of the attribute locations");
+
+// First fit, returns c_invalid when no free block is large enough
+uint32_t Allocate(vector<MeshArena::Block>& freeBlocks, uint32_t count)
+{
+    if (count == 0) return 0;
+    for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+    {
+        if (it->Count < count) continue;
+        const uint32_t offset = it->Offset;
+        it->Offset += count;
+        it->Count -= count;
+        if (it->Count == 0) freeBlocks.erase(it);
+        return offset;
+    }
+    return c_invalid;
+}
+
+// Merges the block with its neighbours, so that space does not fragment into ever smaller blocks
+void Free(vector<MeshArena::Block>& freeBlocks, MeshArena::Block block)
+{
+    if (block.Count == 0) return;
+
+    auto it = lower_bound(freeBlocks.begin(),
+                          freeBlocks.end(),
+                          block.Offset,
+                          [](const MeshArena::Block& b, uint32_t offset) { return b.Offset < offset; });
+    it = freeBlocks.insert(it, block);
+    if (it + 1 != freeBlocks.end() && it->Offset + it->Count == (it + 1)->Offset)
+    {
+        it->Count += (it + 1)->Count;
+        freeBlocks.erase(it + 1);
+    }
+    if (it != freeBlocks.begin() && (it - 1)->Offset + (it - 1)->Count == it->Offset)
+    {
+        (it - 1)->Count += it->Count;
+        freeBlocks.erase(it);
+    }
+}
+
+// Interleaves the attributes of every vertex into target, which holds data.GetVertexCount() * stride bytes
+void WriteVertices(const MeshData& data, bool quantize, uint8_t* target)
+{
+    const AttributeFormat* layout = quantize ? c_quantizedLayout : c_layout;
+    const uint32_t stride = quantize ? c_quantizedStride : c_stride;
+    const auto write = [](uint8_t* vertex, const AttributeFormat& format, const auto& value)
+    { memcpy(vertex + format.Offset, &value, sizeof(value)); };
+
+    for (size_t v = 0; v < data.GetVertexCount(); v++)
+    {
+        uint8_t* vertex = target + v * stride;
+        const vec3 normal = data.Normals.empty() ? vec3(0.0f) : data.Normals[v];
+        const vec2 uv0 = data.TexCoords0.empty() ? vec2(0.0f) : data.TexCoords0[v];
+        const vec2 uv1 = data.TexCoords1.empty() ? vec2(0.0f) : data.TexCoords1[v];
+        const vec3 color = data.Colors.empty() ? vec3(0.0f) : data.Colors[v];
+        const vec4 tangent = data.Tangents.empty() ? vec4(0.0f, 0.0f, 0.0f, 1.0f) : data.Tangents[v];
+
+        write(vertex, layout[POSITION_LOCATION], data.Positions[v]);
+        write(vertex, layout[COLOR_LOCATION], color);
+        if (quantize)
+        {
+            write(vertex, layout[NORMAL_LOCATION], glm::packSnorm3x10_1x2(vec4(normal, 0.0f)));
+            write(vertex, layout[TEXTURE0_LOCATION], glm::packHalf2x16(uv0));
+            write(vertex, layout[TEXTURE1_LOCATION], glm::packHalf2x16(uv1));
+            write(vertex, layout[TANGENT_LOCATION], glm::packSnorm3x10_1x2(tangent));
+        }
+        else
+        {
+            write(vertex, layout[NORMAL_LOCATION], normal);
+            write(vertex, layout[TEXTURE0_LOCATION], uv0);
+            write(vertex, layout[TEXTURE1_LOCATION], uv1);
+            write(vertex, layout[TANGENT_LOCATION], tangent);
+        }
+    }
+}
+
+}  // namespace
+
+MeshArena::MeshArena(bool quantize) : m_quantize(quantize), m_stride(quantize ? c_quantizedStride : c_stride)
+{
+    glGenVertexArrays(1, &m_vao);
+    LabelGL(GL_VERTEX_ARRAY, m_vao, "[R] Mesh Arena VAO");
+    Grow(c_initialVertices, c_initialIndices);
+}
+
+MeshArena::~MeshArena()
+{
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteBuffers(1, &m_vbo);
+    glDeleteBuffers(1, &m_ebo);
+}
+
+void MeshArena::Add(const shared_ptr<Mesh>& mesh)
+{
+    const uint32_t id = mesh->GetId();
+    if (id >= m_entries.size())
+    {
+        m_entries.resize(id + 1);
+        m_ranges.resize((id + 1) * DrawKey::c_maxLods);
+    }
+
+    // An expired entry with the same owner is a new mesh at the address of an old one
+    Entry& entry = m_entries[id];
+    if (entry.Owner != mesh.get() || entry.Mesh.expired() || entry.Version != mesh->GetVersion())
+    {
+        Remove(entry);
+        Insert(mesh, entry);
+    }
+}
+
+void MeshArena::Insert(const shared_ptr<Mesh>& mesh, Entry& entry)
+{
+    const MeshData& data = mesh->GetData();
+    const auto vertexCount = static_cast<uint32_t>(data.GetVertexCount());
+    uint32_t indexCount = 0;
+    for (int lod = 0; lod < data.GetLodCount(); lod++) indexCount += static_cast<uint32_t>(data.GetLodIndices(lod).size());
+
+    uint32_t firstVertex = Allocate(m_freeVertices, vertexCount);
+    uint32_t firstIndex = Allocate(m_freeIndices, indexCount);
+    if (firstVertex == c_invalid || firstIndex == c_invalid)
+    {
+        // Release what was allocated, and the space of meshes that no longer exist, before growing
+        if (firstVertex != c_invalid) Free(m_freeVertices, {firstVertex, vertexCount});
+        if (firstIndex != c_invalid) Free(m_freeIndices, {firstIndex, indexCount});
+        CollectGarbage();
+
+        firstVertex = Allocate(m_freeVertices, vertexCount);
+        firstIndex = Allocate(m_freeIndices, indexCount);
+        if (firstVertex == c_invalid || firstIndex == c_invalid)
+        {
+            if (firstVertex != c_invalid) Free(m_freeVertices, {firstVertex, vertexCount});
+            if (firstIndex != c_invalid) Free(m_freeIndices, {firstIndex, indexCount});
+            Grow(max(m_vertexCapacity * 2, m_vertexCapacity + vertexCount),
+                 max(m_indexCapacity * 2, m_indexCapacity + indexCount));
+            firstVertex = Allocate(m_freeVertices, vertexCount);
+            firstIndex = Allocate(m_freeIndices, indexCount);
+        }
+    }
+    assert(firstVertex != c_invalid && firstIndex != c_invalid);
+
+    m_staging.resize(static_cast<size_t>(vertexCount) * m_stride);
+    WriteVertices(data, m_quantize, m_staging.data());
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferSubData(GL_ARRAY_BUFFER,
+                    static_cast<GLintptr>(firstVertex) * m_stride,
+                    static_cast<GLsizeiptr>(m_staging.size()),
+                    m_staging.data());
+    BEE_DEBUG_ONLY(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+    // The levels of detail follow each other, and all index the same vertices
+    MeshRange* ranges = &m_ranges[mesh->GetId() * DrawKey::c_maxLods];
+    uint32_t lodFirstIndex = firstIndex;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+    for (int lod = 0; lod < static_cast<int>(DrawKey::c_maxLods); lod++)
+    {
+        if (lod >= data.GetLodCount())
+        {
+            ranges[lod] = ranges[lod - 1];
+            continue;
+        }
+
+        const auto& indices = data.GetLodIndices(lod);
+        glBufferSubData(GL_COPY_WRITE_BUFFER,
+                        static_cast<GLintptr>(lodFirstIndex * sizeof(uint32_t)),
+                        static_cast<GLsizeiptr>(indices.size() * sizeof(uint32_t)),
+                        indices.data());
+        ranges[lod] = {lodFirstIndex, static_cast<uint32_t>(indices.size()), static_cast<int32_t>(firstVertex)};
+        lodFirstIndex += static_cast<uint32_t>(indices.size());
+    }
+    BEE_DEBUG_ONLY(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+
+    entry.Mesh = mesh;
+    entry.Owner = mesh.get();
+    entry.Version = mesh->GetVersion();
+    entry.Vertices = {firstVertex, vertexCount};
+    entry.Indices = {firstIndex, indexCount};
+    m_usedVertices += vertexCount;
+    m_usedIndices += indexCount;
+}
+
+void MeshArena::Remove(Entry& entry)
+{
+    if (!entry.Owner) return;
+
+    Free(m_freeVertices, entry.Vertices);
+    Free(m_freeIndices, entry.Indices);
+    m_usedVertices -= entry.Vertices.Count;
+    m_usedIndices -= entry.Indices.Count;
+    entry = {};
+}
+
+void MeshArena::CollectGarbage()
+{
+    for (auto& entry : m_entries)
+        if (entry.Owner && entry.Mesh.expired()) Remove(entry);
+}
+
+void MeshArena::Grow(uint32_t vertexCapacity, uint32_t indexCapacity)
+{
+    if (m_vertexCapacity > 0) Log::Info("Mesh arena grows to {} vertices and {} indices", vertexCapacity, indexCapacity);
+
+    // Copy the old buffers into new ones on the GPU
+    const auto grow = [](unsigned int& buffer, GLenum target, size_t oldSize, size_t newSize, const char* label)
+    {
+        unsigned int grown = 0;
+        glGenBuffers(1, &grown);
+        glBindBuffer(target, grown);
+        glBufferData(target, static_cast<GLsizeiptr>(newSize), nullptr, GL_STATIC_DRAW);
+        LabelGL(GL_BUFFER, grown, label);
+        if (buffer != 0)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, target, 0, 0, static_cast<GLsizeiptr>(oldSize));
+            glDeleteBuffers(1, &buffer);
+        }
+        buffer = grown;
+    };
+
+    glBindVertexArray(m_vao);
+    grow(m_vbo, GL_ARRAY_BUFFER, m_vertexCapacity * m_stride, vertexCapacity * m_stride, "[R] Mesh Arena VBO");
+    const AttributeFormat* layout = m_quantize ? c_quantizedLayout : c_layout;
+    for (int location = 0; location < c_attributes; location++)
+    {
+        const AttributeFormat& format = layout[location];
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location,
+                              format.Components,
+                              format.Type,
+                              format.Normalized,
+                              static_cast<GLsizei>(m_stride),
+                              reinterpret_cast<const void*>(static_cast<uintptr_t>(format.Offset)));
+    }
+    grow(m_ebo,
+         GL_ELEMENT_ARRAY_BUFFER,
+         m_indexCapacity * sizeof(uint32_t),
+         indexCapacity * sizeof(uint32_t),
+         "[R] Mesh Arena EBO");
+    BEE_DEBUG_ONLY(glBindVertexArray(0));
+    BEE_DEBUG_ONLY(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+    Free(m_freeVertices, {m_vertexCapacity, vertexCapacity - m_vertexCapacity});
+    Free(m_freeIndices, {m_indexCapacity, indexCapacity - m_indexCapacity});
+    m_vertexCapacity = vertexCapacity;
+    m_indexCapacity = indexCapacity;
+}
@@ -1,4 +1,10 @@
 #include "platform/opengl/mesh_gl.hpp"
+
+#include <tuple>
+
+#include "math/geometry.hpp"
+#include "rendering/mesh_lod.hpp"        // before uniforms_gl.hpp, which defines vec3 as a macro
+#include "rendering/mesh_optimizer.hpp"  // before uniforms_gl.hpp, which defines vec3 as a macro
 #include "platform/opengl/open_gl.hpp"
 #include "platform/opengl/uniforms_gl.hpp"
 #include "rendering/model.hpp"
@@ -9,6 +15,31 @@ using namespace std;
 
 static uint32_t CalculateDataTypeSize(tinygltf::Accessor const& accessor) noexcept;
 
+namespace
+{
+
+// Copies the elements of an accessor, which may be interleaved with other data
+template <typename T>
+void CopyAccessor(const tinygltf::Model& document, const tinygltf::Accessor& accessor, std::vector<T>& target)
+{
+    const auto& view = document.bufferViews[accessor.bufferView];
+    const auto& buffer = document.buffers[view.buffer];
+    const size_t stride = view.byteStride != 0 ? view.byteStride : sizeof(T);
+    const unsigned char* source = &buffer.data.at(view.byteOffset + accessor.byteOffset);
+
+    target.resize(accessor.count);
+    for (size_t i = 0; i < accessor.count; i++) memcpy(&target[i], source + i * stride, sizeof(T));
+}
+
+template <typename T>
+void CopyBytes(std::vector<T>& target, size_t count, const void* data)
+{
+    target.resize(count / sizeof(T));
+    memcpy(target.data(), data, target.size() * sizeof(T));
+}
+
+}  // namespace
+
 Mesh::Mesh() : Resource(ResourceType::Mesh)
 {
     m_generated = true;
@@ -46,8 +77,6 @@ Mesh::Mesh(const Model& model, size_t meshIndex, size_t primitiveIndex) : Resour
         const auto& view = document.bufferViews[accessor.bufferView];
         const auto& buffer = document.buffers[view.buffer];
 
-        // Note: accessor.max / accessor.min are the AABB of the mesh. You can use this for culling if you want.
-
         if (attribute.first == "POSITION")
         {
             // for consistency sake it's better to skip this lint
@@ -60,8 +89,18 @@ Mesh::Mesh(const Model& model, size_t meshIndex, size_t primitiveIndex) : Resour
             glEnableVertexAttribArray(POSITION_LOCATION);
             glVertexAttribPointer(POSITION_LOCATION, 3, GL_FLOAT, GL_FALSE, (GLsizei)view.byteStride, nullptr);
             LabelGL(GL_BUFFER, m_vbo[POSITION_LOCATION], "VBO |" + m_path + " | POSITION");
-            m_positions.resize(accessor.count);
-            memcpy(m_positions.data(), &buffer.data.at(view.byteOffset + accessor.byteOffset), accessor.count * 12);
+            CopyAccessor(document, accessor, m_data.Positions);
+
+            // glTF requires the bounds of positions, compute them anyway for files that do not follow that
+            if (accessor.minValues.size() == 3 && accessor.maxValues.size() == 3)
+            {
+                m_min = vec3(accessor.minValues[0], accessor.minValues[1], accessor.minValues[2]);
+                m_max = vec3(accessor.maxValues[0], accessor.maxValues[1], accessor.maxValues[2]);
+            }
+            else if (!m_data.Positions.empty())
+            {
+                std::tie(m_min, m_max) = ComputeAABB(m_data.Positions);
+            }
         }
         else if (attribute.first == "NORMAL")
         {
@@ -74,6 +113,7 @@ Mesh::Mesh(const Model& model, size_t meshIndex, size_t primitiveIndex) : Resour
             glEnableVertexAttribArray(NORMAL_LOCATION);
             glVertexAttribPointer(NORMAL_LOCATION, 3, GL_FLOAT, GL_FALSE, (GLsizei)view.byteStride, nullptr);
             LabelGL(GL_BUFFER, m_vbo[NORMAL_LOCATION], "VBO |" + m_path + " | NORMAL");
+            CopyAccessor(document, accessor, m_data.Normals);
         }
         else if (attribute.first == "TANGENT")
         {
@@ -85,6 +125,7 @@ Mesh::Mesh(const Model& model, size_t meshIndex, size_t primitiveIndex) : Resour
                          GL_STATIC_DRAW);
             glEnableVertexAttribArray(TANGENT_LOCATION);
             glVertexAttribPointer(TANGENT_LOCATION, 4, GL_FLOAT, GL_FALSE, (GLsizei)view.byteStride, nullptr);
+            CopyAccessor(document, accessor, m_data.Tangents);
         }
         else if (attribute.first == "TEXCOORD_0")
         {
@@ -97,6 +138,7 @@ Mesh::Mesh(const Model& model, size_t meshIndex, size_t primitiveIndex) : Resour
             glEnableVertexAttribArray(TEXTURE0_LOCATION);
             glVertexAttribPointer(TEXTURE0_LOCATION, 2, GL_FLOAT, GL_FALSE, (GLsizei)view.byteStride, nullptr);
             LabelGL(GL_BUFFER, m_vbo[TEXTURE0_LOCATION], "VBO |" + m_path + " | TEXCOORD_0");
+            CopyAccessor(document, accessor, m_data.TexCoords0);
         }
         else if (attribute.first == "TEXCOORD_1")
         {
@@ -109,6 +151,7 @@ Mesh::Mesh(const Model& model, size_t meshIndex, size_t primitiveIndex) : Resour
             glEnableVertexAttribArray(TEXTURE1_LOCATION);
             glVertexAttribPointer(TEXTURE1_LOCATION, 2, GL_FLOAT, GL_FALSE, (GLsizei)view.byteStride, nullptr);
             LabelGL(GL_BUFFER, m_vbo[TEXTURE1_LOCATION], "VBO |" + m_path + " | TEXCOORD_1");
+            CopyAccessor(document, accessor, m_data.TexCoords1);
         }
     }
 
@@ -131,7 +174,26 @@ Mesh::Mesh(const Model& model, size_t meshIndex, size_t primitiveIndex) : Resour
                  GL_DYNAMIC_DRAW);
     LabelGL(GL_BUFFER, m_ebo, "EBO |" + m_path);
 
-    if (m_vbo[TANGENT_LOCATION] == 0) ComputeTangents(model, meshIndex, primitiveIndex);
+    if (typeSize == 4)
+    {
+        CopyAccessor(document, accessor, m_data.Indices);
+    }
+    else if (typeSize == 2)
+    {
+        std::vector<uint16_t> indices;
+        CopyAccessor(document, accessor, indices);
+        m_data.Indices.assign(indices.begin(), indices.end());
+    }
+    else if (typeSize == 1)
+    {
+        std::vector<uint8_t> indices;
+        CopyAccessor(document, accessor, indices);
+        m_data.Indices.assign(indices.begin(), indices.end());
+    }
+
+    if (m_vbo[TANGENT_LOCATION] == 0) ComputeTangents();
+    GenerateLods();
+    Optimize();
 
     BEE_DEBUG_ONLY(glBindVertexArray(0));
 }
@@ -145,20 +207,75 @@ Mesh::~Mesh()
 
 void Mesh::SetIndices(std::vector<uint16_t>& data)
 {
-    m_count = (int)data.size();
-    m_indexType = GL_UNSIGNED_SHORT;
+    m_data.Indices.assign(data.begin(), data.end());
+    SetIndices(data.size(), data.data(), GL_UNSIGNED_SHORT);
+}
+
+void Mesh::SetIndices(std::vector<uint32_t>& data)
+{
+    m_data.Indices = data;
+    SetIndices(data.size(), data.data(), GL_UNSIGNED_INT);
+}
+
+void Mesh::SetIndices(size_t count, const void* data, uint32_t type)
+{
+    m_version++;
+    m_data.Lods.clear();
+    m_count = static_cast<uint32_t>(count);
+    m_indexType = type;
     glBindVertexArray(m_vao);
     if (m_ebo != 0) glDeleteBuffers(1, &m_ebo);
     glCreateBuffers(1, &m_ebo);
     LabelGL(GL_BUFFER, m_ebo, "EBO:" + m_path);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size() * sizeof(uint16_t), data.data(), GL_DYNAMIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * (type == GL_UNSIGNED_INT ? 4 : 2), data, GL_DYNAMIC_DRAW);
     BEE_DEBUG_ONLY(glBindVertexArray(0));
     BEE_DEBUG_ONLY(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 }
 
-void Mesh::SetAttribute(Attribute attribute, size_t count, void* data)
+void Mesh::SetData(const MeshData& data)
 {
+    // Attributes that are empty would not be drawn correctly, skip them just like a model without them
+    const auto set = [this](Attribute attribute, const auto& values)
+    {
+        if (!values.empty()) SetAttribute(attribute, values.size() * sizeof(values[0]), values.data());
+    };
+    set(Attribute::Position, data.Positions);
+    set(Attribute::Normal, data.Normals);
+    set(Attribute::Tangent, data.Tangents);
+    set(Attribute::Color, data.Colors);
+    set(Attribute::Texture, data.TexCoords0);
+    set(Attribute::Texture1, data.TexCoords1);
+
+    m_data.Indices = data.Indices;
+    SetIndices(data.Indices.size(), data.Indices.data(), GL_UNSIGNED_INT);
+    m_data.Lods = data.Lods;
+}
+
+void Mesh::GenerateLods()
+{
+    m_version++;
+    bee::GenerateLods(m_data);
+}
+
+void Mesh::Optimize()
+{
+    if (m_data.IsEmpty()) return;
+
+    MeshData data = m_data;
+    const MeshOptimizationStats stats = OptimizeMesh(data);
+    SetData(data);
+    Log::Info("Optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+              m_path,
+              stats.Before.Acmr,
+              stats.After.Acmr,
+              stats.Before.Atvr,
+              stats.After.Atvr);
+}
+
+void Mesh::SetAttribute(Attribute attribute, size_t count, const void* data)
+{
+    m_version++;
     glBindVertexArray(m_vao);
 
     unsigned int location = 0;
@@ -214,61 +331,37 @@ void Mesh::SetAttribute(Attribute attribute, size_t count, void* data)
     glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, (GLsizei)0, nullptr);
     BEE_DEBUG_ONLY(glBindVertexArray(0));
     BEE_DEBUG_ONLY(glBindBuffer(GL_ARRAY_BUFFER, 0));
-}
 
-void Mesh::ComputeTangents(const Model& model, size_t meshIndex, size_t primitiveIndex)
-{
-    const auto& document = model.GetDocument();
-    auto mesh = document.meshes[meshIndex];
-    auto primitive = mesh.primitives[primitiveIndex];
-
-    std::vector<vec3> normals;
-    std::vector<vec2> uvs;
-    std::vector<uint32_t> indices;
-
-    // Loop over all attributes
-    for (auto& attribute : primitive.attributes)
-    {
-        // Get attribute data from GLTF
-        const auto& accessor = document.accessors[attribute.second];
-        const auto& view = document.bufferViews[accessor.bufferView];
-        const auto& buffer = document.buffers[view.buffer];
-
-        if (attribute.first == "NORMAL")
-        {
-            normals.resize(accessor.count);
-            memcpy(normals.data(), &buffer.data.at(view.byteOffset + accessor.byteOffset), accessor.count * 12);
-        }
-        else if (attribute.first == "TEXCOORD_0")
-        {
-            uvs.resize(accessor.count);
-            memcpy(uvs.data(), &buffer.data.at(view.byteOffset + accessor.byteOffset), accessor.count * 8);
-        }
-    }
-
-    // Index buffer
-    const auto& accessor = document.accessors[primitive.indices];
-    const auto& view = document.bufferViews[accessor.bufferView];
-    const auto& buffer = document.buffers[view.buffer];
-
-    auto typeSize = CalculateDataTypeSize(accessor);
-    if (typeSize == 4)
-    {
-        indices.resize(accessor.count);
-        memcpy(indices.data(), &buffer.data.at(view.byteOffset + accessor.byteOffset), accessor.count * sizeof(uint32_t));
-    }
-    if (typeSize == 2)
+    switch (attribute)
     {
-        std::vector<uint16_t> temp;
-        temp.resize(accessor.count);
-        memcpy(temp.data(), &buffer.data.at(view.byteOffset + accessor.byteOffset), accessor.count * sizeof(uint16_t));
-        indices.resize(accessor.count);
-        for (size_t i = 0; i < temp.size(); i++) indices[i] = temp[i];
+        case Attribute::Position:
+            CopyBytes(m_data.Positions, count, data);
+            if (!m_data.Positions.empty()) std::tie(m_min, m_max) = ComputeAABB(m_data.Positions);
+            break;
+        case Attribute::Normal:
+            CopyBytes(m_data.Normals, count, data);
+            break;
+        case Attribute::Tangent:
+            CopyBytes(m_data.Tangents, count, data);
+            break;
+        case Attribute::Color:
+            CopyBytes(m_data.Colors, count, data);
+            break;
+        case Attribute::Texture:
+            CopyBytes(m_data.TexCoords0, count, data);
+            break;
+        case Attribute::Texture1:
+            CopyBytes(m_data.TexCoords1, count, data);
+            break;
     }
+}
 
-    if (m_positions.size() == normals.size() && uvs.size() == normals.size())
+void Mesh::ComputeTangents()
+{
+    const auto& data = m_data;
+    if (data.Positions.size() == data.Normals.size() && data.TexCoords0.size() == data.Normals.size())
     {
-        std::vector<vec4> tangents = ComputeTangents(m_positions, normals, uvs, indices);
+        std::vector<vec4> tangents = ComputeTangents(data.Positions, data.Normals, data.TexCoords0, data.Indices);
         SetAttribute(Attribute::Tangent, tangents);
     }
 }
@@ -0,0 +1,110 @@
+#include "platform/opengl/persistent_buffer_gl.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "platform/opengl/open_gl.hpp"
+#include "tools/log.hpp"
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+constexpr GLbitfield c_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+constexpr GLuint64 c_waitTimeout = 1000000000;  // one second, in nanoseconds
+
+size_t RoundUp(size_t value, size_t multiple) { return (value + multiple - 1) / multiple * multiple; }
+
+}  // namespace
+
+PersistentBuffer::PersistentBuffer(uint32_t target, uint32_t binding, size_t regionSize, std::string label)
+    : m_target(target), m_binding(binding), m_label(std::move(label))
+{
+    Create(regionSize);
+}
+
+PersistentBuffer::~PersistentBuffer() { Delete(); }
+
+void PersistentBuffer::Create(size_t regionSize)
+{
+    m_regionSize = regionSize;
+    m_used = 0;
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(m_target, m_buffer);
+    glBufferStorage(m_target, static_cast<GLsizeiptr>(m_regionSize * c_regions), nullptr, c_flags);
+    m_mapped =
+        static_cast<std::byte*>(glMapBufferRange(m_target, 0, static_cast<GLsizeiptr>(m_regionSize * c_regions), c_flags));
+    assert(m_mapped != nullptr);
+    BEE_DEBUG_ONLY(glBindBuffer(m_target, 0));
+    if (m_binding != c_noBinding) glBindBufferBase(m_target, m_binding, m_buffer);
+    LabelGL(GL_BUFFER, m_buffer, m_label + " (size:" + to_string(m_regionSize * c_regions) + ")");
+}
+
+void PersistentBuffer::Delete()
+{
+    for (auto& fence : m_fences)
+    {
+        if (fence) glDeleteSync(static_cast<GLsync>(fence));
+        fence = nullptr;
+    }
+
+    // Deleting unmaps the buffer. Draws that still read it keep it alive until they are done.
+    glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+    m_mapped = nullptr;
+}
+
+void PersistentBuffer::BeginFrame()
+{
+    m_region = (m_region + 1) % c_regions;
+    m_used = 0;
+
+    auto& fence = m_fences[m_region];
+    if (!fence) return;
+
+    GLenum result = glClientWaitSync(static_cast<GLsync>(fence), 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        m_stalls++;
+        do
+        {
+            result = glClientWaitSync(static_cast<GLsync>(fence), GL_SYNC_FLUSH_COMMANDS_BIT, c_waitTimeout);
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+    if (result == GL_WAIT_FAILED) Log::Error("Waiting for the GPU to finish with {} failed", m_label);
+
+    glDeleteSync(static_cast<GLsync>(fence));
+    fence = nullptr;
+}
+
+void PersistentBuffer::EndFrame()
+{
+    auto& fence = m_fences[m_region];
+    if (fence) glDeleteSync(static_cast<GLsync>(fence));
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void* PersistentBuffer::Allocate(size_t size, size_t alignment, size_t& offset)
+{
+    const size_t regionStart = static_cast<size_t>(m_region) * m_regionSize;
+    offset = RoundUp(regionStart + m_used, alignment);
+
+    if (offset + size > regionStart + m_regionSize)
+    {
+        // Everything that was issued so far keeps reading the old buffer, the rest of the frame uses a new one
+        const size_t needed = RoundUp(size + alignment, alignment);
+        const size_t regionSize = RoundUp(max(m_regionSize * 2, needed), alignment);
+        Log::Info("{} grows to {} bytes per frame", m_label, regionSize);
+
+        Delete();
+        Create(regionSize);
+        m_region = 0;
+        offset = 0;
+    }
+
+    m_used = offset + size - static_cast<size_t>(m_region) * m_regionSize;
+    return m_mapped + offset;
+}
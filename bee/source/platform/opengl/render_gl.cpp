@@ -3,24 +3,46 @@
 #include <imgui/imgui.h>
 #include <tinygltf/stb_image.h>  // Implementation of stb_image is in gltf_loader.cpp
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <glm/glm.hpp>
+#include <unordered_map>
 
 #include "core/device.hpp"
 #include "core/ecs.hpp"
 #include "core/engine.hpp"
 #include "core/resources.hpp"
 #include "core/transform.hpp"
+#include "rendering/mesh_lod.hpp"  // these before uniforms_gl.hpp, which defines vec3 and mat4 as macros
+#include "rendering/particles.hpp"
+#include "rendering/scene_tree.hpp"
+#include "rendering/skid_marks.hpp"
+#include "rendering/static_batch.hpp"
 #include "tools/inspector.hpp"
 #include "platform/opengl/image_gl.hpp"
+#include "platform/opengl/mesh_arena_gl.hpp"
 #include "platform/opengl/mesh_gl.hpp"
 #include "platform/opengl/open_gl.hpp"
+#include "platform/opengl/persistent_buffer_gl.hpp"
 #include "platform/opengl/shader_gl.hpp"
 #include "platform/opengl/uniforms_gl.hpp"
+#include "tools/arena.hpp"
+#include "tools/job_system.hpp"
 #include "tools/log.hpp"
 #include "tools/profiler.hpp"
 
 #define DEBUG_UBO_LOCATION (UBO_LOCATION_COUNT + 1)
-#define SORT_MESH_RENDERERS TRUE
+
+// The targets of the commands in Renderer::m_commandBuffers
+static constexpr uint32_t c_indirectCommandsTarget = 0;  // uploads to m_indirectCommands, and draws from them
+static constexpr uint32_t c_drawMaterialsTarget = 1;     // uploads to m_drawMaterials
+static constexpr uint32_t c_materialTarget = 2;          // binds the textures of a material
+
+static_assert(sizeof(bee::particle_struct) == sizeof(bee::FramePacket::ParticleInstance),
+              "additive particles are copied into the particle buffer as they are");
+static_assert(sizeof(bee::SkidMarkVertex) == 6 * sizeof(float), "skid mark vertices are uploaded as they are");
 
 using namespace bee;
 using namespace glm;
@@ -31,6 +53,10 @@ static void RenderCube();
 static void SetTexture(const shared_ptr<Texture>& texture, int location);
 static int SamplerTypeToGL(Sampler::Filter filter);
 static int SamplerTypeToGL(Sampler::Wrap wrap);
+static void ComputeBounds(const vector<FramePacket::MeshInstance>& meshes, BoundingBoxes& bounds);
+static void ExtractParticles(const ParticleSystem& particles, vector<FramePacket::ParticleBatch>& batches);
+static void ExtractSkidMarks(SkidMarkSystem& skidMarks, bool all, FramePacket::SkidMarkChanges& changes);
+static int GetScaledSize(int size, float scale);
 
 Renderer::Renderer()
 {
@@ -40,8 +66,11 @@ Renderer::Renderer()
     m_post = Engine.Resources().Load<Shader>(FileIO::Directory::SharedAssets, "shaders/post.vert", "shaders/post.frag");
     m_shadowPass =
         Engine.Resources().Load<Shader>(FileIO::Directory::SharedAssets, "shaders/depth_only.vert", "shaders/depth_only.frag");
+    m_particlePass =
+        Engine.Resources().Load<Shader>(FileIO::Directory::SharedAssets, "shaders/particle.vert", "shaders/particle.frag");
+    m_skidMarkPass =
+        Engine.Resources().Load<Shader>(FileIO::Directory::SharedAssets, "shaders/skid_mark.vert", "shaders/skid_mark.frag");
     CreateFrameBuffers();
-    CreateShadowMaps();
 
     // UBOs
     m_cameraData = new CameraUBO();
@@ -66,38 +95,108 @@ Renderer::Renderer()
     glBindBufferBase(GL_UNIFORM_BUFFER, DIRECTIONAL_LIGHTS_UBO_LOCATION, m_dirLightsUBO);
     LabelGL(GL_BUFFER, m_dirLightsUBO, ("Dir Lights UBO (size:" + to_string(sizeof(DirectionalLightsUBO)) + ")"));
 
-    m_pointLightsData = new PointLightsUBO();
-    glGenBuffers(1, &m_pointLightsUBO);
-    glBindBuffer(GL_UNIFORM_BUFFER, m_pointLightsUBO);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(PointLightsUBO), m_pointLightsData, GL_DYNAMIC_DRAW);
-    BEE_DEBUG_ONLY(glBindBuffer(GL_UNIFORM_BUFFER, 0));
-    glBindBufferBase(GL_UNIFORM_BUFFER, LIGHTS_UBO_LOCATION, m_pointLightsUBO);
-    LabelGL(GL_BUFFER, m_pointLightsUBO, ("Point Lights UBO (size:" + to_string(sizeof(PointLightsUBO)) + ")"));
+    // Resized to the lights of every frame
+    glGenBuffers(1, &m_pointLightsSSBO);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_pointLightsSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(point_light_struct), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, POINT_LIGHTS_SSBO_LOCATION, m_pointLightsSSBO);
+    LabelGL(GL_BUFFER, m_pointLightsSSBO, "Point Lights SSBO");
+
+    glGenBuffers(1, &m_clustersSSBO);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_clustersSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(LightClusters::Cluster) * CLUSTER_COUNT, nullptr, GL_DYNAMIC_DRAW);
+    BEE_DEBUG_ONLY(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTERS_SSBO_LOCATION, m_clustersSSBO);
+    LabelGL(GL_BUFFER, m_clustersSSBO, "Light Clusters SSBO");
+
+    // Instances of all passes of a frame, grows when a frame needs more
+    m_instances = make_unique<PersistentBuffer>(GL_SHADER_STORAGE_BUFFER,
+                                                TRANSFORMS_SSBO_LOCATION,
+                                                sizeof(transform_struct) * c_initialInstances,
+                                                "Transforms SSBO");
+    m_indirectCommands = make_unique<PersistentBuffer>(GL_DRAW_INDIRECT_BUFFER,
+                                                       PersistentBuffer::c_noBinding,
+                                                       sizeof(DrawElementsIndirectCommand) * c_initialInstances,
+                                                       "Indirect Commands");
+    m_drawMaterials = make_unique<PersistentBuffer>(GL_SHADER_STORAGE_BUFFER,
+                                                    DRAWS_SSBO_LOCATION,
+                                                    sizeof(material_struct) * c_initialInstances,
+                                                    "Draws SSBO");
+    m_particles = make_unique<PersistentBuffer>(GL_SHADER_STORAGE_BUFFER,
+                                                PARTICLES_SSBO_LOCATION,
+                                                sizeof(particle_struct) * c_initialParticles,
+                                                "Particles SSBO");
+    m_meshArena = make_unique<MeshArena>();
+    glGenVertexArrays(1, &m_particleVAO);
+    LabelGL(GL_VERTEX_ARRAY, m_particleVAO, "Particles VAO");
+
+    // The skid mark ring, allocated when the size of the ring is known, see UploadSkidMarks
+    glGenVertexArrays(1, &m_skidMarkVAO);
+    glBindVertexArray(m_skidMarkVAO);
+    LabelGL(GL_VERTEX_ARRAY, m_skidMarkVAO, "Skid Marks VAO");
+    glGenBuffers(1, &m_skidMarkVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_skidMarkVBO);
+    LabelGL(GL_BUFFER, m_skidMarkVBO, "Skid Marks VBO");
+    glGenBuffers(1, &m_skidMarkIBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_skidMarkIBO);
+    LabelGL(GL_BUFFER, m_skidMarkIBO, "Skid Marks IBO");
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0,
+                          4,
+                          GL_FLOAT,
+                          GL_FALSE,
+                          sizeof(SkidMarkVertex),
+                          reinterpret_cast<void*>(offsetof(SkidMarkVertex, Position)));  // and Time
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1,
+                          2,
+                          GL_FLOAT,
+                          GL_FALSE,
+                          sizeof(SkidMarkVertex),
+                          reinterpret_cast<void*>(offsetof(SkidMarkVertex, Side)));  // and Intensity
+    glBindVertexArray(0);
 
-    m_transformsData = new TransformsUBO();
-    glGenBuffers(1, &m_transformsUBO);
-    glBindBuffer(GL_UNIFORM_BUFFER, m_transformsUBO);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(TransformsUBO), m_transformsData, GL_DYNAMIC_DRAW);
-    BEE_DEBUG_ONLY(glBindBuffer(GL_UNIFORM_BUFFER, 0));
-    glBindBufferBase(GL_UNIFORM_BUFFER, TRANSFORMS_UBO_LOCATION, m_transformsUBO);
-    LabelGL(GL_BUFFER, m_transformsUBO, ("Transforms UBO (size:" + to_string(sizeof(TransformsUBO)) + ")"));
+    // The GPU time of every frame, for dynamic resolution
+    glGenQueries(c_gpuTimers, m_gpuTimers);
+
+    // Every game with a renderer gets spatial queries and picking
+    Engine.ECS().CreateSystem<SceneTree>();
+
+    // Static meshes are extracted again only when one of them changes
+    auto& registry = Engine.ECS().Registry;
+    registry.on_construct<Static>().connect<&Renderer::OnStaticEntityChanged>(*this);
+    registry.on_destroy<Static>().connect<&Renderer::OnStaticEntityChanged>(*this);
+    registry.on_construct<MeshRenderer>().connect<&Renderer::OnComponentChanged>(*this);
+    registry.on_update<MeshRenderer>().connect<&Renderer::OnComponentChanged>(*this);
+    registry.on_destroy<MeshRenderer>().connect<&Renderer::OnComponentChanged>(*this);
+    registry.on_update<Transform>().connect<&Renderer::OnComponentChanged>(*this);
 }
 
 Renderer::~Renderer()
 {
+    auto& registry = Engine.ECS().Registry;
+    registry.on_construct<Static>().disconnect(this);
+    registry.on_destroy<Static>().disconnect(this);
+    registry.on_construct<MeshRenderer>().disconnect(this);
+    registry.on_update<MeshRenderer>().disconnect(this);
+    registry.on_destroy<MeshRenderer>().disconnect(this);
+    registry.on_update<Transform>().disconnect(this);
+
     delete m_cameraData;
-    delete m_pointLightsData;
-    delete m_transformsData;
     delete m_dirLightsData;
     DeleteFrameBuffers();
     DeleteShadowMaps();
     DeleteUBOs();
+    glDeleteQueries(c_gpuTimers, m_gpuTimers);
 }
 
 void Renderer::CreateFrameBuffers()
 {
     m_width = Engine.Device().GetWidth();
     m_height = Engine.Device().GetHeight();
+    m_renderWidth = GetScaledSize(m_width, m_dynamicResolution.GetScale());
+    m_renderHeight = GetScaledSize(m_height, m_dynamicResolution.GetScale());
+    m_msaa = m_dynamicResolution.GetSamples();
 
     //  -- MSAA framebuffer --
     glGenFramebuffers(1, &m_msaaFramebuffer);              // Create
@@ -108,14 +207,14 @@ void Renderer::CreateFrameBuffers()
     glGenTextures(1, &m_msaaColorbuffer);                         // Create MSAA color attachment
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, m_msaaColorbuffer);  // Bind
     LabelGL(GL_TEXTURE, m_msaaColorbuffer, "[R] MSAA Color Buffer");
-    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, m_msaa, GL_RGB, m_width, m_height, GL_TRUE);  // Set storage
+    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, m_msaa, GL_RGB, m_renderWidth, m_renderHeight, GL_TRUE);  // Set storage
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, m_msaaColorbuffer, 0);  // Attach it
 
     // MSAA depth buffer
     glGenRenderbuffers(1, &m_msaaDepthbuffer);               // Create
     glBindRenderbuffer(GL_RENDERBUFFER, m_msaaDepthbuffer);  // Bind
     LabelGL(GL_RENDERBUFFER, m_msaaDepthbuffer, "[R] MSAA Depth Buffer");
-    glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_msaa, GL_DEPTH_COMPONENT, m_width, m_height);    // Set storage
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_msaa, GL_DEPTH_COMPONENT, m_renderWidth, m_renderHeight);
     glBindRenderbuffer(GL_RENDERBUFFER, 0);                                                              // Unbind
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_msaaDepthbuffer);  // Attach it
 
@@ -136,7 +235,7 @@ void Renderer::CreateFrameBuffers()
     glGenTextures(1, &m_resolvedColorbuffer);             // Resolved
     glBindTexture(GL_TEXTURE_2D, m_resolvedColorbuffer);  // Bind
     LabelGL(GL_TEXTURE, m_resolvedColorbuffer, "[R] Resolved Color Buffer");
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_width, m_height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);        // Set storage
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_renderWidth, m_renderHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);                                       // Filtering
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);                                       // Filtering
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);                                    // Clamping
@@ -147,7 +246,7 @@ void Renderer::CreateFrameBuffers()
     glGenRenderbuffers(1, &m_resolvedDepthbuffer);               // Create
     glBindRenderbuffer(GL_RENDERBUFFER, m_resolvedDepthbuffer);  // Bind
     LabelGL(GL_RENDERBUFFER, m_resolvedDepthbuffer, "[R] Resolved Depth Buffer");
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, m_width, m_height);                           // Set storage
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, m_renderWidth, m_renderHeight);               // Set storage
     glBindRenderbuffer(GL_RENDERBUFFER, 0);                                                                  // Unbind
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_resolvedDepthbuffer);  // Attach it
 
@@ -193,27 +292,19 @@ void Renderer::DeleteFrameBuffers()
     glDeleteTextures(1, &m_resolvedColorbuffer);
     glDeleteRenderbuffers(1, &m_resolvedDepthbuffer);
     glDeleteFramebuffers(1, &m_resolvedFramebuffer);
-}
 
-void Renderer::DeleteShadowMaps()
-{
-    glDeleteTextures(6, m_shadowMaps);
-    glDeleteFramebuffers(6, m_shadowFBOs);
+    glDeleteTextures(1, &m_finalColorbuffer);
+    glDeleteFramebuffers(1, &m_finalFramebuffer);
 }
 
-void Renderer::RenderCurrentInstances(int instances)
+void Renderer::DeleteShadowMaps()
 {
-    glBindBuffer(GL_UNIFORM_BUFFER, m_transformsUBO);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(TransformsUBO), m_transformsData, GL_DYNAMIC_DRAW);
-    BEE_DEBUG_ONLY(glBindBuffer(GL_UNIFORM_BUFFER, 0));
-
-    glBindVertexArray(m_currentMesh->GetVAO());
-    glDrawElementsInstanced(GL_TRIANGLES, m_currentMesh->GetCount(), m_currentMesh->GetIndexType(), nullptr, instances);
-
-#ifdef BEE_INSPECTOR
-    m_drawCalls++;
-    m_drawInstances += instances;
-#endif
+    for (auto& map : m_shadowMaps)
+    {
+        glDeleteTextures(1, &map.Texture);
+        glDeleteFramebuffers(1, &map.FBO);
+        map = {};
+    }
 }
 
 void Renderer::SetFog(vec4 fogColor, float forNear, float fogFar)
@@ -223,120 +314,1020 @@ void Renderer::SetFog(vec4 fogColor, float forNear, float fogFar)
     m_cameraData->bee_FogColor = fogColor;
 }
 
-void Renderer::CreateShadowMaps()
+void Renderer::CreateShadowMap(int light)
 {
-    for (int i = 0; i < m_max_dir_lights; i++)
-    {
-        const int size = m_shadowResolution;
+    static_assert(c_shadowCascades == MAX_SHADOW_CASCADES, "The cascades of a shadow map are in uniforms.glsl");
 
-        // Shadows being made
-        glGenFramebuffers(1, &m_shadowFBOs[i]);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_shadowFBOs[i]);
-        LabelGL(GL_FRAMEBUFFER, m_shadowFBOs[i], ("[R] Shadow Map FBO" + to_string(i)).c_str());
+    auto& map = m_shadowMaps[light];
+    const int size = m_shadowResolution;
 
-        glGenTextures(1, &m_shadowMaps[i]);
-        glBindTexture(GL_TEXTURE_2D, m_shadowMaps[i]);
-        LabelGL(GL_TEXTURE, m_shadowMaps[i], ("[R] Shadow Map" + to_string(i)).c_str());
+    // Shadows being made
+    glGenFramebuffers(1, &map.FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, map.FBO);
+    LabelGL(GL_FRAMEBUFFER, map.FBO, ("[R] Shadow Map FBO" + to_string(light)).c_str());
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glGenTextures(1, &map.Texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, map.Texture);
+    LabelGL(GL_TEXTURE, map.Texture, ("[R] Shadow Map" + to_string(light)).c_str());
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY,
+                 0,
+                 GL_DEPTH_COMPONENT32,
+                 size,
+                 size,
+                 c_shadowCascades,
+                 0,
+                 GL_DEPTH_COMPONENT,
+                 GL_FLOAT,
+                 nullptr);
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
 
-        float borderColor[] = {1.0, 1.0, 1.0, 1.0};
-        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
 
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_shadowMaps[i], 0);
+    float borderColor[] = {1.0, 1.0, 1.0, 1.0};
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
 
-        // Check that our framebuffer is OK
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) assert(false);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, map.Texture, 0, 0);
 
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    }
+    // Check that our framebuffer is OK
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) assert(false);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void Renderer::RenderShadowMaps()
+void Renderer::RenderShadowMaps(const FramePacket& packet)
 {
     BEE_PROFILE_FUNCTION();
-    int i = 0;
-    for (const auto& [lightEntity, lightTransform, light] : Engine.ECS().Registry.view<Transform, Light>().each())
+
+    int light = 0;
+    for (const auto& [l, lightWorld] : packet.Lights)
     {
-        if (light.Type == Light::Type::Directional && i < m_max_dir_lights && light.CastShadows && light.ShadowExtent > 0)
+        if (l.Type != Light::Type::Directional || light >= m_max_dir_lights) continue;
+        auto& map = m_shadowMaps[light];
+        fill(begin(map.Splits), end(map.Splits), 0.0f);
+        if (!l.CastShadows || l.ShadowDistance <= 0.0f || packet.Views.empty())
         {
-            glViewport(0, 0, m_shadowResolution, m_shadowResolution);
-            glBindFramebuffer(GL_FRAMEBUFFER, m_shadowFBOs[i]);
-            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-            glClear(GL_DEPTH_BUFFER_BIT);
-            glEnable(GL_CULL_FACE);
-            glEnable(GL_DEPTH_TEST);
+            light++;
+            continue;
+        }
+        if (map.Texture == 0) CreateShadowMap(light);
 
-            m_shadowPass->Activate();
-            const float size = light.ShadowExtent;
-            const mat4& projection = ortho(size * -0.5f, size * 0.5f, size * -0.5f, size * 0.5f, size * -0.5f, size * 0.5f);
-            const mat4& view = inverse(lightTransform.World());
-            const mat4& vp = projection * view;
+        // The cascades follow the first view
+        const auto& view = packet.Views.front();
+        ComputeCascadeSplits(view.Projection, l.ShadowDistance, c_cascadeSplitLambda, c_shadowCascades, map.Splits);
 
-            m_currentMesh.reset();
-            int instances = 0;
+        // Static meshes are extracted again whenever one of them changes, see ExtractStaticMeshes
+        const bool staticMeshesChanged = map.StaticMeshes.expired() || map.StaticMeshes.lock() != packet.StaticMeshes;
+        const mat4 lightView = GetLightView(lightWorld);
 
-            for (const auto& [entity, renderer, transform] : Engine.ECS().Registry.view<MeshRenderer, Transform>().each())
+        glViewport(0, 0, m_shadowResolution, m_shadowResolution);
+        glBindFramebuffer(GL_FRAMEBUFFER, map.FBO);
+        glEnable(GL_CULL_FACE);
+        glEnable(GL_DEPTH_TEST);
+        m_shadowPass->Activate();
+
+        for (int cascade = 0; cascade < c_shadowCascades; cascade++)
+        {
+            // The first slice starts at the eye, which is a little more than it needs
+            const float sliceNear = cascade == 0 ? 0.0f : map.Splits[cascade - 1];
+            const auto [center, radius] = GetFrustumSliceSphere(view.View, view.Projection, sliceNear, map.Splits[cascade]);
+            auto& fit = map.Cascades[cascade];
+
+            const bool cached = cascade >= c_firstCachedCascade;
+            if (cached && map.Cached[cascade] && !staticMeshesChanged && fit.View == lightView &&
+                fit.Covers(center, radius) && fit.HalfSize < radius * c_cachedCascadeMargin * 2.0f)
             {
-                // Check if end of batch is reached
-                if (m_currentMesh != renderer.Mesh || instances > MAX_TRANSFORM_INSTANCES - 1)
-                {
-                    // Check if batch is valid
-                    if (m_currentMesh && instances > 0) RenderCurrentInstances(instances);
-
-                    // Start with a new batch
-                    m_currentMesh = renderer.Mesh;
-                    instances = 0;
-                }
-
-                // Always fill in the information for this object
-                const mat4& world = transform.World();
-                m_transformsData->bee_transforms[instances].wvp = vp * world;
-                instances++;
+#ifdef BEE_INSPECTOR
+                m_shadowCascadesCached++;
+#endif
+                continue;
             }
 
-            // Render last buffer
-            if (instances > 0) RenderCurrentInstances(instances);
+            // Cached cascades get some room, so that they can be used while the view moves
+            fit = FitShadowCascade(lightWorld, center, cached ? radius * c_cachedCascadeMargin : radius, m_shadowResolution);
+            RenderShadowCascade(packet, light, cascade, cached);
+            map.Cached[cascade] = cached;
+        }
+        map.StaticMeshes = packet.StaticMeshes;
 
-            BEE_DEBUG_ONLY(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        BEE_DEBUG_ONLY(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        light++;
+    }
+}
+
+void Renderer::RenderShadowCascade(const FramePacket& packet, int light, int cascade, bool staticOnly)
+{
+    auto& map = m_shadowMaps[light];
+    auto& fit = map.Cascades[cascade];
+
+    // Everything between the light and the far side of the cascade can cast a shadow into it
+    ScratchScope scratch;
+    auto* visible = scratch.GetArena().Allocate<uint8_t>(packet.GetMeshCount());
+    size_t numVisible = packet.Cull(fit.GetCasterFrustum(), visible);
+
+    // Move the near plane to the casters, so that the depth range is as small as it can be
+    const size_t numStatic = packet.StaticMeshes ? packet.StaticMeshes->Meshes.size() : 0;
+    for (size_t i = 0; i < packet.GetMeshCount(); i++)
+    {
+        if (!visible[i]) continue;
+        if (staticOnly && i >= numStatic)
+        {
+            visible[i] = 0;
+            numVisible--;
+            continue;
         }
-        ++i;
+        const auto [min, max] = packet.GetBounds(i);
+        fit.IncludeCaster(min, max);
     }
+#ifdef BEE_INSPECTOR
+    m_shadowCasters += static_cast<int>(numVisible);
+    m_shadowCascadesDrawn++;
+#endif
+
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, map.Texture, 0, cascade);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    // Depth only, so only the mesh matters for batching, and all of it is one multi-draw call. Casters use the levels
+    // of detail of the first view, so that they match what the view shows.
+    const vec3 eye = vec3(transpose(fit.View) * vec4(fit.Center, fit.MaxZ, 1.0f));
+    BuildDrawList(packet, visible, numVisible, DrawKey::Pass::Shadow, eye, m_lods[0], m_drawList);
+    DrawIndirect(packet, m_drawList, fit.GetViewProjection(), false);
+}
+
+void Renderer::UploadLightClusters()
+{
+    static_assert(LightClusters::c_tilesX == CLUSTER_TILES_X && LightClusters::c_tilesY == CLUSTER_TILES_Y &&
+                      LightClusters::c_slices == CLUSTER_SLICES,
+                  "The cluster grid is in uniforms.glsl");
+
+    const auto& clusters = m_lightClusters.GetClusters();
+    const auto& indices = m_lightClusters.GetLightIndices();
+    const size_t clustersSize = sizeof(LightClusters::Cluster) * clusters.size();
+    const size_t indicesSize = sizeof(uint32_t) * indices.size();
+
+    // Orphans the buffer of the previous view, which draws may still read
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_clustersSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+                 static_cast<GLsizeiptr>(clustersSize + std::max(indicesSize, sizeof(uint32_t))),
+                 nullptr,
+                 GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(clustersSize), clusters.data());
+    if (!indices.empty())
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                        static_cast<GLintptr>(clustersSize),
+                        static_cast<GLsizeiptr>(indicesSize),
+                        indices.data());
+    BEE_DEBUG_ONLY(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+
+#ifdef BEE_INSPECTOR
+    m_maxClusterLights = std::max(m_maxClusterLights, static_cast<int>(m_lightClusters.GetMaxClusterLights()));
+#endif
 }
 
 void Renderer::DeleteUBOs()
 {
     glDeleteBuffers(1, &m_cameraUBO);
     glDeleteBuffers(1, &m_dirLightsUBO);
-    glDeleteBuffers(1, &m_pointLightsUBO);
-    glDeleteBuffers(1, &m_transformsUBO);
+    glDeleteBuffers(1, &m_pointLightsSSBO);
+    glDeleteBuffers(1, &m_clustersSSBO);
+    m_instances.reset();
+    m_indirectCommands.reset();
+    m_drawMaterials.reset();
+    m_particles.reset();
+    m_meshArena.reset();
+    glDeleteVertexArrays(1, &m_particleVAO);
+    glDeleteVertexArrays(1, &m_skidMarkVAO);
+    glDeleteBuffers(1, &m_skidMarkVBO);
+    glDeleteBuffers(1, &m_skidMarkIBO);
 }
 
 void Renderer::SetAlphaBlending2D(bool value) { m_useAlphaBlending = value; }
+
+void Renderer::SetDynamicResolution(bool value)
+{
+    m_dynamicResolutionEnabled = value;
+    m_dynamicResolution.Reset();  // the frame buffers follow in the next frame, see UpdateResolution
+}
 void Renderer::SetVignette(float value) { m_vignette = glm::clamp<float>(value, 0.f, 1.f); }
 
-void Renderer::Render()
+void Renderer::SetVertexQuantization(bool value)
+{
+    if (m_meshArena->IsQuantized() != value) m_meshArena = make_unique<MeshArena>(value);
+}
+
+void Renderer::Extract()
+{
+    BEE_PROFILE_FUNCTION();
+
+    auto& packet = m_packets[Engine.GetFrameIndex() % 2];
+    packet.Clear();
+
+    for (const auto& [entity, light, transform] : Engine.ECS().Registry.view<Light, Transform>().each())
+        packet.Lights.push_back({light, transform.World()});
+
+    for (const auto& [entity, camera, transform] : Engine.ECS().Registry.view<Camera, Transform>().each())
+        packet.Views.push_back(
+            {inverse(transform.World()), camera.Projection, transform.GetTranslation(), camera.Viewport});
+
+    if (m_useAlphaBlending)
+    {
+        // Everything is sorted back to front below, so static meshes cannot be kept apart
+        for (const auto& [entity, renderer, transform] : Engine.ECS().Registry.view<MeshRenderer, Transform>().each())
+            packet.Meshes.push_back({renderer.Mesh, renderer.Material, transform.World()});
+    }
+    else
+    {
+        ExtractStaticMeshes(packet);
+        const auto& view = Engine.ECS().Registry.view<MeshRenderer, Transform>(entt::exclude<Static>);
+        for (const auto& [entity, renderer, transform] : view.each())
+            packet.Meshes.push_back({renderer.Mesh, renderer.Material, transform.World()});
+    }
+
+    if (m_useAlphaBlending)
+    {
+        // Sort the objects by z value. Sorts small keys in scratch memory and then moves every instance once, instead of
+        // shuffling the instances around (and std::stable_sort allocating a buffer every frame).
+        struct SortKey
+        {
+            vec3 Position;
+            uint32_t Index;
+        };
+
+        ScratchScope scratch;
+        std::pmr::vector<SortKey> keys(&scratch.GetArena());
+        keys.reserve(packet.Meshes.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(packet.Meshes.size()); i++)
+            keys.push_back({vec3(packet.Meshes[i].World[3]), i});
+
+        std::sort(keys.begin(),
+                  keys.end(),
+                  [](const SortKey& k1, const SortKey& k2)
+                  {
+                      const vec3& t1 = k1.Position;
+                      const vec3& t2 = k2.Position;
+                      if (t1.z == t2.z)
+                      {
+                          if (t1.y == t2.y)
+                          {
+                              if (t1.x == t2.x) return k1.Index < k2.Index;  // keep it stable
+                              return t1.x < t2.x;
+                          }
+                          return t1.y < t2.y;
+                      }
+                      return t1.z < t2.z;
+                  });
+
+        std::pmr::vector<FramePacket::MeshInstance> sorted(&scratch.GetArena());
+        sorted.reserve(keys.size());
+        for (const auto& key : keys) sorted.push_back(std::move(packet.Meshes[key.Index]));
+        std::move(sorted.begin(), sorted.end(), packet.Meshes.begin());
+    }
+
+    ComputeBounds(packet.Meshes, packet.Bounds);
+
+    const auto particleSystems = Engine.ECS().GetSystems<ParticleSystem>();
+    if (!particleSystems.empty()) ExtractParticles(*particleSystems.front(), packet.Particles);
+
+    const auto skidMarkSystems = Engine.ECS().GetSystems<SkidMarkSystem>();
+    if (!skidMarkSystems.empty())
+    {
+        // Lowering the frame latency skips the packet that was extracted last, so the next one takes the whole ring
+        const bool all = m_skidMarkLatency != Engine.GetFrameLatency();
+        m_skidMarkLatency = Engine.GetFrameLatency();
+        ExtractSkidMarks(*skidMarkSystems.front(), all, packet.SkidMarks);
+    }
+}
+
+void Renderer::ExtractStaticMeshes(FramePacket& packet)
+{
+    if (m_staticMeshesDirty.exchange(false) || !m_staticMeshes)
+    {
+        auto list = std::make_shared<FramePacket::MeshList>();
+        auto& meshes = list->Meshes;
+        meshes = m_staticBatches;
+        for (const auto& [entity, renderer, transform] :
+             Engine.ECS().Registry.view<MeshRenderer, Transform, Static>(entt::exclude<StaticBatched>).each())
+            meshes.push_back({renderer.Mesh, renderer.Material, transform.World()});
+        ComputeBounds(meshes, list->Bounds);
+        list->Tree.Build(list->Bounds);
+
+        // The packet that is being submitted may still use the old meshes, let this packet release them
+        packet.RetiredStaticMeshes = std::move(m_staticMeshes);
+        m_staticMeshes = std::move(list);
+    }
+
+    packet.StaticMeshes = m_staticMeshes;
+}
+
+void Renderer::BakeStaticGeometry(float chunkSize)
+{
+    BEE_PROFILE_FUNCTION();
+
+    auto& registry = Engine.ECS().Registry;
+    registry.clear<StaticBatched>();
+
+    // Materials are referred to by index, so that the merge step does not depend on the graphics backend
+    vector<shared_ptr<Material>> materials;
+    unordered_map<const Material*, uint32_t> materialIndices;
+    vector<StaticBatchSource> sources;
+    vector<Entity> entities;
+    for (const auto& [entity, renderer, transform] : registry.view<MeshRenderer, Transform, Static>().each())
+    {
+        if (!renderer.Mesh || !renderer.Material || renderer.Mesh->GetData().IsEmpty()) continue;
+
+        const auto [it, inserted] =
+            materialIndices.try_emplace(renderer.Material.get(), static_cast<uint32_t>(materials.size()));
+        if (inserted) materials.push_back(renderer.Material);
+        sources.push_back({&renderer.Mesh->GetData(), transform.World(), it->second});
+        entities.push_back(entity);
+    }
+
+    const auto batches = BuildStaticBatches(sources, chunkSize);
+
+    // Packets that are still in flight keep the old batches alive through their static meshes
+    m_staticBatches.clear();
+    for (const auto& batch : batches)
+    {
+        auto mesh = make_shared<Mesh>();
+        mesh->SetData(batch.Data);
+        m_staticBatches.push_back({std::move(mesh), materials[batch.Material], mat4(1.0f)});
+    }
+
+    for (const auto entity : entities) registry.emplace<StaticBatched>(entity);
+    m_staticBatchedMeshes = entities.size();
+    m_staticMeshesDirty = true;
+
+    Log::Info("Baked {} static meshes into {} batches", entities.size(), batches.size());
+}
+
+void Renderer::OnStaticEntityChanged(entt::registry&, Entity) { m_staticMeshesDirty = true; }
+
+void Renderer::OnComponentChanged(entt::registry& registry, Entity entity)
+{
+    if (registry.all_of<Static>(entity)) m_staticMeshesDirty = true;
+}
+
+void Renderer::SelectLods(const FramePacket& packet)
+{
+    BEE_PROFILE_FUNCTION();
+
+    const size_t count = packet.GetMeshCount();
+    m_lods.resize(std::max<size_t>(packet.Views.size(), 1));
+    for (auto& lods : m_lods) lods.resize(count);
+
+    for (size_t v = 0; v < packet.Views.size(); v++)
+    {
+        const auto& view = packet.Views[v];
+        auto& lods = m_lods[v];
+        const auto select = [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                // Another mesh in this place, when entities were created or destroyed, starts without hysteresis
+                const auto& object = packet.GetMesh(i);
+                auto& state = lods[i];
+                const int previous = state.Mesh == object.Mesh.get() ? state.Lod : 0;
+
+                const auto [min, max] = packet.GetBounds(i);
+                const float size = GetScreenSize(view.View, view.Projection, (min + max) * 0.5f, length(max - min) * 0.5f);
+                const int lod = SelectLod(size, previous, object.Mesh->GetData().GetLodCount());
+                state = {object.Mesh.get(), static_cast<uint8_t>(lod)};
+            }
+        };
+        Engine.JobSystem().ParallelFor(count, 1024, select);
+    }
+}
+
+void Renderer::BuildSharedKeys(const FramePacket& packet)
+{
+    BEE_PROFILE_FUNCTION();
+
+    // Texture sets are numbered in the order they are found, once per material
+    const size_t count = packet.GetMeshCount();
+    const uint32_t unassigned = c_invalid_index;
+    m_textureSetIds.clear();
+    fill(m_textureSets.begin(), m_textureSets.end(), unassigned);
+    for (size_t i = 0; i < count; i++)
+    {
+        const Material& material = *packet.GetMesh(i).Material;
+        const uint32_t id = material.Id.Get();
+        if (id >= m_textureSets.size()) m_textureSets.resize(id + 1, unassigned);
+        if (m_textureSets[id] == unassigned) m_textureSets[id] = GetTextureSet(material);
+    }
+
+    // Texture sets take the place of shaders, there is only one. Sets beyond the range of the field wrap around, which
+    // only splits multi-draw calls.
+    m_sharedKeys.resize(count);
+    const auto buildKeys = [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            const auto& object = packet.GetMesh(i);
+            const uint32_t material = object.Material->Id.Get();
+            const uint32_t textures = m_textureSets[material] % DrawKey::c_maxShaders;
+            m_sharedKeys[i] = DrawKey::MakeShared(DrawKey::Pass::Opaque, textures, material, object.Mesh->GetId());
+        }
+    };
+    Engine.JobSystem().ParallelFor(count, 1024, buildKeys);
+}
+
+void Renderer::CullViews(const FramePacket& packet)
+{
+    BEE_PROFILE_FUNCTION();
+#ifdef BEE_INSPECTOR
+    const auto start = chrono::steady_clock::now();
+#endif
+
+    // Every view culls and sorts on a job of its own, which spread their own work over the job system as well
+    m_views.resize(packet.Views.size());
+    Engine.JobSystem().ParallelFor(packet.Views.size(),
+                                   1,
+                                   [&](size_t first, size_t last)
+                                   {
+                                       for (size_t v = first; v < last; v++) CullView(packet, v);
+                                   });
+
+#ifdef BEE_INSPECTOR
+    m_cullTime = chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+#endif
+}
+
+void Renderer::CullView(const FramePacket& packet, size_t view)
+{
+    const auto& instance = packet.Views[view];
+    auto& state = m_views[view];
+    state.Visible = Engine.FrameArena().Allocate<uint8_t>(packet.GetMeshCount());
+    state.NumVisible = packet.Cull(Frustum::FromMatrix(instance.Projection * instance.View), state.Visible);
+#ifdef BEE_INSPECTOR
+    state.OccluderMeshes = 0;
+    state.OccluderTriangles = 0;
+    state.OccludedMeshes = 0;
+    state.OcclusionTime = 0.0f;
+#endif
+    if (m_occlusionCulling && !m_useAlphaBlending) state.NumVisible -= CullOccluded(packet, instance, state);
+
+    // Blended particles go back to front, their key only holds the depth
+    state.Particles.resize(packet.Particles.size());
+    for (size_t b = 0; b < packet.Particles.size(); b++)
+    {
+        const auto& batch = packet.Particles[b];
+        auto& order = state.Particles[b];
+        order.Clear();
+        if (!batch.AlphaBlended) continue;
+
+        order.Resize(batch.Instances.size());
+        for (size_t i = 0; i < batch.Instances.size(); i++)
+        {
+            const vec3 offset = batch.Instances[i].Position - instance.Position;
+            const uint32_t depth = DrawKey::c_maxDepth - DrawKey::QuantizeDepth(dot(offset, offset));
+            order[i].Key = DrawKey::MakeOrdered(DrawKey::Pass::Blended, depth, 0, 0, 0, 0);
+            order[i].Index = static_cast<uint32_t>(i);
+        }
+        order.Sort();
+    }
+
+    // 2D games draw in the order of extraction, which is sorted back to front
+    BuildDrawList(packet,
+                  state.Visible,
+                  state.NumVisible,
+                  m_useAlphaBlending ? DrawKey::Pass::Blended : DrawKey::Pass::Opaque,
+                  instance.Position,
+                  m_lods[view],
+                  state.Draws);
+}
+
+size_t Renderer::CullOccluded(const FramePacket& packet, const FramePacket::ViewInstance& view, ViewState& state) const
+{
+    BEE_PROFILE_FUNCTION();
+#ifdef BEE_INSPECTOR
+    const auto start = chrono::steady_clock::now();
+#endif
+
+    // The meshes that are largest on screen hide the most
+    const uint8_t* visible = state.Visible;
+    auto& occluders = state.Occluders;
+    auto& culler = state.Occlusion;
+    occluders.clear();
+    for (size_t i = 0; i < packet.GetMeshCount(); i++)
+    {
+        if (!visible[i]) continue;
+        const auto [min, max] = packet.GetBounds(i);
+        const float size = GetScreenSize(view.View, view.Projection, (min + max) * 0.5f, length(max - min) * 0.5f);
+        if (size >= c_minOccluderSize) occluders.emplace_back(size, static_cast<uint32_t>(i));
+    }
+    sort(occluders.begin(),
+         occluders.end(),
+         [](const auto& a, const auto& b) { return a.first > b.first || (a.first == b.first && a.second < b.second); });
+
+    culler.SetView(view.Projection * view.View);
+    size_t triangles = 0;
+    for (const auto& [size, i] : occluders)
+    {
+        const auto& object = packet.GetMesh(i);
+        const MeshData& data = object.Mesh->GetData();
+        const auto& indices = data.GetLodIndices(data.GetLodCount() - 1);
+        if (triangles + indices.size() / 3 > c_maxOccluderTriangles) continue;
+        triangles += indices.size() / 3;
+        culler.AddOccluder(data.Positions, indices, object.World);
+    }
+
+    atomic<size_t> culled{0};
+    if (culler.GetOccluderCount() > 0)
+    {
+        auto& jobs = Engine.JobSystem();
+        jobs.ParallelFor(culler.GetOccluderCount(),
+                         1,
+                         [&culler](size_t first, size_t last) { culler.SetupOccluders(first, last); });
+        jobs.ParallelFor(OcclusionCuller::c_bands,
+                         1,
+                         [&culler](size_t first, size_t last) { culler.RasterizeBands(first, last); });
+        culler.BuildHierarchy();
+
+        jobs.ParallelFor(packet.GetMeshCount(),
+                         256,
+                         [&](size_t first, size_t last)
+                         {
+                             size_t count = 0;
+                             for (size_t i = first; i < last; i++)
+                             {
+                                 if (!visible[i]) continue;
+                                 const auto [min, max] = packet.GetBounds(i);
+                                 if (!culler.IsOccluded(min, max)) continue;
+                                 state.Visible[i] = 0;
+                                 count++;
+                             }
+                             culled += count;
+                         });
+    }
+
+#ifdef BEE_INSPECTOR
+    state.OccluderMeshes = static_cast<int>(culler.GetOccluderCount());
+    state.OccluderTriangles = static_cast<int>(culler.GetTriangleCount());
+    state.OccludedMeshes = static_cast<int>(culled);
+    state.OcclusionTime = chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+#endif
+    return culled;
+}
+
+void Renderer::BuildDrawList(const FramePacket& packet,
+                             const uint8_t* visible,
+                             size_t numVisible,
+                             DrawKey::Pass pass,
+                             const vec3& eye,
+                             const vector<LodState>& lods,
+                             DrawList& drawList) const
+{
+    BEE_PROFILE_FUNCTION();
+
+    ScratchScope scratch;
+    auto* indices = scratch.GetArena().Allocate<uint32_t>(numVisible);
+    size_t count = 0;
+    for (size_t i = 0; i < packet.GetMeshCount(); i++)
+        if (visible[i]) indices[count++] = static_cast<uint32_t>(i);
+    assert(count == numVisible);
+
+    // Every key only depends on its own mesh, so they are built in parallel
+    const auto buildKeys = [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            const uint32_t index = indices[i];
+            const auto& object = packet.GetMesh(index);
+            const uint32_t mesh = object.Mesh->GetId();
+            const uint32_t lod = lods[index].Lod;
+            const uint32_t material = pass == DrawKey::Pass::Shadow ? 0 : object.Material->Id.Get();
+
+            // Blended meshes keep their extracted order, all others go front to back. Only shadows ignore materials,
+            // opaque meshes add the view to their shared key.
+            uint64_t key = 0;
+            const vec3 offset = vec3(object.World[3]) - eye;
+            const uint32_t depth = DrawKey::QuantizeDepth(dot(offset, offset));
+            if (pass == DrawKey::Pass::Blended)
+            {
+                const uint32_t textures = m_textureSets[material] % DrawKey::c_maxShaders;
+                key = DrawKey::MakeOrdered(pass, index, textures, material, mesh, lod);
+            }
+            else if (pass == DrawKey::Pass::Opaque)
+            {
+                key = DrawKey::AddView(m_sharedKeys[index], lod, depth);
+            }
+            else
+            {
+                key = DrawKey::Make(pass, 0, 0, mesh, lod, depth);
+            }
+            drawList[i] = {key,
+                             index,
+                             static_cast<uint16_t>(material),
+                             static_cast<uint16_t>(mesh),
+                             static_cast<uint8_t>(lod)};
+        }
+    };
+    drawList.Resize(count);
+    Engine.JobSystem().ParallelFor(count, 1024, buildKeys);
+
+    drawList.Sort();
+}
+
+uint32_t Renderer::GetTextureSet(const Material& material)
+{
+    // Only the textures that shaders sample, the others may be anything
+    const array<const Texture*, 5> textures = {
+        material.UseBaseTexture ? material.BaseColorTexture.get() : nullptr,
+        material.UseNormalTexture ? material.NormalTexture.get() : nullptr,
+        material.UseMetallicRoughnessTexture ? material.MetallicRoughnessTexture.get() : nullptr,
+        material.UseOcclusionTexture ? material.OcclusionTexture.get() : nullptr,
+        material.UseEmissiveTexture ? material.EmissiveTexture.get() : nullptr,
+    };
+    return m_textureSetIds.try_emplace(textures, static_cast<uint32_t>(m_textureSetIds.size())).first->second;
+}
+
+void Renderer::DrawIndirect(const FramePacket& packet, const DrawList& drawList, const mat4& viewProjection, bool shade)
+{
+    BEE_PROFILE_FUNCTION();
+    const size_t count = drawList.Size();
+    if (count == 0) return;
+
+    // Copying meshes into the arena calls GL, so it happens here and recording only reads the ranges
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i == 0 || drawList[i].Mesh != drawList[i - 1].Mesh) m_meshArena->Add(packet.GetMesh(drawList[i].Index).Mesh);
+    }
+
+    // The instances of all commands are written once, in draw order. They are reserved up front, so that the slices
+    // know their base instance and write straight into the mapped buffer.
+    uint32_t firstInstance = 0;
+    auto* transforms = m_instances->Allocate<transform_struct>(count, firstInstance);
+
+    // Every slice of the draw list is recorded into a command buffer of its own, on the job system
+    const size_t slices = std::min(static_cast<size_t>(Engine.JobSystem().GetMaxConcurrency()),
+                                   (count + c_minDrawsPerCommandBuffer - 1) / c_minDrawsPerCommandBuffer);
+    if (m_commandBuffers.size() < slices)
+    {
+        m_commandBuffers.resize(slices);
+        m_sliceCommands.resize(slices);
+    }
+
+    const auto record = [&](size_t first, size_t last)
+    {
+        for (size_t slice = first; slice < last; slice++)
+        {
+            const size_t begin = count * slice / slices;
+            const size_t end = count * (slice + 1) / slices;
+            for (size_t i = begin; i < end; i++)
+            {
+                const mat4& world = packet.GetMesh(drawList[i].Index).World;
+                transforms[i].world = world;
+                transforms[i].wvp = viewProjection * world;
+            }
+            RecordDraws(packet,
+                        drawList,
+                        begin,
+                        end,
+                        firstInstance,
+                        shade,
+                        m_commandBuffers[slice],
+                        m_sliceCommands[slice]);
+        }
+    };
+    Engine.JobSystem().ParallelFor(slices, 1, record);
+
+    glBindVertexArray(m_meshArena->GetVAO());
+    for (size_t slice = 0; slice < slices; slice++) ReplayCommands(m_commandBuffers[slice]);
+    BEE_DEBUG_ONLY(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+
+#ifdef BEE_INSPECTOR
+    m_drawInstances += static_cast<int>(count);
+    m_commandBuffersRecorded += static_cast<int>(slices);
+#endif
+}
+
+void Renderer::RecordDraws(const FramePacket& packet,
+                           const DrawList& drawList,
+                           size_t begin,
+                           size_t end,
+                           uint32_t firstInstance,
+                           bool shade,
+                           CommandBuffer& buffer,
+                           IndirectCommands& commands) const
+{
+    buffer.Clear();
+    const vector<uint32_t> oneBucket;
+    BuildIndirectCommands(drawList,
+                          begin,
+                          end,
+                          firstInstance,
+                          m_meshArena->GetRanges(),
+                          shade ? m_textureSets : oneBucket,
+                          commands);
+
+    const size_t numCommands = commands.Commands.size();
+    auto* indirect = buffer.Upload<DrawElementsIndirectCommand>(c_indirectCommandsTarget, numCommands);
+    copy(commands.Commands.begin(), commands.Commands.end(), indirect);
+
+    // Everything of a material but its textures is read per draw
+    if (shade)
+    {
+        auto* materials = buffer.Upload<material_struct>(c_drawMaterialsTarget, numCommands);
+        for (size_t c = 0; c < numCommands; c++)
+        {
+            const Material& material = *packet.GetMesh(drawList[commands.FirstDraws[c]].Index).Material;
+            auto& data = materials[c];
+            data.base_color_factor = material.BaseColorFactor;
+            data.metallic_factor = material.MetallicFactor;
+            data.roughness_factor = material.RoughnessFactor;
+            data.flags = (material.UseBaseTexture ? MATERIAL_BASE_TEXTURE : 0) |
+                         (material.UseMetallicRoughnessTexture ? MATERIAL_METALLIC_ROUGHNESS_TEXTURE : 0) |
+                         (material.UseEmissiveTexture ? MATERIAL_EMISSIVE_TEXTURE : 0) |
+                         (material.UseNormalTexture ? MATERIAL_NORMAL_TEXTURE : 0) |
+                         (material.UseOcclusionTexture ? MATERIAL_OCCLUSION_TEXTURE : 0) |
+                         (material.IsUnlit ? MATERIAL_UNLIT : 0) | (material.ReceiveShadows ? MATERIAL_RECEIVE_SHADOWS : 0);
+        }
+    }
+
+    for (const auto& bucket : commands.Buckets)
+    {
+        if (shade)
+        {
+            const auto& material = packet.GetMesh(drawList[commands.FirstDraws[bucket.FirstCommand]].Index).Material;
+            buffer.Bind(c_materialTarget, material.get());
+        }
+        buffer.Draw(c_indirectCommandsTarget, bucket.FirstCommand, bucket.CommandCount);
+    }
+}
+
+void Renderer::ReplayCommands(const CommandBuffer& buffer)
+{
+    // Where the last uploads of the buffer ended up, in elements from the start of their persistent buffer
+    uint32_t firstCommand = 0;
+    uint32_t firstMaterial = 0;
+    bool hasMaterials = false;
+
+    for (const auto& command : buffer.GetCommands())
+    {
+        switch (command.Type)
+        {
+            case CommandBuffer::Type::Bind:
+                assert(command.Target == c_materialTarget);
+                ApplyMaterial(*static_cast<const Material*>(command.Object));
+                break;
+
+            case CommandBuffer::Type::Upload:
+            {
+                const bool isMaterials = command.Target == c_drawMaterialsTarget;
+                auto& target = isMaterials ? *m_drawMaterials : *m_indirectCommands;
+                const size_t stride = isMaterials ? sizeof(material_struct) : sizeof(DrawElementsIndirectCommand);
+                size_t offset = 0;
+                void* data = target.Allocate(command.Count, stride, offset);
+                memcpy(data, buffer.GetData(command), command.Count);
+                (isMaterials ? firstMaterial : firstCommand) = static_cast<uint32_t>(offset / stride);
+                hasMaterials |= isMaterials;
+
+                // Allocating may have replaced the buffer with a larger one
+                if (!isMaterials) glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectCommands->GetBuffer());
+                break;
+            }
+
+            case CommandBuffer::Type::Draw:
+            {
+                assert(command.Target == c_indirectCommandsTarget);
+                if (hasMaterials)
+                    m_forwardPass->GetParameter("u_draw_offset")->SetValue(static_cast<int>(firstMaterial + command.First));
+
+                const size_t offset = (firstCommand + command.First) * sizeof(DrawElementsIndirectCommand);
+                glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                            GL_UNSIGNED_INT,
+                                            reinterpret_cast<const void*>(offset),
+                                            static_cast<GLsizei>(command.Count),
+                                            0);
+#ifdef BEE_INSPECTOR
+                m_drawCalls++;
+#endif
+                break;
+            }
+        }
+    }
+}
+
+void Renderer::DrawParticles(const FramePacket& packet, const ViewState& state)
+{
+    BEE_PROFILE_FUNCTION();
+
+    bool active = false;
+    for (size_t b = 0; b < packet.Particles.size(); b++)
+    {
+        const auto& batch = packet.Particles[b];
+        const size_t count = batch.Instances.size();
+        if (count == 0) continue;
+
+        if (!active)
+        {
+            // Particles never hide each other, and their quads have no back side
+            m_particlePass->Activate();
+            glBindVertexArray(m_particleVAO);
+            glDepthMask(GL_FALSE);
+            glDisable(GL_CULL_FACE);
+            glEnable(GL_BLEND);
+            active = true;
+        }
+
+        uint32_t first = 0;
+        auto* particles = m_particles->Allocate<particle_struct>(count, first);
+        if (batch.AlphaBlended)
+        {
+            const auto& order = state.Particles[b];
+            Engine.JobSystem().ParallelFor(count,
+                                           ParticleSystem::c_simulateBatch,
+                                           [&](size_t begin, size_t end)
+                                           {
+                                               for (size_t i = begin; i < end; i++)
+                                                   memcpy(&particles[i],
+                                                          &batch.Instances[order[i].Index],
+                                                          sizeof(particle_struct));
+                                           });
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+        else
+        {
+            memcpy(particles, batch.Instances.data(), sizeof(particle_struct) * count);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        }
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(count), first);
+
+#ifdef BEE_INSPECTOR
+        m_drawCalls++;
+        m_particleInstances += static_cast<int>(count);
+#endif
+    }
+    if (!active) return;
+
+    // Back to the state of the mesh pass
+    glDepthMask(GL_TRUE);
+    glEnable(GL_CULL_FACE);
+    if (m_useAlphaBlending)
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    else
+        glDisable(GL_BLEND);
+    m_forwardPass->Activate();
+}
+
+void Renderer::UploadSkidMarks(const FramePacket& packet)
+{
+    BEE_PROFILE_FUNCTION();
+
+    const auto& skidMarks = packet.SkidMarks;
+    if (skidMarks.Capacity == 0) return;
+
+    if (skidMarks.Capacity != m_skidMarkCapacity)
+    {
+        // Slots that were never written are zero, which makes quads without area
+        m_skidMarkCapacity = skidMarks.Capacity;
+        const size_t vertices = static_cast<size_t>(m_skidMarkCapacity) * 4;
+        const vector<SkidMarkVertex> zero(vertices);
+        glBindBuffer(GL_ARRAY_BUFFER, m_skidMarkVBO);
+        glBufferData(GL_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(sizeof(SkidMarkVertex) * vertices),
+                     zero.data(),
+                     GL_DYNAMIC_DRAW);
+
+        // Two triangles per quad, the same in every frame
+        vector<uint32_t> indices;
+        indices.reserve(static_cast<size_t>(m_skidMarkCapacity) * 6);
+        for (uint32_t quad = 0; quad < m_skidMarkCapacity; quad++)
+        {
+            const uint32_t first = quad * 4;
+            for (const uint32_t corner : {0u, 1u, 2u, 2u, 1u, 3u}) indices.push_back(first + corner);
+        }
+        glBindVertexArray(m_skidMarkVAO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(sizeof(uint32_t) * indices.size()),
+                     indices.data(),
+                     GL_STATIC_DRAW);
+        glBindVertexArray(0);
+    }
+    if (skidMarks.Slots.empty()) return;
+
+    // Slots are ascending, so every run of neighbouring slots is one upload
+    glBindBuffer(GL_ARRAY_BUFFER, m_skidMarkVBO);
+    const auto& slots = skidMarks.Slots;
+    for (size_t begin = 0; begin < slots.size();)
+    {
+        size_t end = begin + 1;
+        while (end < slots.size() && slots[end] == slots[end - 1] + 1) end++;
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        static_cast<GLintptr>(sizeof(SkidMarkVertex) * 4 * slots[begin]),
+                        static_cast<GLsizeiptr>(sizeof(SkidMarkVertex) * 4 * (end - begin)),
+                        &skidMarks.Vertices[begin * 4]);
+        begin = end;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Renderer::DrawSkidMarks(const FramePacket& packet)
+{
+    BEE_PROFILE_FUNCTION();
+
+    const auto& skidMarks = packet.SkidMarks;
+    if (skidMarks.Capacity == 0 || skidMarks.Count == 0) return;
+
+    // Marks lie on the road, so they are pulled towards the camera a bit to win the depth test against it
+    m_skidMarkPass->Activate();
+    m_skidMarkPass->GetParameter("u_time")->SetValue(skidMarks.Time);
+    m_skidMarkPass->GetParameter("u_fade_time")->SetValue(skidMarks.FadeTime);
+    glBindVertexArray(m_skidMarkVAO);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(-1.0f, -1.0f);
+
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(skidMarks.Count) * 6, GL_UNSIGNED_INT, nullptr);
+
+#ifdef BEE_INSPECTOR
+    m_drawCalls++;
+    m_skidMarkQuads = static_cast<int>(skidMarks.Count);
+#endif
+
+    // Back to the state of the mesh pass
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_CULL_FACE);
+    if (!m_useAlphaBlending) glDisable(GL_BLEND);
+    glBindVertexArray(0);
+    m_forwardPass->Activate();
+}
+
+void Renderer::UpdateResolution()
+{
+    // Timer queries finish a few frames late, their times are read in the order they were begun
+    while (m_gpuTimersRead < m_gpuTimersBegun)
+    {
+        const unsigned int query = m_gpuTimers[m_gpuTimersRead % c_gpuTimers];
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+        m_gpuTime = static_cast<float>(nanoseconds) * 1e-6f;
+        m_gpuTimersRead++;
+        if (m_dynamicResolutionEnabled) m_dynamicResolution.AddFrame(m_gpuTime);
+    }
+
+    const float scale = m_dynamicResolution.GetScale();
+    if (GetScaledSize(m_width, scale) == m_renderWidth && GetScaledSize(m_height, scale) == m_renderHeight &&
+        m_dynamicResolution.GetSamples() == m_msaa)
+        return;
+    DeleteFrameBuffers();
+    CreateFrameBuffers();
+}
+
+void Renderer::Submit()
 {
 #ifdef BEE_INSPECTOR
     m_drawCalls = 0;
     m_drawInstances = 0;
+    m_materialChanges = 0;
+    m_shadowCasters = 0;
+    m_shadowCascadesDrawn = 0;
+    m_shadowCascadesCached = 0;
+    m_commandBuffersRecorded = 0;
+    fill(begin(m_lodInstances), end(m_lodInstances), 0);
+    m_occluderMeshes = 0;
+    m_occluderTriangles = 0;
+    m_occludedMeshes = 0;
+    m_occlusionTime = 0.0f;
+    m_particleInstances = 0;
+    m_skidMarkQuads = 0;
 #endif
 
     BEE_PROFILE_FUNCTION();
 
-    RenderShadowMaps();
+    UpdateResolution();
+    const bool timed = m_gpuTimersBegun - m_gpuTimersRead < c_gpuTimers;  // unless all queries are still in flight
+    if (timed) glBeginQuery(GL_TIME_ELAPSED, m_gpuTimers[m_gpuTimersBegun % c_gpuTimers]);
+
+    // With a frame latency of 1, the packet of the current frame is still being extracted
+    auto& packet = m_packets[(Engine.GetFrameIndex() - Engine.GetFrameLatency()) % 2];
+    m_instances->BeginFrame();
+    m_indirectCommands->BeginFrame();
+    m_drawMaterials->BeginFrame();
+    m_particles->BeginFrame();
+
+    SelectLods(packet);
+    BuildSharedKeys(packet);
+    RenderShadowMaps(packet);
+    CullViews(packet);
+    UploadSkidMarks(packet);
 
     glBindFramebuffer(GL_FRAMEBUFFER, m_msaaFramebuffer);
-    glViewport(0, 0, m_width, m_height);
+    glViewport(0, 0, m_renderWidth, m_renderHeight);
     glClearColor(0.35f, 0.55f, 0.9f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glEnable(GL_CULL_FACE);
@@ -354,42 +1345,61 @@ void Renderer::Render()
     }
 
     m_forwardPass->Activate();
-    vec2 resolution((float)m_width, (float)m_height);
+    vec2 resolution((float)m_renderWidth, (float)m_renderHeight);
     m_forwardPass->GetParameter("u_resolution")->SetValue(resolution);
     if (m_iblSpecularMipCount != -1) m_forwardPass->GetParameter("u_ibl_specular_mip_count")->SetValue(m_iblSpecularMipCount);
     m_forwardPass->GetParameter("use_alpha_blending")->SetValue(m_useAlphaBlending);
+#ifdef BEE_DEBUG
+    m_forwardPass->GetParameter("debug_base_color")->SetValue(m_debugData.BaseColor);
+    m_forwardPass->GetParameter("debug_normals")->SetValue(m_debugData.Normals);
+    m_forwardPass->GetParameter("debug_normal_map")->SetValue(m_debugData.NormalMap);
+    m_forwardPass->GetParameter("debug_metallic")->SetValue(m_debugData.Metallic);
+    m_forwardPass->GetParameter("debug_roughness")->SetValue(m_debugData.Roughness);
+    m_forwardPass->GetParameter("debug_emissive")->SetValue(m_debugData.Emissive);
+    m_forwardPass->GetParameter("debug_occlusion")->SetValue(m_debugData.Occlusion);
+#endif
+
+    // Point lights are uploaded once, and binned into the clusters of every view, see LightClusters
+    ScratchScope lightScratch;
+    const size_t maxPointLights = std::min(packet.Lights.size(), static_cast<size_t>(MAX_POINT_LIGHT_INSTANCES));
+    auto* pointLights = lightScratch.GetArena().Allocate<point_light_struct>(std::max<size_t>(maxPointLights, 1));
+    auto* pointLightBounds = lightScratch.GetArena().Allocate<vec4>(maxPointLights);
 
-    auto lights = Engine.ECS().Registry.view<Transform, Light>();
     int dirLightCount = 0;
     int pointLightCount = 0;
-    for (const auto& e : lights)
+    for (const auto& [l, world] : packet.Lights)
     {
-        const auto& l = lights.get<Light>(e);
-        auto& t = lights.get<Transform>(e);
         if (l.Type == Light::Type::Directional && dirLightCount < m_max_dir_lights)
         {
-            const float size = l.ShadowExtent;
-            const mat4 projection = ortho(size * -0.5f, size * 0.5f, size * -0.5f, size * 0.5f, size * -0.5f, size * 0.5f);
-            const mat4 view = inverse(t.World());
-            const mat4 vp = projection * view;
-
             auto& sl = m_dirLightsData->bee_directional_lights[dirLightCount];
             sl.color = l.Color;
             sl.intensity = l.Intensity;
-            sl.direction = t.World() * vec4(0.0f, 0.0f, 1.0f, 0.0f);
-            sl.shadow_matrix = vp;
+            sl.direction = world * vec4(0.0f, 0.0f, 1.0f, 0.0f);
+
+            // Move what is sampled a texel and a half towards the light, against shadow acne
+            const auto& map = m_shadowMaps[dirLightCount];
+            for (int c = 0; c < c_shadowCascades; c++)
+            {
+                const auto& fit = map.Cascades[c];
+                const float bias = 1.5f * fit.GetTexelSize(m_shadowResolution);
+                const float depthRange = std::max(fit.MaxZ - fit.MinZ, 1e-4f);
+                sl.shadow_matrices[c] = translate(mat4(1.0f), vec3(0.0f, 0.0f, -2.0f * bias / depthRange)) *
+                                        fit.GetViewProjection();
+                sl.cascade_splits[c] = map.Splits[c];
+            }
 
             if (dirLightCount++ > m_max_dir_lights) break;
         }
 
-        if (l.Type == Light::Type::Point)
+        if (l.Type == Light::Type::Point && pointLightCount < MAX_POINT_LIGHT_INSTANCES)
         {
-            auto& sl = m_pointLightsData->bee_point_lights[pointLightCount];
+            auto& sl = pointLights[pointLightCount];
             sl.color = l.Color;
             sl.intensity = l.Intensity;
-            sl.position = t.GetTranslation();
+            sl.position = world[3];
             sl.range = l.Range;
-            if (pointLightCount++ > MAX_POINT_LIGHT_INSTANCES) break;
+            pointLightBounds[pointLightCount] = vec4(sl.position, sl.range);
+            pointLightCount++;
         }
     }
 
@@ -397,7 +1407,7 @@ void Renderer::Render()
     {
         int sampler = SHADOWMAP_LOCATION + i;
         glActiveTexture(GL_TEXTURE0 + sampler);
-        glBindTexture(GL_TEXTURE_2D, m_shadowMaps[i]);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_shadowMaps[i].Texture);
         glUniform1i(sampler, sampler);
     }
 
@@ -405,104 +1415,121 @@ void Renderer::Render()
     glBufferData(GL_UNIFORM_BUFFER, sizeof(DirectionalLightsUBO), m_dirLightsData, GL_DYNAMIC_DRAW);
     BEE_DEBUG_ONLY(glBindBuffer(GL_UNIFORM_BUFFER, 0));
 
-    glBindBuffer(GL_UNIFORM_BUFFER, m_pointLightsUBO);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(PointLightsUBO), m_pointLightsData, GL_DYNAMIC_DRAW);
-    BEE_DEBUG_ONLY(glBindBuffer(GL_UNIFORM_BUFFER, 0));
-
-#pragma region OPTIMIZATION
-#if SORT_MESH_RENDERERS == TRUE
-    Engine.ECS().Registry.sort<MeshRenderer>(
-        [](const MeshRenderer& lhs, const MeshRenderer& rhs)
-        {
-            if (lhs.Material == rhs.Material) return lhs.Mesh.get() < rhs.Mesh.get();
-            return lhs.Material.get() < rhs.Material.get();
-        });
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_pointLightsSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+                 static_cast<GLsizeiptr>(sizeof(point_light_struct) * std::max(pointLightCount, 1)),
+                 pointLights,
+                 GL_DYNAMIC_DRAW);
+    BEE_DEBUG_ONLY(glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0));
+#ifdef BEE_INSPECTOR
+    m_pointLights = pointLightCount;
+    m_maxClusterLights = 0;
 #endif
-#pragma endregion
 
-    for (const auto& [e, camera, cameraTransform] : Engine.ECS().Registry.view<Camera, Transform>().each())
+    // The environment is the same for all materials
+    glActiveTexture(GL_TEXTURE0 + SPECULAR_SAMPER_LOCATION);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, m_specularIBL);
+    glUniform1i(SPECULAR_SAMPER_LOCATION, SPECULAR_SAMPER_LOCATION);
+
+    glActiveTexture(GL_TEXTURE0 + DIFFUSE_SAMPER_LOCATION);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, m_diffuseIBL);
+    glUniform1i(DIFFUSE_SAMPER_LOCATION, DIFFUSE_SAMPER_LOCATION);
+
+    glActiveTexture(GL_TEXTURE0 + LUT_SAMPER_LOCATION);
+    glBindTexture(GL_TEXTURE_2D, m_lutIBL);
+    glUniform1i(LUT_SAMPER_LOCATION, LUT_SAMPER_LOCATION);
+
+    for (size_t v = 0; v < packet.Views.size(); v++)
     {
-        const mat4& view = inverse(cameraTransform.World());
-        const vec4 eyePos(cameraTransform.GetTranslation(), 1.0f);  // cameraWorld* vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        const auto& view = packet.Views[v];
+        const auto& state = m_views[v];
+
+        // Views after the first draw over the ones before them, so they only clear the depth of their own part
+        const int x = static_cast<int>(view.Viewport.x * static_cast<float>(m_renderWidth));
+        const int y = static_cast<int>(view.Viewport.y * static_cast<float>(m_renderHeight));
+        const int width = std::max(static_cast<int>(view.Viewport.z * static_cast<float>(m_renderWidth)), 1);
+        const int height = std::max(static_cast<int>(view.Viewport.w * static_cast<float>(m_renderHeight)), 1);
+        glViewport(x, y, width, height);
+        if (v > 0)
+        {
+            glEnable(GL_SCISSOR_TEST);
+            glScissor(x, y, width, height);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            glDisable(GL_SCISSOR_TEST);
+        }
 
-        m_cameraData->bee_view = view;
-        m_cameraData->bee_projection = camera.Projection;
-        m_cameraData->bee_viewProjection = camera.Projection * view;
-        m_cameraData->bee_eyePos = eyePos;
+        // Bin the point lights into the clusters of the view, a slice per job
+        m_lightClusters.SetView(view.View, view.Projection, pointLightBounds, static_cast<size_t>(pointLightCount));
+        Engine.JobSystem().ParallelFor(LightClusters::c_slices,
+                                       1,
+                                       [this](size_t first, size_t last) { m_lightClusters.BinSlices(first, last); });
+        m_lightClusters.Compact();
+        UploadLightClusters();
+
+        m_cameraData->bee_view = view.View;
+        m_cameraData->bee_projection = view.Projection;
+        m_cameraData->bee_viewProjection = view.Projection * view.View;
+        m_cameraData->bee_eyePos = vec4(view.Position, 1.0f);
         m_cameraData->bee_directionalLightsCount = dirLightCount;
         m_cameraData->bee_pointLightsCount = pointLightCount;
-        m_cameraData->bee_resolution = vec2((float)Engine.Device().GetWidth(), (float)Engine.Device().GetHeight());
+        m_cameraData->bee_resolution = vec2(static_cast<float>(width), static_cast<float>(height));
+        m_cameraData->bee_clusterScale = m_lightClusters.GetSliceScale();
+        m_cameraData->bee_clusterBias = m_lightClusters.GetSliceBias();
+        m_cameraData->bee_clusterLogarithmic = m_lightClusters.IsLogarithmic();
+        m_cameraData->bee_viewportOffset = vec2(static_cast<float>(x), static_cast<float>(y));
         glBindBuffer(GL_UNIFORM_BUFFER, m_cameraUBO);
         glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraUBO), m_cameraData, GL_DYNAMIC_DRAW);
         glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-        m_currentMaterial.reset();
-        m_currentMesh.reset();
-
-        if (m_useAlphaBlending)
-        {
-            // Sort the objects by z value
-            std::vector<std::tuple<bee::Entity, MeshRenderer, Transform>> drawables;
-            for (const auto& [entity, renderer, transform] : Engine.ECS().Registry.view<MeshRenderer, Transform>().each())
-                drawables.push_back({entity, renderer, transform});
-
-            struct CompareDrawables
-            {
-                bool operator()(const std::tuple<bee::Entity, MeshRenderer, Transform>& d1,
-                                const std::tuple<bee::Entity, MeshRenderer, Transform>& d2)
-                {
-                    const auto& t1 = get<2>(d1);
-                    const auto& t2 = get<2>(d2);
-                    if (t1.GetTranslation().z == t2.GetTranslation().z)
-                    {
-                        if (t1.GetTranslation().y == t2.GetTranslation().y)
-                            return t1.GetTranslation().x < t2.GetTranslation().x;
-                        return t1.GetTranslation().y < t2.GetTranslation().y;
-                    }
-                    return t1.GetTranslation().z < t2.GetTranslation().z;
-                }
-            };
-            std::sort(drawables.begin(), drawables.end(), CompareDrawables());
-
-            int instances = 0;
-            // Render all objects; try instancing as much as possible
-            for (auto& [entity, renderer, transform] : drawables) ProcessObjectForRendering(renderer, transform, instances);
-
-            // Render last buffer
-            if (instances > 0)
-            {
-                ApplyMaterial(m_currentMaterial);
-                RenderCurrentInstances(instances);
-            }
-        }
-        else
-        {
-            // Render all objects; try instancing as much as possible
-            int instances = 0;
-            for (const auto& [entity, renderer, transform] : Engine.ECS().Registry.view<MeshRenderer, Transform>().each())
-                ProcessObjectForRendering(renderer, transform, instances);
+#ifdef BEE_INSPECTOR
+        m_visibleMeshes = static_cast<int>(state.NumVisible);
+        m_totalMeshes = static_cast<int>(packet.GetMeshCount());
+        m_occluderMeshes = state.OccluderMeshes;
+        m_occluderTriangles = state.OccluderTriangles;
+        m_occludedMeshes = state.OccludedMeshes;
+        m_occlusionTime = state.OcclusionTime;
+        for (const auto& draw : state.Draws) m_lodInstances[draw.Lod]++;
+#endif
 
-            // Render last buffer
-            if (instances > 0)
-            {
-                ApplyMaterial(m_currentMaterial);
-                RenderCurrentInstances(instances);
-            }
-        }
+        DrawIndirect(packet, state.Draws, m_cameraData->bee_viewProjection, true);
+        DrawSkidMarks(packet);
+        DrawParticles(packet, state);
     }
+    m_instances->EndFrame();
+    m_indirectCommands->EndFrame();
+    m_drawMaterials->EndFrame();
+    m_particles->EndFrame();
+
+    // Release the meshes and materials on the main thread, since destroying them can make GL calls
+    packet.Clear();
 
     // Resolve MSAA
     glBindFramebuffer(GL_READ_FRAMEBUFFER, m_msaaFramebuffer);
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_resolvedFramebuffer);
     glReadBuffer(GL_COLOR_ATTACHMENT0);
     glDrawBuffer(GL_COLOR_ATTACHMENT0);
-    glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-
-    // Final pass
+    glBlitFramebuffer(0,
+                      0,
+                      m_renderWidth,
+                      m_renderHeight,
+                      0,
+                      0,
+                      m_renderWidth,
+                      m_renderHeight,
+                      GL_COLOR_BUFFER_BIT,
+                      GL_NEAREST);
+
+    // Final pass, over the whole screen whatever the views covered. Samples the scene with linear filtering, which
+    // scales it up to the screen when it was rendered at a lower resolution.
     glDisable(GL_CULL_FACE);
     glDisable(GL_DEPTH_TEST);
     glBindFramebuffer(GL_FRAMEBUFFER, m_finalFramebuffer);
     glViewport(0, 0, m_width, m_height);
+    m_cameraData->bee_resolution = vec2(static_cast<float>(m_width), static_cast<float>(m_height));
+    m_cameraData->bee_viewportOffset = vec2(0.0f);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_cameraUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraUBO), m_cameraData, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
     glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     glActiveTexture(GL_TEXTURE0);
@@ -516,31 +1543,12 @@ void Renderer::Render()
     glReadBuffer(GL_COLOR_ATTACHMENT0);
     glDrawBuffer(GL_BACK);
     glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-}
 
-void Renderer::ProcessObjectForRendering(const MeshRenderer& renderer, Transform& transform, int& instances)
-{
-    // Check if end of batch is reached
-    if (m_currentMesh != renderer.Mesh || m_currentMaterial != renderer.Material || instances > MAX_TRANSFORM_INSTANCES - 1)
+    if (timed)
     {
-        // Check if batch is valid
-        if (m_currentMaterial && m_currentMesh && instances > 0)
-        {
-            ApplyMaterial(m_currentMaterial);
-            RenderCurrentInstances(instances);
-        }
-
-        // Start with a new batch
-        m_currentMesh = renderer.Mesh;
-        m_currentMaterial = renderer.Material;
-        instances = 0;
+        glEndQuery(GL_TIME_ELAPSED);
+        m_gpuTimersBegun++;
     }
-
-    // Always fill in the information for this object
-    const auto& world = transform.World();
-    m_transformsData->bee_transforms[instances].world = world;
-    m_transformsData->bee_transforms[instances].wvp = m_cameraData->bee_viewProjection * world;
-    instances++;
 }
 
 void Renderer::LoadEnvironment(FileIO::Directory directory, const std::string& filename)
@@ -802,55 +1810,23 @@ void Renderer::LoadEnvironment(FileIO::Directory directory, const std::string& f
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void Renderer::ApplyMaterial(const std::shared_ptr<Material>& material)
+void Renderer::ApplyMaterial(const Material& material)
 {
-    // if (material != m_currentMaterial)
-    {
-        m_currentMaterial = material;
-
-        if (material->BaseColorTexture) SetTexture(material->BaseColorTexture, BASE_COLOR_SAMPLER_LOCATION);
-
-        if (material->UseNormalTexture) SetTexture(material->NormalTexture, NORMAL_SAMPLER_LOCATION);
-
-        if (material->UseMetallicRoughnessTexture) SetTexture(material->MetallicRoughnessTexture, ORM_SAMPLER_LOCATION);
-
-        if (material->UseOcclusionTexture) SetTexture(material->OcclusionTexture, OCCLUSION_SAMPLER_LOCATION);
+#ifdef BEE_INSPECTOR
+    m_materialChanges++;
+#endif
 
-        if (material->UseEmissiveTexture) SetTexture(material->EmissiveTexture, EMISSIVE_SAMPLER_LOCATION);
+    if (material.BaseColorTexture) SetTexture(material.BaseColorTexture, BASE_COLOR_SAMPLER_LOCATION);
 
-        glActiveTexture(GL_TEXTURE0 + SPECULAR_SAMPER_LOCATION);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_specularIBL);
-        glUniform1i(SPECULAR_SAMPER_LOCATION, SPECULAR_SAMPER_LOCATION);
+    if (material.UseNormalTexture) SetTexture(material.NormalTexture, NORMAL_SAMPLER_LOCATION);
 
-        glActiveTexture(GL_TEXTURE0 + DIFFUSE_SAMPER_LOCATION);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, m_diffuseIBL);
-        glUniform1i(DIFFUSE_SAMPER_LOCATION, DIFFUSE_SAMPER_LOCATION);
+    if (material.UseMetallicRoughnessTexture) SetTexture(material.MetallicRoughnessTexture, ORM_SAMPLER_LOCATION);
 
-        glActiveTexture(GL_TEXTURE0 + LUT_SAMPER_LOCATION);
-        glBindTexture(GL_TEXTURE_2D, m_lutIBL);
-        glUniform1i(LUT_SAMPER_LOCATION, LUT_SAMPER_LOCATION);
-    }
+    if (material.UseOcclusionTexture) SetTexture(material.OcclusionTexture, OCCLUSION_SAMPLER_LOCATION);
 
-    m_forwardPass->GetParameter("base_color_factor")->SetValue(material->BaseColorFactor);
-    m_forwardPass->GetParameter("use_base_texture")->SetValue(material->UseBaseTexture);
-    m_forwardPass->GetParameter("use_occlusion_texture")->SetValue(material->UseBaseTexture);
-    m_forwardPass->GetParameter("use_metallic_roughness_texture")->SetValue(material->UseMetallicRoughnessTexture);
-    m_forwardPass->GetParameter("use_normal_texture")->SetValue(material->UseNormalTexture);
-    m_forwardPass->GetParameter("metallic_factor")->SetValue(material->MetallicFactor);
-    m_forwardPass->GetParameter("roughness_factor")->SetValue(material->RoughnessFactor);
-    m_forwardPass->GetParameter("use_emissive_texture")->SetValue(material->UseEmissiveTexture);
-    m_forwardPass->GetParameter("is_unlit")->SetValue(material->IsUnlit);
-    m_forwardPass->GetParameter("u_recieve_shadows")->SetValue(material->ReceiveShadows);
+    if (material.UseEmissiveTexture) SetTexture(material.EmissiveTexture, EMISSIVE_SAMPLER_LOCATION);
 
-#ifdef BEE_DEBUG
-    m_forwardPass->GetParameter("debug_base_color")->SetValue(m_debugData.BaseColor);
-    m_forwardPass->GetParameter("debug_normals")->SetValue(m_debugData.Normals);
-    m_forwardPass->GetParameter("debug_normal_map")->SetValue(m_debugData.NormalMap);
-    m_forwardPass->GetParameter("debug_metallic")->SetValue(m_debugData.Metallic);
-    m_forwardPass->GetParameter("debug_roughness")->SetValue(m_debugData.Roughness);
-    m_forwardPass->GetParameter("debug_emissive")->SetValue(m_debugData.Emissive);
-    m_forwardPass->GetParameter("debug_occlusion")->SetValue(m_debugData.Occlusion);
-#endif
+    // The rest of the material is in the draws SSBO, see RecordDraws
 }
 
 // Renders a 1x1 XY quad in NDC
@@ -1227,6 +2203,72 @@ void RenderCube()
     glBindVertexArray(0);
 }
 
+void ComputeBounds(const vector<FramePacket::MeshInstance>& meshes, BoundingBoxes& bounds)
+{
+    bounds.Clear();
+    bounds.Reserve(meshes.size());
+    for (const auto& mesh : meshes)
+    {
+        const auto [min, max] = TransformAABB(mesh.Mesh->GetMin(), mesh.Mesh->GetMax(), mesh.World);
+        bounds.Add(min, max);
+    }
+}
+
+int GetScaledSize(int size, float scale)
+{
+    return std::max(static_cast<int>(std::lround(static_cast<float>(size) * scale)), 1);
+}
+
+void ExtractSkidMarks(SkidMarkSystem& skidMarks, bool all, FramePacket::SkidMarkChanges& changes)
+{
+    auto& ring = skidMarks.GetRing();
+    changes.Capacity = ring.GetCapacity();
+    changes.Count = ring.GetQuadCount();
+    changes.Time = skidMarks.GetTime();
+    changes.FadeTime = skidMarks.FadeTime;
+
+    if (all)
+    {
+        changes.Slots.resize(changes.Count);
+        for (uint32_t slot = 0; slot < changes.Count; slot++) changes.Slots[slot] = slot;
+    }
+    else
+    {
+        changes.Slots = ring.GetChangedSlots();
+        std::sort(changes.Slots.begin(), changes.Slots.end());
+    }
+    changes.Vertices.resize(changes.Slots.size() * 4);
+    for (size_t i = 0; i < changes.Slots.size(); i++)
+        memcpy(&changes.Vertices[i * 4], ring.GetQuad(changes.Slots[i]), sizeof(SkidMarkVertex) * 4);
+    ring.ClearChanges();
+}
+
+void ExtractParticles(const ParticleSystem& particles, vector<FramePacket::ParticleBatch>& batches)
+{
+    // Particles are copied with their size and color at their age, so drawing them does not need their types
+    batches.resize(particles.GetTypeCount());
+    for (uint32_t t = 0; t < static_cast<uint32_t>(batches.size()); t++)
+    {
+        const auto& type = particles.GetType(t);
+        const auto& pool = particles.GetPool(t);
+        auto& batch = batches[t];
+        batch.AlphaBlended = type.AlphaBlended;
+        batch.Instances.resize(pool.GetCount());
+        Engine.JobSystem().ParallelFor(pool.GetCount(),
+                                       ParticleSystem::c_simulateBatch,
+                                       [&](size_t first, size_t last)
+                                       {
+                                           for (size_t i = first; i < last; i++)
+                                           {
+                                               const float age = pool.GetAge(i);
+                                               batch.Instances[i] = {pool.GetPosition(i),
+                                                                     mix(type.StartSize, type.EndSize, age),
+                                                                     mix(type.StartColor, type.EndColor, age)};
+                                           }
+                                       });
+    }
+}
+
 void SetTexture(const shared_ptr<Texture>& texture, int location)
 {
     glActiveTexture(GL_TEXTURE0 + location);
@@ -1284,14 +2326,61 @@ void Renderer::Reload()
     }
 }
 
-void Renderer::OnStatsBar() { ImGui::Text("%s %d [%d]", ICON_FA_CAMERA, m_drawCalls, m_drawInstances); }
+void Renderer::OnStatsBar()
+{
+    ImGui::Text("%s %d [%d]", ICON_FA_CAMERA, m_drawCalls, m_drawInstances);
+    ImGui::SameLine();
+    ImGui::Text("%s %d/%d", ICON_FA_EYE, m_visibleMeshes, m_totalMeshes);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Visible meshes %d of %d", m_visibleMeshes, m_totalMeshes);
+        ImGui::Text("Views %d, culled in %.2f ms", static_cast<int>(m_views.size()), m_cullTime);
+        ImGui::Text("Shadow casters %d", m_shadowCasters);
+        ImGui::Text("Shadow cascades %d drawn, %d cached", m_shadowCascadesDrawn, m_shadowCascadesCached);
+        ImGui::Text("Point lights %d, at most %d per cluster", m_pointLights, m_maxClusterLights);
+        ImGui::Text("Material changes %d", m_materialChanges);
+        ImGui::Text("Command buffers %d", m_commandBuffersRecorded);
+        ImGui::Text("Particles %d", m_particleInstances);
+        ImGui::Text("Skid mark quads %d", m_skidMarkQuads);
+        ImGui::Text("Resolution %dx%d with %dx MSAA, GPU %.2f ms", m_renderWidth, m_renderHeight, m_msaa, m_gpuTime);
+        ImGui::Text("Occlusion culled %d meshes behind %d occluders (%d triangles) in %.2f ms",
+                    m_occludedMeshes,
+                    m_occluderMeshes,
+                    m_occluderTriangles,
+                    m_occlusionTime);
+        ImGui::Text("Instances per level of detail %d %d %d %d",
+                    m_lodInstances[0],
+                    m_lodInstances[1],
+                    m_lodInstances[2],
+                    m_lodInstances[3]);
+        ImGui::EndTooltip();
+    }
+}
 
 void Renderer::OnPanel()
 {
     Engine.Inspector().Inspect(m_debugData);
     ImGui::DragFloat("Vignette", &m_vignette, 0.01f, 0.0f, 1.0f);
+    ImGui::Checkbox("Occlusion Culling", &m_occlusionCulling);
+    bool dynamicResolution = m_dynamicResolutionEnabled;
+    if (ImGui::Checkbox("Dynamic Resolution", &dynamicResolution)) SetDynamicResolution(dynamicResolution);
+    ImGui::DragFloat("Target GPU Time", &m_dynamicResolution.TargetTime, 0.1f, 1.0f, 100.0f, "%.1f ms");
     ImGui::DragInt("Draw Calls", &m_drawCalls);
     ImGui::DragInt("Draw Instances", &m_drawInstances);
+    ImGui::DragInt("Material Changes", &m_materialChanges);
+    ImGui::Text("Instance Buffer %d KB per frame, %d stalls",
+                static_cast<int>(m_instances->GetRegionSize() / 1024),
+                m_instances->GetStalls());
+    ImGui::Text("Mesh Arena %d/%d vertices, %d/%d indices",
+                static_cast<int>(m_meshArena->GetUsedVertices()),
+                static_cast<int>(m_meshArena->GetVertexCapacity()),
+                static_cast<int>(m_meshArena->GetUsedIndices()),
+                static_cast<int>(m_meshArena->GetIndexCapacity()));
+    ImGui::Text("Static Batches %d (%d meshes)",
+                static_cast<int>(m_staticBatches.size()),
+                static_cast<int>(m_staticBatchedMeshes));
+    if (ImGui::Button("Bake Static Geometry")) BakeStaticGeometry();
     if (ImGui::Button("Reload")) m_reload = true;
 }
 
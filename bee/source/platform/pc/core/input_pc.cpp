@@ -58,7 +58,9 @@ void mousebutton_callback(GLFWwindow*, int button, int action, int)
 
 Input::Input()
 {
+    // Headless devices have no window, and no input
     auto* window = static_cast<GLFWwindow*>(Engine.Device().GetWindow());
+    if (!window) return;
 
     // glfwSetJoystickCallback(joystick_callback);
     glfwSetCursorPosCallback(window, cursor_position_callback);
@@ -72,6 +74,7 @@ Input::Input()
 Input::~Input()
 {
     auto* window = static_cast<GLFWwindow*>(Engine.Device().GetWindow());
+    if (!window) return;
 
     // TODO: Remove
     // glfwSetJoystickCallback(NULL);
@@ -106,7 +109,8 @@ void Input::Update()
         mousebuttons_action[i] = KeyAction::None;
     }
 
-    // update gamepad states
+    // update gamepad states, GLFW is not initialized without a window
+    if (!Engine.Device().GetWindow()) return;
     for (int i = 0; i < max_nr_gamepads; ++i)
     {
         prev_gamepad_state[i] = gamepad_state[i];
@@ -177,6 +181,7 @@ float Input::GetMouseWheel() const { return mousewheel; }
 void Input::SetCursorEnabled(bool value)
 {
     auto* window = static_cast<GLFWwindow*>(Engine.Device().GetWindow());
+    if (!window) return;
     glfwSetInputMode(window, GLFW_CURSOR, value ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
 }
 
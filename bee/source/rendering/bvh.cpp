@@ -0,0 +1,267 @@
+#include "rendering/bvh.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <numeric>
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+constexpr int c_bins = 12;
+constexpr float c_traversalCost = 1.0f;  // relative to testing one item
+constexpr int c_maxDepth = 48;           // leaves room on the query stacks, which hold at most depth + 1 entries
+
+float Area(const glm::vec3& min, const glm::vec3& max)
+{
+    const glm::vec3 size = glm::max(max - min, glm::vec3(0.0f));
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+struct Bin
+{
+    glm::vec3 Min = glm::vec3(numeric_limits<float>::max());
+    glm::vec3 Max = glm::vec3(-numeric_limits<float>::max());
+    uint32_t Count = 0;
+
+    void Grow(const glm::vec3& min, const glm::vec3& max)
+    {
+        Min = glm::min(Min, min);
+        Max = glm::max(Max, max);
+    }
+};
+
+}  // namespace
+
+void BoundingVolumeHierarchy::Build(const BoundingBoxes& bounds, uint32_t maxLeafSize)
+{
+    assert(maxLeafSize > 0);
+    Clear();
+
+    const auto count = static_cast<uint32_t>(bounds.Size());
+    if (count == 0) return;
+
+    m_itemMin.resize(count);
+    m_itemMax.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_itemMin[i] = bounds.GetMin(i);
+        m_itemMax[i] = bounds.GetMax(i);
+    }
+    m_items.resize(count);
+    iota(m_items.begin(), m_items.end(), 0u);
+    m_leaves.resize(count);
+
+    m_nodes.reserve(2 * count);
+    m_parents.reserve(2 * count);
+    m_nodes.push_back({});
+    m_parents.push_back(0);
+    m_nodes[0].First = 0;
+    m_nodes[0].Count = count;
+    Subdivide(0, maxLeafSize, 0);
+
+    m_buildCost = GetCost();
+}
+
+void BoundingVolumeHierarchy::Clear()
+{
+    m_nodes.clear();
+    m_parents.clear();
+    m_items.clear();
+    m_leaves.clear();
+    m_itemMin.clear();
+    m_itemMax.clear();
+    m_buildCost = 0.0f;
+}
+
+void BoundingVolumeHierarchy::Subdivide(uint32_t index, uint32_t maxLeafSize, int depth)
+{
+    UpdateLeafBounds(index);
+    const uint32_t first = m_nodes[index].First;
+    const uint32_t count = m_nodes[index].Count;
+
+    const auto makeLeaf = [&]
+    {
+        for (uint32_t i = first; i < first + count; i++) m_leaves[m_items[i]] = index;
+    };
+
+    if (count <= 1 || depth >= c_maxDepth) return makeLeaf();
+
+    // Bin the items by their centers along every axis, and find the split between two bins with the lowest cost
+    glm::vec3 centerMin(numeric_limits<float>::max());
+    glm::vec3 centerMax(-numeric_limits<float>::max());
+    for (uint32_t i = first; i < first + count; i++)
+    {
+        const glm::vec3 center = (m_itemMin[m_items[i]] + m_itemMax[m_items[i]]) * 0.5f;
+        centerMin = glm::min(centerMin, center);
+        centerMax = glm::max(centerMax, center);
+    }
+
+    float bestCost = numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestSplit = 0;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const float extent = centerMax[axis] - centerMin[axis];
+        if (extent <= 0.0f) continue;
+
+        Bin bins[c_bins];
+        const float scale = static_cast<float>(c_bins) / extent;
+        for (uint32_t i = first; i < first + count; i++)
+        {
+            const uint32_t item = m_items[i];
+            const float center = (m_itemMin[item][axis] + m_itemMax[item][axis]) * 0.5f;
+            const int bin = min(c_bins - 1, static_cast<int>((center - centerMin[axis]) * scale));
+            bins[bin].Grow(m_itemMin[item], m_itemMax[item]);
+            bins[bin].Count++;
+        }
+
+        // Sweep from both sides, so that every split position is evaluated in O(bins)
+        float leftArea[c_bins - 1], rightArea[c_bins - 1];
+        uint32_t leftCount[c_bins - 1], rightCount[c_bins - 1];
+        Bin left, right;
+        uint32_t leftSum = 0, rightSum = 0;
+        for (int i = 0; i < c_bins - 1; i++)
+        {
+            leftSum += bins[i].Count;
+            leftCount[i] = leftSum;
+            if (bins[i].Count > 0) left.Grow(bins[i].Min, bins[i].Max);
+            leftArea[i] = Area(left.Min, left.Max);
+
+            rightSum += bins[c_bins - 1 - i].Count;
+            rightCount[c_bins - 2 - i] = rightSum;
+            if (bins[c_bins - 1 - i].Count > 0) right.Grow(bins[c_bins - 1 - i].Min, bins[c_bins - 1 - i].Max);
+            rightArea[c_bins - 2 - i] = Area(right.Min, right.Max);
+        }
+
+        for (int i = 0; i < c_bins - 1; i++)
+        {
+            if (leftCount[i] == 0 || rightCount[i] == 0) continue;
+            const float cost =
+                leftArea[i] * static_cast<float>(leftCount[i]) + rightArea[i] * static_cast<float>(rightCount[i]);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i;
+            }
+        }
+    }
+
+    // All centers in one point, the items cannot be told apart
+    if (bestAxis < 0) return makeLeaf();
+
+    // Stop when testing all items is cheaper than visiting two children, unless the leaf would be too large
+    const Node& node = m_nodes[index];
+    const float area = Area(node.Min, node.Max);
+    const float splitCost = c_traversalCost + (area > 0.0f ? bestCost / area : 0.0f);
+    if (count <= maxLeafSize && splitCost >= static_cast<float>(count)) return makeLeaf();
+
+    const float scale = static_cast<float>(c_bins) / (centerMax[bestAxis] - centerMin[bestAxis]);
+    const auto isLeft = [&](uint32_t item)
+    {
+        const float center = (m_itemMin[item][bestAxis] + m_itemMax[item][bestAxis]) * 0.5f;
+        return min(c_bins - 1, static_cast<int>((center - centerMin[bestAxis]) * scale)) <= bestSplit;
+    };
+    const auto middle = partition(m_items.begin() + first, m_items.begin() + first + count, isLeft);
+    const auto leftCount = static_cast<uint32_t>(middle - (m_items.begin() + first));
+
+    const auto child = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back({});
+    m_nodes.push_back({});
+    m_parents.push_back(index);
+    m_parents.push_back(index);
+    m_nodes[child].First = first;
+    m_nodes[child].Count = leftCount;
+    m_nodes[child + 1].First = first + leftCount;
+    m_nodes[child + 1].Count = count - leftCount;
+    m_nodes[index].First = child;
+    m_nodes[index].Count = 0;
+
+    Subdivide(child, maxLeafSize, depth + 1);
+    Subdivide(child + 1, maxLeafSize, depth + 1);
+}
+
+void BoundingVolumeHierarchy::UpdateLeafBounds(uint32_t index)
+{
+    Node& node = m_nodes[index];
+    node.Min = glm::vec3(numeric_limits<float>::max());
+    node.Max = glm::vec3(-numeric_limits<float>::max());
+    for (uint32_t i = node.First; i < node.First + node.Count; i++)
+    {
+        node.Min = glm::min(node.Min, m_itemMin[m_items[i]]);
+        node.Max = glm::max(node.Max, m_itemMax[m_items[i]]);
+    }
+}
+
+void BoundingVolumeHierarchy::Update(uint32_t item, const glm::vec3& min, const glm::vec3& max)
+{
+    SetBounds(item, min, max);
+
+    uint32_t index = m_leaves[item];
+    UpdateLeafBounds(index);
+    while (index != 0)
+    {
+        index = m_parents[index];
+        Node& node = m_nodes[index];
+        const Node& left = m_nodes[node.First];
+        const Node& right = m_nodes[node.First + 1];
+        const glm::vec3 newMin = glm::min(left.Min, right.Min);
+        const glm::vec3 newMax = glm::max(left.Max, right.Max);
+        if (newMin == node.Min && newMax == node.Max) break;  // nothing changes further up
+        node.Min = newMin;
+        node.Max = newMax;
+    }
+}
+
+void BoundingVolumeHierarchy::SetBounds(uint32_t item, const glm::vec3& min, const glm::vec3& max)
+{
+    m_itemMin[item] = min;
+    m_itemMax[item] = max;
+}
+
+void BoundingVolumeHierarchy::Refit()
+{
+    // Children are always created after their parent, so going backwards visits them first
+    for (size_t i = m_nodes.size(); i-- > 0;)
+    {
+        Node& node = m_nodes[i];
+        if (node.IsLeaf())
+        {
+            UpdateLeafBounds(static_cast<uint32_t>(i));
+            continue;
+        }
+        node.Min = glm::min(m_nodes[node.First].Min, m_nodes[node.First + 1].Min);
+        node.Max = glm::max(m_nodes[node.First].Max, m_nodes[node.First + 1].Max);
+    }
+}
+
+float BoundingVolumeHierarchy::GetCost() const
+{
+    if (m_nodes.empty()) return 0.0f;
+
+    float cost = 0.0f;
+    for (const auto& node : m_nodes)
+        cost += Area(node.Min, node.Max) * (node.IsLeaf() ? static_cast<float>(node.Count) : c_traversalCost);
+
+    const float rootArea = Area(m_nodes[0].Min, m_nodes[0].Max);
+    return rootArea > 0.0f ? cost / rootArea : 0.0f;
+}
+
+float BoundingVolumeHierarchy::RayBox(const glm::vec3& origin,
+                                      const glm::vec3& inverseDirection,
+                                      const glm::vec3& min,
+                                      const glm::vec3& max,
+                                      float maxDistance)
+{
+    const glm::vec3 t0 = (min - origin) * inverseDirection;
+    const glm::vec3 t1 = (max - origin) * inverseDirection;
+    const glm::vec3 entries = glm::min(t0, t1);
+    const glm::vec3 exits = glm::max(t0, t1);
+    const float enter = std::max(std::max(entries.x, entries.y), std::max(entries.z, 0.0f));
+    const float exit = std::min(std::min(exits.x, exits.y), std::min(exits.z, maxDistance));
+    return enter <= exit ? enter : -1.0f;
+}
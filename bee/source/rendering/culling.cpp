@@ -0,0 +1,195 @@
+#include "rendering/culling.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BEE_CULL_SSE
+#endif
+
+using namespace bee;
+using namespace std;
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection)
+{
+    const auto row = [&](int i)
+    { return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]); };
+
+    Frustum frustum;
+    frustum.Planes[0] = row(3) + row(0);  // left
+    frustum.Planes[1] = row(3) - row(0);  // right
+    frustum.Planes[2] = row(3) + row(1);  // bottom
+    frustum.Planes[3] = row(3) - row(1);  // top
+    frustum.Planes[4] = row(3) + row(2);  // near
+    frustum.Planes[5] = row(3) - row(2);  // far
+    for (auto& plane : frustum.Planes) plane /= glm::length(glm::vec3(plane));
+    return frustum;
+}
+
+bool Frustum::Intersects(const glm::vec3& min, const glm::vec3& max) const
+{
+    for (const auto& plane : Planes)
+    {
+        // The corner of the box that is furthest along the plane normal
+        const glm::vec3 corner(plane.x >= 0.0f ? max.x : min.x,
+                               plane.y >= 0.0f ? max.y : min.y,
+                               plane.z >= 0.0f ? max.z : min.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) return false;
+    }
+    return true;
+}
+
+bool Frustum::Contains(const glm::vec3& min, const glm::vec3& max) const
+{
+    for (const auto& plane : Planes)
+    {
+        // The corner of the box that is furthest against the plane normal
+        const glm::vec3 corner(plane.x >= 0.0f ? min.x : max.x,
+                               plane.y >= 0.0f ? min.y : max.y,
+                               plane.z >= 0.0f ? min.z : max.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) return false;
+    }
+    return true;
+}
+
+void BoundingBoxes::Add(const glm::vec3& min, const glm::vec3& max)
+{
+    m_minX.push_back(min.x);
+    m_minY.push_back(min.y);
+    m_minZ.push_back(min.z);
+    m_maxX.push_back(max.x);
+    m_maxY.push_back(max.y);
+    m_maxZ.push_back(max.z);
+}
+
+void BoundingBoxes::Clear()
+{
+    m_minX.clear();
+    m_minY.clear();
+    m_minZ.clear();
+    m_maxX.clear();
+    m_maxY.clear();
+    m_maxZ.clear();
+}
+
+void BoundingBoxes::Reserve(size_t count)
+{
+    m_minX.reserve(count);
+    m_minY.reserve(count);
+    m_minZ.reserve(count);
+    m_maxX.reserve(count);
+    m_maxY.reserve(count);
+    m_maxZ.reserve(count);
+}
+
+size_t BoundingBoxes::Cull(const Frustum& frustum, uint8_t* visible) const
+{
+    // Per plane, the arrays that hold the corner furthest along its normal, the same for every box
+    const float* cornerX[6];
+    const float* cornerY[6];
+    const float* cornerZ[6];
+    for (int p = 0; p < 6; p++)
+    {
+        const auto& plane = frustum.Planes[p];
+        cornerX[p] = plane.x >= 0.0f ? m_maxX.data() : m_minX.data();
+        cornerY[p] = plane.y >= 0.0f ? m_maxY.data() : m_minY.data();
+        cornerZ[p] = plane.z >= 0.0f ? m_maxZ.data() : m_minZ.data();
+    }
+
+    const size_t count = Size();
+    size_t i = 0;
+    size_t numVisible = 0;
+
+#if defined(__AVX__)
+    __m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int p = 0; p < 6; p++)
+    {
+        planeX[p] = _mm256_set1_ps(frustum.Planes[p].x);
+        planeY[p] = _mm256_set1_ps(frustum.Planes[p].y);
+        planeZ[p] = _mm256_set1_ps(frustum.Planes[p].z);
+        planeW[p] = _mm256_set1_ps(frustum.Planes[p].w);
+    }
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 outside = _mm256_setzero_ps();
+        for (int p = 0; p < 6; p++)
+        {
+            __m256 distance = _mm256_mul_ps(planeX[p], _mm256_loadu_ps(cornerX[p] + i));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(planeY[p], _mm256_loadu_ps(cornerY[p] + i)));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(planeZ[p], _mm256_loadu_ps(cornerZ[p] + i)));
+            distance = _mm256_add_ps(distance, planeW[p]);
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+
+        const int mask = _mm256_movemask_ps(outside);
+        for (int j = 0; j < 8; j++)
+        {
+            visible[i + j] = ((mask >> j) & 1) == 0;
+            numVisible += visible[i + j];
+        }
+    }
+#elif defined(BEE_CULL_SSE)
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int p = 0; p < 6; p++)
+    {
+        planeX[p] = _mm_set1_ps(frustum.Planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.Planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.Planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.Planes[p].w);
+    }
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_mul_ps(planeX[p], _mm_loadu_ps(cornerX[p] + i));
+            distance = _mm_add_ps(distance, _mm_mul_ps(planeY[p], _mm_loadu_ps(cornerY[p] + i)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(planeZ[p], _mm_loadu_ps(cornerZ[p] + i)));
+            distance = _mm_add_ps(distance, planeW[p]);
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+        }
+
+        const int mask = _mm_movemask_ps(outside);
+        for (int j = 0; j < 4; j++)
+        {
+            visible[i + j] = ((mask >> j) & 1) == 0;
+            numVisible += visible[i + j];
+        }
+    }
+#endif
+
+    // The boxes that do not fill a whole SIMD register
+    for (; i < count; i++)
+    {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; p++)
+        {
+            const auto& plane = frustum.Planes[p];
+            inside = plane.x * cornerX[p][i] + plane.y * cornerY[p][i] + plane.z * cornerZ[p][i] + plane.w >= 0.0f;
+        }
+        visible[i] = inside;
+        numVisible += visible[i];
+    }
+
+    return numVisible;
+}
+
+pair<glm::vec3, glm::vec3> bee::TransformAABB(const glm::vec3& min, const glm::vec3& max, const glm::mat4& transform)
+{
+    // Transform the center, and project the extents onto the world axes
+    const glm::vec3 center = glm::vec3(transform * glm::vec4((min + max) * 0.5f, 1.0f));
+    const glm::vec3 extent = (max - min) * 0.5f;
+    const glm::mat3 linear = glm::mat3(transform);
+    glm::vec3 worldExtent(0.0f);
+    for (int column = 0; column < 3; column++) worldExtent += glm::abs(linear[column]) * extent[column];
+    return {center - worldExtent, center + worldExtent};
+}
+
+pair<float, float> bee::GetDepthRange(const glm::mat4& projection)
+{
+    if (projection[2][3] != 0.0f)
+        return {projection[3][2] / (projection[2][2] - 1.0f), projection[3][2] / (projection[2][2] + 1.0f)};
+    return {(projection[3][2] + 1.0f) / projection[2][2], (projection[3][2] - 1.0f) / projection[2][2]};
+}
@@ -1,11 +1,157 @@
 #include "rendering/debug_render.hpp"
 
+#include <atomic>
+#include <cmath>
 #include <glm/gtc/constants.hpp>
 #include <glm/gtx/quaternion.hpp>
 
 using namespace bee;
 using namespace glm;
 
+namespace
+{
+
+constexpr int c_circleSegments = 32;
+constexpr int c_cylinderSegments = 16;
+const vec2 c_square[] = {vec2(-1.0f, -1.0f), vec2(1.0f, -1.0f), vec2(1.0f, 1.0f), vec2(-1.0f, 1.0f)};
+
+// A rotation that turns the z axis into the normal, without trigonometry (Duff et al., "Building an Orthonormal Basis,
+// Revisited")
+mat3 GetBasis(const vec3& normal)
+{
+    const float sign = std::copysign(1.0f, normal.z);
+    const float a = -1.0f / (sign + normal.z);
+    const float b = normal.x * normal.y * a;
+    return mat3(vec3(1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x),
+                vec3(b, sign + normal.y * normal.y * a, -normal.y),
+                normal);
+}
+
+// From a unit shape to the world, with the z axis along the normal
+mat4 GetTransform(const vec3& center, const mat3& basis, const vec3& scale)
+{
+    return mat4(vec4(basis[0] * scale.x, 0.0f),
+                vec4(basis[1] * scale.y, 0.0f),
+                vec4(basis[2] * scale.z, 0.0f),
+                vec4(center, 1.0f));
+}
+
+// A circle or an arc of one in the plane of two axes
+void AddArc(std::vector<vec3>& lines, const vec3& x, const vec3& y, const vec3& center, int segments, float angle)
+{
+    for (int i = 0; i < segments; i++)
+    {
+        const float t0 = angle * static_cast<float>(i) / static_cast<float>(segments);
+        const float t1 = angle * static_cast<float>(i + 1) / static_cast<float>(segments);
+        lines.push_back(center + x * std::cos(t0) + y * std::sin(t0));
+        lines.push_back(center + x * std::cos(t1) + y * std::sin(t1));
+    }
+}
+
+}  // namespace
+
+uint64_t DebugRenderer::NextId()
+{
+    static std::atomic<uint64_t> next{1};
+    return next++;
+}
+
+std::vector<vec3> DebugRenderer::GetUnitShape(Primitive primitive)
+{
+    const vec3 x(1.0f, 0.0f, 0.0f);
+    const vec3 y(0.0f, 1.0f, 0.0f);
+    const vec3 z(0.0f, 0.0f, 1.0f);
+    std::vector<vec3> lines;
+    switch (primitive)
+    {
+        case Primitive::Circle:
+            AddArc(lines, x, y, vec3(0.0f), c_circleSegments, two_pi<float>());
+            break;
+        case Primitive::Square:
+            for (int i = 0; i < 4; i++)
+            {
+                lines.push_back(vec3(c_square[i] * 0.5f, 0.0f));
+                lines.push_back(vec3(c_square[(i + 1) % 4] * 0.5f, 0.0f));
+            }
+            break;
+        case Primitive::Box:
+            for (int i = 0; i < 4; i++)
+            {
+                // The bottom, the top and the edge between them
+                const vec2 corner = c_square[i];
+                const vec2 next = c_square[(i + 1) % 4];
+                lines.push_back(vec3(corner, -1.0f));
+                lines.push_back(vec3(next, -1.0f));
+                lines.push_back(vec3(corner, 1.0f));
+                lines.push_back(vec3(next, 1.0f));
+                lines.push_back(vec3(corner, -1.0f));
+                lines.push_back(vec3(corner, 1.0f));
+            }
+            break;
+        case Primitive::Sphere:
+            AddArc(lines, x, y, vec3(0.0f), c_circleSegments, two_pi<float>());
+            AddArc(lines, y, z, vec3(0.0f), c_circleSegments, two_pi<float>());
+            AddArc(lines, z, x, vec3(0.0f), c_circleSegments, two_pi<float>());
+            break;
+        case Primitive::Cylinder:
+            AddArc(lines, x, y, vec3(0.0f), c_cylinderSegments, two_pi<float>());
+            AddArc(lines, x, y, z, c_cylinderSegments, two_pi<float>());
+            for (int i = 0; i < c_cylinderSegments; i++)
+            {
+                const float t = two_pi<float>() * static_cast<float>(i) / static_cast<float>(c_cylinderSegments);
+                lines.push_back(vec3(std::cos(t), std::sin(t), 0.0f));
+                lines.push_back(vec3(std::cos(t), std::sin(t), 1.0f));
+            }
+            break;
+        case Primitive::Hemisphere:
+            AddArc(lines, x, z, vec3(0.0f), c_circleSegments / 2, pi<float>());
+            AddArc(lines, y, z, vec3(0.0f), c_circleSegments / 2, pi<float>());
+            break;
+        case Primitive::ArrowHead:
+            for (int i = 0; i < 4; i++)
+            {
+                // From the tip to a corner of the base, and along the base to the next corner
+                const vec3 corner(c_square[i] * 0.5f, -1.0f);
+                lines.push_back(vec3(0.0f));
+                lines.push_back(corner);
+                lines.push_back(corner);
+                lines.push_back(vec3(c_square[(i + 1) % 4] * 0.5f, -1.0f));
+            }
+            break;
+        case Primitive::Count:
+            break;
+    }
+    return lines;
+}
+
+DebugRenderer::Buffer& DebugRenderer::GetThreadBuffer()
+{
+    // A thread keeps the buffer it registered last, as long as it belongs to this debug renderer
+    thread_local uint64_t owner = 0;
+    thread_local Buffer* buffer = nullptr;
+    if (owner != m_id)
+    {
+        std::lock_guard lock(m_buffersMutex);
+        m_buffers.push_back(std::make_unique<Buffer>());
+        buffer = m_buffers.back().get();
+        owner = m_id;
+    }
+    return *buffer;
+}
+
+void DebugRenderer::AddInstance(Primitive primitive, const mat4& transform, const vec4& color)
+{
+    GetThreadBuffer().Instances[static_cast<size_t>(primitive)].push_back({transform, color});
+}
+
+void DebugRenderer::AddLine(DebugCategory::Enum category, const vec3& from, const vec3& to, const vec4& color)
+{
+    if (!(m_categoryFlags & category)) return;
+    auto& lines = GetThreadBuffer().Lines;
+    lines.push_back({from, color});
+    lines.push_back({to, color});
+}
+
 void DebugRenderer::AddCircle(DebugCategory::Enum category,
                               const vec3& center,
                               float radius,
@@ -13,19 +159,7 @@ void DebugRenderer::AddCircle(DebugCategory::Enum category,
                               const vec4& color)
 {
     if (!(m_categoryFlags & category)) return;
-
-    constexpr float dt = glm::two_pi<float>() / 32.0f;
-    float t = 0.0f;
-
-    const auto& rotation = glm::rotation(vec3(0, 0, 1), normal);
-
-    vec3 v0 = center + radius * glm::rotate(rotation, vec3(cos(t), sin(t), 0));
-    for (; t < glm::two_pi<float>(); t += dt)
-    {
-        vec3 v1 = center + radius * glm::rotate(rotation, vec3(cos(t + dt), sin(t + dt), 0));
-        AddLine(category, v0, v1, color);
-        v0 = v1;
-    }
+    AddInstance(Primitive::Circle, GetTransform(center, GetBasis(normalize(normal)), vec3(radius)), color);
 }
 
 void DebugRenderer::AddSquare(DebugCategory::Enum category,
@@ -35,21 +169,23 @@ void DebugRenderer::AddSquare(DebugCategory::Enum category,
                               const glm::vec4& color)
 {
     if (!(m_categoryFlags & category)) return;
+    AddInstance(Primitive::Square, GetTransform(center, GetBasis(normalize(normal)), vec3(size)), color);
+}
 
-    const auto& rotation = glm::rotation(vec3(0, 0, 1), normal);
-
-    const float s = size * 0.5f;
-    auto A = center + glm::rotate(rotation, vec3(-s, -s, 0.0f));
-    auto B = center + glm::rotate(rotation, vec3(-s, s, 0.0f));
-    auto C = center + glm::rotate(rotation, vec3(s, s, 0.0f));
-    auto D = center + glm::rotate(rotation, vec3(s, -s, 0.0f));
-
-    // TODO: use normal
+void DebugRenderer::AddBox(DebugCategory::Enum category,
+                           const glm::vec3& center,
+                           const glm::vec3& halfExtents,
+                           const glm::quat& rotation,
+                           const glm::vec4& color)
+{
+    if (!(m_categoryFlags & category)) return;
+    AddInstance(Primitive::Box, GetTransform(center, mat3_cast(rotation), halfExtents), color);
+}
 
-    AddLine(category, A, B, color);
-    AddLine(category, B, C, color);
-    AddLine(category, C, D, color);
-    AddLine(category, D, A, color);
+void DebugRenderer::AddSphere(DebugCategory::Enum category, const glm::vec3& center, float radius, const glm::vec4& color)
+{
+    if (!(m_categoryFlags & category)) return;
+    AddInstance(Primitive::Sphere, GetTransform(center, mat3(1.0f), vec3(radius)), color);
 }
 
 void DebugRenderer::AddCylinder(DebugCategory::Enum category,
@@ -60,19 +196,36 @@ void DebugRenderer::AddCylinder(DebugCategory::Enum category,
 {
     if (!(m_categoryFlags & category)) return;
 
-    constexpr float dt = glm::two_pi<float>() / 16.0f;
-    float t = 0.0f;
+    const vec3 axis = center2 - center1;
+    const float height = length(axis);
+    const mat3 basis = GetBasis(height > 0.0f ? axis / height : vec3(0.0f, 0.0f, 1.0f));
+    AddInstance(Primitive::Cylinder, GetTransform(center1, basis, vec3(radius, radius, height)), color);
+}
+
+void DebugRenderer::AddCapsule(DebugCategory::Enum category,
+                               const glm::vec3& center1,
+                               const glm::vec3& center2,
+                               float radius,
+                               const glm::vec4& color)
+{
+    if (!(m_categoryFlags & category)) return;
+
+    const vec3 axis = center2 - center1;
+    const float height = length(axis);
+    const vec3 direction = height > 0.0f ? axis / height : vec3(0.0f, 0.0f, 1.0f);
+    const mat3 basis = GetBasis(direction);
+    AddInstance(Primitive::Cylinder, GetTransform(center1, basis, vec3(radius, radius, height)), color);
+    AddInstance(Primitive::Hemisphere, GetTransform(center2, basis, vec3(radius)), color);
+    AddInstance(Primitive::Hemisphere, GetTransform(center1, GetBasis(-direction), vec3(radius)), color);
+}
 
-    const auto& diff = center2 - center1;
-    const auto& rotation = glm::rotation(vec3(0, 0, 1), glm::normalize(diff));
+void DebugRenderer::AddArrow(DebugCategory::Enum category, const glm::vec3& from, const glm::vec3& to, const glm::vec4& color)
+{
+    if (!(m_categoryFlags & category)) return;
 
-    vec3 v0 = center1 + radius * glm::rotate(rotation, vec3(cos(t), sin(t), 0));
-    for (; t < glm::two_pi<float>(); t += dt)
-    {
-        vec3 v1 = center1 + radius * glm::rotate(rotation, vec3(cos(t + dt), sin(t + dt), 0));
-        AddLine(category, v0, v1, color);
-        AddLine(category, v0 + diff, v1 + diff, color);
-        AddLine(category, v0, v0 + diff, color);
-        v0 = v1;
-    }
+    AddLine(category, from, to, color);
+    const vec3 axis = to - from;
+    const float length = glm::length(axis);
+    if (length <= 0.0f) return;
+    AddInstance(Primitive::ArrowHead, GetTransform(to, GetBasis(axis / length), vec3(length * 0.25f)), color);
 }
@@ -0,0 +1,100 @@
+#include "rendering/draw_list.hpp"
+
+#include <cassert>
+#include <cstring>
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+constexpr int c_depthShift = 0;
+constexpr int c_lodShift = c_depthShift + DrawKey::c_depthBits;
+constexpr int c_meshShift = c_lodShift + DrawKey::c_lodBits;
+constexpr int c_materialShift = c_meshShift + DrawKey::c_meshBits;
+constexpr int c_shaderShift = c_materialShift + DrawKey::c_materialBits;
+constexpr int c_passShift = c_shaderShift + DrawKey::c_shaderBits;
+static_assert(c_passShift + DrawKey::c_passBits == 64, "The key fields must fill 64 bits");
+
+// Ordered keys move depth right below the pass, and the other fields down
+constexpr int c_orderedLodShift = 0;
+constexpr int c_orderedMeshShift = c_orderedLodShift + DrawKey::c_lodBits;
+constexpr int c_orderedMaterialShift = c_orderedMeshShift + DrawKey::c_meshBits;
+constexpr int c_orderedShaderShift = c_orderedMaterialShift + DrawKey::c_materialBits;
+constexpr int c_orderedDepthShift = c_orderedShaderShift + DrawKey::c_shaderBits;
+
+constexpr int c_radixBits = 8;
+constexpr int c_radixSize = 1 << c_radixBits;
+constexpr int c_radixPasses = 64 / c_radixBits;
+
+}  // namespace
+
+uint64_t DrawKey::Make(Pass pass, uint32_t shader, uint32_t material, uint32_t mesh, uint32_t lod, uint32_t depth)
+{
+    return AddView(MakeShared(pass, shader, material, mesh), lod, depth);
+}
+
+uint64_t DrawKey::MakeShared(Pass pass, uint32_t shader, uint32_t material, uint32_t mesh)
+{
+    assert(shader < c_maxShaders && material < c_maxMaterials && mesh < c_maxMeshes);
+    return static_cast<uint64_t>(pass) << c_passShift | static_cast<uint64_t>(shader) << c_shaderShift |
+           static_cast<uint64_t>(material) << c_materialShift | static_cast<uint64_t>(mesh) << c_meshShift;
+}
+
+uint64_t DrawKey::AddView(uint64_t shared, uint32_t lod, uint32_t depth)
+{
+    assert(lod < c_maxLods && depth <= c_maxDepth);
+    return shared | static_cast<uint64_t>(lod) << c_lodShift | static_cast<uint64_t>(depth) << c_depthShift;
+}
+
+uint64_t DrawKey::MakeOrdered(Pass pass, uint32_t depth, uint32_t shader, uint32_t material, uint32_t mesh, uint32_t lod)
+{
+    assert(shader < c_maxShaders && material < c_maxMaterials && mesh < c_maxMeshes && lod < c_maxLods &&
+           depth <= c_maxDepth);
+    return static_cast<uint64_t>(pass) << c_passShift | static_cast<uint64_t>(depth) << c_orderedDepthShift |
+           static_cast<uint64_t>(shader) << c_orderedShaderShift | static_cast<uint64_t>(material) << c_orderedMaterialShift |
+           static_cast<uint64_t>(mesh) << c_orderedMeshShift | static_cast<uint64_t>(lod) << c_orderedLodShift;
+}
+
+uint32_t DrawKey::QuantizeDepth(float distance)
+{
+    if (!(distance > 0.0f)) return 0;  // also catches NaN
+
+    uint32_t bits = 0;
+    memcpy(&bits, &distance, sizeof(bits));
+    return bits >> (31 - c_depthBits);  // the sign bit is 0, keep the next c_depthBits bits
+}
+
+void DrawList::Sort()
+{
+    const size_t count = m_packets.size();
+    if (count < 2) return;
+
+    // Count the digits of all passes at once
+    size_t histograms[c_radixPasses][c_radixSize] = {};
+    for (const auto& packet : m_packets)
+        for (int pass = 0; pass < c_radixPasses; pass++)
+            histograms[pass][(packet.Key >> (pass * c_radixBits)) & (c_radixSize - 1)]++;
+
+    m_scratch.resize(count);
+    for (int pass = 0; pass < c_radixPasses; pass++)
+    {
+        size_t* histogram = histograms[pass];
+        const int shift = pass * c_radixBits;
+
+        // Every key has the same digit, this pass would not move anything
+        if (histogram[(m_packets[0].Key >> shift) & (c_radixSize - 1)] == count) continue;
+
+        size_t offset = 0;
+        for (int digit = 0; digit < c_radixSize; digit++)
+        {
+            const size_t digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (const auto& packet : m_packets) m_scratch[histogram[(packet.Key >> shift) & (c_radixSize - 1)]++] = packet;
+        m_packets.swap(m_scratch);
+    }
+}
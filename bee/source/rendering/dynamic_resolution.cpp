@@ -0,0 +1,73 @@
+#include "rendering/dynamic_resolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+using namespace bee;
+using namespace std;
+
+void DynamicResolution::Reset()
+{
+    m_scale = MaxScale;
+    m_samples = MaxSamples;
+    m_desiredScale = MaxScale;
+    m_filteredTime = 0.0f;
+    std::fill(std::begin(m_recent), std::end(m_recent), 0.0f);
+    m_errors[0] = m_errors[1] = 0.0f;
+    m_frames = 0;
+    m_upFrames = 0;
+    m_overFrames = 0;
+    m_underFrames = 0;
+}
+
+bool DynamicResolution::AddFrame(float gpuTime)
+{
+    // Times of the frames right after a change were measured before it, or are about to be
+    m_frames++;
+    if (m_frames <= SettleFrames) return false;
+    const bool first = m_frames == SettleFrames + 1;
+    if (first) std::fill(std::begin(m_recent), std::end(m_recent), gpuTime);
+    m_recent[m_frames % 3] = gpuTime;
+    const float median = std::max(std::min(m_recent[0], m_recent[1]),
+                                  std::min(std::max(m_recent[0], m_recent[1]), m_recent[2]));
+    m_filteredTime = first ? median : m_filteredTime + (median - m_filteredTime) * Smoothing;
+
+    // Positive with headroom and negative over budget, without the deadband so that the error does not jump at its edge
+    const float relative = (TargetTime - m_filteredTime) / TargetTime;
+    const float error = std::copysign(std::max(std::abs(relative) - Deadband, 0.0f), relative);
+    if (first) m_errors[0] = m_errors[1] = error;
+
+    // Velocity form: the terms move the scale rather than set it, so clamping it does not wind up the integral
+    const float delta = Proportional * (error - m_errors[0]) + Integral * error +
+                        Derivative * (error - 2.0f * m_errors[0] + m_errors[1]);
+    m_errors[1] = m_errors[0];
+    m_errors[0] = error;
+    m_desiredScale = std::clamp(m_desiredScale + delta, MinScale, MaxScale);
+
+    // Down as many steps as needed right away, up one step once there was headroom for a while
+    float scale = m_scale;
+    if (m_scale > MinScale && m_desiredScale <= std::max(m_scale - ScaleStep, MinScale))
+    {
+        const float steps = std::max(std::floor((m_scale - m_desiredScale) / ScaleStep), 1.0f);
+        scale = std::max(m_scale - steps * ScaleStep, MinScale);
+    }
+    m_upFrames = m_scale < MaxScale && m_desiredScale >= std::min(m_scale + ScaleStep, MaxScale) ? m_upFrames + 1 : 0;
+    if (m_upFrames >= UpFrames) scale = std::min(m_scale + ScaleStep, MaxScale);
+
+    // Samples are the last resort, halved only when the smallest scale is not enough
+    int samples = m_samples;
+    m_overFrames = m_scale <= MinScale && relative < -Deadband ? m_overFrames + 1 : 0;
+    m_underFrames = m_scale >= MaxScale && relative >= SampleHeadroom ? m_underFrames + 1 : 0;
+    if (m_overFrames >= SampleFrames && m_samples > MinSamples) samples = std::max(m_samples / 2, MinSamples);
+    if (m_underFrames >= SampleFrames && m_samples < MaxSamples) samples = std::min(m_samples * 2, MaxSamples);
+
+    if (scale == m_scale && samples == m_samples) return false;
+    m_scale = scale;
+    m_samples = samples;
+    m_frames = 0;
+    m_upFrames = 0;
+    m_overFrames = 0;
+    m_underFrames = 0;
+    return true;
+}
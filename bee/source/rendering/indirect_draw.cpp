@@ -0,0 +1,46 @@
+#include "rendering/indirect_draw.hpp"
+
+#include <cassert>
+
+using namespace bee;
+using namespace std;
+
+void bee::BuildIndirectCommands(const DrawList& list,
+                                size_t begin,
+                                size_t end,
+                                uint32_t firstInstance,
+                                const vector<MeshRange>& meshRanges,
+                                const vector<uint32_t>& bucketKeys,
+                                IndirectCommands& result)
+{
+    result.Clear();
+
+    assert(begin <= end && end <= list.Size());
+    uint32_t bucketKey = 0;
+    for (uint32_t i = static_cast<uint32_t>(begin); i < static_cast<uint32_t>(end); i++)
+    {
+        const DrawPacket& draw = list[i];
+        const DrawPacket* previous = i > begin ? &list[i - 1] : nullptr;
+
+        // Another instance of the command before
+        if (previous && previous->Mesh == draw.Mesh && previous->Lod == draw.Lod && previous->Material == draw.Material)
+        {
+            result.Commands.back().InstanceCount++;
+            continue;
+        }
+
+        const uint32_t key = bucketKeys.empty() ? 0 : bucketKeys[draw.Material];
+        if (!previous || key != bucketKey)
+        {
+            result.Buckets.push_back({static_cast<uint32_t>(result.Commands.size()), 0});
+            bucketKey = key;
+        }
+
+        const size_t rangeIndex = draw.Mesh * DrawKey::c_maxLods + draw.Lod;
+        assert(rangeIndex < meshRanges.size());
+        const MeshRange& range = meshRanges[rangeIndex];
+        result.Commands.push_back({range.IndexCount, 1, range.FirstIndex, range.BaseVertex, firstInstance + i});
+        result.FirstDraws.push_back(i);
+        result.Buckets.back().CommandCount++;
+    }
+}
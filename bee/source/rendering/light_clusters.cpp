@@ -0,0 +1,267 @@
+#include "rendering/light_clusters.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "rendering/culling.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BEE_CLUSTER_SSE
+#endif
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+constexpr float c_minDepth = 1e-4f;  // that is taken the logarithm of
+
+}  // namespace
+
+LightClusters::LightClusters()
+{
+    m_minX.resize(c_count);
+    m_minY.resize(c_count);
+    m_minZ.resize(c_count);
+    m_maxX.resize(c_count);
+    m_maxY.resize(c_count);
+    m_maxZ.resize(c_count);
+    m_clusters.resize(c_count);
+}
+
+void LightClusters::SetView(const glm::mat4& view, const glm::mat4& projection, const glm::vec4* lights, size_t count)
+{
+    if (projection != m_projection) ComputeBounds(projection);
+
+    m_lightX.clear();
+    m_lightY.clear();
+    m_lightZ.clear();
+    m_lightRadius.clear();
+    m_lightIndex.clear();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (lights[i].w <= 0.0f) continue;
+        const glm::vec4 position = view * glm::vec4(glm::vec3(lights[i]), 1.0f);
+        m_lightX.push_back(position.x);
+        m_lightY.push_back(position.y);
+        m_lightZ.push_back(position.z);
+        m_lightRadius.push_back(lights[i].w);
+        m_lightIndex.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+void LightClusters::BinSlices(size_t first, size_t last)
+{
+    assert(last <= static_cast<size_t>(c_slices));
+    for (size_t s = first; s < last; s++)
+    {
+        auto& slice = m_slices[s];
+        slice.X.clear();
+        slice.Y.clear();
+        slice.Z.clear();
+        slice.Radius2.clear();
+        slice.Lights.clear();
+        slice.Indices.clear();
+
+        // Only the lights that reach the depth range of the slice can touch its clusters
+        const float sliceNear = m_sliceDepths[s];
+        const float sliceFar = m_sliceDepths[s + 1];
+        for (size_t i = 0; i < m_lightX.size(); i++)
+        {
+            const float depth = -m_lightZ[i];
+            if (depth + m_lightRadius[i] < sliceNear || depth - m_lightRadius[i] > sliceFar) continue;
+            slice.X.push_back(m_lightX[i]);
+            slice.Y.push_back(m_lightY[i]);
+            slice.Z.push_back(m_lightZ[i]);
+            slice.Radius2.push_back(m_lightRadius[i] * m_lightRadius[i]);
+            slice.Lights.push_back(m_lightIndex[i]);
+        }
+
+        const size_t count = slice.Lights.size();
+        for (int y = 0; y < c_tilesY; y++)
+        {
+            for (int x = 0; x < c_tilesX; x++)
+            {
+                const int c = GetIndex(x, y, static_cast<int>(s));
+                const auto offset = static_cast<uint32_t>(slice.Indices.size());
+
+                // A sphere touches a box when the distance from its center to the box is at most its radius
+                size_t i = 0;
+#if defined(__AVX__)
+                const __m256 minX = _mm256_set1_ps(m_minX[c]);
+                const __m256 minY = _mm256_set1_ps(m_minY[c]);
+                const __m256 minZ = _mm256_set1_ps(m_minZ[c]);
+                const __m256 maxX = _mm256_set1_ps(m_maxX[c]);
+                const __m256 maxY = _mm256_set1_ps(m_maxY[c]);
+                const __m256 maxZ = _mm256_set1_ps(m_maxZ[c]);
+                const __m256 zero = _mm256_setzero_ps();
+                for (; i + 8 <= count; i += 8)
+                {
+                    const __m256 lx = _mm256_loadu_ps(slice.X.data() + i);
+                    const __m256 ly = _mm256_loadu_ps(slice.Y.data() + i);
+                    const __m256 lz = _mm256_loadu_ps(slice.Z.data() + i);
+                    const __m256 dx = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minX, lx), _mm256_sub_ps(lx, maxX)), zero);
+                    const __m256 dy = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minY, ly), _mm256_sub_ps(ly, maxY)), zero);
+                    const __m256 dz = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minZ, lz), _mm256_sub_ps(lz, maxZ)), zero);
+                    __m256 distance = _mm256_mul_ps(dx, dx);
+                    distance = _mm256_add_ps(distance, _mm256_mul_ps(dy, dy));
+                    distance = _mm256_add_ps(distance, _mm256_mul_ps(dz, dz));
+                    const __m256 radius2 = _mm256_loadu_ps(slice.Radius2.data() + i);
+                    const int mask = _mm256_movemask_ps(_mm256_cmp_ps(distance, radius2, _CMP_LE_OQ));
+                    for (int j = 0; j < 8; j++)
+                        if ((mask >> j) & 1) slice.Indices.push_back(slice.Lights[i + j]);
+                }
+#elif defined(BEE_CLUSTER_SSE)
+                const __m128 minX = _mm_set1_ps(m_minX[c]);
+                const __m128 minY = _mm_set1_ps(m_minY[c]);
+                const __m128 minZ = _mm_set1_ps(m_minZ[c]);
+                const __m128 maxX = _mm_set1_ps(m_maxX[c]);
+                const __m128 maxY = _mm_set1_ps(m_maxY[c]);
+                const __m128 maxZ = _mm_set1_ps(m_maxZ[c]);
+                const __m128 zero = _mm_setzero_ps();
+                for (; i + 4 <= count; i += 4)
+                {
+                    const __m128 lx = _mm_loadu_ps(slice.X.data() + i);
+                    const __m128 ly = _mm_loadu_ps(slice.Y.data() + i);
+                    const __m128 lz = _mm_loadu_ps(slice.Z.data() + i);
+                    const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minX, lx), _mm_sub_ps(lx, maxX)), zero);
+                    const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minY, ly), _mm_sub_ps(ly, maxY)), zero);
+                    const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minZ, lz), _mm_sub_ps(lz, maxZ)), zero);
+                    __m128 distance = _mm_mul_ps(dx, dx);
+                    distance = _mm_add_ps(distance, _mm_mul_ps(dy, dy));
+                    distance = _mm_add_ps(distance, _mm_mul_ps(dz, dz));
+                    const __m128 radius2 = _mm_loadu_ps(slice.Radius2.data() + i);
+                    const int mask = _mm_movemask_ps(_mm_cmple_ps(distance, radius2));
+                    for (int j = 0; j < 4; j++)
+                        if ((mask >> j) & 1) slice.Indices.push_back(slice.Lights[i + j]);
+                }
+#endif
+
+                // The lights that do not fill a whole SIMD register
+                for (; i < count; i++)
+                {
+                    const float dx = std::max(std::max(m_minX[c] - slice.X[i], slice.X[i] - m_maxX[c]), 0.0f);
+                    const float dy = std::max(std::max(m_minY[c] - slice.Y[i], slice.Y[i] - m_maxY[c]), 0.0f);
+                    const float dz = std::max(std::max(m_minZ[c] - slice.Z[i], slice.Z[i] - m_maxZ[c]), 0.0f);
+                    if (dx * dx + dy * dy + dz * dz <= slice.Radius2[i]) slice.Indices.push_back(slice.Lights[i]);
+                }
+
+                // Relative to the slice until Compact
+                m_clusters[c] = {offset, static_cast<uint32_t>(slice.Indices.size()) - offset};
+            }
+        }
+    }
+}
+
+void LightClusters::Compact()
+{
+    m_lightIndices.clear();
+    m_maxClusterLights = 0;
+    for (int s = 0; s < c_slices; s++)
+    {
+        const auto base = static_cast<uint32_t>(m_lightIndices.size());
+        for (int c = GetIndex(0, 0, s); c < GetIndex(0, 0, s + 1); c++)
+        {
+            m_clusters[c].Offset += base;
+            m_maxClusterLights = std::max(m_maxClusterLights, m_clusters[c].Count);
+        }
+        m_lightIndices.insert(m_lightIndices.end(), m_slices[s].Indices.begin(), m_slices[s].Indices.end());
+    }
+}
+
+void LightClusters::Build(const glm::mat4& view, const glm::mat4& projection, const glm::vec4* lights, size_t count)
+{
+    SetView(view, projection, lights, count);
+    BinSlices(0, c_slices);
+    Compact();
+}
+
+int LightClusters::GetSlice(float depth) const
+{
+    const float d = m_logarithmic ? std::log(std::max(depth, c_minDepth)) : depth;
+    return std::clamp(static_cast<int>(std::floor(d * m_sliceScale - m_sliceBias)), 0, c_slices - 1);
+}
+
+pair<glm::vec3, glm::vec3> LightClusters::GetBounds(int index) const
+{
+    return {{m_minX[index], m_minY[index], m_minZ[index]}, {m_maxX[index], m_maxY[index], m_maxZ[index]}};
+}
+
+void LightClusters::ComputeBounds(const glm::mat4& projection)
+{
+    m_projection = projection;
+
+    const auto [zNear, zFar] = GetDepthRange(projection);
+    m_logarithmic = projection[2][3] != 0.0f && zNear > 0.0f;
+    if (m_logarithmic)
+    {
+        m_sliceScale = static_cast<float>(c_slices) / std::log(zFar / zNear);
+        m_sliceBias = std::log(zNear) * m_sliceScale;
+    }
+    else
+    {
+        m_sliceScale = static_cast<float>(c_slices) / (zFar - zNear);
+        m_sliceBias = zNear * m_sliceScale;
+    }
+    for (int s = 0; s <= c_slices; s++)
+    {
+        const float t = static_cast<float>(s) / static_cast<float>(c_slices);
+        m_sliceDepths[s] = m_logarithmic ? zNear * std::pow(zFar / zNear, t) : zNear + (zFar - zNear) * t;
+    }
+
+    // The points where the rays through the corners of the tiles cross the near and far plane, in view space
+    const glm::mat4 inverseProjection = glm::inverse(projection);
+    glm::vec3 nearCorners[(c_tilesX + 1) * (c_tilesY + 1)];
+    glm::vec3 farCorners[(c_tilesX + 1) * (c_tilesY + 1)];
+    for (int y = 0; y <= c_tilesY; y++)
+    {
+        for (int x = 0; x <= c_tilesX; x++)
+        {
+            const glm::vec2 ndc(-1.0f + 2.0f * static_cast<float>(x) / static_cast<float>(c_tilesX),
+                                -1.0f + 2.0f * static_cast<float>(y) / static_cast<float>(c_tilesY));
+            const glm::vec4 nearCorner = inverseProjection * glm::vec4(ndc, -1.0f, 1.0f);
+            const glm::vec4 farCorner = inverseProjection * glm::vec4(ndc, 1.0f, 1.0f);
+            nearCorners[y * (c_tilesX + 1) + x] = glm::vec3(nearCorner) / nearCorner.w;
+            farCorners[y * (c_tilesX + 1) + x] = glm::vec3(farCorner) / farCorner.w;
+        }
+    }
+
+    // A cluster is the box around the corners of its tile at the depths where its slice starts and ends
+    for (int s = 0; s < c_slices; s++)
+    {
+        const float t0 = (m_sliceDepths[s] - zNear) / (zFar - zNear);
+        const float t1 = (m_sliceDepths[s + 1] - zNear) / (zFar - zNear);
+        for (int y = 0; y < c_tilesY; y++)
+        {
+            for (int x = 0; x < c_tilesX; x++)
+            {
+                glm::vec3 min(numeric_limits<float>::max());
+                glm::vec3 max(-numeric_limits<float>::max());
+                for (int corner = 0; corner < 4; corner++)
+                {
+                    const int i = (y + (corner >> 1)) * (c_tilesX + 1) + x + (corner & 1);
+                    for (const float t : {t0, t1})
+                    {
+                        const glm::vec3 point = glm::mix(nearCorners[i], farCorners[i], t);
+                        min = glm::min(min, point);
+                        max = glm::max(max, point);
+                    }
+                }
+
+                const int c = GetIndex(x, y, s);
+                m_minX[c] = min.x;
+                m_minY[c] = min.y;
+                m_minZ[c] = min.z;
+                m_maxX[c] = max.x;
+                m_maxY[c] = max.y;
+                m_maxZ[c] = max.z;
+            }
+        }
+    }
+}
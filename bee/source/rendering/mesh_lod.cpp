@@ -0,0 +1,358 @@
+#include "rendering/mesh_lod.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+
+#include "math/geometry.hpp"
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+constexpr size_t c_minLodTriangles = 64;  // smaller meshes are cheap enough as they are
+constexpr float c_minLodReduction = 0.8f;  // a level must have at most this part of the triangles of the one before
+
+// The largest error of every level, relative to the diagonal of the bounds of the mesh
+constexpr float c_lodMaxErrors[MeshData::c_maxLods - 1] = {0.002f, 0.006f, 0.02f};
+
+// The squared distances to a set of planes, weighted by the area of the triangles they came from: for a point p,
+// p^T A p + 2 b^T p + c
+struct Quadric
+{
+    double A00 = 0.0, A11 = 0.0, A22 = 0.0, A01 = 0.0, A02 = 0.0, A12 = 0.0;
+    double B0 = 0.0, B1 = 0.0, B2 = 0.0;
+    double C = 0.0;
+    double Weight = 0.0;
+
+    void AddPlane(const glm::dvec3& normal, double distance, double weight)
+    {
+        A00 += weight * normal.x * normal.x;
+        A11 += weight * normal.y * normal.y;
+        A22 += weight * normal.z * normal.z;
+        A01 += weight * normal.x * normal.y;
+        A02 += weight * normal.x * normal.z;
+        A12 += weight * normal.y * normal.z;
+        B0 += weight * normal.x * distance;
+        B1 += weight * normal.y * distance;
+        B2 += weight * normal.z * distance;
+        C += weight * distance * distance;
+        Weight += weight;
+    }
+
+    Quadric& operator+=(const Quadric& other)
+    {
+        A00 += other.A00;
+        A11 += other.A11;
+        A22 += other.A22;
+        A01 += other.A01;
+        A02 += other.A02;
+        A12 += other.A12;
+        B0 += other.B0;
+        B1 += other.B1;
+        B2 += other.B2;
+        C += other.C;
+        Weight += other.Weight;
+        return *this;
+    }
+
+    // The mean squared distance of a point to the planes
+    double GetError(const glm::vec3& point) const
+    {
+        const double x = point.x, y = point.y, z = point.z;
+        const double error = A00 * x * x + A11 * y * y + A22 * z * z + 2.0 * (A01 * x * y + A02 * x * z + A12 * y * z) +
+                             2.0 * (B0 * x + B1 * y + B2 * z) + C;
+        return Weight > 0.0 ? std::max(error, 0.0) / Weight : 0.0;
+    }
+};
+
+// Moves position From onto position To
+struct Collapse
+{
+    uint32_t From = 0;
+    uint32_t To = 0;
+    double Error = 0.0;  // squared
+};
+
+struct PositionHash
+{
+    size_t operator()(const glm::vec3& position) const
+    {
+        uint32_t bits[3];
+        memcpy(bits, &position, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+    }
+};
+
+uint64_t GetEdgeKey(uint32_t a, uint32_t b)
+{
+    return a < b ? static_cast<uint64_t>(a) << 32 | b : static_cast<uint64_t>(b) << 32 | a;
+}
+
+}  // namespace
+
+vector<uint32_t> bee::SimplifyMesh(const vector<glm::vec3>& positions,
+                                   const vector<uint32_t>& indices,
+                                   size_t targetIndexCount,
+                                   float maxError,
+                                   float* resultError)
+{
+    assert(indices.size() % 3 == 0);
+    if (resultError) *resultError = 0.0f;
+    vector<uint32_t> result = indices;
+    if (result.size() <= targetIndexCount) return result;
+
+    // Vertices with the same position are the sides of a seam, and collapse as one position
+    const size_t vertexCount = positions.size();
+    vector<uint32_t> positionOf(vertexCount);
+    vector<glm::vec3> welded;
+    {
+        unordered_map<glm::vec3, uint32_t, PositionHash> ids;
+        ids.reserve(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            const auto [it, inserted] = ids.try_emplace(positions[v], static_cast<uint32_t>(welded.size()));
+            if (inserted) welded.push_back(positions[v]);
+            positionOf[v] = it->second;
+        }
+    }
+    const size_t positionCount = welded.size();
+
+    vector<Quadric> quadrics(positionCount);
+    for (size_t t = 0; t < result.size(); t += 3)
+    {
+        const glm::dvec3 p0 = welded[positionOf[result[t]]];
+        const glm::dvec3 p1 = welded[positionOf[result[t + 1]]];
+        const glm::dvec3 p2 = welded[positionOf[result[t + 2]]];
+        glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        const double doubleArea = glm::length(normal);
+        if (!(doubleArea > 0.0)) continue;
+
+        normal /= doubleArea;
+        for (int c = 0; c < 3; c++)
+            quadrics[positionOf[result[t + c]]].AddPlane(normal, -glm::dot(normal, p0), doubleArea * 0.5);
+    }
+
+    // Positions on open borders, and on edges of more than two triangles, do not move
+    vector<uint8_t> locked(positionCount, 0);
+    {
+        unordered_map<uint64_t, uint32_t> edgeTriangles;
+        edgeTriangles.reserve(result.size());
+        for (size_t t = 0; t < result.size(); t += 3)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                const uint32_t a = positionOf[result[t + c]];
+                const uint32_t b = positionOf[result[t + (c + 1) % 3]];
+                if (a != b) edgeTriangles[GetEdgeKey(a, b)]++;
+            }
+        }
+        for (const auto& [edge, count] : edgeTriangles)
+        {
+            if (count == 2) continue;
+            locked[edge >> 32] = 1;
+            locked[edge & 0xffffffffu] = 1;
+        }
+    }
+
+    const double maxError2 = static_cast<double>(maxError) * maxError;
+    double worstError2 = 0.0;
+    vector<uint32_t> triangleOffsets(positionCount + 1);
+    vector<uint32_t> cursors(positionCount);
+    vector<uint32_t> adjacency;
+    vector<uint64_t> edges;
+    vector<Collapse> collapses;
+    vector<uint8_t> touched(positionCount);
+    vector<uint32_t> remap(vertexCount);
+    iota(remap.begin(), remap.end(), 0u);
+    vector<uint32_t> moved;
+    vector<pair<uint32_t, uint32_t>> wedges;  // of a collapse, every vertex at From and the vertex at To it moves to
+
+    // Every pass collapses the edges with the smallest error, as long as they do not share triangles
+    while (result.size() > targetIndexCount)
+    {
+        // The triangles around every position
+        fill(triangleOffsets.begin(), triangleOffsets.end(), 0u);
+        for (const uint32_t index : result) triangleOffsets[positionOf[index] + 1]++;
+        partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+        copy(triangleOffsets.begin(), triangleOffsets.end() - 1, cursors.begin());
+        adjacency.resize(result.size());
+        for (size_t i = 0; i < result.size(); i++)
+            adjacency[cursors[positionOf[result[i]]]++] = static_cast<uint32_t>(i / 3);
+
+        edges.clear();
+        for (size_t t = 0; t < result.size(); t += 3)
+            for (int c = 0; c < 3; c++)
+                edges.push_back(GetEdgeKey(positionOf[result[t + c]], positionOf[result[t + (c + 1) % 3]]));
+        sort(edges.begin(), edges.end());
+        edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+        // Every edge collapses in the direction that adds the least error
+        collapses.clear();
+        for (const uint64_t edge : edges)
+        {
+            const auto a = static_cast<uint32_t>(edge >> 32);
+            const auto b = static_cast<uint32_t>(edge & 0xffffffffu);
+            Quadric quadric = quadrics[a];
+            quadric += quadrics[b];
+            const double toB = locked[a] ? numeric_limits<double>::infinity() : quadric.GetError(welded[b]);
+            const double toA = locked[b] ? numeric_limits<double>::infinity() : quadric.GetError(welded[a]);
+            if (std::min(toA, toB) > maxError2) continue;
+            collapses.push_back(toB <= toA ? Collapse{a, b, toB} : Collapse{b, a, toA});
+        }
+        sort(collapses.begin(),
+             collapses.end(),
+             [](const Collapse& c1, const Collapse& c2) { return c1.Error < c2.Error; });
+
+        fill(touched.begin(), touched.end(), uint8_t(0));
+        const size_t needed = (result.size() - targetIndexCount + 2) / 3;  // triangles to remove
+        size_t removed = 0;
+        for (const auto& collapse : collapses)
+        {
+            if (removed >= needed) break;
+            const uint32_t from = collapse.From;
+            const uint32_t to = collapse.To;
+            if (touched[from] || touched[to]) continue;
+
+            // Every vertex at From moves to the vertex at To that it shares an edge with, on the same side of a seam
+            wedges.clear();
+            size_t shared = 0;
+            for (uint32_t k = triangleOffsets[from]; k < triangleOffsets[from + 1]; k++)
+            {
+                const uint32_t* triangle = &result[adjacency[k] * 3];
+                int cornerFrom = -1;
+                int cornerTo = -1;
+                for (int c = 0; c < 3; c++)
+                {
+                    if (positionOf[triangle[c]] == from) cornerFrom = c;
+                    if (positionOf[triangle[c]] == to) cornerTo = c;
+                }
+                if (cornerTo < 0) continue;
+
+                shared++;
+                const uint32_t vertex = triangle[cornerFrom];
+                const auto found = find_if(wedges.begin(), wedges.end(), [&](const auto& w) { return w.first == vertex; });
+                if (found == wedges.end()) wedges.emplace_back(vertex, triangle[cornerTo]);
+            }
+
+            // The triangles that remain must find where their vertex goes, and must not flip
+            bool valid = shared > 0;
+            for (uint32_t k = triangleOffsets[from]; valid && k < triangleOffsets[from + 1]; k++)
+            {
+                const uint32_t* triangle = &result[adjacency[k] * 3];
+                glm::vec3 before[3];
+                glm::vec3 after[3];
+                bool removes = false;
+                uint32_t vertex = 0;
+                for (int c = 0; c < 3; c++)
+                {
+                    const uint32_t position = positionOf[triangle[c]];
+                    removes |= position == to;
+                    before[c] = after[c] = welded[position];
+                    if (position == from)
+                    {
+                        after[c] = welded[to];
+                        vertex = triangle[c];
+                    }
+                }
+                if (removes) continue;
+
+                const bool mapped =
+                    find_if(wedges.begin(), wedges.end(), [&](const auto& w) { return w.first == vertex; }) != wedges.end();
+                const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+                valid = mapped && glm::dot(normalBefore, normalAfter) > 0.0f;
+            }
+            if (!valid) continue;
+
+            for (const auto& [vertex, target] : wedges)
+            {
+                remap[vertex] = target;
+                moved.push_back(vertex);
+            }
+            quadrics[to] += quadrics[from];
+
+            // Later collapses of this pass may not change the triangles that this one tested
+            for (uint32_t k = triangleOffsets[from]; k < triangleOffsets[from + 1]; k++)
+                for (int c = 0; c < 3; c++) touched[positionOf[result[adjacency[k] * 3 + c]]] = 1;
+            worstError2 = std::max(worstError2, collapse.Error);
+            removed += shared;
+        }
+        if (moved.empty()) break;
+
+        // Move the vertices, and drop the triangles that collapsed
+        size_t size = 0;
+        for (size_t t = 0; t < result.size(); t += 3)
+        {
+            const uint32_t i0 = remap[result[t]];
+            const uint32_t i1 = remap[result[t + 1]];
+            const uint32_t i2 = remap[result[t + 2]];
+            const uint32_t p0 = positionOf[i0];
+            const uint32_t p1 = positionOf[i1];
+            const uint32_t p2 = positionOf[i2];
+            if (p0 == p1 || p1 == p2 || p0 == p2) continue;
+            result[size++] = i0;
+            result[size++] = i1;
+            result[size++] = i2;
+        }
+        result.resize(size);
+
+        for (const uint32_t vertex : moved) remap[vertex] = vertex;
+        moved.clear();
+    }
+
+    if (resultError) *resultError = static_cast<float>(std::sqrt(worstError2));
+    return result;
+}
+
+void bee::GenerateLods(MeshData& data)
+{
+    data.Lods.clear();
+    if (data.Indices.size() < c_minLodTriangles * 3 || data.Positions.empty()) return;
+
+    const auto [min, max] = ComputeAABB(data.Positions);
+    const float diagonal = glm::length(max - min);
+    if (!(diagonal > 0.0f)) return;
+
+    // Every level simplifies the one before, so the errors add up
+    data.Lods.reserve(MeshData::c_maxLods - 1);
+    float error = 0.0f;
+    for (int level = 1; level < MeshData::c_maxLods; level++)
+    {
+        const auto& previous = data.GetLodIndices(level - 1);
+        const size_t target = (data.Indices.size() >> level) / 3 * 3;
+        const float maxError = c_lodMaxErrors[level - 1] * diagonal - error;
+        if (maxError <= 0.0f) break;
+
+        float levelError = 0.0f;
+        auto indices = SimplifyMesh(data.Positions, previous, target, maxError, &levelError);
+        if (static_cast<float>(indices.size()) > static_cast<float>(previous.size()) * c_minLodReduction) break;
+
+        error += levelError;
+        data.Lods.push_back({std::move(indices), error / diagonal});
+    }
+}
+
+float bee::GetScreenSize(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& center, float radius)
+{
+    // w is the distance in front of the camera for perspective projections, and 1 for orthographic ones. Spheres around
+    // or behind the camera get a large size, and the most detail.
+    const glm::vec4 clip = projection * (view * glm::vec4(center, 1.0f));
+    return radius * std::abs(projection[1][1]) / std::max(clip.w, 1e-4f);
+}
+
+int bee::SelectLod(float screenSize, int previous, int lodCount)
+{
+    assert(lodCount >= 1 && lodCount <= MeshData::c_maxLods);
+    int lod = std::clamp(previous, 0, lodCount - 1);
+    while (lod < lodCount - 1 && screenSize < c_lodScreenSizes[lod] * (1.0f - c_lodHysteresis)) lod++;
+    while (lod > 0 && screenSize > c_lodScreenSizes[lod - 1] * (1.0f + c_lodHysteresis)) lod--;
+    return lod;
+}
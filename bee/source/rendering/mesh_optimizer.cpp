@@ -0,0 +1,300 @@
+#include "rendering/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+constexpr uint32_t c_unused = numeric_limits<uint32_t>::max();
+
+// A cluster may end once its ACMR is this close to the ACMR of the whole mesh
+constexpr float c_clusterAcmrThreshold = 1.05f;
+
+// The triangles around every vertex, as ranges of one array
+struct Adjacency
+{
+    vector<uint32_t> Offsets;  // vertexCount + 1
+    vector<uint32_t> Triangles;
+
+    Adjacency(const vector<uint32_t>& indices, size_t vertexCount) : Offsets(vertexCount + 1, 0), Triangles(indices.size())
+    {
+        for (const uint32_t index : indices) Offsets[index + 1]++;
+        partial_sum(Offsets.begin(), Offsets.end(), Offsets.begin());
+        vector<uint32_t> cursors(Offsets.begin(), Offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++) Triangles[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+};
+
+// Orders the triangles with Tipsify, and returns in clusters where the order had to jump to a vertex that is no longer
+// in the cache
+void Tipsify(const vector<uint32_t>& indices, size_t vertexCount, vector<uint32_t>& order, vector<uint32_t>& clusters)
+{
+    const size_t triangleCount = indices.size() / 3;
+    const Adjacency adjacency(indices, vertexCount);
+
+    vector<uint32_t> live(vertexCount);  // triangles around a vertex that were not emitted yet
+    for (size_t v = 0; v < vertexCount; v++) live[v] = adjacency.Offsets[v + 1] - adjacency.Offsets[v];
+    vector<uint32_t> cacheTime(vertexCount, 0);
+    vector<uint8_t> emitted(triangleCount, 0);
+    vector<uint32_t> deadEnds;  // vertices of emitted triangles, to continue from when a fan has no neighbours left
+    vector<uint32_t> candidates;
+    uint32_t time = c_vertexCacheSize + 1;
+    size_t cursor = 0;
+
+    const auto skipDeadEnd = [&]() -> int64_t
+    {
+        while (!deadEnds.empty())
+        {
+            const uint32_t vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (live[vertex] > 0) return vertex;
+        }
+        for (; cursor < vertexCount; cursor++)
+            if (live[cursor] > 0) return static_cast<int64_t>(cursor);
+        return -1;
+    };
+
+    order.clear();
+    clusters.assign(1, 0);
+    int64_t fan = skipDeadEnd();
+    while (fan >= 0)
+    {
+        // Emit all triangles around the fan vertex
+        candidates.clear();
+        for (uint32_t k = adjacency.Offsets[fan]; k < adjacency.Offsets[fan + 1]; k++)
+        {
+            const uint32_t triangle = adjacency.Triangles[k];
+            if (emitted[triangle]) continue;
+            emitted[triangle] = 1;
+            order.push_back(triangle);
+            for (int c = 0; c < 3; c++)
+            {
+                const uint32_t vertex = indices[triangle * 3 + c];
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                live[vertex]--;
+                if (time - cacheTime[vertex] > c_vertexCacheSize) cacheTime[vertex] = time++;
+            }
+        }
+
+        // Continue with the neighbour that has been in the cache the longest, as long as fanning around it does not
+        // push it out of the cache
+        int64_t next = -1;
+        int64_t best = -1;
+        for (const uint32_t vertex : candidates)
+        {
+            if (live[vertex] == 0) continue;
+            int64_t priority = 0;
+            if (time - cacheTime[vertex] + 2 * live[vertex] <= c_vertexCacheSize) priority = time - cacheTime[vertex];
+            if (priority > best)
+            {
+                best = priority;
+                next = vertex;
+            }
+        }
+
+        if (next < 0)
+        {
+            next = skipDeadEnd();
+            const bool flushed = next >= 0 && time - cacheTime[next] > c_vertexCacheSize;
+            if (flushed && order.size() > clusters.back()) clusters.push_back(static_cast<uint32_t>(order.size()));
+        }
+        fan = next;
+    }
+    assert(order.size() == triangleCount);
+}
+
+// Splits clusters further where their ACMR is already good, so that the overdraw order has more to choose from
+void SplitClusters(const vector<uint32_t>& indices,
+                   const vector<uint32_t>& order,
+                   size_t vertexCount,
+                   float meshAcmr,
+                   vector<uint32_t>& clusters)
+{
+    vector<uint32_t> split;
+    vector<uint32_t> cacheTime(vertexCount, 0);
+    uint32_t time = c_vertexCacheSize + 1;
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        const size_t end = c + 1 < clusters.size() ? clusters[c + 1] : order.size();
+        split.push_back(clusters[c]);
+
+        // Every cluster starts with an empty cache, since it may be drawn after any other
+        time += c_vertexCacheSize + 1;
+        uint32_t misses = 0;
+        uint32_t triangles = 0;
+        for (size_t t = clusters[c]; t < end; t++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                const uint32_t vertex = indices[order[t] * 3 + k];
+                if (time - cacheTime[vertex] <= c_vertexCacheSize) continue;
+                cacheTime[vertex] = time++;
+                misses++;
+            }
+            triangles++;
+
+            if (t + 1 < end && static_cast<float>(misses) <= c_clusterAcmrThreshold * meshAcmr * triangles)
+            {
+                split.push_back(static_cast<uint32_t>(t + 1));
+                time += c_vertexCacheSize + 1;
+                misses = 0;
+                triangles = 0;
+            }
+        }
+    }
+    clusters = std::move(split);
+}
+
+}  // namespace
+
+VertexCacheStats bee::AnalyzeVertexCache(const vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+    VertexCacheStats stats;
+    if (indices.empty()) return stats;
+
+    vector<uint32_t> cacheTime(vertexCount, 0);
+    vector<uint8_t> used(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0;
+    size_t usedCount = 0;
+    for (const uint32_t index : indices)
+    {
+        assert(index < vertexCount);
+        usedCount += used[index] == 0;
+        used[index] = 1;
+        if (time - cacheTime[index] <= cacheSize) continue;
+        cacheTime[index] = time++;
+        misses++;
+    }
+
+    stats.Acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+    stats.Atvr = static_cast<float>(misses) / static_cast<float>(usedCount);
+    return stats;
+}
+
+vector<uint32_t> bee::OptimizeVertexCache(const vector<uint32_t>& indices,
+                                          const vector<glm::vec3>& positions,
+                                          size_t vertexCount)
+{
+    assert(indices.size() % 3 == 0);
+    if (indices.empty()) return {};
+
+    vector<uint32_t> order;
+    vector<uint32_t> clusters;
+    Tipsify(indices, vertexCount, order, clusters);
+
+    vector<uint32_t> clusterOrder(clusters.size());
+    iota(clusterOrder.begin(), clusterOrder.end(), 0u);
+    if (!positions.empty())
+    {
+        vector<uint32_t> tipsified(indices.size());
+        for (size_t t = 0; t < order.size(); t++)
+            for (int c = 0; c < 3; c++) tipsified[t * 3 + c] = indices[order[t] * 3 + c];
+        SplitClusters(indices, order, vertexCount, AnalyzeVertexCache(tipsified, vertexCount).Acmr, clusters);
+        clusterOrder.resize(clusters.size());
+        iota(clusterOrder.begin(), clusterOrder.end(), 0u);
+
+        // The center of the mesh and of every cluster weighted by area, and the direction that clusters face
+        vector<glm::vec3> centers(clusters.size(), glm::vec3(0.0f));
+        vector<glm::vec3> normals(clusters.size(), glm::vec3(0.0f));
+        vector<float> areas(clusters.size(), 0.0f);
+        glm::vec3 meshCenter(0.0f);
+        float meshArea = 0.0f;
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            const size_t end = c + 1 < clusters.size() ? clusters[c + 1] : order.size();
+            for (size_t t = clusters[c]; t < end; t++)
+            {
+                const glm::vec3& p0 = positions[indices[order[t] * 3]];
+                const glm::vec3& p1 = positions[indices[order[t] * 3 + 1]];
+                const glm::vec3& p2 = positions[indices[order[t] * 3 + 2]];
+                const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                const float area = glm::length(normal);
+                centers[c] += (p0 + p1 + p2) * (area / 3.0f);
+                normals[c] += normal;
+                areas[c] += area;
+            }
+            meshCenter += centers[c];
+            meshArea += areas[c];
+            if (areas[c] > 0.0f) centers[c] /= areas[c];
+        }
+        if (meshArea > 0.0f) meshCenter /= meshArea;
+
+        // Clusters that face away from the center are likely on the outside, in front of the others
+        vector<float> outwards(clusters.size(), 0.0f);
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            const float length = glm::length(normals[c]);
+            if (length > 0.0f) outwards[c] = glm::dot(centers[c] - meshCenter, normals[c] / length);
+        }
+        stable_sort(clusterOrder.begin(),
+                    clusterOrder.end(),
+                    [&](uint32_t c1, uint32_t c2) { return outwards[c1] > outwards[c2]; });
+    }
+
+    vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (const uint32_t c : clusterOrder)
+    {
+        const size_t end = c + 1 < clusters.size() ? clusters[c + 1] : order.size();
+        for (size_t t = clusters[c]; t < end; t++)
+            for (int k = 0; k < 3; k++) result.push_back(indices[order[t] * 3 + k]);
+    }
+    return result;
+}
+
+void bee::OptimizeVertexFetch(MeshData& data)
+{
+    const size_t vertexCount = data.GetVertexCount();
+    vector<uint32_t> remap(vertexCount, c_unused);
+    uint32_t used = 0;
+    const auto remapIndices = [&](vector<uint32_t>& indices)
+    {
+        for (auto& index : indices)
+        {
+            assert(index < vertexCount);
+            if (remap[index] == c_unused) remap[index] = used++;
+            index = remap[index];
+        }
+    };
+    remapIndices(data.Indices);
+    for (auto& lod : data.Lods) remapIndices(lod.Indices);
+
+    const auto reorder = [&](auto& attribute)
+    {
+        if (attribute.empty()) return;
+        assert(attribute.size() == vertexCount);
+        std::decay_t<decltype(attribute)> reordered(used);
+        for (size_t v = 0; v < vertexCount; v++)
+            if (remap[v] != c_unused) reordered[remap[v]] = attribute[v];
+        attribute = std::move(reordered);
+    };
+    reorder(data.Positions);
+    reorder(data.Normals);
+    reorder(data.Tangents);
+    reorder(data.Colors);
+    reorder(data.TexCoords0);
+    reorder(data.TexCoords1);
+}
+
+MeshOptimizationStats bee::OptimizeMesh(MeshData& data)
+{
+    MeshOptimizationStats stats;
+    if (data.IsEmpty()) return stats;
+
+    const size_t vertexCount = data.GetVertexCount();
+    stats.Before = AnalyzeVertexCache(data.Indices, vertexCount);
+    data.Indices = OptimizeVertexCache(data.Indices, data.Positions, vertexCount);
+    for (auto& lod : data.Lods) lod.Indices = OptimizeVertexCache(lod.Indices, data.Positions, vertexCount);
+    OptimizeVertexFetch(data);
+    stats.After = AnalyzeVertexCache(data.Indices, data.GetVertexCount());
+    return stats;
+}
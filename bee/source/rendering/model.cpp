@@ -7,6 +7,7 @@
 #include "core/device.hpp"
 #include "core/engine.hpp"
 #include "core/fileio.hpp"
+#include "core/name.hpp"
 #include "core/resources.hpp"
 #include "core/transform.hpp"
 #include "rendering/image.hpp"
@@ -98,7 +99,7 @@ void Model::InstantiateNode(uint32_t nodeIdx, Entity parent) const
 
     // Transform
     auto& transform = Engine.ECS().CreateComponent<Transform>(entity);
-    transform.Name = node.name;
+    if (!node.name.empty()) Engine.ECS().CreateComponent<Name>(entity, node.name);
     if (parent != entt::null) transform.SetParent(parent);
 
     if (!node.matrix.empty())
@@ -128,7 +129,7 @@ void Model::InstantiateNode(uint32_t nodeIdx, Entity parent) const
             {
                 primitiveEntity = Engine.ECS().CreateEntity();
                 auto& primitiveTransform = Engine.ECS().CreateComponent<Transform>(primitiveEntity);
-                primitiveTransform.Name = "Primitive " + to_string(p);
+                Engine.ECS().CreateComponent<Name>(primitiveEntity, "Primitive " + to_string(p));
                 primitiveTransform.SetParent(entity);
             }
 
@@ -0,0 +1,301 @@
+#include "rendering/occlusion_culler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BEE_OCCLUSION_SSE
+#endif
+
+using namespace bee;
+using namespace std;
+
+static_assert(OcclusionCuller::c_width % 4 == 0, "rows are rasterized 4 pixels at a time");
+static_assert(OcclusionCuller::c_height % OcclusionCuller::c_bands == 0, "bands have the same number of rows");
+
+void OcclusionCuller::SetView(const glm::mat4& viewProjection)
+{
+    m_viewProjection = viewProjection;
+    m_occluderCount = 0;
+
+    if (m_levels.empty())
+    {
+        int width = c_width;
+        int height = c_height;
+        while (true)
+        {
+            m_levels.push_back({width, height, vector<float>(static_cast<size_t>(width) * height)});
+            if (width == 1 && height == 1) break;
+            width = max(1, width / 2);
+            height = max(1, height / 2);
+        }
+    }
+    fill(m_levels[0].Depth.begin(), m_levels[0].Depth.end(), 1.0f);
+}
+
+void OcclusionCuller::AddOccluder(const vector<glm::vec3>& positions,
+                                  const vector<uint32_t>& indices,
+                                  const glm::mat4& world)
+{
+    if (m_occluderCount == m_occluders.size()) m_occluders.emplace_back();
+    Occluder& occluder = m_occluders[m_occluderCount++];
+    occluder.Positions = &positions;
+    occluder.Indices = &indices;
+    occluder.Transform = m_viewProjection * world;
+    occluder.Triangles.clear();
+}
+
+void OcclusionCuller::SetupOccluders(size_t first, size_t last)
+{
+    for (size_t i = first; i < last; i++)
+    {
+        Occluder& occluder = m_occluders[i];
+        const auto& positions = *occluder.Positions;
+        const auto& indices = *occluder.Indices;
+        occluder.Triangles.clear();
+
+        for (size_t t = 0; t + 2 < indices.size(); t += 3)
+        {
+            const glm::vec4 v[3] = {occluder.Transform * glm::vec4(positions[indices[t]], 1.0f),
+                                    occluder.Transform * glm::vec4(positions[indices[t + 1]], 1.0f),
+                                    occluder.Transform * glm::vec4(positions[indices[t + 2]], 1.0f)};
+
+            // Skip triangles that are completely outside one side of the view volume
+            const auto outside = [&](int axis, float sign)
+            {
+                for (const auto& vertex : v)
+                    if (sign * vertex[axis] <= vertex.w) return false;
+                return true;
+            };
+            if (outside(0, 1.0f) || outside(0, -1.0f) || outside(1, 1.0f) || outside(1, -1.0f) || outside(2, 1.0f))
+                continue;
+
+            // Clip against the near plane, z >= -w, which leaves a triangle or a quad
+            glm::vec4 polygon[4];
+            int count = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                const glm::vec4& a = v[k];
+                const glm::vec4& b = v[(k + 1) % 3];
+                const float da = a.z + a.w;
+                const float db = b.z + b.w;
+                if (da >= 0.0f) polygon[count++] = a;
+                if ((da >= 0.0f) != (db >= 0.0f)) polygon[count++] = a + (b - a) * (da / (da - db));
+            }
+            for (int k = 1; k + 1 < count; k++) AddTriangle(polygon[0], polygon[k], polygon[k + 1], occluder.Triangles);
+        }
+    }
+}
+
+void OcclusionCuller::AddTriangle(const glm::vec4& v0,
+                                  const glm::vec4& v1,
+                                  const glm::vec4& v2,
+                                  vector<Triangle>& triangles)
+{
+    if (v0.w <= 0.0f || v1.w <= 0.0f || v2.w <= 0.0f) return;
+
+    // Pixels, with y up like normalized device coordinates, and depth from 0 to 1
+    const auto toScreen = [](const glm::vec4& v)
+    {
+        const glm::vec3 ndc = glm::vec3(v) / v.w;
+        return glm::vec3((ndc.x * 0.5f + 0.5f) * c_width, (ndc.y * 0.5f + 0.5f) * c_height, ndc.z * 0.5f + 0.5f);
+    };
+    const glm::vec3 p[3] = {toScreen(v0), toScreen(v1), toScreen(v2)};
+
+    // Counter-clockwise triangles have a positive area, the others face away or are degenerate
+    const float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+    if (!(area > 0.0f)) return;
+
+    Triangle triangle;
+    triangle.MinX = max(0, static_cast<int>(floor(min({p[0].x, p[1].x, p[2].x}))));
+    triangle.MaxX = min(c_width - 1, static_cast<int>(floor(max({p[0].x, p[1].x, p[2].x}))));
+    triangle.MinY = max(0, static_cast<int>(floor(min({p[0].y, p[1].y, p[2].y}))));
+    triangle.MaxY = min(c_height - 1, static_cast<int>(floor(max({p[0].y, p[1].y, p[2].y}))));
+    if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY) return;
+
+    for (int k = 0; k < 3; k++)
+    {
+        const glm::vec3& a = p[k];
+        const glm::vec3& b = p[(k + 1) % 3];
+        triangle.A[k] = a.y - b.y;
+        triangle.B[k] = b.x - a.x;
+        triangle.C[k] = -(triangle.A[k] * a.x + triangle.B[k] * a.y);
+    }
+
+    // The depth plane at the far corner of every pixel, but never beyond the farthest vertex
+    const glm::vec3 d1 = p[1] - p[0];
+    const glm::vec3 d2 = p[2] - p[0];
+    triangle.ZA = (d1.z * d2.y - d2.z * d1.y) / area;
+    triangle.ZB = (d1.x * d2.z - d2.x * d1.z) / area;
+    triangle.ZC = p[0].z - triangle.ZA * p[0].x - triangle.ZB * p[0].y + 0.5f * (abs(triangle.ZA) + abs(triangle.ZB));
+    triangle.ZMax = max({p[0].z, p[1].z, p[2].z});
+    triangles.push_back(triangle);
+}
+
+void OcclusionCuller::RasterizeBands(size_t first, size_t last)
+{
+    for (size_t band = first; band < last; band++)
+    {
+        const int minY = static_cast<int>(band) * c_bandHeight;
+        const int maxY = minY + c_bandHeight - 1;
+        for (size_t i = 0; i < m_occluderCount; i++)
+        {
+            for (const auto& triangle : m_occluders[i].Triangles)
+            {
+                if (triangle.MaxY < minY || triangle.MinY > maxY) continue;
+                RasterizeTriangle(triangle, max(minY, triangle.MinY), min(maxY, triangle.MaxY));
+            }
+        }
+    }
+}
+
+void OcclusionCuller::RasterizeTriangle(const Triangle& triangle, int minY, int maxY)
+{
+    float* depth = m_levels[0].Depth.data();
+    const int minX = triangle.MinX & ~3;
+
+#ifdef BEE_OCCLUSION_SSE
+    const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 a0 = _mm_set1_ps(triangle.A[0]);
+    const __m128 a1 = _mm_set1_ps(triangle.A[1]);
+    const __m128 a2 = _mm_set1_ps(triangle.A[2]);
+    const __m128 za = _mm_set1_ps(triangle.ZA);
+    const __m128 zMax = _mm_set1_ps(triangle.ZMax);
+    for (int y = minY; y <= maxY; y++)
+    {
+        const float py = static_cast<float>(y) + 0.5f;
+        const __m128 c0 = _mm_set1_ps(triangle.B[0] * py + triangle.C[0]);
+        const __m128 c1 = _mm_set1_ps(triangle.B[1] * py + triangle.C[1]);
+        const __m128 c2 = _mm_set1_ps(triangle.B[2] * py + triangle.C[2]);
+        const __m128 zc = _mm_set1_ps(triangle.ZB * py + triangle.ZC);
+        float* row = depth + static_cast<size_t>(y) * c_width;
+        for (int x = minX; x <= triangle.MaxX; x += 4)
+        {
+            const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+            const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), c0), zero),
+                                                        _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), c1), zero)),
+                                             _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), c2), zero));
+            const __m128 z = _mm_min_ps(_mm_add_ps(_mm_mul_ps(za, px), zc), zMax);
+            const __m128 old = _mm_loadu_ps(row + x);
+            const __m128 nearer = _mm_min_ps(old, z);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+        }
+    }
+#else
+    for (int y = minY; y <= maxY; y++)
+    {
+        const float py = static_cast<float>(y) + 0.5f;
+        const float c0 = triangle.B[0] * py + triangle.C[0];
+        const float c1 = triangle.B[1] * py + triangle.C[1];
+        const float c2 = triangle.B[2] * py + triangle.C[2];
+        const float zc = triangle.ZB * py + triangle.ZC;
+        float* row = depth + static_cast<size_t>(y) * c_width;
+        for (int x = minX; x <= triangle.MaxX; x++)
+        {
+            const float px = static_cast<float>(x) + 0.5f;
+            if (triangle.A[0] * px + c0 < 0.0f || triangle.A[1] * px + c1 < 0.0f || triangle.A[2] * px + c2 < 0.0f)
+                continue;
+            row[x] = min(row[x], min(triangle.ZA * px + zc, triangle.ZMax));
+        }
+    }
+#endif
+}
+
+void OcclusionCuller::BuildHierarchy()
+{
+    for (size_t level = 1; level < m_levels.size(); level++)
+    {
+        const Level& source = m_levels[level - 1];
+        Level& target = m_levels[level];
+        for (int y = 0; y < target.Height; y++)
+        {
+            const int y0 = min(y * 2, source.Height - 1);
+            const int y1 = min(y * 2 + 1, source.Height - 1);
+            for (int x = 0; x < target.Width; x++)
+            {
+                const int x0 = min(x * 2, source.Width - 1);
+                const int x1 = min(x * 2 + 1, source.Width - 1);
+                target.Depth[y * target.Width + x] = max(max(source.Depth[y0 * source.Width + x0],
+                                                             source.Depth[y0 * source.Width + x1]),
+                                                         max(source.Depth[y1 * source.Width + x0],
+                                                             source.Depth[y1 * source.Width + x1]));
+            }
+        }
+    }
+}
+
+void OcclusionCuller::Rasterize()
+{
+    SetupOccluders(0, m_occluderCount);
+    RasterizeBands(0, c_bands);
+    BuildHierarchy();
+}
+
+bool OcclusionCuller::IsOccluded(const glm::vec3& min, const glm::vec3& max) const
+{
+    if (m_levels.empty() || m_occluderCount == 0) return false;
+
+    glm::vec3 lower(numeric_limits<float>::max());
+    glm::vec3 upper(-numeric_limits<float>::max());
+    for (int c = 0; c < 8; c++)
+    {
+        const glm::vec3 corner(c & 1 ? max.x : min.x, c & 2 ? max.y : min.y, c & 4 ? max.z : min.z);
+        const glm::vec4 clip = m_viewProjection * glm::vec4(corner, 1.0f);
+        if (clip.w <= 0.0f || clip.z < -clip.w) return false;
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        lower = glm::min(lower, ndc);
+        upper = glm::max(upper, ndc);
+    }
+
+    const float left = (lower.x * 0.5f + 0.5f) * c_width;
+    const float right = (upper.x * 0.5f + 0.5f) * c_width;
+    const float bottom = (lower.y * 0.5f + 0.5f) * c_height;
+    const float top = (upper.y * 0.5f + 0.5f) * c_height;
+    if (right < 0.0f || top < 0.0f || left >= c_width || bottom >= c_height) return false;
+
+    // One more pixel around the box, since a pixel gets the depth of an occluder that covers its center, but maybe not
+    // all of it. When the box reaches past the edge of an occluder, the pixel next to that edge is not covered.
+    const int x0 = std::max(0, static_cast<int>(floor(left)) - 1);
+    const int x1 = std::min(c_width - 1, static_cast<int>(floor(right)) + 1);
+    const int y0 = std::max(0, static_cast<int>(floor(bottom)) - 1);
+    const int y1 = std::min(c_height - 1, static_cast<int>(floor(top)) + 1);
+    const float depth = lower.z * 0.5f + 0.5f;
+
+    // Start at the level at which the box covers at most 2x2 pixels
+    int level = 0;
+    while (level + 1 < GetLevelCount() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+        level++;
+    for (int y = y0 >> level; y <= y1 >> level; y++)
+        for (int x = x0 >> level; x <= x1 >> level; x++)
+            if (!IsBehind(depth, x, y, level, x0, y0, x1, y1)) return false;
+    return true;
+}
+
+bool OcclusionCuller::IsBehind(float depth, int x, int y, int level, int x0, int y0, int x1, int y1) const
+{
+    if (depth > GetDepth(x, y, level)) return true;
+    if (level == 0) return false;
+
+    // Part of the pixel may be in front, look at the pixels of the level below that the box covers
+    level--;
+    for (int cy = std::max(y * 2, y0 >> level); cy <= std::min(y * 2 + 1, y1 >> level); cy++)
+        for (int cx = std::max(x * 2, x0 >> level); cx <= std::min(x * 2 + 1, x1 >> level); cx++)
+            if (!IsBehind(depth, cx, cy, level, x0, y0, x1, y1)) return false;
+    return true;
+}
+
+float OcclusionCuller::GetDepth(int x, int y, int level) const
+{
+    const Level& source = m_levels[level];
+    return source.Depth[std::min(y, source.Height - 1) * source.Width + std::min(x, source.Width - 1)];
+}
+
+size_t OcclusionCuller::GetTriangleCount() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < m_occluderCount; i++) count += m_occluders[i].Triangles.size();
+    return count;
+}
@@ -0,0 +1,227 @@
+#include "rendering/particles.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/engine.hpp"
+#include "core/transform.hpp"
+#include "tools/job_system.hpp"
+#include "tools/profiler.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BEE_PARTICLES_SSE
+#endif
+
+using namespace bee;
+using namespace std;
+
+static_assert(ParticleSystem::c_simulateBatch % ParticlePool::c_lanes == 0, "only the last chunk of a pool is scalar");
+
+ParticlePool::ParticlePool(size_t capacity)
+    : m_positionX(capacity),
+      m_positionY(capacity),
+      m_positionZ(capacity),
+      m_velocityX(capacity),
+      m_velocityY(capacity),
+      m_velocityZ(capacity),
+      m_age(capacity),
+      m_ageRate(capacity),
+      m_capacity(capacity)
+{
+}
+
+bool ParticlePool::Emit(const glm::vec3& position, const glm::vec3& velocity, float lifetime)
+{
+    if (IsFull()) return false;
+    const size_t i = m_count++;
+    m_positionX[i] = position.x;
+    m_positionY[i] = position.y;
+    m_positionZ[i] = position.z;
+    m_velocityX[i] = velocity.x;
+    m_velocityY[i] = velocity.y;
+    m_velocityZ[i] = velocity.z;
+    m_age[i] = 0.0f;
+    m_ageRate[i] = 1.0f / std::max(lifetime, 1e-3f);
+    return true;
+}
+
+void ParticlePool::Simulate(float dt, const glm::vec3& gravity, float drag, size_t first, size_t last)
+{
+    last = std::min(last, m_count);
+
+    // Semi-implicit Euler. Drag scales the velocity by exp(-drag * dt), which never overshoots, even for long frames.
+    const float damping = std::exp(-drag * dt);
+    const glm::vec3 impulse = gravity * dt;
+    float* positions[3] = {m_positionX.data(), m_positionY.data(), m_positionZ.data()};
+    float* velocities[3] = {m_velocityX.data(), m_velocityY.data(), m_velocityZ.data()};
+    size_t i = first;
+
+#ifdef BEE_PARTICLES_SSE
+    // The same operations in the same order as the scalar loop, so both give the same result
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 dampings = _mm_set1_ps(damping);
+    const __m128 impulses[3] = {_mm_set1_ps(impulse.x), _mm_set1_ps(impulse.y), _mm_set1_ps(impulse.z)};
+    for (; i + c_lanes <= last; i += c_lanes)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const __m128 velocity = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(velocities[axis] + i), impulses[axis]), dampings);
+            _mm_storeu_ps(velocities[axis] + i, velocity);
+            _mm_storeu_ps(positions[axis] + i, _mm_add_ps(_mm_loadu_ps(positions[axis] + i), _mm_mul_ps(velocity, step)));
+        }
+        const __m128 age = _mm_add_ps(_mm_loadu_ps(&m_age[i]), _mm_mul_ps(_mm_loadu_ps(&m_ageRate[i]), step));
+        _mm_storeu_ps(&m_age[i], age);
+    }
+#endif
+
+    for (; i < last; i++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float velocity = (velocities[axis][i] + impulse[axis]) * damping;
+            velocities[axis][i] = velocity;
+            positions[axis][i] = positions[axis][i] + velocity * dt;
+        }
+        m_age[i] = m_age[i] + m_ageRate[i] * dt;
+    }
+}
+
+void ParticlePool::RemoveDead()
+{
+    for (size_t i = 0; i < m_count;)
+    {
+        if (m_age[i] < 1.0f)
+        {
+            i++;
+            continue;
+        }
+
+        // Move the last particle into the gap, and look at it next
+        const size_t last = --m_count;
+        m_positionX[i] = m_positionX[last];
+        m_positionY[i] = m_positionY[last];
+        m_positionZ[i] = m_positionZ[last];
+        m_velocityX[i] = m_velocityX[last];
+        m_velocityY[i] = m_velocityY[last];
+        m_velocityZ[i] = m_velocityZ[last];
+        m_age[i] = m_age[last];
+        m_ageRate[i] = m_ageRate[last];
+    }
+}
+
+ParticleSystem::ParticleSystem()
+{
+    Title = "Particles";
+    Priority = -100;  // after the gameplay that sets the intensity of emitters
+    Writes<ParticleEmitter, Transform>();  // Transform::World() updates cached matrices
+}
+
+uint32_t ParticleSystem::AddType(const ParticleType& type)
+{
+    m_types.push_back(type);
+    m_pools.emplace_back(type.MaxParticles);
+    return static_cast<uint32_t>(m_types.size() - 1);
+}
+
+size_t ParticleSystem::GetParticleCount() const
+{
+    size_t count = 0;
+    for (const auto& pool : m_pools) count += pool.GetCount();
+    return count;
+}
+
+float ParticleSystem::Random()
+{
+    // xorshift32, the upper 24 bits make a float in [0, 1)
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+    return static_cast<float>(m_random >> 8) * (1.0f / 16777216.0f);
+}
+
+void ParticleSystem::Simulate(float dt)
+{
+    BEE_PROFILE_FUNCTION();
+    Simulate(dt, Engine.JobSystem());
+}
+
+void ParticleSystem::Simulate(float dt, JobSystem& jobs)
+{
+    // All pools are split into chunks of c_simulateBatch particles, which run as one parallel loop
+    const auto getChunks = [](const ParticlePool& pool) { return (pool.GetCount() + c_simulateBatch - 1) / c_simulateBatch; };
+    size_t chunks = 0;
+    for (const auto& pool : m_pools) chunks += getChunks(pool);
+
+    const auto simulate = [&](size_t first, size_t last)
+    {
+        for (size_t chunk = first; chunk < last; chunk++)
+        {
+            // There are only a few types, so finding the pool of a chunk is a short walk
+            size_t type = 0;
+            size_t local = chunk;
+            while (local >= getChunks(m_pools[type])) local -= getChunks(m_pools[type++]);
+
+            const auto& particleType = m_types[type];
+            m_pools[type].Simulate(dt,
+                                   particleType.Gravity,
+                                   particleType.Drag,
+                                   local * c_simulateBatch,
+                                   (local + 1) * c_simulateBatch);
+        }
+    };
+    jobs.ParallelFor(chunks, 1, simulate);
+
+    for (auto& pool : m_pools) pool.RemoveDead();
+    m_emitted = 0;
+}
+
+uint32_t ParticleSystem::Emit(uint32_t type,
+                              const glm::vec3& from,
+                              const glm::vec3& to,
+                              const glm::vec3& velocity,
+                              uint32_t count)
+{
+    const auto& particleType = m_types[type];
+    auto& pool = m_pools[type];
+    for (uint32_t k = 0; k < count; k++)
+    {
+        // The newest particle is where the emitter is now
+        const float along = static_cast<float>(k + 1) / static_cast<float>(count);
+        const glm::vec3 spread = glm::vec3(Random(), Random(), Random()) * 2.0f - 1.0f;
+        const float lifetime = glm::mix(particleType.MinLifetime, particleType.MaxLifetime, Random());
+        if (!pool.Emit(glm::mix(from, to, along), velocity + spread * particleType.Spread, lifetime)) return k;
+    }
+    return count;
+}
+
+void ParticleSystem::Update(float dt)
+{
+    BEE_PROFILE_FUNCTION();
+
+    // Particles that exist move first, so new ones start exactly at their emitter
+    Simulate(dt);
+
+    for (auto [entity, emitter, transform] : View<ParticleEmitter, Transform>().each())
+        Emit(emitter, transform.World()[3], dt);
+}
+
+uint32_t ParticleSystem::Emit(ParticleEmitter& emitter, const glm::vec3& position, float dt)
+{
+    const glm::vec3 from = emitter.HasPreviousPosition ? emitter.PreviousPosition : position;
+    emitter.PreviousPosition = position;
+    emitter.HasPreviousPosition = true;
+    if (emitter.Type >= m_types.size()) return 0;
+
+    // Whatever does not fit in the budgets is dropped, catching up later would only make a burst
+    emitter.Accumulated += std::max(emitter.Rate * emitter.Intensity, 0.0f) * dt;
+    const float due = std::floor(emitter.Accumulated);
+    emitter.Accumulated -= due;
+    const float budget = static_cast<float>(std::min<size_t>(emitter.MaxPerFrame, MaxEmittedPerFrame - m_emitted));
+    const auto count = static_cast<uint32_t>(std::min(due, budget));
+    if (count == 0) return 0;
+
+    const uint32_t emitted = Emit(emitter.Type, from, position, emitter.Velocity, count);
+    m_emitted += emitted;
+    return emitted;
+}
@@ -0,0 +1,272 @@
+#include "rendering/scene_tree.hpp"
+
+#include <algorithm>
+
+#include "core/engine.hpp"
+#include "core/transform.hpp"
+#include "rendering/mesh.hpp"
+#include "rendering/render_components.hpp"
+#include "tools/profiler.hpp"
+
+#ifdef BEE_INSPECTOR
+#include <imgui/imgui.h>
+#endif
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+// How much worse refitting may make the dynamic tree before it is built again
+constexpr float c_maxCostGrowth = 2.0f;
+
+pair<glm::vec3, glm::vec3> GetWorldBounds(const MeshRenderer& renderer, Transform& transform)
+{
+    return TransformAABB(renderer.Mesh->GetMin(), renderer.Mesh->GetMax(), transform.World());
+}
+
+// Möller-Trumbore, returns the distance along the ray or a negative value when the triangle is missed
+float RayTriangle(const glm::vec3& origin,
+                  const glm::vec3& direction,
+                  const glm::vec3& a,
+                  const glm::vec3& b,
+                  const glm::vec3& c)
+{
+    const glm::vec3 edge1 = b - a;
+    const glm::vec3 edge2 = c - a;
+    const glm::vec3 p = glm::cross(direction, edge2);
+    const float determinant = glm::dot(edge1, p);
+    if (std::abs(determinant) < 1e-12f) return -1.0f;  // parallel to the triangle
+
+    const float inverse = 1.0f / determinant;
+    const glm::vec3 s = origin - a;
+    const float u = glm::dot(s, p) * inverse;
+    if (u < 0.0f || u > 1.0f) return -1.0f;
+
+    const glm::vec3 q = glm::cross(s, edge1);
+    const float v = glm::dot(direction, q) * inverse;
+    if (v < 0.0f || u + v > 1.0f) return -1.0f;
+
+    return glm::dot(edge2, q) * inverse;
+}
+
+// Returns the distance to the nearest triangle of the entity's mesh that the ray hits, or a negative value
+float RayMesh(Entity entity, const glm::vec3& origin, const glm::vec3& direction, float maxDistance)
+{
+    auto& registry = Engine.ECS().Registry;
+    const auto& renderer = registry.get<MeshRenderer>(entity);
+    auto& transform = registry.get<Transform>(entity);
+
+    // Test in the space of the mesh. The direction is not normalized there, so distances stay in world units.
+    const glm::mat4 toLocal = glm::inverse(transform.World());
+    const glm::vec3 localOrigin = glm::vec3(toLocal * glm::vec4(origin, 1.0f));
+    const glm::vec3 localDirection = glm::vec3(toLocal * glm::vec4(direction, 0.0f));
+
+    const auto& data = renderer.Mesh->GetData();
+    float nearest = -1.0f;
+    for (size_t i = 0; i + 2 < data.Indices.size(); i += 3)
+    {
+        const float distance = RayTriangle(localOrigin,
+                                           localDirection,
+                                           data.Positions[data.Indices[i]],
+                                           data.Positions[data.Indices[i + 1]],
+                                           data.Positions[data.Indices[i + 2]]);
+        if (distance >= 0.0f && distance <= maxDistance && (nearest < 0.0f || distance < nearest)) nearest = distance;
+    }
+    return nearest;
+}
+
+}  // namespace
+
+SceneTree::SceneTree()
+{
+    Title = "Scene Tree";
+    Priority = 1000;  // before everything that might query it
+    Reads<MeshRenderer, Static>();
+    Writes<Transform>();  // Transform::World() updates cached matrices
+
+    auto& registry = Engine.ECS().Registry;
+    registry.on_construct<Static>().connect<&SceneTree::OnStaticChanged>(*this);
+    registry.on_destroy<Static>().connect<&SceneTree::OnStaticChanged>(*this);
+    registry.on_construct<MeshRenderer>().connect<&SceneTree::OnMembershipChanged>(*this);
+    registry.on_update<MeshRenderer>().connect<&SceneTree::OnMembershipChanged>(*this);
+    registry.on_destroy<MeshRenderer>().connect<&SceneTree::OnMembershipChanged>(*this);
+    registry.on_update<Transform>().connect<&SceneTree::OnTransformChanged>(*this);
+    registry.on_destroy<Transform>().connect<&SceneTree::OnMembershipChanged>(*this);
+}
+
+SceneTree::~SceneTree()
+{
+    auto& registry = Engine.ECS().Registry;
+    registry.on_construct<Static>().disconnect(this);
+    registry.on_destroy<Static>().disconnect(this);
+    registry.on_construct<MeshRenderer>().disconnect(this);
+    registry.on_update<MeshRenderer>().disconnect(this);
+    registry.on_destroy<MeshRenderer>().disconnect(this);
+    registry.on_update<Transform>().disconnect(this);
+    registry.on_destroy<Transform>().disconnect(this);
+}
+
+void SceneTree::Update(float)
+{
+    BEE_PROFILE_FUNCTION();
+
+    if (m_staticDirty.exchange(false)) BuildStatic();
+    UpdateDynamic();
+}
+
+void SceneTree::BuildStatic()
+{
+    m_staticEntities.clear();
+    BoundingBoxes bounds;
+    for (const auto& [entity, renderer, transform] : View<const MeshRenderer, Transform, const Static>().each())
+    {
+        if (!renderer.Mesh) continue;
+        const auto [min, max] = GetWorldBounds(renderer, transform);
+        bounds.Add(min, max);
+        m_staticEntities.push_back(entity);
+    }
+
+    m_static.Build(bounds);
+    m_staticBuilds++;
+}
+
+void SceneTree::UpdateDynamic()
+{
+    auto& registry = Engine.ECS().Registry;
+
+    // Refit to the current transforms
+    if (!m_dynamicDirty.exchange(false))
+    {
+        m_moved.clear();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_dynamicEntities.size()); i++)
+        {
+            const auto entity = m_dynamicEntities[i];
+            const auto* renderer = TryGet<const MeshRenderer>(entity);
+            auto* transform = TryGet<Transform>(entity);
+            if (renderer == nullptr || transform == nullptr || !renderer->Mesh)
+            {
+                m_dynamicDirty = true;
+                break;
+            }
+
+            const auto [min, max] = GetWorldBounds(*renderer, *transform);
+            if (min == m_dynamic.GetItemMin(i) && max == m_dynamic.GetItemMax(i)) continue;
+            m_dynamic.SetBounds(i, min, max);
+            m_moved.push_back(i);
+        }
+
+        if (!m_dynamicDirty && !m_moved.empty())
+        {
+            // Walking up from a few leaves is cheaper than visiting every node
+            if (m_moved.size() * 8 < m_dynamicEntities.size())
+            {
+                for (const uint32_t item : m_moved)
+                    m_dynamic.Update(item, m_dynamic.GetItemMin(item), m_dynamic.GetItemMax(item));
+            }
+            else
+            {
+                m_dynamic.Refit();
+            }
+            if (m_dynamic.GetCost() > m_dynamic.GetBuildCost() * c_maxCostGrowth) m_dynamicDirty = true;
+        }
+        if (!m_dynamicDirty) return;
+        m_dynamicDirty = false;
+    }
+
+    m_dynamicEntities.clear();
+    BoundingBoxes bounds;
+    for (const auto& [entity, renderer, transform] :
+         registry.view<const MeshRenderer, Transform>(entt::exclude<Static>).each())
+    {
+        if (!renderer.Mesh) continue;
+        const auto [min, max] = GetWorldBounds(renderer, transform);
+        bounds.Add(min, max);
+        m_dynamicEntities.push_back(entity);
+    }
+
+    m_dynamic.Build(bounds);
+    m_dynamicBuilds++;
+}
+
+void SceneTree::OnStaticChanged(entt::registry&, Entity)
+{
+    // The entity moves from one tree to the other
+    m_staticDirty = true;
+    m_dynamicDirty = true;
+}
+
+void SceneTree::OnTransformChanged(entt::registry& registry, Entity entity)
+{
+    // Dynamic entities are refit every frame anyway
+    if (registry.all_of<Static>(entity)) m_staticDirty = true;
+}
+
+void SceneTree::OnMembershipChanged(entt::registry& registry, Entity entity)
+{
+    if (registry.all_of<Static>(entity))
+        m_staticDirty = true;
+    else
+        m_dynamicDirty = true;
+}
+
+void SceneTree::QueryAABB(const glm::vec3& min, const glm::vec3& max, vector<Entity>& result) const
+{
+    m_static.QueryAABB(min, max, [&](uint32_t item) { result.push_back(m_staticEntities[item]); });
+    m_dynamic.QueryAABB(min, max, [&](uint32_t item) { result.push_back(m_dynamicEntities[item]); });
+}
+
+void SceneTree::QueryFrustum(const Frustum& frustum, vector<Entity>& result) const
+{
+    m_static.QueryFrustum(frustum, [&](uint32_t item) { result.push_back(m_staticEntities[item]); });
+    m_dynamic.QueryFrustum(frustum, [&](uint32_t item) { result.push_back(m_dynamicEntities[item]); });
+}
+
+bool SceneTree::QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& hit, bool precise)
+    const
+{
+    hit = {};
+    hit.Distance = maxDistance;
+
+    const auto test = [&](const vector<Entity>& entities)
+    {
+        return [&](uint32_t item, float boxDistance)
+        {
+            // The box is entered after the nearest hit so far, so the mesh cannot be nearer
+            if (boxDistance > hit.Distance) return hit.Distance;
+
+            const Entity entity = entities[item];
+            const float distance = precise ? RayMesh(entity, origin, direction, hit.Distance) : boxDistance;
+            if (distance >= 0.0f && distance <= hit.Distance)
+            {
+                hit.Entity = entity;
+                hit.Distance = distance;
+            }
+            return hit.Distance;
+        };
+    };
+
+    m_static.QueryRay(origin, direction, hit.Distance, test(m_staticEntities));
+    m_dynamic.QueryRay(origin, direction, hit.Distance, test(m_dynamicEntities));
+    return hit.Entity != entt::null;
+}
+
+#ifdef BEE_INSPECTOR
+
+void SceneTree::OnPanel()
+{
+    ImGui::Text("Static   %d entities, %d nodes, cost %.1f, built %d times",
+                static_cast<int>(m_staticEntities.size()),
+                static_cast<int>(m_static.GetNodeCount()),
+                m_static.GetCost(),
+                m_staticBuilds);
+    ImGui::Text("Dynamic  %d entities, %d nodes, cost %.1f (%.1f when built), built %d times",
+                static_cast<int>(m_dynamicEntities.size()),
+                static_cast<int>(m_dynamic.GetNodeCount()),
+                m_dynamic.GetCost(),
+                m_dynamic.GetBuildCost(),
+                m_dynamicBuilds);
+}
+
+#endif
@@ -0,0 +1,117 @@
+#include "rendering/shadow_cascades.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+constexpr int c_sizeSteps = 8;  // sizes a cascade can have per power of two
+
+}  // namespace
+
+glm::mat4 ShadowCascade::GetViewProjection() const
+{
+    const glm::mat4 projection = glm::ortho(Center.x - HalfSize,
+                                            Center.x + HalfSize,
+                                            Center.y - HalfSize,
+                                            Center.y + HalfSize,
+                                            -MaxZ,
+                                            -MinZ);
+    return projection * View;
+}
+
+Frustum ShadowCascade::GetCasterFrustum() const
+{
+    Frustum frustum = Frustum::FromMatrix(GetViewProjection());
+    frustum.Planes[4] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);  // the near plane, everything is in front of it
+    return frustum;
+}
+
+void ShadowCascade::IncludeCaster(const glm::vec3& min, const glm::vec3& max)
+{
+    MaxZ = std::max(MaxZ, TransformAABB(min, max, View).second.z);
+}
+
+bool ShadowCascade::Covers(const glm::vec3& center, float radius) const
+{
+    const glm::vec3 light = glm::vec3(View * glm::vec4(center, 1.0f));
+    return std::abs(light.x - Center.x) + radius <= HalfSize && std::abs(light.y - Center.y) + radius <= HalfSize &&
+           light.z - radius >= MinZ && light.z + radius <= MaxZ;
+}
+
+void bee::ComputeCascadeSplits(const glm::mat4& projection, float distance, float lambda, int count, float* splits)
+{
+    assert(count > 0);
+    const auto [zNear, zFar] = GetDepthRange(projection);
+    const float end = std::min(distance, zFar);
+    for (int i = 1; i <= count; i++)
+    {
+        const float t = static_cast<float>(i) / static_cast<float>(count);
+        const float logarithmic = zNear * std::pow(end / zNear, t);
+        const float uniform = zNear + (end - zNear) * t;
+        splits[i - 1] = lambda * logarithmic + (1.0f - lambda) * uniform;
+    }
+}
+
+pair<glm::vec3, float> bee::GetFrustumSliceSphere(const glm::mat4& view,
+                                                  const glm::mat4& projection,
+                                                  float sliceNear,
+                                                  float sliceFar)
+{
+    // The corners of the slice in view space, on the edges between the corners of the near and far plane
+    const auto [zNear, zFar] = GetDepthRange(projection);
+    const glm::mat4 inverseProjection = glm::inverse(projection);
+    glm::vec3 corners[8];
+    for (int i = 0; i < 4; i++)
+    {
+        const glm::vec2 ndc((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f);
+        const glm::vec4 nearCorner = inverseProjection * glm::vec4(ndc, -1.0f, 1.0f);
+        const glm::vec4 farCorner = inverseProjection * glm::vec4(ndc, 1.0f, 1.0f);
+        const glm::vec3 from = glm::vec3(nearCorner) / nearCorner.w;
+        const glm::vec3 to = glm::vec3(farCorner) / farCorner.w;
+        corners[i] = glm::mix(from, to, (sliceNear - zNear) / (zFar - zNear));
+        corners[i + 4] = glm::mix(from, to, (sliceFar - zNear) / (zFar - zNear));
+    }
+
+    glm::vec3 center(0.0f);
+    for (const auto& corner : corners) center += corner / 8.0f;
+    float radius = 0.0f;
+    for (const auto& corner : corners) radius = std::max(radius, glm::length(corner - center));
+
+    return {glm::vec3(glm::inverse(view) * glm::vec4(center, 1.0f)), radius};
+}
+
+glm::mat4 bee::GetLightView(const glm::mat4& lightWorld)
+{
+    // The inverse of the rotation of the light, without its scale
+    const glm::mat3 rotation(glm::normalize(glm::vec3(lightWorld[0])),
+                             glm::normalize(glm::vec3(lightWorld[1])),
+                             glm::normalize(glm::vec3(lightWorld[2])));
+    return glm::mat4(glm::transpose(rotation));
+}
+
+ShadowCascade bee::FitShadowCascade(const glm::mat4& lightWorld, const glm::vec3& center, float radius, int resolution)
+{
+    assert(radius > 0.0f && resolution > 0);
+
+    ShadowCascade cascade;
+    cascade.View = GetLightView(lightWorld);
+
+    // Leave room for snapping, and round the size up so that it only changes when the field of view changes a lot
+    const float padded = radius * (1.0f + 2.0f / static_cast<float>(resolution));
+    const float step = std::exp2(std::floor(std::log2(padded))) / c_sizeSteps;
+    cascade.HalfSize = std::ceil(padded / step) * step;
+
+    const glm::vec3 light = glm::vec3(cascade.View * glm::vec4(center, 1.0f));
+    const float texel = cascade.GetTexelSize(resolution);
+    cascade.Center = glm::floor(glm::vec2(light) / texel) * texel;
+    cascade.MinZ = light.z - radius;
+    cascade.MaxZ = light.z + radius;
+    return cascade;
+}
@@ -0,0 +1,124 @@
+#include "rendering/skid_marks.hpp"
+
+#include <algorithm>
+
+#include "core/engine.hpp"
+#include "core/transform.hpp"
+#include "tools/profiler.hpp"
+
+using namespace bee;
+using namespace std;
+
+SkidMarkRing::SkidMarkRing(uint32_t capacity)
+    : m_capacity(std::max(capacity, 1u)),
+      m_vertices(static_cast<size_t>(m_capacity) * 4),
+      m_isChanged(m_capacity, 0)
+{
+}
+
+void SkidMarkRing::MarkChanged(uint64_t quad)
+{
+    const auto slot = static_cast<uint32_t>(quad % m_capacity);
+    if (m_isChanged[slot]) return;
+    m_isChanged[slot] = 1;
+    m_changed.push_back(slot);
+}
+
+void SkidMarkRing::ClearChanges()
+{
+    for (const uint32_t slot : m_changed) m_isChanged[slot] = 0;
+    m_changed.clear();
+}
+
+void SkidMarkRing::Add(SkidMarkStrip& strip,
+                       const glm::vec3& position,
+                       const glm::vec3& up,
+                       float width,
+                       float intensity,
+                       float time)
+{
+    if (intensity <= 0.0f)
+    {
+        strip.Active = false;
+        return;
+    }
+    if (!strip.Active)
+    {
+        strip = {};
+        strip.Active = true;
+        strip.End = position;
+        return;
+    }
+
+    const glm::vec3 step = position - strip.End;
+    const float length = glm::length(step);
+    if (length < c_minSegmentLength) return;
+    const glm::vec3 direction = step / length;
+    const glm::vec3 across = glm::cross(direction, up);
+    const float acrossLength = glm::length(across);
+    if (acrossLength < 1e-4f) return;  // straight along the normal, there is no mark to lay
+    const glm::vec3 halfWidth = across * (0.5f * width / acrossLength);
+    const SkidMarkVertex left = {position - halfWidth, time, -1.0f, intensity};
+    const SkidMarkVertex right = {position + halfWidth, time, 1.0f, intensity};
+
+    const bool connected = strip.HasQuad && IsAlive(strip.Quad);
+    if (connected)
+    {
+        // Stretch the last quad when the point continues it in nearly the same direction
+        SkidMarkVertex* last = GetVertices(strip.Quad);
+        const glm::vec3 chord = strip.End - strip.QuadStart;
+        const float chordLength = glm::length(chord);
+        if (chordLength > 0.0f && glm::dot(chord, direction) >= c_mergeCosine * chordLength &&
+            chordLength + length <= c_maxSegmentLength && std::abs(last[2].Intensity - intensity) <= c_mergeIntensity)
+        {
+            last[2] = left;
+            last[3] = right;
+            MarkChanged(strip.Quad);
+            strip.End = position;
+            m_merged++;
+            return;
+        }
+    }
+
+    // A new quad from the end edge of the last one, copied before the new quad may reuse its slot
+    SkidMarkVertex start[2] = {{strip.End - halfWidth, time, -1.0f, intensity},
+                               {strip.End + halfWidth, time, 1.0f, intensity}};
+    if (connected)
+    {
+        const SkidMarkVertex* last = GetVertices(strip.Quad);
+        start[0] = last[2];
+        start[1] = last[3];
+    }
+
+    const uint64_t quad = m_next++;
+    SkidMarkVertex* vertices = GetVertices(quad);
+    vertices[0] = start[0];
+    vertices[1] = start[1];
+    vertices[2] = left;
+    vertices[3] = right;
+    MarkChanged(quad);
+
+    strip.HasQuad = true;
+    strip.Quad = quad;
+    strip.QuadStart = strip.End;
+    strip.End = position;
+}
+
+SkidMarkSystem::SkidMarkSystem(uint32_t capacity) : m_ring(capacity)
+{
+    Title = "Skid Marks";
+    Priority = -100;  // after the gameplay that sets the intensity of emitters
+    Writes<SkidMarkEmitter, Transform>();  // Transform::World() updates cached matrices
+}
+
+void SkidMarkSystem::Update(float dt)
+{
+    BEE_PROFILE_FUNCTION();
+
+    m_time += dt;
+    for (auto [entity, emitter, transform] : View<SkidMarkEmitter, Transform>().each())
+    {
+        const glm::mat4& world = transform.World();
+        m_ring.Add(emitter.Strip, world[3], world[2], emitter.Width, emitter.Intensity, m_time);
+    }
+}
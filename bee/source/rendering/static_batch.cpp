@@ -0,0 +1,148 @@
+#include "rendering/static_batch.hpp"
+
+#include <cassert>
+#include <map>
+#include <tuple>
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+using BatchKey = tuple<uint32_t, int, int, int>;  // material and chunk
+
+glm::ivec3 GetChunk(const StaticBatchSource& source, float chunkSize)
+{
+    const auto& positions = source.Mesh->Positions;
+    glm::vec3 min = positions.front();
+    glm::vec3 max = positions.front();
+    for (const auto& position : positions)
+    {
+        min = glm::min(min, position);
+        max = glm::max(max, position);
+    }
+
+    const glm::vec3 center = glm::vec3(source.World * glm::vec4((min + max) * 0.5f, 1.0f));
+    return glm::ivec3(glm::floor(center / chunkSize));
+}
+
+// The attributes of a batch, every vertex in it has all of them
+struct Layout
+{
+    bool Normals = false;
+    bool Tangents = false;
+    bool Colors = false;
+    bool TexCoords0 = false;
+    bool TexCoords1 = false;
+};
+
+// Appends the attribute of a source, or a default value for every vertex when the source does not have it
+template <typename T, typename F>
+void Append(vector<T>& target, const vector<T>& attribute, size_t vertexCount, const T& fallback, F&& transform)
+{
+    if (attribute.size() == vertexCount)
+        for (const auto& value : attribute) target.push_back(transform(value));
+    else
+        target.insert(target.end(), vertexCount, fallback);
+}
+
+void AppendSource(MeshData& target, const Layout& layout, const StaticBatchSource& source)
+{
+    const MeshData& mesh = *source.Mesh;
+    const size_t vertexCount = mesh.GetVertexCount();
+    const auto first = static_cast<uint32_t>(target.GetVertexCount());
+    const glm::mat3 linear = glm::mat3(source.World);
+    const glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+    const bool mirrored = glm::determinant(linear) < 0.0f;
+    const auto copy = [](const auto& value) { return value; };
+
+    for (const auto& position : mesh.Positions) target.Positions.push_back(glm::vec3(source.World * glm::vec4(position, 1.0f)));
+
+    if (layout.Normals)
+        Append(target.Normals,
+               mesh.Normals,
+               vertexCount,
+               glm::vec3(0.0f, 0.0f, 1.0f),
+               [&](const glm::vec3& normal) { return glm::normalize(normalMatrix * normal); });
+    if (layout.Tangents)
+        Append(target.Tangents,
+               mesh.Tangents,
+               vertexCount,
+               glm::vec4(1.0f, 0.0f, 0.0f, 1.0f),
+               [&](const glm::vec4& tangent)
+               { return glm::vec4(glm::normalize(linear * glm::vec3(tangent)), mirrored ? -tangent.w : tangent.w); });
+    if (layout.Colors) Append(target.Colors, mesh.Colors, vertexCount, glm::vec3(1.0f), copy);
+    if (layout.TexCoords0) Append(target.TexCoords0, mesh.TexCoords0, vertexCount, glm::vec2(0.0f), copy);
+    if (layout.TexCoords1) Append(target.TexCoords1, mesh.TexCoords1, vertexCount, glm::vec2(0.0f), copy);
+
+    for (size_t i = 0; i + 2 < mesh.Indices.size(); i += 3)
+    {
+        // Mirroring turns front faces into back faces, swap two corners to undo that
+        target.Indices.push_back(first + mesh.Indices[i]);
+        target.Indices.push_back(first + mesh.Indices[mirrored ? i + 2 : i + 1]);
+        target.Indices.push_back(first + mesh.Indices[mirrored ? i + 1 : i + 2]);
+    }
+}
+
+}  // namespace
+
+vector<StaticBatch> bee::BuildStaticBatches(const vector<StaticBatchSource>& sources, float chunkSize)
+{
+    assert(chunkSize > 0.0f);
+
+    // Group the sources first, so that every batch can reserve its memory and knows which attributes it has
+    map<BatchKey, vector<const StaticBatchSource*>> groups;
+    for (const auto& source : sources)
+    {
+        if (source.Mesh == nullptr || source.Mesh->IsEmpty()) continue;
+        const glm::ivec3 chunk = GetChunk(source, chunkSize);
+        groups[BatchKey(source.Material, chunk.x, chunk.y, chunk.z)].push_back(&source);
+    }
+
+    vector<StaticBatch> batches;
+    batches.reserve(groups.size());
+    for (const auto& [key, group] : groups)
+    {
+        StaticBatch batch;
+        batch.Material = get<0>(key);
+        batch.Chunk = glm::ivec3(get<1>(key), get<2>(key), get<3>(key));
+        batch.SourceCount = static_cast<uint32_t>(group.size());
+
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        Layout layout;
+        for (const auto* source : group)
+        {
+            const MeshData& mesh = *source->Mesh;
+            vertexCount += mesh.GetVertexCount();
+            indexCount += mesh.Indices.size();
+            layout.Normals |= !mesh.Normals.empty();
+            layout.Tangents |= !mesh.Tangents.empty();
+            layout.Colors |= !mesh.Colors.empty();
+            layout.TexCoords0 |= !mesh.TexCoords0.empty();
+            layout.TexCoords1 |= !mesh.TexCoords1.empty();
+        }
+
+        auto& data = batch.Data;
+        data.Positions.reserve(vertexCount);
+        data.Indices.reserve(indexCount);
+        if (layout.Normals) data.Normals.reserve(vertexCount);
+        if (layout.Tangents) data.Tangents.reserve(vertexCount);
+        if (layout.Colors) data.Colors.reserve(vertexCount);
+        if (layout.TexCoords0) data.TexCoords0.reserve(vertexCount);
+        if (layout.TexCoords1) data.TexCoords1.reserve(vertexCount);
+        for (const auto* source : group) AppendSource(data, layout, *source);
+
+        batch.Min = batch.Max = data.Positions.front();
+        for (const auto& position : data.Positions)
+        {
+            batch.Min = glm::min(batch.Min, position);
+            batch.Max = glm::max(batch.Max, position);
+        }
+
+        batches.push_back(std::move(batch));
+    }
+
+    return batches;
+}
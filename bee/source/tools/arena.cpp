@@ -0,0 +1,186 @@
+#include "tools/arena.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+#include "tools/log.hpp"
+
+#ifdef BEE_INSPECTOR
+#include <imgui/imgui.h>
+#endif
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+bool IsPowerOfTwo(size_t value) { return value != 0 && (value & (value - 1)) == 0; }
+
+uintptr_t AlignUp(uintptr_t address, size_t alignment) { return (address + alignment - 1) & ~(uintptr_t)(alignment - 1); }
+
+// All scratch arenas that are alive, so that their allocations can be counted
+mutex g_scratchMutex;
+vector<const Arena*> g_scratchArenas;
+uint64_t g_finishedScratchAllocations = 0;  // of threads that have exited
+
+uint64_t GetTotalScratchAllocations()
+{
+    lock_guard<mutex> lock(g_scratchMutex);
+    uint64_t total = g_finishedScratchAllocations;
+    for (const auto* arena : g_scratchArenas) total += arena->GetAllocations();
+    return total;
+}
+
+struct ThreadScratchArena
+{
+    ThreadScratchArena()
+    {
+        lock_guard<mutex> lock(g_scratchMutex);
+        g_scratchArenas.push_back(&Instance);
+    }
+
+    ~ThreadScratchArena()
+    {
+        lock_guard<mutex> lock(g_scratchMutex);
+        g_finishedScratchAllocations += Instance.GetAllocations();
+        g_scratchArenas.erase(find(g_scratchArenas.begin(), g_scratchArenas.end(), &Instance));
+    }
+
+    Arena Instance;
+};
+
+}  // namespace
+
+Arena::Arena(size_t blockSize) : m_blockSize(blockSize) {}
+
+Arena::~Arena() = default;
+
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+    assert(IsPowerOfTwo(alignment));
+    m_allocations.store(m_allocations.load(memory_order_relaxed) + 1, memory_order_relaxed);
+
+    // Continue in the current block, or in the next one that fits
+    for (; m_block < m_blocks.size(); m_block++, m_offset = 0)
+    {
+        const auto& block = m_blocks[m_block];
+        const auto base = reinterpret_cast<uintptr_t>(block.Memory.get());
+        const uintptr_t address = AlignUp(base + m_offset, alignment);
+        if (address + size > base + block.Size) continue;
+
+        m_offset = address + size - base;
+        return reinterpret_cast<void*>(address);
+    }
+
+    // Out of blocks, add one that is large enough
+    Block block;
+    block.Size = max(m_blockSize, size + alignment);
+    block.Memory = make_unique<byte[]>(block.Size);
+    m_blocks.push_back(move(block));
+    m_block = m_blocks.size() - 1;
+
+    const auto base = reinterpret_cast<uintptr_t>(m_blocks.back().Memory.get());
+    const uintptr_t address = AlignUp(base, alignment);
+    m_offset = address + size - base;
+    return reinterpret_cast<void*>(address);
+}
+
+void Arena::Rewind(const Marker& marker)
+{
+    assert(marker.Block < m_blocks.size() || (marker.Block == 0 && marker.Offset == 0));
+    m_block = marker.Block;
+    m_offset = marker.Offset;
+}
+
+size_t Arena::GetCapacity() const
+{
+    size_t capacity = 0;
+    for (const auto& block : m_blocks) capacity += block.Size;
+    return capacity;
+}
+
+Arena& bee::GetScratchArena()
+{
+    thread_local ThreadScratchArena arena;
+    return arena.Instance;
+}
+
+FrameArena::FrameArena(size_t capacity) : m_memory(make_unique<byte[]>(capacity)), m_capacity(capacity) {}
+
+FrameArena::~FrameArena() { Reset(); }
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+    assert(IsPowerOfTwo(alignment));
+    m_allocations.fetch_add(1, memory_order_relaxed);
+
+    const auto base = reinterpret_cast<uintptr_t>(m_memory.get());
+    size_t offset = m_offset.load(memory_order_relaxed);
+    while (true)
+    {
+        const uintptr_t address = AlignUp(base + offset, alignment);
+        const size_t end = address + size - base;
+        if (end > m_capacity) break;
+        if (m_offset.compare_exchange_weak(offset, end, memory_order_relaxed)) return reinterpret_cast<void*>(address);
+    }
+
+    // Does not fit, use the heap for the rest of the frame
+    void* memory = ::operator new(size, align_val_t(alignment));
+    lock_guard<mutex> lock(m_heapMutex);
+    m_heapAllocations.push_back({memory, alignment});
+    m_heapBytes += size;
+    return memory;
+}
+
+void FrameArena::Reset()
+{
+    const uint64_t scratchAllocations = GetTotalScratchAllocations();
+    const size_t used = min(m_offset.load(memory_order_relaxed), m_capacity);
+
+    m_lastFrame.Allocations = m_allocations.exchange(0, memory_order_relaxed);
+    m_lastFrame.ScratchAllocations = scratchAllocations - m_scratchAllocations;
+    m_lastFrame.HeapAllocations = m_heapAllocations.size();
+    m_lastFrame.Bytes = used + m_heapBytes;
+    m_scratchAllocations = scratchAllocations;
+
+    for (const auto& allocation : m_heapAllocations) ::operator delete(allocation.Memory, align_val_t(allocation.Alignment));
+    m_heapAllocations.clear();
+
+    // Grow so that a frame like this one fits next time
+    if (m_heapBytes > 0)
+    {
+        size_t capacity = m_capacity;
+        while (capacity < used + m_heapBytes * 2) capacity *= 2;
+        Log::Warn("Frame arena ran out of memory, growing from {} KB to {} KB", m_capacity / 1024, capacity / 1024);
+        m_memory = make_unique<byte[]>(capacity);
+        m_capacity = capacity;
+        m_heapBytes = 0;
+    }
+
+    m_offset.store(0, memory_order_relaxed);
+}
+
+#ifdef BEE_INSPECTOR
+
+void FrameArena::OnStatsBar()
+{
+    ImGui::Text("%s %llu [%llu]",
+                ICON_FA_MICROCHIP,
+                static_cast<unsigned long long>(m_lastFrame.Allocations + m_lastFrame.ScratchAllocations),
+                static_cast<unsigned long long>(m_lastFrame.HeapAllocations));
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Frame arena    %llu allocations, %.1f / %.1f KB",
+                    static_cast<unsigned long long>(m_lastFrame.Allocations),
+                    static_cast<float>(m_lastFrame.Bytes) / 1024.0f,
+                    static_cast<float>(m_capacity) / 1024.0f);
+        ImGui::Text("Scratch arenas %llu allocations", static_cast<unsigned long long>(m_lastFrame.ScratchAllocations));
+        ImGui::Text("Heap fallback  %llu allocations", static_cast<unsigned long long>(m_lastFrame.HeapAllocations));
+        ImGui::EndTooltip();
+    }
+}
+
+#endif
@@ -9,12 +9,14 @@
 #include "core/device.hpp"
 #include "core/fileio.hpp"
 #include "core/input.hpp"
+#include "core/name.hpp"
 #include "core/transform.hpp"
 #include "tools/log.hpp"
 #include "tools/tools.hpp"
 #include "tools/profiler.hpp"
 #include "tools/inspectable.hpp"
 #include "rendering/debug_render.hpp"
+#include "rendering/scene_tree.hpp"
 #include <imgui/IconsFontAwesome.h>
 #include <imgui/imgui_internal.h>
 #include "tools/warnings.hpp"
@@ -36,6 +38,13 @@ namespace
 
 ImVec4 GetColor(const glm::vec3& color) { return ImVec4(color.r, color.g, color.b, 1.0); }
 
+const std::string& GetEntityName(Entity entity)
+{
+    static const std::string empty;
+    const auto* name = Engine.ECS().Registry.try_get<Name>(entity);
+    return name ? name->Get() : empty;
+}
+
 void AddToInspected(Entity entity, std::set<Entity>& inspected)
 {
     inspected.insert(entity);
@@ -119,8 +128,8 @@ void SceneInspector::OnPanel()
     ImGui::PopStyleColor();
 
     string selectedEntityName = Engine.ECS().Registry.valid(m_selectedEntity)
-                                    ? (Engine.ECS().Registry.get<Transform>(m_selectedEntity).Name + "   " + ICON_FA_ID_CARD +
-                                       " " + to_string(static_cast<int>(m_selectedEntity)))
+                                    ? (GetEntityName(m_selectedEntity) + "   " + ICON_FA_ID_CARD + " " +
+                                       to_string(static_cast<int>(m_selectedEntity)))
                                     : "None";
     ImGui::SeparatorText(selectedEntityName.c_str());
     if (Engine.ECS().Registry.valid(m_selectedEntity))
@@ -136,17 +145,38 @@ void SceneInspector::OnPanel()
 
 void SceneInspector::OnEntity(entt::entity entity)
 {
+    char nameBuffer[128];
+    snprintf(nameBuffer, sizeof(nameBuffer), "%s", GetEntityName(entity).c_str());
+    if (ImGui::InputText("Name", nameBuffer, sizeof(nameBuffer), ImGuiInputTextFlags_EnterReturnsTrue))
+        Engine.ECS().Registry.emplace_or_replace<Name>(entity, nameBuffer);
+
     if (ImGui::CollapsingHeader("Transform", ImGuiTreeNodeFlags_DefaultOpen))
     {
         if (Engine.ECS().Registry.try_get<Transform>(entity))
         {
             Transform& t = Engine.ECS().Registry.get<Transform>(entity);
+            bool changed = false;
             glm::vec3 translation(t.GetTranslation());
-            if (DragFloat3("Position", translation, 0.01f)) t.SetTranslation(translation);
+            if (DragFloat3("Position", translation, 0.01f))
+            {
+                t.SetTranslation(translation);
+                changed = true;
+            }
             glm::vec3 scale(t.GetScale());
-            if (DragFloat3("Scale", scale, 0.01f)) t.SetScale(scale);
+            if (DragFloat3("Scale", scale, 0.01f))
+            {
+                t.SetScale(scale);
+                changed = true;
+            }
             glm::vec3 rotationDeg = glm::degrees(glm::eulerAngles(t.GetRotation()));
-            if (DragFloat3("Rotation", rotationDeg, 0.5f)) t.SetRotation(glm::quat(glm::radians(rotationDeg)));
+            if (DragFloat3("Rotation", rotationDeg, 0.5f))
+            {
+                t.SetRotation(glm::quat(glm::radians(rotationDeg)));
+                changed = true;
+            }
+
+            // Static entities are only extracted again when their Transform is marked as changed
+            if (changed) Engine.ECS().MarkChanged<Transform>(entity);
         }
     }
 }
@@ -246,15 +276,44 @@ void bee::SceneInspector::Gizmo(const glm::mat4& view, const glm::mat4& projecti
             model = glm::inverse(parentTransform.World()) * model;
         }
         transform->SetFromMatrix(model);
+        Engine.ECS().MarkChanged<Transform>(m_selectedEntity);
     }
 }
 
+void bee::SceneInspector::Pick(const glm::mat4& view, const glm::mat4& projection)
+{
+    if (!ImGui::IsMouseClicked(ImGuiMouseButton_Left) || Inspector::IsMouseOver()) return;
+    if (ImGuizmo::IsOver() || ImGuizmo::IsUsing()) return;
+
+    const auto trees = Engine.ECS().GetSystems<SceneTree>();
+    if (trees.empty()) return;
+
+    // Unproject the mouse position onto the near and far planes
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+    const ImVec2 size = ImGui::GetIO().DisplaySize;
+    const glm::vec2 ndc(mouse.x / size.x * 2.0f - 1.0f, 1.0f - mouse.y / size.y * 2.0f);
+    const glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndc, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+    nearPoint /= nearPoint.w;
+    farPoint /= farPoint.w;
+
+    const glm::vec3 origin(nearPoint);
+    const glm::vec3 ray = glm::vec3(farPoint) - origin;
+    const float length = glm::length(ray);
+    if (length <= 0.0f) return;
+
+    SceneTree::RayHit hit;
+    if (trees.front()->QueryRay(origin, ray / length, length, hit)) m_selectedEntity = hit.Entity;
+}
+
 void SceneInspector::Inspect(Entity entity, Transform& transform, std::set<Entity>& inspected)
 {
     if (inspected.find(entity) != inspected.end()) return;
     inspected.insert(entity);
 
-    string name = transform.Name.empty() ? "Entity-" + std::to_string(static_cast<std::uint32_t>(entity)) : transform.Name;
+    const auto& entityName = GetEntityName(entity);
+    string name = entityName.empty() ? "Entity-" + std::to_string(static_cast<std::uint32_t>(entity)) : entityName;
 
     ImGuiTreeNodeFlags nodeFlags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
 
@@ -336,8 +395,7 @@ void SceneInspector::Filter(
     // Fist go through all entities and filter them
     for (auto entity : entities)
     {
-        auto& transform = entities.get<Transform>(entity);
-        if (!filter.PassFilter(transform.Name.c_str())) inspected_or_filtered.insert(entity);
+        if (!filter.PassFilter(GetEntityName(entity).c_str())) inspected_or_filtered.insert(entity);
     }
 
     // Next walk through all entities and remove their entire parent and grandparents from the filtered set
@@ -667,6 +725,7 @@ void bee::Inspector::Gizmo()
     auto projection = camera.Projection;
 
     m_scene.Gizmo(view, projection);
+    m_scene.Pick(view, projection);
 }
 
 void SetStyle()
@@ -0,0 +1,255 @@
+#include "tools/job_system.hpp"
+
+#include <cassert>
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+// The job system the current thread belongs to, and the index of its queue and job pool
+thread_local const JobSystem* t_jobSystem = nullptr;
+thread_local int t_threadIndex = -1;
+
+}  // namespace
+
+JobSystem::JobSystem(int numberOfWorkers)
+{
+    if (numberOfWorkers < 0) numberOfWorkers = max(static_cast<int>(thread::hardware_concurrency()) - 1, 1);
+
+    m_numberOfThreads = numberOfWorkers + 1;
+    m_queues = make_unique<Queue[]>(m_numberOfThreads);
+    m_pools = make_unique<JobPool[]>(m_numberOfThreads + 1);
+    for (int i = 0; i < m_numberOfThreads + 1; i++) m_pools[i].Jobs = make_unique<Job[]>(kJobsPerThread);
+
+    // The creating thread owns queue 0
+    t_jobSystem = this;
+    t_threadIndex = 0;
+
+    m_workers.reserve(numberOfWorkers);
+    for (int i = 1; i <= numberOfWorkers; i++) m_workers.emplace_back([this, i] { WorkerMain(i); });
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        lock_guard<mutex> lock(m_sleepMutex);
+        m_stopped = true;
+    }
+    m_sleepCondition.notify_all();
+    for (auto& worker : m_workers) worker.join();
+
+    // Run whatever is left, jobs may be waited on by handles that outlive this frame
+    while (ExecuteOne())
+    {
+    }
+
+    if (t_jobSystem == this)
+    {
+        t_jobSystem = nullptr;
+        t_threadIndex = -1;
+    }
+}
+
+void JobSystem::Wait(const JobHandle& handle)
+{
+    while (!IsDone(handle))
+    {
+        if (!ExecuteOne()) this_thread::yield();
+    }
+}
+
+bool JobSystem::IsDone(const JobHandle& handle) const
+{
+    return !handle.IsValid() || handle.m_job->Generation.load(memory_order_acquire) != handle.m_generation;
+}
+
+bool JobSystem::ExecuteOne()
+{
+    Job* job = Pop();
+    if (!job) return false;
+    Execute(job);
+    return true;
+}
+
+int JobSystem::GetThreadIndex() const { return t_jobSystem == this ? t_threadIndex : -1; }
+
+JobSystem::Job* JobSystem::AllocateJob()
+{
+    // Threads that do not belong to the job system share the last pool
+    const int index = GetThreadIndex();
+    JobPool& pool = m_pools[index >= 0 ? index : m_numberOfThreads];
+    unique_lock<mutex> lock(m_sharedPoolMutex, defer_lock);
+    if (index < 0) lock.lock();
+
+    for (;;)
+    {
+        for (size_t i = 0; i < kJobsPerThread; i++)
+        {
+            Job& job = pool.Jobs[pool.Next++ & (kJobsPerThread - 1)];
+            if (job.InUse.load(memory_order_acquire)) continue;
+
+            job.InUse.store(true, memory_order_relaxed);
+            job.Parent = nullptr;
+            job.Unfinished.store(1, memory_order_relaxed);
+            job.Dependencies.store(0, memory_order_relaxed);
+            job.NumContinuations = 0;
+            return &job;
+        }
+
+        // Every job of this thread is still in flight, help out until one of them finishes
+        if (lock.owns_lock()) lock.unlock();
+        if (!ExecuteOne()) this_thread::yield();
+        if (index < 0) lock.lock();
+    }
+}
+
+void JobSystem::Submit(Job* job, initializer_list<JobHandle> dependencies)
+{
+    // Hold one dependency ourselves, so the job cannot start before all dependencies have been registered
+    job->Dependencies.store(1, memory_order_relaxed);
+
+    for (const auto& dependency : dependencies)
+    {
+        if (!dependency.IsValid()) continue;
+        Job* other = dependency.m_job;
+
+        while (other->Lock.test_and_set(memory_order_acquire))
+        {
+        }
+        bool registered = false;
+        const bool done = other->Generation.load(memory_order_relaxed) != dependency.m_generation;
+        if (!done && other->NumContinuations < kMaxContinuations)
+        {
+            job->Dependencies.fetch_add(1, memory_order_relaxed);
+            other->Continuations[other->NumContinuations++] = job;
+            registered = true;
+        }
+        other->Lock.clear(memory_order_release);
+
+        if (!done && !registered)
+        {
+            assert(false && "Too many jobs depend on the same job");
+            Wait(dependency);
+        }
+    }
+
+    if (job->Dependencies.fetch_sub(1, memory_order_acq_rel) == 1) Push(job);
+}
+
+void JobSystem::Push(Job* job)
+{
+    const int index = GetThreadIndex();
+    Queue& queue = m_queues[index >= 0 ? index : 0];
+
+    bool pushed = false;
+    {
+        lock_guard<mutex> lock(queue.Mutex);
+        if (queue.Back - queue.Front < kJobsPerThread)
+        {
+            queue.Jobs[queue.Back++ & (kJobsPerThread - 1)] = job;
+            pushed = true;
+        }
+    }
+
+    // The queue is full, so run the job right away instead
+    if (!pushed)
+    {
+        Execute(job);
+        return;
+    }
+
+    m_pendingJobs.fetch_add(1);
+    if (m_sleepingWorkers.load() > 0)
+    {
+        // Taking the lock makes sure a worker that is about to sleep sees the new job, or gets notified
+        {
+            lock_guard<mutex> lock(m_sleepMutex);
+        }
+        m_sleepCondition.notify_one();
+    }
+}
+
+JobSystem::Job* JobSystem::Pop()
+{
+    const int index = GetThreadIndex();
+
+    // Newest job from our own queue first, it is most likely still in the cache
+    if (index >= 0)
+    {
+        Queue& queue = m_queues[index];
+        lock_guard<mutex> lock(queue.Mutex);
+        if (queue.Back != queue.Front)
+        {
+            m_pendingJobs.fetch_sub(1);
+            return queue.Jobs[--queue.Back & (kJobsPerThread - 1)];
+        }
+    }
+
+    // Otherwise steal the oldest job of another thread
+    const int start = max(index, 0);
+    for (int i = 1; i <= m_numberOfThreads; i++)
+    {
+        Queue& queue = m_queues[(start + i) % m_numberOfThreads];
+        lock_guard<mutex> lock(queue.Mutex);
+        if (queue.Back != queue.Front)
+        {
+            m_pendingJobs.fetch_sub(1);
+            m_jobsStolen.fetch_add(1, memory_order_relaxed);
+            return queue.Jobs[queue.Front++ & (kJobsPerThread - 1)];
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::Execute(Job* job)
+{
+    job->Invoke(*job);
+    m_jobsExecuted.fetch_add(1, memory_order_relaxed);
+    Finish(job);
+}
+
+void JobSystem::Finish(Job* job)
+{
+    // Still waiting for children
+    if (job->Unfinished.fetch_sub(1, memory_order_acq_rel) != 1) return;
+
+    // Bumping the generation marks all handles as done, and stops new continuations from being added
+    Job* continuations[kMaxContinuations];
+    while (job->Lock.test_and_set(memory_order_acquire))
+    {
+    }
+    const uint8_t numContinuations = job->NumContinuations;
+    copy(job->Continuations, job->Continuations + numContinuations, continuations);
+    job->NumContinuations = 0;
+    job->Generation.fetch_add(1, memory_order_release);
+    job->Lock.clear(memory_order_release);
+
+    // From here on the job can be reused by the thread that owns it
+    Job* parent = job->Parent;
+    job->InUse.store(false, memory_order_release);
+
+    for (uint8_t i = 0; i < numContinuations; i++)
+    {
+        if (continuations[i]->Dependencies.fetch_sub(1, memory_order_acq_rel) == 1) Push(continuations[i]);
+    }
+    if (parent) Finish(parent);
+}
+
+void JobSystem::WorkerMain(int threadIndex)
+{
+    t_jobSystem = this;
+    t_threadIndex = threadIndex;
+
+    while (!m_stopped)
+    {
+        if (ExecuteOne()) continue;
+
+        unique_lock<mutex> lock(m_sleepMutex);
+        m_sleepingWorkers.fetch_add(1);
+        m_sleepCondition.wait(lock, [this] { return m_pendingJobs.load() > 0 || m_stopped; });
+        m_sleepingWorkers.fetch_sub(1);
+    }
+}
@@ -8,8 +8,10 @@ BEE_DISABLE_WARNING_MISSING_FIELD_INITIALIZERS
 #include <Superluminal/PerformanceAPI_loader.h>
 BEE_DISABLE_WARNING_POP
 #endif
+#include "tools/arena.hpp"
 #include "tools/log.hpp"
 #include "core/engine.hpp"
+#include <algorithm>
 #include <imgui/imgui.h>
 #include <imgui/implot.h>
 
@@ -40,10 +42,15 @@ Profiler::Profiler()
 
 Profiler::~Profiler() {}
 
-void Profiler::BeginSection(const std::string& name) { m_times[name].Start = std::chrono::high_resolution_clock::now(); }
+void Profiler::BeginSection(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_times[name].Start = std::chrono::high_resolution_clock::now();
+}
 
 void Profiler::EndSection(const std::string& name)
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     auto& e = m_times[name];
     e.End = std::chrono::high_resolution_clock::now();
     auto elapsed = e.End - e.Start;
@@ -75,12 +82,16 @@ void Profiler::OnPanel()
         {
             auto& e = itr.second;
 
-            std::vector<float> vals(e.History.begin(), e.History.end());
+            // ImPlot needs contiguous values, copy them to scratch memory instead of the heap
+            ScratchScope scratch;
+            const int count = (int)e.History.size();
+            float* vals = scratch.GetArena().Allocate<float>(e.History.size());
+            std::copy(e.History.begin(), e.History.end(), vals);
 
             ImPlot::PushStyleVar(ImPlotStyleVar_FillAlpha, 0.25f);
-            ImPlot::PlotShaded(itr.first.c_str(), vals.data(), (int)vals.size());
+            ImPlot::PlotShaded(itr.first.c_str(), vals, count);
             ImPlot::PopStyleVar();
-            ImPlot::PlotLine(itr.first.c_str(), vals.data(), (int)vals.size());
+            ImPlot::PlotLine(itr.first.c_str(), vals, count);
         }
         ImPlot::EndPlot();
     }
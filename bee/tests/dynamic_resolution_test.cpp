@@ -0,0 +1,132 @@
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "rendering/dynamic_resolution.hpp"
+#include "test.hpp"
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+// A change of the scale or the samples, as AddFrame reported it
+struct Change
+{
+    size_t Frame = 0;
+    float Scale = 0.0f;
+    int Samples = 0;
+};
+
+// Reads GPU times in milliseconds, one per line, from the traces folder next to the tests. Lines with # are comments.
+// The traces are synthetic: a load shape with noise, generated once with a fixed seed. Times recorded from the game's
+// GL_TIME_ELAPSED queries would already depend on the scale that the controller picked while recording, so replaying
+// them could not show how a different controller reacts. These are played back as they are, open loop: they do not
+// get faster when the controller lowers the resolution.
+vector<float> LoadTrace(const string& name)
+{
+    vector<float> times;
+    ifstream file("traces/" + name);
+    string line;
+    while (getline(file, line))
+        if (!line.empty() && line[0] != '#') times.push_back(stof(line));
+    return times;
+}
+
+vector<Change> Play(DynamicResolution& controller, const vector<float>& times, size_t first, size_t last)
+{
+    vector<Change> changes;
+    for (size_t i = first; i < last && i < times.size(); i++)
+        if (controller.AddFrame(times[i])) changes.push_back({i, controller.GetScale(), controller.GetSamples()});
+    return changes;
+}
+
+}  // namespace
+
+TEST(DynamicResolutionIgnoresJitterAndHitches)
+{
+    const auto times = LoadTrace("synthetic_steady.csv");
+    CHECK(times.size() == 900);
+
+    DynamicResolution controller;
+    CHECK(Play(controller, times, 0, times.size()).empty());
+    CHECK(controller.GetScale() == controller.MaxScale);
+    CHECK(controller.GetSamples() == controller.MaxSamples);
+}
+
+TEST(DynamicResolutionStepsDownThenHalvesSamples)
+{
+    // 120 light frames, then a scene that is too heavy even at the smallest scale
+    const auto times = LoadTrace("synthetic_spike.csv");
+    CHECK(times.size() == 720);
+
+    DynamicResolution controller;
+    CHECK(Play(controller, times, 0, 120).empty());
+    const auto changes = Play(controller, times, 120, times.size());
+    CHECK(!changes.empty());
+    if (changes.empty()) return;
+
+    // Reacts within a few frames, and only goes down
+    CHECK(changes.front().Frame < 130);
+    float scale = controller.MaxScale;
+    int samples = controller.MaxSamples;
+    for (const auto& change : changes)
+    {
+        CHECK(change.Scale <= scale);
+        CHECK(change.Samples == samples || change.Samples == samples / 2);
+
+        // Samples are the last resort, the scale is at its smallest before they change
+        if (change.Samples != samples) CHECK(scale == controller.MinScale && change.Scale == controller.MinScale);
+        scale = change.Scale;
+        samples = change.Samples;
+    }
+
+    CHECK(controller.GetScale() == controller.MinScale);
+    CHECK(controller.GetSamples() == controller.MinSamples);
+
+    // Halving 4 to 2 waits for SampleFrames at the smallest scale
+    size_t atMinScale = 0;
+    for (const auto& change : changes)
+    {
+        if (atMinScale == 0 && change.Scale == controller.MinScale) atMinScale = change.Frame;
+        if (change.Samples == 2) CHECK(change.Frame >= atMinScale + controller.SampleFrames);
+    }
+}
+
+TEST(DynamicResolutionRecovers)
+{
+    // 600 heavy frames, then 1500 light ones
+    const auto times = LoadTrace("synthetic_recovery.csv");
+    CHECK(times.size() == 2100);
+
+    DynamicResolution controller;
+    Play(controller, times, 0, 600);
+    CHECK(controller.GetScale() == controller.MinScale);
+    CHECK(controller.GetSamples() == controller.MinSamples);
+
+    // Back up one step at a time, never faster than UpFrames, and the samples only once the scale is back
+    const auto changes = Play(controller, times, 600, times.size());
+    float scale = controller.MinScale;
+    int samples = controller.MinSamples;
+    size_t lastFrame = 600;
+    for (const auto& change : changes)
+    {
+        CHECK(change.Frame >= lastFrame + controller.UpFrames);
+        if (change.Samples == samples)
+        {
+            CHECK_NEAR(change.Scale, scale + controller.ScaleStep, 1e-4f);
+        }
+        else
+        {
+            CHECK(change.Samples == samples * 2);
+            CHECK(change.Scale == controller.MaxScale && scale == controller.MaxScale);
+        }
+        scale = change.Scale;
+        samples = change.Samples;
+        lastFrame = change.Frame;
+    }
+
+    CHECK(controller.GetScale() == controller.MaxScale);
+    CHECK(controller.GetSamples() == controller.MaxSamples);
+}
@@ -0,0 +1,154 @@
+#include "rendering/indirect_draw.hpp"
+#include "test.hpp"
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+// Packets given as mesh, level of detail and material, in the order of the list
+DrawList MakeList(const vector<DrawPacket>& packets)
+{
+    DrawList list;
+    list.Resize(packets.size());
+    for (size_t i = 0; i < packets.size(); i++)
+    {
+        list[i] = packets[i];
+        list[i].Index = static_cast<uint32_t>(i);
+    }
+    return list;
+}
+
+DrawPacket Packet(uint16_t mesh, uint8_t lod, uint16_t material)
+{
+    DrawPacket packet;
+    packet.Mesh = mesh;
+    packet.Lod = lod;
+    packet.Material = material;
+    return packet;
+}
+
+// A range of its own for every mesh and level of detail, so commands tell which one they draw
+vector<MeshRange> MakeRanges(uint32_t meshes)
+{
+    vector<MeshRange> ranges;
+    for (uint32_t i = 0; i < meshes * DrawKey::c_maxLods; i++)
+        ranges.push_back({i * 100, 3 + i, static_cast<int32_t>(i * 10)});
+    return ranges;
+}
+
+}  // namespace
+
+TEST(IndirectDrawMergesInstances)
+{
+    const DrawList list = MakeList({Packet(0, 0, 0), Packet(0, 0, 0), Packet(0, 0, 0), Packet(0, 1, 0), Packet(1, 1, 0),
+                                    Packet(1, 1, 1), Packet(1, 1, 1)});
+    const auto ranges = MakeRanges(2);
+    IndirectCommands result;
+    BuildIndirectCommands(list, 0, list.Size(), 50, ranges, {}, result);
+
+    // Same mesh, level of detail and material is one command, any difference starts another
+    CHECK(result.Commands.size() == 4);
+    if (result.Commands.size() != 4) return;
+    const uint32_t instances[] = {3, 1, 1, 2};
+    const uint32_t firstDraws[] = {0, 3, 4, 5};
+    const size_t rangeIndices[] = {0, 1, 1 * DrawKey::c_maxLods + 1, 1 * DrawKey::c_maxLods + 1};
+    for (size_t c = 0; c < 4; c++)
+    {
+        const auto& command = result.Commands[c];
+        const auto& range = ranges[rangeIndices[c]];
+        CHECK(command.InstanceCount == instances[c]);
+        CHECK(result.FirstDraws[c] == firstDraws[c]);
+        CHECK(command.BaseInstance == 50 + firstDraws[c]);
+        CHECK(command.Count == range.IndexCount);
+        CHECK(command.FirstIndex == range.FirstIndex);
+        CHECK(command.BaseVertex == range.BaseVertex);
+    }
+
+    // Without bucket keys everything is in one bucket
+    CHECK(result.Buckets.size() == 1);
+    CHECK(result.Buckets[0].FirstCommand == 0);
+    CHECK(result.Buckets[0].CommandCount == 4);
+}
+
+TEST(IndirectDrawSplitsBucketsByKey)
+{
+    // Materials 0 and 1 share a key, 2 does not, and 3 has the key of 0 again
+    const DrawList list = MakeList({Packet(0, 0, 0), Packet(1, 0, 1), Packet(0, 0, 2), Packet(1, 0, 2), Packet(0, 0, 3),
+                                    Packet(1, 0, 0)});
+    const vector<uint32_t> bucketKeys = {7, 7, 9, 7};
+    IndirectCommands result;
+    BuildIndirectCommands(list, 0, list.Size(), 0, MakeRanges(2), bucketKeys, result);
+
+    CHECK(result.Commands.size() == 6);
+    CHECK(result.Buckets.size() == 3);
+    if (result.Buckets.size() != 3) return;
+    CHECK(result.Buckets[0].FirstCommand == 0 && result.Buckets[0].CommandCount == 2);
+    CHECK(result.Buckets[1].FirstCommand == 2 && result.Buckets[1].CommandCount == 2);
+    CHECK(result.Buckets[2].FirstCommand == 4 && result.Buckets[2].CommandCount == 2);
+
+    // An empty range gives nothing
+    BuildIndirectCommands(list, 3, 3, 0, MakeRanges(2), bucketKeys, result);
+    CHECK(result.Commands.empty() && result.FirstDraws.empty() && result.Buckets.empty());
+}
+
+TEST(IndirectDrawSlicesMatchWholeList)
+{
+    const DrawList list = MakeList({Packet(0, 0, 0), Packet(0, 0, 0), Packet(0, 0, 0), Packet(0, 0, 0), Packet(1, 0, 0),
+                                    Packet(1, 0, 1), Packet(1, 0, 1), Packet(0, 2, 1)});
+    const auto ranges = MakeRanges(2);
+    const vector<uint32_t> bucketKeys = {1, 2};
+    IndirectCommands whole;
+    BuildIndirectCommands(list, 0, list.Size(), 20, ranges, bucketKeys, whole);
+
+    // Cut in the middle of the first run of 4 instances, and again in the run of material 1
+    const size_t cuts[] = {0, 2, 6, list.Size()};
+    vector<DrawElementsIndirectCommand> commands;
+    vector<uint32_t> firstDraws;
+    size_t buckets = 0;
+    for (size_t s = 0; s + 1 < 4; s++)
+    {
+        IndirectCommands slice;
+        BuildIndirectCommands(list, cuts[s], cuts[s + 1], 20, ranges, bucketKeys, slice);
+        commands.insert(commands.end(), slice.Commands.begin(), slice.Commands.end());
+        firstDraws.insert(firstDraws.end(), slice.FirstDraws.begin(), slice.FirstDraws.end());
+        buckets += slice.Buckets.size();
+    }
+
+    // Every cut inside a run splits one command in two and starts a bucket, nothing else changes
+    CHECK(whole.Commands.size() == 4);
+    CHECK(commands.size() == whole.Commands.size() + 2);
+    CHECK(whole.Buckets.size() == 2);
+    CHECK(buckets == whole.Buckets.size() + 2);
+    if (commands.size() != 6 || whole.Commands.size() != 4) return;
+
+    // Put the split commands back together and compare
+    vector<DrawElementsIndirectCommand> merged;
+    vector<uint32_t> mergedFirstDraws;
+    for (size_t c = 0; c < commands.size(); c++)
+    {
+        const auto& command = commands[c];
+        const bool continues = !merged.empty() && merged.back().FirstIndex == command.FirstIndex &&
+                               mergedFirstDraws.back() + merged.back().InstanceCount == firstDraws[c] &&
+                               list[firstDraws[c]].Material == list[mergedFirstDraws.back()].Material;
+        if (continues)
+        {
+            merged.back().InstanceCount += command.InstanceCount;
+            continue;
+        }
+        merged.push_back(command);
+        mergedFirstDraws.push_back(firstDraws[c]);
+    }
+
+    CHECK(merged.size() == whole.Commands.size());
+    CHECK(mergedFirstDraws == whole.FirstDraws);
+    for (size_t c = 0; c < merged.size() && c < whole.Commands.size(); c++)
+    {
+        CHECK(merged[c].Count == whole.Commands[c].Count);
+        CHECK(merged[c].InstanceCount == whole.Commands[c].InstanceCount);
+        CHECK(merged[c].FirstIndex == whole.Commands[c].FirstIndex);
+        CHECK(merged[c].BaseVertex == whole.Commands[c].BaseVertex);
+        CHECK(merged[c].BaseInstance == whole.Commands[c].BaseInstance);
+    }
+}
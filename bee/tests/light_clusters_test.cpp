@@ -0,0 +1,140 @@
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "rendering/light_clusters.hpp"
+#include "test.hpp"
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+// Lights scattered through and around the frustum of a camera at the origin looking down -Z, with a fixed seed. Every
+// seventh light has a range of 0 or less and must be skipped.
+vector<glm::vec4> MakeLights(size_t count, float depth)
+{
+    vector<glm::vec4> lights;
+    uint32_t random = 12345;
+    const auto next = [&random]
+    {
+        random = random * 1664525u + 1013904223u;
+        return static_cast<float>(random >> 8) * (1.0f / 16777216.0f);
+    };
+    for (size_t i = 0; i < count; i++)
+    {
+        const float z = -next() * depth;
+        const float spread = 0.8f * std::abs(z) + 2.0f;
+        const float range = i % 7 == 3 ? -next() : (i % 7 == 5 ? 0.0f : 0.5f + 4.0f * next());
+        lights.push_back({(next() * 2.0f - 1.0f) * spread, (next() * 2.0f - 1.0f) * spread, z, range});
+    }
+    return lights;
+}
+
+// Compares the lights of every cluster against testing every light against the box of the cluster
+int CountMismatches(const LightClusters& clusters, const glm::mat4& view, const vector<glm::vec4>& lights)
+{
+    int mismatches = 0;
+    for (int c = 0; c < LightClusters::c_count; c++)
+    {
+        const auto [min, max] = clusters.GetBounds(c);
+        vector<uint32_t> expected;
+        for (size_t i = 0; i < lights.size(); i++)
+        {
+            if (lights[i].w <= 0.0f) continue;
+            const glm::vec3 center = glm::vec3(view * glm::vec4(glm::vec3(lights[i]), 1.0f));
+            const glm::vec3 offset = glm::max(glm::max(min - center, center - max), glm::vec3(0.0f));
+            if (glm::dot(offset, offset) <= lights[i].w * lights[i].w) expected.push_back(static_cast<uint32_t>(i));
+        }
+
+        const auto& cluster = clusters.GetClusters()[c];
+        const auto& indices = clusters.GetLightIndices();
+        if (cluster.Offset + cluster.Count > indices.size())
+        {
+            mismatches++;
+            continue;
+        }
+        const vector<uint32_t> found(indices.begin() + cluster.Offset, indices.begin() + cluster.Offset + cluster.Count);
+        if (found != expected) mismatches++;
+    }
+    return mismatches;
+}
+
+// The clusters follow each other in the index list, without gaps or overlaps
+bool IsCompact(const LightClusters& clusters)
+{
+    uint32_t offset = 0;
+    uint32_t maxLights = 0;
+    for (const auto& cluster : clusters.GetClusters())
+    {
+        if (cluster.Offset != offset) return false;
+        offset += cluster.Count;
+        maxLights = std::max(maxLights, cluster.Count);
+    }
+    return offset == clusters.GetLightIndices().size() && maxLights == clusters.GetMaxClusterLights();
+}
+
+size_t CountLit(const vector<glm::vec4>& lights)
+{
+    size_t count = 0;
+    for (const auto& light : lights)
+        if (light.w > 0.0f) count++;
+    return count;
+}
+
+}  // namespace
+
+TEST(LightClustersMatchBruteForcePerspective)
+{
+    const glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 60.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(3.0f, 2.0f, 5.0f), glm::vec3(3.0f, 1.0f, -5.0f), glm::vec3(0, 1, 0));
+
+    // Counts that leave a tail after the 4 and 8 lights of the SIMD registers, and fewer lights than a register
+    LightClusters clusters;
+    for (size_t count : {3u, 13u, 61u, 203u})
+    {
+        const auto lights = MakeLights(count, 70.0f);
+        clusters.Build(view, projection, lights.data(), lights.size());
+        CHECK(clusters.IsLogarithmic());
+        CHECK(clusters.GetLightCount() == CountLit(lights));
+        CHECK(CountMismatches(clusters, view, lights) == 0);
+        CHECK(IsCompact(clusters));
+    }
+    CHECK(!clusters.GetLightIndices().empty());
+}
+
+TEST(LightClustersMatchBruteForceOrthographic)
+{
+    const glm::mat4 projection = glm::ortho(-20.0f, 20.0f, -12.0f, 12.0f, 0.5f, 50.0f);
+    const glm::mat4 view = glm::mat4(1.0f);
+
+    LightClusters clusters;
+    for (size_t count : {5u, 29u, 99u})
+    {
+        const auto lights = MakeLights(count, 50.0f);
+        clusters.Build(view, projection, lights.data(), lights.size());
+        CHECK(!clusters.IsLogarithmic());
+        CHECK(CountMismatches(clusters, view, lights) == 0);
+        CHECK(IsCompact(clusters));
+    }
+}
+
+TEST(LightClustersSkipLightsWithoutRange)
+{
+    const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    const vector<glm::vec4> lights = {{0.0f, 0.0f, -10.0f, 0.0f}, {0.0f, 0.0f, -10.0f, -5.0f}, {0.0f, 0.0f, -10.0f, 2.0f}};
+
+    LightClusters clusters;
+    clusters.Build(glm::mat4(1.0f), projection, lights.data(), lights.size());
+    CHECK(clusters.GetLightCount() == 1);
+    CHECK(!clusters.GetLightIndices().empty());
+    for (const uint32_t light : clusters.GetLightIndices()) CHECK(light == 2);
+
+    // Binned slices by hand, out of order, give the same clusters
+    LightClusters banded;
+    banded.SetView(glm::mat4(1.0f), projection, lights.data(), lights.size());
+    banded.BinSlices(10, LightClusters::c_slices);
+    banded.BinSlices(0, 10);
+    banded.Compact();
+    CHECK(banded.GetLightIndices() == clusters.GetLightIndices());
+    CHECK(IsCompact(banded));
+}
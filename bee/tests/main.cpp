@@ -0,0 +1,42 @@
+#include <cstdio>
+
+#include "test.hpp"
+
+using namespace bee::tests;
+using namespace std;
+
+namespace
+{
+
+int g_failures = 0;
+
+}  // namespace
+
+vector<Test>& bee::tests::GetTests()
+{
+    // A function static, so that tests in other files can register before it is used
+    static vector<Test> tests;
+    return tests;
+}
+
+void bee::tests::Fail(const char* file, int line, const char* expression)
+{
+    printf("%s(%d): check failed: %s\n", file, line, expression);
+    g_failures++;
+}
+
+int main()
+{
+    int failed = 0;
+    for (const auto& test : GetTests())
+    {
+        const int failures = g_failures;
+        test.Function();
+        if (g_failures == failures) continue;
+        printf("FAILED %s\n", test.Name);
+        failed++;
+    }
+
+    printf("%d of %d tests passed\n", static_cast<int>(GetTests().size()) - failed, static_cast<int>(GetTests().size()));
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+#include <thread>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "rendering/occlusion_culler.hpp"
+#include "test.hpp"
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+// At the origin looking down -Z, with the aspect ratio of the depth buffer so that pixels are square
+const glm::mat4 c_viewProjection =
+    glm::perspective(glm::radians(60.0f),
+                     static_cast<float>(OcclusionCuller::c_width) / static_cast<float>(OcclusionCuller::c_height),
+                     0.1f,
+                     100.0f);
+
+// A quad of 10 by 10 at z = -10, facing the camera
+const vector<glm::vec3> c_quad = {{-5.0f, -5.0f, -10.0f}, {5.0f, -5.0f, -10.0f}, {5.0f, 5.0f, -10.0f}, {-5.0f, 5.0f, -10.0f}};
+const vector<uint32_t> c_quadIndices = {0, 1, 2, 0, 2, 3};
+
+// World units per pixel at a distance from the camera
+float GetPixelSize(float distance)
+{
+    return 2.0f * distance * glm::tan(glm::radians(30.0f)) / static_cast<float>(OcclusionCuller::c_height);
+}
+
+void RasterizeQuad(OcclusionCuller& culler)
+{
+    culler.SetView(c_viewProjection);
+    culler.AddOccluder(c_quad, c_quadIndices, glm::mat4(1.0f));
+    culler.Rasterize();
+}
+
+}  // namespace
+
+TEST(OcclusionCullerHidesBoxBehindQuad)
+{
+    OcclusionCuller culler;
+    RasterizeQuad(culler);
+    CHECK(culler.GetTriangleCount() == 2);
+
+    CHECK(culler.IsOccluded(glm::vec3(-1.0f, -1.0f, -21.0f), glm::vec3(1.0f, 1.0f, -19.0f)));
+    CHECK(culler.IsOccluded(glm::vec3(-9.0f, -9.0f, -30.0f), glm::vec3(9.0f, 9.0f, -25.0f)));
+
+    // In front of the quad, or intersecting it
+    CHECK(!culler.IsOccluded(glm::vec3(-1.0f, -1.0f, -6.0f), glm::vec3(1.0f, 1.0f, -4.0f)));
+    CHECK(!culler.IsOccluded(glm::vec3(-1.0f, -1.0f, -11.0f), glm::vec3(1.0f, 1.0f, -9.0f)));
+
+    // Without occluders nothing is hidden
+    OcclusionCuller empty;
+    empty.SetView(c_viewProjection);
+    empty.Rasterize();
+    CHECK(!empty.IsOccluded(glm::vec3(-1.0f, -1.0f, -21.0f), glm::vec3(1.0f, 1.0f, -19.0f)));
+}
+
+TEST(OcclusionCullerKeepsBoxAtQuadEdge)
+{
+    OcclusionCuller culler;
+    RasterizeQuad(culler);
+
+    // At z = -20 the right edge of the quad is at x = 10
+    const float pixel = GetPixelSize(20.0f);
+    const auto box = [&culler](float maxX)
+    { return culler.IsOccluded(glm::vec3(maxX - 2.0f, -1.0f, -21.0f), glm::vec3(maxX, 1.0f, -20.0f)); };
+    CHECK(!box(10.5f));
+    CHECK(!box(10.0f + 0.5f * pixel));
+
+    // The pixels around the box must be covered as well, so a box that ends within a pixel of the edge stays visible
+    CHECK(!box(10.0f - 0.5f * pixel));
+    CHECK(box(10.0f - 3.0f * pixel));
+}
+
+TEST(OcclusionCullerKeepsBoxCrossingNearPlane)
+{
+    OcclusionCuller culler;
+    RasterizeQuad(culler);
+
+    CHECK(!culler.IsOccluded(glm::vec3(-1.0f, -1.0f, -30.0f), glm::vec3(1.0f, 1.0f, 0.5f)));
+    CHECK(!culler.IsOccluded(glm::vec3(-1.0f, -1.0f, -0.05f), glm::vec3(1.0f, 1.0f, 0.05f)));
+
+    // An occluder that crosses the near plane is clipped, and still hides what is behind it
+    const vector<glm::vec3> floor = {
+        {-50.0f, -1.0f, 5.0f}, {50.0f, -1.0f, 5.0f}, {50.0f, -1.0f, -50.0f}, {-50.0f, -1.0f, -50.0f}};
+    const vector<uint32_t> floorIndices = {0, 1, 2, 0, 2, 3};
+    OcclusionCuller clipped;
+    clipped.SetView(c_viewProjection);
+    clipped.AddOccluder(floor, floorIndices, glm::mat4(1.0f));
+    clipped.Rasterize();
+    CHECK(clipped.GetTriangleCount() > 0);
+    CHECK(clipped.IsOccluded(glm::vec3(-1.0f, -3.0f, -12.0f), glm::vec3(1.0f, -2.0f, -10.0f)));
+    CHECK(!clipped.IsOccluded(glm::vec3(-1.0f, 0.0f, -12.0f), glm::vec3(1.0f, 1.0f, -10.0f)));
+}
+
+TEST(OcclusionCullerBandsMatchRasterize)
+{
+    // Tilted quads at different depths, so that the depth planes differ over every band
+    vector<glm::mat4> worlds;
+    for (int i = 0; i < 8; i++)
+    {
+        glm::mat4 world = glm::translate(glm::mat4(1.0f), glm::vec3(-6.0f + 2.0f * i, 0.7f * i - 3.0f, -4.0f * i));
+        world = glm::rotate(world, glm::radians(11.0f * i), glm::vec3(0.3f, 1.0f, 0.2f));
+        worlds.push_back(world);
+    }
+
+    OcclusionCuller serial;
+    serial.SetView(c_viewProjection);
+    for (const auto& world : worlds) serial.AddOccluder(c_quad, c_quadIndices, world);
+    serial.Rasterize();
+
+    // Set up and rasterize on different threads, with bands out of order
+    OcclusionCuller banded;
+    banded.SetView(c_viewProjection);
+    for (const auto& world : worlds) banded.AddOccluder(c_quad, c_quadIndices, world);
+    {
+        thread first([&banded] { banded.SetupOccluders(0, 3); });
+        thread second([&banded] { banded.SetupOccluders(3, 8); });
+        first.join();
+        second.join();
+    }
+    {
+        thread first([&banded] { banded.RasterizeBands(9, OcclusionCuller::c_bands); });
+        thread second([&banded] { banded.RasterizeBands(0, 9); });
+        first.join();
+        second.join();
+    }
+    banded.BuildHierarchy();
+
+    CHECK(banded.GetTriangleCount() == serial.GetTriangleCount());
+    CHECK(banded.GetLevelCount() == serial.GetLevelCount());
+    int mismatches = 0;
+    int covered = 0;
+    for (int level = 0; level < serial.GetLevelCount(); level++)
+        for (int y = 0; y < serial.GetLevelHeight(level); y++)
+            for (int x = 0; x < serial.GetLevelWidth(level); x++)
+            {
+                if (banded.GetDepth(x, y, level) != serial.GetDepth(x, y, level)) mismatches++;
+                if (level == 0 && serial.GetDepth(x, y) < 1.0f) covered++;
+            }
+    CHECK(mismatches == 0);
+    CHECK(covered > 0);
+}
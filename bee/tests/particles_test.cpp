@@ -0,0 +1,219 @@
+#include <cstring>
+
+#include "rendering/particles.hpp"
+#include "test.hpp"
+#include "tools/job_system.hpp"
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+// Particles with different velocities and lifetimes, so that every lane of a register sees different values
+void Fill(ParticlePool& pool, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const float f = static_cast<float>(i);
+        pool.Emit(glm::vec3(f, -f, 0.5f * f), glm::vec3(0.1f * f, 3.0f - 0.2f * f, 1.0f / (f + 1.0f)), 0.5f + 0.01f * f);
+    }
+}
+
+bool SameBits(float a, float b) { return memcmp(&a, &b, sizeof(float)) == 0; }
+
+bool SameParticle(const ParticlePool& a, size_t i, const ParticlePool& b, size_t j)
+{
+    const glm::vec3 pa = a.GetPosition(i), pb = b.GetPosition(j), va = a.GetVelocity(i), vb = b.GetVelocity(j);
+    bool same = SameBits(a.GetAge(i), b.GetAge(j));
+    for (int axis = 0; axis < 3; axis++) same &= SameBits(pa[axis], pb[axis]) && SameBits(va[axis], vb[axis]);
+    return same;
+}
+
+ParticleType MakeType(uint32_t maxParticles)
+{
+    ParticleType type;
+    type.Gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+    type.Drag = 0.5f;
+    type.MaxParticles = maxParticles;
+    return type;
+}
+
+}  // namespace
+
+TEST(ParticlePoolSseMatchesScalar)
+{
+    // 4 registers and a scalar tail in one call, against only scalar code one particle at a time
+    constexpr size_t count = 4 * ParticlePool::c_lanes + 3;
+    ParticlePool wide(count);
+    ParticlePool narrow(count);
+    Fill(wide, count);
+    Fill(narrow, count);
+
+    const glm::vec3 gravity(0.5f, -9.81f, 0.25f);
+    for (int frame = 0; frame < 10; frame++)
+    {
+        const float dt = 0.013f + 0.002f * static_cast<float>(frame);
+        wide.Simulate(dt, gravity, 0.7f, 0, count);
+        for (size_t i = 0; i < count; i++) narrow.Simulate(dt, gravity, 0.7f, i, i + 1);
+    }
+
+    int mismatches = 0;
+    for (size_t i = 0; i < count; i++)
+        if (!SameParticle(wide, i, narrow, i)) mismatches++;
+    CHECK(mismatches == 0);
+
+    // A range that starts in the middle of a register
+    ParticlePool offset(count);
+    Fill(offset, count);
+    for (int frame = 0; frame < 10; frame++)
+    {
+        const float dt = 0.013f + 0.002f * static_cast<float>(frame);
+        offset.Simulate(dt, gravity, 0.7f, 0, 1);
+        offset.Simulate(dt, gravity, 0.7f, 1, count);
+    }
+    mismatches = 0;
+    for (size_t i = 0; i < count; i++)
+        if (!SameParticle(offset, i, narrow, i)) mismatches++;
+    CHECK(mismatches == 0);
+}
+
+TEST(ParticlePoolRemovesDeadBySwapping)
+{
+    // Lifetimes of 1, 3, 1, 3, 3, 1 seconds, so 3 particles die after 2 seconds
+    ParticlePool pool(6);
+    const float lifetimes[] = {1.0f, 3.0f, 1.0f, 3.0f, 3.0f, 1.0f};
+    for (int i = 0; i < 6; i++) pool.Emit(glm::vec3(static_cast<float>(i), 0.0f, 0.0f), glm::vec3(0.0f), lifetimes[i]);
+    CHECK(pool.IsFull());
+    CHECK(!pool.Emit(glm::vec3(0.0f), glm::vec3(0.0f), 1.0f));
+
+    pool.Simulate(2.0f, glm::vec3(0.0f), 0.0f, 0, pool.GetCount());
+    pool.RemoveDead();
+
+    // 0 is replaced by 5, which is dead too and replaced by 4. 2 is replaced by 3.
+    CHECK(pool.GetCount() == 3);
+    if (pool.GetCount() != 3) return;
+    CHECK(pool.GetPosition(0).x == 4.0f);
+    CHECK(pool.GetPosition(1).x == 1.0f);
+    CHECK(pool.GetPosition(2).x == 3.0f);
+    for (size_t i = 0; i < pool.GetCount(); i++) CHECK_NEAR(pool.GetAge(i), 2.0f / 3.0f, 1e-5f);
+
+    // The free slots can be used again
+    CHECK(pool.Emit(glm::vec3(9.0f), glm::vec3(0.0f), 1.0f));
+    CHECK(pool.GetCount() == 4);
+    CHECK(pool.GetPosition(3).x == 9.0f);
+}
+
+TEST(ParticleSystemKeepsEmissionBudgets)
+{
+    JobSystem jobs(1);
+    ParticleSystem particles;
+    const uint32_t type = particles.AddType(MakeType(100));
+
+    ParticleEmitter emitter;
+    emitter.Type = type;
+    emitter.Rate = 1000.0f;
+    emitter.Intensity = 1.0f;
+    emitter.MaxPerFrame = 10;
+
+    // 16 particles are due, the emitter allows 10 and the rest is dropped
+    particles.Simulate(0.016f, jobs);
+    CHECK(particles.Emit(emitter, glm::vec3(0.0f), 0.016f) == 10);
+    CHECK(particles.GetEmittedCount() == 10);
+    CHECK(emitter.Accumulated < 1.0f);
+
+    // Two emitters share the budget of the frame
+    particles.MaxEmittedPerFrame = 15;
+    ParticleEmitter other = emitter;
+    particles.Simulate(0.016f, jobs);
+    CHECK(particles.GetEmittedCount() == 0);
+    CHECK(particles.Emit(emitter, glm::vec3(0.0f), 0.016f) == 10);
+    CHECK(particles.Emit(other, glm::vec3(0.0f), 0.016f) == 5);
+    CHECK(particles.Emit(emitter, glm::vec3(0.0f), 0.016f) == 0);
+    CHECK(particles.GetEmittedCount() == 15);
+
+    // And the pool, which is not emptied by a short frame
+    particles.MaxEmittedPerFrame = 1000;
+    emitter.MaxPerFrame = 1000;
+    particles.Simulate(0.001f, jobs);
+    CHECK(particles.Emit(emitter, glm::vec3(0.0f), 0.1f) == 75);
+    CHECK(particles.GetPool(type).IsFull());
+    CHECK(particles.GetParticleCount() == 100);
+
+    // Stopped and unknown emitters emit nothing
+    ParticleEmitter stopped = emitter;
+    stopped.Intensity = 0.0f;
+    stopped.Accumulated = 0.0f;
+    ParticleEmitter unknown = emitter;
+    unknown.Type = 5;
+    particles.Simulate(10.0f, jobs);
+    CHECK(particles.GetParticleCount() == 0);
+    CHECK(particles.Emit(stopped, glm::vec3(0.0f), 0.016f) == 0);
+    CHECK(particles.Emit(unknown, glm::vec3(0.0f), 0.016f) == 0);
+}
+
+TEST(ParticleSystemSpreadsEmissionAlongPath)
+{
+    JobSystem jobs(1);
+    ParticleSystem particles;
+    ParticleType type = MakeType(100);
+    type.Gravity = glm::vec3(0.0f);
+    const uint32_t index = particles.AddType(type);
+
+    ParticleEmitter emitter;
+    emitter.Type = index;
+    emitter.Rate = 4.0f;
+    emitter.Intensity = 1.0f;
+    CHECK(particles.Emit(emitter, glm::vec3(0.0f), 0.0f) == 0);
+    CHECK(particles.Emit(emitter, glm::vec3(4.0f, 0.0f, 0.0f), 1.0f) == 4);
+
+    // The newest particle is where the emitter is now
+    const auto& pool = particles.GetPool(index);
+    for (size_t i = 0; i < pool.GetCount(); i++) CHECK_NEAR(pool.GetPosition(i).x, static_cast<float>(i + 1), 1e-5f);
+}
+
+TEST(ParticleSystemSimulatesEveryChunkOnce)
+{
+    // Empty pools between and around full ones, and a pool of several chunks with a partial last one
+    JobSystem jobs(3);
+    ParticleSystem particles;
+    const size_t counts[] = {0, 2 * ParticleSystem::c_simulateBatch + 7, 0, 0, 5, 0};
+    vector<ParticlePool> expected;
+    for (size_t count : counts)
+    {
+        ParticleType type = MakeType(static_cast<uint32_t>(count + 1));
+        type.MinLifetime = type.MaxLifetime = 100.0f;
+        const uint32_t index = particles.AddType(type);
+
+        ParticleEmitter emitter;
+        emitter.Type = index;
+        emitter.Rate = static_cast<float>(count);
+        emitter.Intensity = 1.0f;
+        emitter.MaxPerFrame = static_cast<uint32_t>(count);
+        particles.MaxEmittedPerFrame = static_cast<uint32_t>(count);
+        particles.Simulate(0.0f, jobs);
+        particles.Emit(emitter, glm::vec3(0.0f), 0.0f);
+        particles.Emit(emitter, glm::vec3(1.0f, 2.0f, 3.0f), 1.0f);
+        CHECK(particles.GetPool(index).GetCount() == count);
+
+        // The same particles, moved on this thread
+        expected.push_back(particles.GetPool(index));
+    }
+
+    for (int frame = 0; frame < 3; frame++)
+    {
+        particles.Simulate(0.02f, jobs);
+        for (size_t t = 0; t < expected.size(); t++)
+            expected[t].Simulate(0.02f, particles.GetType(t).Gravity, particles.GetType(t).Drag, 0, expected[t].GetCount());
+    }
+
+    int mismatches = 0;
+    for (size_t t = 0; t < expected.size(); t++)
+    {
+        const auto& pool = particles.GetPool(static_cast<uint32_t>(t));
+        CHECK(pool.GetCount() == expected[t].GetCount());
+        for (size_t i = 0; i < pool.GetCount(); i++)
+            if (!SameParticle(pool, i, expected[t], i)) mismatches++;
+    }
+    CHECK(mismatches == 0);
+}
@@ -0,0 +1,135 @@
+#include <cmath>
+
+#include "rendering/skid_marks.hpp"
+#include "test.hpp"
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+const glm::vec3 c_up(0.0f, 0.0f, 1.0f);
+constexpr float c_width = 0.2f;
+
+void Add(SkidMarkRing& ring, SkidMarkStrip& strip, float x, float y, float intensity = 1.0f)
+{
+    ring.Add(strip, glm::vec3(x, y, 0.0f), c_up, c_width, intensity, 0.0f);
+}
+
+// The center of the start or the end edge of the quad in a slot
+glm::vec3 GetStart(const SkidMarkRing& ring, uint32_t slot)
+{
+    return (ring.GetQuad(slot)[0].Position + ring.GetQuad(slot)[1].Position) * 0.5f;
+}
+
+glm::vec3 GetEnd(const SkidMarkRing& ring, uint32_t slot)
+{
+    return (ring.GetQuad(slot)[2].Position + ring.GetQuad(slot)[3].Position) * 0.5f;
+}
+
+bool Equal(const glm::vec3& a, const glm::vec3& b) { return glm::all(glm::lessThanEqual(glm::abs(a - b), glm::vec3(1e-5f))); }
+
+}  // namespace
+
+TEST(SkidMarkRingStretchesStraightStrips)
+{
+    SkidMarkRing ring(16);
+    SkidMarkStrip strip;
+
+    // The first point only starts the strip, and steps shorter than c_minSegmentLength wait
+    Add(ring, strip, 0.0f, 0.0f);
+    Add(ring, strip, 0.1f, 0.0f);
+    CHECK(ring.GetWrittenCount() == 0);
+    Add(ring, strip, 1.0f, 0.0f);
+    CHECK(ring.GetWrittenCount() == 1);
+
+    // Straight on stretches the quad
+    Add(ring, strip, 2.0f, 0.0f);
+    Add(ring, strip, 3.0f, 0.0f);
+    CHECK(ring.GetWrittenCount() == 1);
+    CHECK(ring.GetMergedCount() == 2);
+    CHECK(Equal(GetStart(ring, 0), glm::vec3(0.0f)));
+    CHECK(Equal(GetEnd(ring, 0), glm::vec3(3.0f, 0.0f, 0.0f)));
+    CHECK_NEAR(glm::length(ring.GetQuad(0)[3].Position - ring.GetQuad(0)[2].Position), c_width, 1e-5f);
+
+    // A bend of more than 2 degrees starts a new quad at the end edge of the last one
+    Add(ring, strip, 3.5f, 0.1f);
+    CHECK(ring.GetWrittenCount() == 2);
+    CHECK(ring.GetQuad(1)[0].Position == ring.GetQuad(0)[2].Position);
+    CHECK(ring.GetQuad(1)[1].Position == ring.GetQuad(0)[3].Position);
+
+    // A bend of 1 degree stretches it
+    const float angle = std::atan2(0.1f, 0.5f) + glm::radians(1.0f);
+    Add(ring, strip, 3.5f + 0.5f * std::cos(angle), 0.1f + 0.5f * std::sin(angle));
+    CHECK(ring.GetWrittenCount() == 2);
+    CHECK(ring.GetMergedCount() == 3);
+
+    // So does a small change in intensity, but not a large one
+    const float slightlyLess = 1.0f - 0.5f * SkidMarkRing::c_mergeIntensity;
+    Add(ring, strip, 3.5f + 1.0f * std::cos(angle), 0.1f + 1.0f * std::sin(angle), slightlyLess);
+    CHECK(ring.GetWrittenCount() == 2);
+    Add(ring, strip, 3.5f + 1.5f * std::cos(angle), 0.1f + 1.5f * std::sin(angle), 0.5f);
+    CHECK(ring.GetWrittenCount() == 3);
+
+    // An intensity of 0 ends the strip, the next point starts over without a quad
+    Add(ring, strip, 6.0f, 1.0f, 0.0f);
+    Add(ring, strip, 7.0f, 1.0f);
+    CHECK(!strip.HasQuad);
+    Add(ring, strip, 8.0f, 1.0f);
+    CHECK(ring.GetWrittenCount() == 4);
+    CHECK(Equal(GetStart(ring, 3), glm::vec3(7.0f, 1.0f, 0.0f)));
+}
+
+TEST(SkidMarkRingLimitsQuadLength)
+{
+    SkidMarkRing ring(16);
+    SkidMarkStrip strip;
+
+    // Steps of 1.5 stretch the first quad to 3, one more would make it longer than c_maxSegmentLength
+    static_assert(SkidMarkRing::c_maxSegmentLength > 3.0f && SkidMarkRing::c_maxSegmentLength < 4.5f);
+    for (int i = 0; i <= 5; i++) Add(ring, strip, 1.5f * static_cast<float>(i), 0.0f);
+
+    CHECK(ring.GetWrittenCount() == 3);
+    CHECK(ring.GetMergedCount() == 2);
+    CHECK(Equal(GetEnd(ring, 0), glm::vec3(3.0f, 0.0f, 0.0f)));
+    CHECK(Equal(GetEnd(ring, 1), glm::vec3(6.0f, 0.0f, 0.0f)));
+    CHECK(Equal(GetEnd(ring, 2), glm::vec3(7.5f, 0.0f, 0.0f)));
+    for (uint32_t slot = 0; slot < ring.GetQuadCount(); slot++)
+        CHECK(glm::length(GetEnd(ring, slot) - GetStart(ring, slot)) <= SkidMarkRing::c_maxSegmentLength);
+}
+
+TEST(SkidMarkRingDoesNotContinueReusedQuads)
+{
+    SkidMarkRing ring(2);
+    SkidMarkStrip first;
+    SkidMarkStrip second;
+
+    Add(ring, first, 0.0f, 0.0f);
+    Add(ring, first, 1.0f, 0.0f);
+    CHECK(first.Quad == 0);
+
+    // Two quads of the other strip, the second one in the slot of the first strip's quad
+    Add(ring, second, 0.0f, 5.0f);
+    Add(ring, second, 0.0f, 6.0f);
+    Add(ring, second, 1.0f, 7.0f);
+    CHECK(ring.GetWrittenCount() == 3);
+    CHECK(ring.GetQuadCount() == 2);
+    CHECK(Equal(GetEnd(ring, 0), glm::vec3(1.0f, 7.0f, 0.0f)));
+
+    // Straight on would stretch the first strip's quad, but its slot now belongs to the other strip
+    Add(ring, first, 2.0f, 0.0f);
+    CHECK(ring.GetMergedCount() == 0);
+    CHECK(ring.GetWrittenCount() == 4);
+    CHECK(first.Quad == 3);
+    CHECK(Equal(GetEnd(ring, 0), glm::vec3(1.0f, 7.0f, 0.0f)));
+
+    // The new quad starts where the strip ended, not at the edge that is in the reused slot
+    CHECK(Equal(GetStart(ring, 1), glm::vec3(1.0f, 0.0f, 0.0f)));
+    CHECK(Equal(GetEnd(ring, 1), glm::vec3(2.0f, 0.0f, 0.0f)));
+
+    // Every slot is reported once, however often it was written
+    CHECK(ring.GetChangedSlots().size() == 2);
+    ring.ClearChanges();
+    CHECK(ring.GetChangedSlots().empty());
+}
@@ -0,0 +1,135 @@
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "rendering/static_batch.hpp"
+#include "test.hpp"
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+// A unit triangle in the XY plane facing +Z, with a normal per vertex
+MeshData MakeTriangle()
+{
+    MeshData mesh;
+    mesh.Positions = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+    mesh.Normals = {{0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}};
+    mesh.Indices = {0, 1, 2};
+    return mesh;
+}
+
+StaticBatchSource MakeSource(const MeshData& mesh, const glm::vec3& position, uint32_t material)
+{
+    StaticBatchSource source;
+    source.Mesh = &mesh;
+    source.World = glm::translate(glm::mat4(1.0f), position);
+    source.Material = material;
+    return source;
+}
+
+bool Equal(const glm::vec3& a, const glm::vec3& b) { return glm::all(glm::lessThanEqual(glm::abs(a - b), glm::vec3(1e-5f))); }
+
+}  // namespace
+
+TEST(StaticBatchTransformsToWorldSpace)
+{
+    const MeshData triangle = MakeTriangle();
+    StaticBatchSource source = MakeSource(triangle, glm::vec3(10.0f, 0.0f, 0.0f), 0);
+    source.World = glm::rotate(source.World, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    const auto batches = BuildStaticBatches({source}, 100.0f);
+    CHECK(batches.size() == 1);
+    if (batches.size() != 1) return;
+    const auto& data = batches[0].Data;
+
+    // A quarter turn around Y takes +X to -Z and +Z to +X
+    CHECK(data.Positions.size() == 3);
+    CHECK(Equal(data.Positions[0], glm::vec3(10.0f, 0.0f, 0.0f)));
+    CHECK(Equal(data.Positions[1], glm::vec3(10.0f, 0.0f, -1.0f)));
+    CHECK(Equal(data.Positions[2], glm::vec3(10.0f, 1.0f, 0.0f)));
+    CHECK(data.Normals.size() == 3);
+    for (const auto& normal : data.Normals) CHECK(Equal(normal, glm::vec3(1.0f, 0.0f, 0.0f)));
+    CHECK((data.Indices == vector<uint32_t>{0, 1, 2}));
+    CHECK(Equal(batches[0].Min, glm::vec3(10.0f, 0.0f, -1.0f)));
+    CHECK(Equal(batches[0].Max, glm::vec3(10.0f, 1.0f, 0.0f)));
+}
+
+TEST(StaticBatchKeepsMirroredFacesFrontFacing)
+{
+    const MeshData triangle = MakeTriangle();
+    StaticBatchSource source = MakeSource(triangle, glm::vec3(0.0f), 0);
+    source.World = glm::scale(source.World, glm::vec3(-1.0f, 1.0f, 1.0f));
+
+    const auto batches = BuildStaticBatches({source}, 100.0f);
+    CHECK(batches.size() == 1);
+    if (batches.size() != 1) return;
+    const auto& data = batches[0].Data;
+
+    // The triangle still winds counterclockwise seen from the side its normal points to
+    CHECK((data.Indices == vector<uint32_t>{0, 2, 1}));
+    const glm::vec3 face = glm::cross(data.Positions[data.Indices[1]] - data.Positions[data.Indices[0]],
+                                      data.Positions[data.Indices[2]] - data.Positions[data.Indices[0]]);
+    CHECK(glm::dot(face, data.Normals[0]) > 0.0f);
+}
+
+TEST(StaticBatchGroupsByMaterial)
+{
+    const MeshData triangle = MakeTriangle();
+    MeshData colored = MakeTriangle();
+    colored.Colors = {{1.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}};
+
+    const vector<StaticBatchSource> sources = {MakeSource(triangle, glm::vec3(1.0f, 0.0f, 0.0f), 7),
+                                               MakeSource(triangle, glm::vec3(2.0f, 0.0f, 0.0f), 3),
+                                               MakeSource(colored, glm::vec3(3.0f, 0.0f, 0.0f), 7)};
+    const auto batches = BuildStaticBatches(sources, 100.0f);
+
+    // Sorted by material, with the sources of a material in their original order
+    CHECK(batches.size() == 2);
+    if (batches.size() != 2) return;
+    CHECK(batches[0].Material == 3);
+    CHECK(batches[0].SourceCount == 1);
+    CHECK(batches[1].Material == 7);
+    CHECK(batches[1].SourceCount == 2);
+
+    // The second source of a batch indexes its own vertices
+    const auto& data = batches[1].Data;
+    CHECK(data.Positions.size() == 6);
+    CHECK((data.Indices == vector<uint32_t>{0, 1, 2, 3, 4, 5}));
+    CHECK(Equal(data.Positions[0], glm::vec3(1.0f, 0.0f, 0.0f)));
+    CHECK(Equal(data.Positions[3], glm::vec3(3.0f, 0.0f, 0.0f)));
+
+    // Only one source has colors, the other one gets white
+    CHECK(data.Colors.size() == 6);
+    CHECK(Equal(data.Colors[0], glm::vec3(1.0f)));
+    CHECK(Equal(data.Colors[3], glm::vec3(1.0f, 0.0f, 0.0f)));
+    CHECK(batches[0].Data.Colors.empty());
+}
+
+TEST(StaticBatchAssignsChunksByCenter)
+{
+    const MeshData triangle = MakeTriangle();
+    MeshData empty;
+    StaticBatchSource missing;
+
+    // The last triangle starts in chunk 0 but its center is in chunk 1
+    const vector<StaticBatchSource> sources = {MakeSource(triangle, glm::vec3(5.0f, 0.0f, 0.0f), 0),
+                                               MakeSource(triangle, glm::vec3(-5.0f, 0.0f, 0.0f), 0),
+                                               MakeSource(triangle, glm::vec3(15.0f, 0.0f, 25.0f), 0),
+                                               MakeSource(empty, glm::vec3(0.0f), 0),
+                                               missing,
+                                               MakeSource(triangle, glm::vec3(9.8f, 0.0f, 0.0f), 0)};
+    const auto batches = BuildStaticBatches(sources, 10.0f);
+
+    CHECK(batches.size() == 4);
+    if (batches.size() != 4) return;
+    CHECK(batches[0].Chunk == glm::ivec3(-1, 0, 0));
+    CHECK(batches[1].Chunk == glm::ivec3(0, 0, 0));
+    CHECK(batches[2].Chunk == glm::ivec3(1, 0, 0));
+    CHECK(batches[3].Chunk == glm::ivec3(1, 0, 2));
+    for (const auto& batch : batches) CHECK(batch.SourceCount == 1);
+
+    // Triangles are not split, so the batch reaches back into chunk 0
+    CHECK(batches[2].Min.x < 10.0f);
+    CHECK(Equal(batches[2].Min, glm::vec3(9.8f, 0.0f, 0.0f)));
+}
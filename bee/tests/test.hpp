@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+namespace bee::tests
+{
+
+/// <summary>
+/// A test case, registered by TEST() before main() runs.
+/// </summary>
+struct Test
+{
+    const char* Name = nullptr;
+    void (*Function)() = nullptr;
+};
+
+std::vector<Test>& GetTests();
+
+struct Registrar
+{
+    Registrar(const char* name, void (*function)()) { GetTests().push_back({name, function}); }
+};
+
+/// <summary>
+/// Reports a failed check of the test that is running. The test continues, so that one run shows every failure.
+/// </summary>
+void Fail(const char* file, int line, const char* expression);
+
+}  // namespace bee::tests
+
+#define TEST(name)                                                    \
+    static void name();                                               \
+    static const bee::tests::Registrar name##Registrar(#name, &name); \
+    static void name()
+
+#define CHECK(expression)                                                     \
+    do                                                                        \
+    {                                                                         \
+        if (!(expression)) bee::tests::Fail(__FILE__, __LINE__, #expression); \
+    } while (false)
+
+#define CHECK_NEAR(a, b, tolerance) CHECK(std::abs((a) - (b)) <= (tolerance))
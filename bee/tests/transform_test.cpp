@@ -0,0 +1,69 @@
+#include <entt/entity/registry.hpp>
+#include <string>
+
+#include "core/transform.hpp"
+#include "test.hpp"
+
+using namespace bee;
+using namespace std;
+
+namespace
+{
+
+// The Transform as it was before names moved into their own component, with the members in their old order
+struct OldTransform
+{
+    std::string Name = {};
+    glm::vec3 m_translation = glm::vec3(0.0f, 0.0f, 0.0f);
+    glm::vec3 m_scale = glm::vec3(1.0f, 1.0f, 1.0f);
+    glm::quat m_rotation = glm::identity<glm::quat>();
+    glm::mat4 m_worldMatrix = glm::identity<glm::mat4>();
+    bool m_worldMatrixDirty = true;
+    Entity m_parent{entt::null};
+    Entity m_first{entt::null};
+    Entity m_next{entt::null};
+};
+
+constexpr int c_poolSize = 100000;
+
+glm::vec3 Translation(int i) { return glm::vec3(static_cast<float>(i % 1000), 1.0f, -static_cast<float>(i % 7)); }
+
+}  // namespace
+
+TEST(TransformIsSmallerThanOldLayout)
+{
+    CHECK(sizeof(Transform) <= 128);
+    CHECK(alignof(Transform) == 16);
+    CHECK(sizeof(Transform) < sizeof(OldTransform));
+}
+
+TEST(TransformPoolIteratesLikeOldLayout)
+{
+    entt::registry registry;
+    for (int i = 0; i < c_poolSize; i++)
+    {
+        registry.emplace<Transform>(registry.create(), Translation(i), glm::vec3(1.0f), glm::identity<glm::quat>());
+        OldTransform old;
+        old.m_translation = Translation(i);
+        registry.emplace<OldTransform>(registry.create(), old);
+    }
+
+    // Both pools hold the same translations, so walking them must give the same sum
+    glm::vec3 sum(0.0f), oldSum(0.0f);
+    int count = 0;
+    for (const auto& [entity, transform] : registry.view<const Transform>().each())
+    {
+        sum += transform.GetTranslation();
+        count++;
+    }
+    for (const auto& [entity, transform] : registry.view<const OldTransform>().each()) oldSum += transform.m_translation;
+
+    CHECK(count == c_poolSize);
+    CHECK(sum == oldSum);
+
+    // A pass over the pool touches fewer bytes, since entt stores the components back to back
+    const auto& storage = registry.storage<Transform>();
+    const auto& oldStorage = registry.storage<OldTransform>();
+    CHECK(storage.size() == oldStorage.size());
+    CHECK(storage.size() * sizeof(Transform) < oldStorage.size() * sizeof(OldTransform));
+}
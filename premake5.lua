@@ -1,6 +1,6 @@
 workspace "redline"
     architecture "x86_64"
-    configurations { "Debug", "Release" }
+    configurations { "Debug", "Release", "Headless" }
     startproject "redline"
     language "C++"
     cppdialect "C++17"
@@ -17,7 +17,7 @@ workspace "redline"
         symbols "On"
         defines { "_DEBUG", "DEBUG" }
 
-    filter "configurations:Release"
+    filter "configurations:Release or Headless"
         runtime "Release"
         symbols "On"
         optimize "Full"
@@ -76,6 +76,7 @@ project "bee"
         "bee/source/tools/**.cpp",
         "bee/source/platform/pc/**.cpp",
         "bee/source/platform/opengl/**.cpp",
+        "bee/source/platform/null/**.cpp",
         "bee/include/**.hpp",
         "bee/include/**.h",
         "bee/external/clipper/src/**.cpp",
@@ -91,6 +92,9 @@ project "bee"
         defines { "BEE_DEBUG", "BEE_INSPECTOR" }
     filter "configurations:Release"
         defines { "BEE_INSPECTOR" }
+    -- Renders with the null graphics backend, without a window or the inspector, to measure the CPU side of rendering
+    filter "configurations:Headless"
+        defines { "BEE_GRAPHICS_NULL" }
     filter {}
 
 project "redline"
@@ -149,13 +153,91 @@ project "redline"
             '{COPYFILE} "%{wks.location}bee/external/fmod/lib/fmodstudioL.dll" "%{cfg.targetdir}"',
         }
 
+    filter "configurations:Release or Headless"
+        links { "glfw3", "fmod/lib/fmodstudio_vc", "fmod/lib/fmod_vc", "Superluminal/PerformanceAPI_MD" }
+        postbuildcommands
+        {
+            '{COPYFILE} "%{wks.location}bee/external/fmod/lib/fmod.dll" "%{cfg.targetdir}"',
+            '{COPYFILE} "%{wks.location}bee/external/fmod/lib/fmodstudio.dll" "%{cfg.targetdir}"',
+        }
     filter "configurations:Release"
         defines { "BEE_INSPECTOR" }
+    filter "configurations:Headless"
+        defines { "BEE_GRAPHICS_NULL" }
+
+    filter {}
+
+-- Unit tests of the parts of bee that do not need a window or a graphics context. Runs them after every build, so a
+-- failing test fails the build.
+project "tests"
+    kind "ConsoleApp"
+    location "bee/tests"
+    targetdir "bee/tests/executable/x64/%{cfg.buildcfg}"
+    objdir "bee/tests/intermediate/x64/%{cfg.buildcfg}"
+    debugdir "bee/tests"
+    dependson { "bee", "Jolt" }
+
+    includedirs
+    {
+        "bee/include",
+        "bee/external",
+        "bee/external/fmt/include",
+        "bee/external/csv_parser/include",
+        "bee/external/clipper/include",
+        "bee/external/Jolt",
+        "bee/external/glad/include",
+    }
+
+    defines
+    {
+        "BEE_PROFILE", "BEE_JOLT_PHYSICS", "BEE_PLATFORM_PC",
+        "BEE_GRAPHICS_OPENGL", "GLM_FORCE_SILENT_WARNINGS", "_UNICODE", "UNICODE",
+    }
+
+    files
+    {
+        "bee/tests/**.cpp",
+        "bee/tests/**.hpp",
+    }
+
+    libdirs
+    {
+        "bee/lib/x64/%{cfg.buildcfg}",
+        "bee/external/Jolt/lib/x64/%{cfg.buildcfg}",
+        "bee/external",
+        "bee/external/GLFW",
+    }
+
+    links { "bee", "Jolt", "opengl32" }
+
+    postbuildcommands
+    {
+        '{COPYFILE} "%{wks.location}bee/external/Superluminal/PerformanceAPI.dll" "%{cfg.targetdir}"',
+    }
+
+    filter "configurations:Debug"
+        defines { "BEE_DEBUG", "BEE_INSPECTOR" }
+        links { "glfw3", "fmod/lib/fmodstudioL_vc", "fmod/lib/fmodL_vc", "Superluminal/PerformanceAPI_MDd" }
+        ignoredefaultlibraries { "MSVCRT" }
+        postbuildcommands
+        {
+            '{COPYFILE} "%{wks.location}bee/external/fmod/lib/fmodL.dll" "%{cfg.targetdir}"',
+            '{COPYFILE} "%{wks.location}bee/external/fmod/lib/fmodstudioL.dll" "%{cfg.targetdir}"',
+        }
+
+    filter "configurations:Release or Headless"
         links { "glfw3", "fmod/lib/fmodstudio_vc", "fmod/lib/fmod_vc", "Superluminal/PerformanceAPI_MD" }
         postbuildcommands
         {
             '{COPYFILE} "%{wks.location}bee/external/fmod/lib/fmod.dll" "%{cfg.targetdir}"',
             '{COPYFILE} "%{wks.location}bee/external/fmod/lib/fmodstudio.dll" "%{cfg.targetdir}"',
         }
+    filter "configurations:Release"
+        defines { "BEE_INSPECTOR" }
+    filter "configurations:Headless"
+        defines { "BEE_GRAPHICS_NULL" }
+
+    filter {}
 
-    filter {}
\ No newline at end of file
+    -- Post-build commands run in the project location, which is also where the tests find their data
+    postbuildcommands { '"%{cfg.buildtarget.abspath}"' }
@@ -13,8 +13,12 @@ struct Chassis
     float C_drag        = 0.38f;
     
     // ── Runtime state (updated every frame) ──────────────────
+    bool initialized    = false;      // position is taken from the Transform on the first tick
+    float3 position     = {0, 0, 0};  // m ─ simulated, the transform is interpolated towards it
     float3 velocity     = {0, 0, 0};  // m/s
     float3 direction    = {0, 0, 0};  // unit vector, Y-forward in bee
+    float3 previousPosition  = {0, 0, 0};  // at the previous tick
+    float3 previousDirection = {0, 0, 0};  // at the previous tick
     float accelLong     = 0.0f;             // m/s^2
     float W_front       = 0.0f;             // N
     float W_rear        = 0.0f;             // N
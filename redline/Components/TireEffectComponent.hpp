@@ -0,0 +1,19 @@
+#pragma once
+#include "core/ecs.hpp"
+
+// One kind of particles that a tire throws up, on an entity of its own next to the bee::ParticleEmitter, since an entity
+// holds a single emitter, or next to the bee::SkidMarkEmitter for Marks. Parented to the car rather than the wheel, so the
+// emitter stays at the contact patch while the wheel spins.
+struct TireEffect
+{
+    enum Kind
+    {
+        Smoke,   // from slip, on any surface
+        Sparks,  // from scraping over curbs
+        Dust,    // from driving on gravel
+        Marks    // skid marks from locked or slipping tires, on the road rather than emitted as particles
+    };
+
+    bee::Entity wheel = entt::null;  // with WheelVisual
+    Kind kind         = Smoke;
+};
@@ -1,10 +1,19 @@
 #pragma once
 #include "core/ecs.hpp"
 
+// What the ground under a tire is made of, decides which particles it throws up
+enum class Surface
+{
+    Asphalt,
+    Curb,
+    Gravel
+};
+
 struct WheelVisual
 {
     bee::Entity car  = entt::null;
     bool isFront     = false;
     bool mirror      = false;
     float spinAngle  = 0.0f;  // accumulated rad
+    Surface surface  = Surface::Asphalt;  // the floor is all asphalt, nothing detects curbs or gravel yet
 };
@@ -11,13 +11,25 @@
 
 ChassisSystem::ChassisSystem()
 {
+    Writes<bee::Transform, Chassis, Wheel>();
+    Reads<DriveInput>();
 }
 
-void ChassisSystem::Update(const float dt)
+void ChassisSystem::FixedUpdate(const float dt)
 {
-    bee::Engine.ECS().Registry.view<bee::Transform, Chassis, Wheel, const DriveInput>().each(
-        [&](bee::Transform& transform, Chassis& chassis, Wheel& wheel, const DriveInput& drive)
+    View<const bee::Transform, Chassis, Wheel, const DriveInput>().each(
+        [&](const bee::Transform& transform, Chassis& chassis, Wheel& wheel, const DriveInput& drive)
         {
+            // Start where the car was placed
+            if (!chassis.initialized)
+            {
+                chassis.position = transform.GetTranslation();
+                chassis.initialized = true;
+            }
+
+            chassis.previousPosition = chassis.position;
+            chassis.previousDirection = chassis.direction;
+
             const float speed = glm::length(chassis.velocity);
             
             // ── Weight transfer ───────────────────────────────────
@@ -52,11 +64,33 @@ void ChassisSystem::Update(const float dt)
                 wheel.angularVelocity *= blend;
             }
             
-            transform.SetTranslation(transform.GetTranslation() + chassis.velocity * dt);
+            chassis.position += chassis.velocity * dt;
+        }
+    );
+}
+
+void ChassisSystem::Update(const float)
+{
+    // Smoothly interpolate the transform between the last two ticks
+    const float alpha = bee::Engine.GetFixedAlpha();
+    View<bee::Transform, const Chassis>().each(
+        [&](bee::Transform& transform, const Chassis& chassis)
+        {
+            // Stays where it was placed until the first tick
+            if (!chassis.initialized) return;
+
+            transform.SetTranslation(glm::mix(chassis.previousPosition, chassis.position, alpha));
+
+            const float3 direction = glm::mix(chassis.previousDirection, chassis.direction, alpha);
+            if (glm::dot(direction, direction) < 0.0001f) return;
+            const float angle = -glm::atan(direction.x, direction.y);
+            transform.SetRotation(glm::angleAxis(angle, glm::vec3(0.0f, 0.0f, 1.0f)));
         }
     );
 }
 
+#ifdef BEE_INSPECTOR
+
 void ChassisSystem::OnPanel()
 {
     bee::Engine.ECS().Registry.view<const Chassis>().each([](const Chassis& chassis)
@@ -71,3 +105,5 @@ void ChassisSystem::OnPanel()
         ImGui::Text("Dir        (%.2f, %.2f, %.2f)", chassis.direction.x, chassis.direction.y, chassis.direction.z);
     });
 }
+
+#endif
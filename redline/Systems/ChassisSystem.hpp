@@ -10,9 +10,12 @@ class ChassisSystem : public bee::System, public bee::IPanel
 public:
     ChassisSystem();
     ~ChassisSystem() override = default;
+    void FixedUpdate(float dt) override;
     void Update(float dt) override;
     
+#ifdef BEE_INSPECTOR
     void OnPanel() override;
     [[nodiscard]] std::string GetName() const override { return "Chassis System"; }
     [[nodiscard]] std::string GetIcon() const override { return ICON_FA_CAR; }
+#endif
 };
@@ -10,9 +10,15 @@
 #include "core/engine.hpp"
 #include "tools/log.hpp"
 
-void EngineSystem::Update(const float)
+EngineSystem::EngineSystem()
 {
-    bee::Engine.ECS().Registry.view<Engine, const Gearbox, const Wheel, const DriveInput>().each(
+    Writes<Engine>();
+    Reads<Gearbox, Wheel, DriveInput>();
+}
+
+void EngineSystem::FixedUpdate(const float)
+{
+    View<Engine, const Gearbox, const Wheel, const DriveInput>().each(
         [&](Engine& engine, const Gearbox& gearbox, const Wheel& wheel, const DriveInput& drive)
         {
             const float gearRatio = gearbox.GetRatio(gearbox.activeGear);
@@ -22,8 +28,8 @@ void EngineSystem::Update(const float)
                 ? glm::abs(wheel.angularVelocity) * glm::abs(gearRatio) * gearbox.diffRatio * 60.0f / glm::two_pi<float>()
                 : 0.0f;
             
-            bee::Log::Info("EngineSystem::Update eng vel: {}", wheel.angularVelocity);
-            bee::Log::Info("EngineSystem::Update RPM: {}", RPM);
+            bee::Log::Info("EngineSystem::FixedUpdate eng vel: {}", wheel.angularVelocity);
+            bee::Log::Info("EngineSystem::FixedUpdate RPM: {}", RPM);
             
             engine.currentRPM = glm::clamp(
                 RPM,
@@ -31,7 +37,7 @@ void EngineSystem::Update(const float)
                 engine.torqueCurve.GetMaxT()
             );
             
-            bee::Log::Info("EngineSystem::Update currentRPM: {}", engine.currentRPM);
+            bee::Log::Info("EngineSystem::FixedUpdate currentRPM: {}", engine.currentRPM);
             
             engine.driveTorque = 0.0f;                                   // rev limiter
             if (drive.throttle > 0.0f && glm::abs(gearRatio) > 0.001f && RPM <= engine.torqueCurve.GetMaxT())
@@ -47,6 +53,8 @@ void EngineSystem::Update(const float)
     );
 }
 
+#ifdef BEE_INSPECTOR
+
 void EngineSystem::OnPanel()
 {
     bee::Engine.ECS().Registry.view<const Engine>().each([](const Engine& engine)
@@ -59,3 +67,5 @@ void EngineSystem::OnPanel()
         ImGui::Text("Brake Trq  %.1f Nm", engine.engineBrakingTorque);
     });
 }
+
+#endif
@@ -8,11 +8,13 @@
 class EngineSystem : public bee::System, public bee::IPanel
 {
 public:
-    EngineSystem() = default;
+    EngineSystem();
     ~EngineSystem() override = default;
-    void Update(float dt) override;
+    void FixedUpdate(float dt) override;
     
+#ifdef BEE_INSPECTOR
     void OnPanel() override;
     [[nodiscard]] std::string GetName() const override { return "Engine System"; }
     [[nodiscard]] std::string GetIcon() const override { return ICON_FA_BOLT; }
+#endif
 };
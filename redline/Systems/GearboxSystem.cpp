@@ -11,10 +11,15 @@
 #include "core/engine.hpp"
 #include "tools/log.hpp"
 
-void GearboxSystem::Update(const float)
+GearboxSystem::GearboxSystem()
 {
-    bee::Engine.ECS().Registry
-        .view<Gearbox, Wheel, const Engine, const Chassis, const DriveInput>()
+    Writes<Gearbox, Wheel>();
+    Reads<Engine, Chassis, DriveInput>();
+}
+
+void GearboxSystem::FixedUpdate(const float)
+{
+    View<Gearbox, Wheel, const Engine, const Chassis, const DriveInput>()
         .each([&](Gearbox& gearbox, Wheel& wheel, const Engine& engine, const Chassis& chassis, const DriveInput& drive)
         {
             const float vLong = glm::dot(chassis.velocity, chassis.direction);
@@ -42,6 +47,8 @@ void GearboxSystem::Update(const float)
         });
 }
 
+#ifdef BEE_INSPECTOR
+
 void GearboxSystem::OnPanel()
 {
     bee::Engine.ECS().Registry.view<const Gearbox>().each([](const Gearbox& gearbox)
@@ -57,3 +64,5 @@ void GearboxSystem::OnPanel()
         ImGui::Text("Efficiency %.0f%%", gearbox.efficiency * 100.0f);
     });
 }
+
+#endif
@@ -8,11 +8,13 @@
 class GearboxSystem : public bee::System, public bee::IPanel
 {
 public:
-    GearboxSystem() = default;
+    GearboxSystem();
     ~GearboxSystem() override = default;
-    void Update(float dt) override;
+    void FixedUpdate(float dt) override;
     
+#ifdef BEE_INSPECTOR
     void OnPanel() override;
     [[nodiscard]] std::string GetName() const override { return "Gearbox System"; }
     [[nodiscard]] std::string GetIcon() const override { return ICON_FA_COG; }
+#endif
 };
@@ -6,7 +6,12 @@
 #include "core/engine.hpp"
 #include "core/input.hpp"
 
-void InputSystem::Update(const float)
+InputSystem::InputSystem()
+{
+    Writes<DriveInput>();
+}
+
+void InputSystem::FixedUpdate(const float)
 {
     const auto& input = bee::Engine.Input();
     
@@ -16,8 +21,7 @@ void InputSystem::Update(const float)
     const float steerRight = input.GetKeyboardKey(bee::Input::KeyboardKey::D);
     const float handbrake = input.GetKeyboardKey(bee::Input::KeyboardKey::Space);
     
-    bee::Engine.ECS().Registry
-        .view<DriveInput>()
+    View<DriveInput>()
         .each([&](DriveInput& drive)
         {
             drive.throttle = accel;
@@ -27,6 +31,8 @@ void InputSystem::Update(const float)
         });
 }
 
+#ifdef BEE_INSPECTOR
+
 void InputSystem::OnPanel()
 {
     bee::Engine.ECS().Registry.view<const DriveInput>().each([](const DriveInput& drive)
@@ -38,3 +44,5 @@ void InputSystem::OnPanel()
         ImGui::Text("Steer      %.2f", drive.steer);
     });
 }
+
+#endif
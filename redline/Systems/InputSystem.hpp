@@ -8,11 +8,13 @@
 class InputSystem : public bee::System, public bee::IPanel
 {
 public:
-    InputSystem() = default;
+    InputSystem();
     ~InputSystem() override = default;
-    void Update(float dt) override;
+    void FixedUpdate(float dt) override;
     
+#ifdef BEE_INSPECTOR
     void OnPanel() override;
     [[nodiscard]] std::string GetName() const override { return "Input System"; }
     [[nodiscard]] std::string GetIcon() const override { return ICON_FA_GAMEPAD; }
+#endif
 };
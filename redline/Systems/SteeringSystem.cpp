@@ -10,10 +10,16 @@
 #include "core/engine.hpp"
 #include "core/transform.hpp"
 
-void SteeringSystem::Update(const float dt)
+SteeringSystem::SteeringSystem()
 {
-    bee::Engine.ECS().Registry.view<bee::Transform, Steering, Chassis, const DriveInput>()
-        .each([&](bee::Transform& transform, Steering& steering, Chassis& chassis, const DriveInput& drive)
+    Writes<Steering, Chassis>();
+    Reads<DriveInput>();
+}
+
+void SteeringSystem::FixedUpdate(const float dt)
+{
+    View<Steering, Chassis, const DriveInput>()
+        .each([&](Steering& steering, Chassis& chassis, const DriveInput& drive)
         {
             const float targetAngle = steering.maxAngleRad * -drive.steer;
             const float slewRate   = steering.maxAngleRad / 0.5f;  // full lock in 0.5 s
@@ -35,12 +41,12 @@ void SteeringSystem::Update(const float dt)
             chassis.direction = glm::normalize(rot * chassis.direction);
 
             chassis.velocity = chassis.direction * speed;
-            const float angle = -glm::atan(chassis.direction.x, chassis.direction.y);
-            transform.SetRotation(glm::toQuat(glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.0f, 0.0f, 1.0f))));
         }
     );
 }
 
+#ifdef BEE_INSPECTOR
+
 void SteeringSystem::OnPanel()
 {
     bee::Engine.ECS().Registry.view<const Steering>().each([](const Steering& steering)
@@ -51,3 +57,5 @@ void SteeringSystem::OnPanel()
         ImGui::Text("Yaw Rate   %.3f rad/s", steering.yawRate);
     });
 }
+
+#endif
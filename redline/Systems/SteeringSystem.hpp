@@ -8,11 +8,13 @@
 class SteeringSystem : public bee::System, public bee::IPanel
 {
 public:
-    SteeringSystem() = default;
+    SteeringSystem();
     ~SteeringSystem() override = default;
-    void Update(float dt) override;
+    void FixedUpdate(float dt) override;
     
+#ifdef BEE_INSPECTOR
     void OnPanel() override;
     [[nodiscard]] std::string GetName() const override { return "Steering System"; }
     [[nodiscard]] std::string GetIcon() const override { return ICON_FA_COMPASS; }
+#endif
 };
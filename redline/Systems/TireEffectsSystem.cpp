@@ -0,0 +1,217 @@
+#include "TireEffectsSystem.hpp"
+
+#include <imgui/imgui.h>
+#include <glm/glm.hpp>
+
+#include "../Components/ChassisComponent.hpp"
+#include "../Components/TireEffectComponent.hpp"
+#include "../Components/WheelComponent.hpp"
+#include "../Components/WheelVisualComponent.hpp"
+#include "core/engine.hpp"
+#include "core/name.hpp"
+#include "core/transform.hpp"
+#include "rendering/particles.hpp"
+#include "rendering/skid_marks.hpp"
+
+namespace
+{
+constexpr float c_contactHeight = 0.05f;     // m ─ emitters sit just above the ground, the car's origin is on it
+constexpr float c_smokeSlip = 0.15f;         // |slip ratio| where smoke starts
+constexpr float c_fullSmokeSlip = 0.6f;      // |slip ratio| of full smoke
+constexpr float c_fullSmokeSliding = 8.0f;   // m/s ─ sliding speed of the tread over the ground for full smoke
+constexpr float c_minScrapeSpeed = 3.0f;     // m/s ─ slower than this, curbs do not spark
+constexpr float c_fullEffectSpeed = 25.0f;   // m/s ─ sparks and dust are at full intensity from this speed
+constexpr float c_markHeight = 0.01f;        // m ─ skid marks are laid on the ground, the renderer offsets their depth
+constexpr float c_markSlip = 0.1f;           // |slip ratio| where skid marks start
+constexpr float c_fullMarkSlip = 0.5f;       // |slip ratio| of the darkest skid marks
+constexpr float c_fullMarkSliding = 4.0f;    // m/s ─ sliding speed of the tread over the ground for the darkest marks
+constexpr float c_maxMarkIntensity = 0.8f;   // even the darkest marks let some of the road through
+}
+
+TireEffectsSystem::TireEffectsSystem()
+{
+    Writes<bee::ParticleEmitter, bee::SkidMarkEmitter>();
+    Reads<TireEffect, WheelVisual, Wheel, Chassis>();
+
+    auto& ecs = bee::Engine.ECS();
+    const auto existing = ecs.GetSystems<bee::ParticleSystem>();
+    particles = existing.empty() ? &ecs.CreateSystem<bee::ParticleSystem>() : existing.front();
+    const auto existingMarks = ecs.GetSystems<bee::SkidMarkSystem>();
+    skidMarks = existingMarks.empty() ? &ecs.CreateSystem<bee::SkidMarkSystem>() : existingMarks.front();
+
+    // Budgets are sized for 20 cars drifting at once: 80 wheels at the full smoke rate stay under MaxParticles
+    bee::ParticleType smoke;
+    smoke.Name         = "Tire Smoke";
+    smoke.MinLifetime  = 1.5f;
+    smoke.MaxLifetime  = 3.0f;
+    smoke.StartSize    = 0.3f;
+    smoke.EndSize      = 2.0f;
+    smoke.StartColor   = {0.85f, 0.85f, 0.85f, 0.5f};
+    smoke.EndColor     = {0.9f, 0.9f, 0.9f, 0.0f};
+    smoke.Gravity      = {0.0f, 0.0f, 0.4f};  // warm smoke rises
+    smoke.Drag         = 1.5f;
+    smoke.Spread       = 0.6f;
+    smoke.AlphaBlended = true;
+    smoke.MaxParticles = 20000;
+    smokeType = particles->AddType(smoke);
+
+    bee::ParticleType sparks;
+    sparks.Name         = "Curb Sparks";
+    sparks.MinLifetime  = 0.2f;
+    sparks.MaxLifetime  = 0.5f;
+    sparks.StartSize    = 0.03f;
+    sparks.EndSize      = 0.01f;
+    sparks.StartColor   = {1.0f, 0.75f, 0.35f, 1.0f};
+    sparks.EndColor     = {1.0f, 0.3f, 0.05f, 0.0f};
+    sparks.Gravity      = {0.0f, 0.0f, -9.8f};
+    sparks.Drag         = 0.3f;
+    sparks.Spread       = 2.5f;
+    sparks.MaxParticles = 8192;
+    sparksType = particles->AddType(sparks);
+
+    bee::ParticleType dust;
+    dust.Name         = "Gravel Dust";
+    dust.MinLifetime  = 1.0f;
+    dust.MaxLifetime  = 2.0f;
+    dust.StartSize    = 0.2f;
+    dust.EndSize      = 1.2f;
+    dust.StartColor   = {0.55f, 0.47f, 0.36f, 0.6f};
+    dust.EndColor     = {0.6f, 0.52f, 0.4f, 0.0f};
+    dust.Gravity      = {0.0f, 0.0f, -0.5f};
+    dust.Drag         = 2.0f;
+    dust.Spread       = 1.0f;
+    dust.AlphaBlended = true;
+    dust.MaxParticles = 16384;
+    dustType = particles->AddType(dust);
+
+    std::vector<bee::Entity> wheels;
+    for (const auto entity : bee::Engine.ECS().Registry.view<WheelVisual>()) wheels.push_back(entity);
+    for (const auto wheel : wheels) CreateEmitters(wheel);
+}
+
+void TireEffectsSystem::CreateEmitters(const bee::Entity wheel)
+{
+    auto& ecs = bee::Engine.ECS();
+    const auto& visual = ecs.Registry.get<WheelVisual>(wheel);
+    const float3 position = ecs.Registry.get<bee::Transform>(wheel).GetTranslation();
+
+    const auto create = [&](TireEffect::Kind kind, uint32_t type, float rate, const std::string& name)
+    {
+        const auto entity = ecs.CreateEntity();
+        auto& transform = ecs.CreateComponent<bee::Transform>(entity);
+        ecs.CreateComponent<bee::Name>(entity, name);
+        transform.SetTranslation({position.x, position.y, c_contactHeight});
+        transform.SetParent(visual.car);
+
+        auto& emitter = ecs.CreateComponent<bee::ParticleEmitter>(entity);
+        emitter.Type = type;
+        emitter.Rate = rate;
+        emitter.MaxPerFrame = 16;
+
+        auto& effect = ecs.CreateComponent<TireEffect>(entity);
+        effect.wheel = wheel;
+        effect.kind = kind;
+    };
+    create(TireEffect::Smoke, smokeType, 60.0f, "TireSmoke");
+    create(TireEffect::Sparks, sparksType, 200.0f, "TireSparks");
+    create(TireEffect::Dust, dustType, 80.0f, "TireDust");
+
+    const auto marks = ecs.CreateEntity();
+    auto& transform = ecs.CreateComponent<bee::Transform>(marks);
+    ecs.CreateComponent<bee::Name>(marks, "TireMarks");
+    transform.SetTranslation({position.x, position.y, c_markHeight});
+    transform.SetParent(visual.car);
+    ecs.CreateComponent<bee::SkidMarkEmitter>(marks).Width = 0.22f;
+    auto& effect = ecs.CreateComponent<TireEffect>(marks);
+    effect.wheel = wheel;
+    effect.kind = TireEffect::Marks;
+}
+
+void TireEffectsSystem::Update(float)
+{
+    View<bee::ParticleEmitter, const TireEffect>().each(
+        [&](bee::ParticleEmitter& emitter, const TireEffect& effect)
+        {
+            emitter.Intensity = 0.0f;
+            const auto* visual = TryGet<const WheelVisual>(effect.wheel);
+            if (!visual) return;
+            const auto* wheel = TryGet<const Wheel>(visual->car);
+            const auto* chassis = TryGet<const Chassis>(visual->car);
+            if (!wheel || !chassis) return;
+
+            const float speed = glm::length(chassis->velocity);
+            const float3 up = {0.0f, 0.0f, 1.0f};
+            switch (effect.kind)
+            {
+                case TireEffect::Smoke:
+                {
+                    // The car has one Wheel, for the driven rear axle. The front wheels only slip when the brakes
+                    // lock them (slip ratio -1).
+                    if (visual->isFront && wheel->slipRatio > 0.0f) return;
+
+                    // Smoke needs the tread to slide over the ground, a locked wheel at a standstill does not smoke
+                    const float vLong = glm::dot(chassis->velocity, chassis->direction);
+                    const float sliding = glm::abs(wheel->angularVelocity * wheel->radius - vLong);
+                    emitter.Intensity = glm::smoothstep(c_smokeSlip, c_fullSmokeSlip, glm::abs(wheel->slipRatio))
+                        * glm::min(sliding / c_fullSmokeSliding, 1.0f);
+                    emitter.Velocity = chassis->velocity * 0.2f + up * 0.5f;
+                    break;
+                }
+                case TireEffect::Sparks:
+                    if (visual->surface != Surface::Curb || speed < c_minScrapeSpeed) return;
+                    emitter.Intensity = glm::min(speed / c_fullEffectSpeed, 1.0f);
+                    emitter.Velocity = chassis->velocity * 0.6f + up * 1.5f;
+                    break;
+                case TireEffect::Dust:
+                    if (visual->surface != Surface::Gravel) return;
+                    emitter.Intensity = glm::min(speed / c_fullEffectSpeed, 1.0f);
+                    emitter.Velocity = chassis->velocity * 0.3f + up;
+                    break;
+                case TireEffect::Marks:
+                    break;
+            }
+        }
+    );
+
+    View<bee::SkidMarkEmitter, const TireEffect>().each(
+        [&](bee::SkidMarkEmitter& emitter, const TireEffect& effect)
+        {
+            emitter.Intensity = 0.0f;
+            const auto* visual = TryGet<const WheelVisual>(effect.wheel);
+            if (!visual) return;
+            const auto* wheel = TryGet<const Wheel>(visual->car);
+            const auto* chassis = TryGet<const Chassis>(visual->car);
+            if (!wheel || !chassis) return;
+
+            // Like smoke, from the tread sliding over the ground, which only locks the front wheels under braking.
+            // Gravel takes no rubber.
+            if (visual->isFront && wheel->slipRatio > 0.0f) return;
+            if (visual->surface == Surface::Gravel) return;
+            const float vLong = glm::dot(chassis->velocity, chassis->direction);
+            const float sliding = glm::abs(wheel->angularVelocity * wheel->radius - vLong);
+            emitter.Intensity = glm::smoothstep(c_markSlip, c_fullMarkSlip, glm::abs(wheel->slipRatio))
+                * glm::min(sliding / c_fullMarkSliding, 1.0f) * c_maxMarkIntensity;
+        }
+    );
+}
+
+#ifdef BEE_INSPECTOR
+
+void TireEffectsSystem::OnPanel()
+{
+    for (uint32_t type = 0; type < static_cast<uint32_t>(particles->GetTypeCount()); type++)
+    {
+        const auto& pool = particles->GetPool(type);
+        ImGui::Text("%-12s %zu / %zu", particles->GetType(type).Name.c_str(), pool.GetCount(), pool.GetCapacity());
+    }
+    ImGui::Separator();
+    ImGui::Text("Emitted    %zu this frame", particles->GetEmittedCount());
+
+    const auto& ring = skidMarks->GetRing();
+    ImGui::Text("Skid marks %u / %u quads, %llu merged",
+                ring.GetQuadCount(),
+                ring.GetCapacity(),
+                static_cast<unsigned long long>(ring.GetMergedCount()));
+}
+
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <imgui/IconsFontAwesome.h>
+
+#include "core/ecs.hpp"
+#include "tools/inspectable.hpp"
+
+namespace bee
+{
+class ParticleSystem;
+class SkidMarkSystem;
+}
+
+// Tire smoke, curb sparks, gravel dust and skid marks. Registers the particle types, gives every wheel an emitter of
+// each, and sets how hard they emit from the state of the car every frame.
+class TireEffectsSystem : public bee::System, public bee::IPanel
+{
+public:
+    TireEffectsSystem();
+    ~TireEffectsSystem() override = default;
+    void Update(float dt) override;
+
+    // Wheels that exist when the system is created get their emitters right away, call this for wheels created later
+    void CreateEmitters(bee::Entity wheel);
+
+#ifdef BEE_INSPECTOR
+    void OnPanel() override;
+    [[nodiscard]] std::string GetName() const override { return "Tire Effects"; }
+    [[nodiscard]] std::string GetIcon() const override { return ICON_FA_FIRE; }
+#endif
+
+private:
+    bee::ParticleSystem* particles = nullptr;
+    bee::SkidMarkSystem* skidMarks = nullptr;
+    uint32_t smokeType = 0;
+    uint32_t sparksType = 0;
+    uint32_t dustType = 0;
+};
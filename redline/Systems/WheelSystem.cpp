@@ -13,9 +13,15 @@
 #include "core/transform.hpp"
 #include "tools/log.hpp"
 
-void WheelSystem::Update(const float dt)
+WheelSystem::WheelSystem()
 {
-    bee::Engine.ECS().Registry.view<Wheel, const Engine, const Gearbox, const Chassis, const DriveInput>().each(
+    Writes<Wheel, WheelVisual, bee::Transform>();
+    Reads<Engine, Gearbox, Chassis, DriveInput, Steering>();
+}
+
+void WheelSystem::FixedUpdate(const float dt)
+{
+    View<Wheel, const Engine, const Gearbox, const Chassis, const DriveInput>().each(
         [&](Wheel& wheel, const Engine& engine, const Gearbox& gearbox, const Chassis& chassis, const DriveInput& drive)
         {
             const float vLong = glm::dot(chassis.velocity, chassis.direction);
@@ -61,10 +67,10 @@ void WheelSystem::Update(const float dt)
     );
 
     // ── Visual wheel rotation (spin + steer) ──────────────────────────────
-    bee::Engine.ECS().Registry.view<bee::Transform, WheelVisual>().each(
+    View<bee::Transform, WheelVisual>().each(
         [&](bee::Transform& wTransform, WheelVisual& visual)
         {
-            const auto* wheel = bee::Engine.ECS().Registry.try_get<const Wheel>(visual.car);
+            const auto* wheel = TryGet<const Wheel>(visual.car);
             if (!wheel) return;
 
             visual.spinAngle += wheel->angularVelocity * dt;
@@ -75,7 +81,7 @@ void WheelSystem::Update(const float dt)
 
             if (visual.isFront)
             {
-                const auto* steering = bee::Engine.ECS().Registry.try_get<const Steering>(visual.car);
+                const auto* steering = TryGet<const Steering>(visual.car);
                 if (steering)
                 {
                     const glm::quat steerQuat = glm::angleAxis(steering->currentAngle, glm::vec3(0.0f, 0.0f, 1.0f));
@@ -88,6 +94,8 @@ void WheelSystem::Update(const float dt)
     );
 }
 
+#ifdef BEE_INSPECTOR
+
 void WheelSystem::OnPanel()
 {
     bee::Engine.ECS().Registry.view<const Wheel>().each([](const Wheel& wheel)
@@ -100,3 +108,5 @@ void WheelSystem::OnPanel()
         ImGui::Text("Axle Load  %.0f N", wheel.axleLoad);
     });
 }
+
+#endif
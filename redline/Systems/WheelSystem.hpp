@@ -8,11 +8,13 @@
 class WheelSystem : public bee::System, public bee::IPanel
 {
 public:
-    WheelSystem() = default;
+    WheelSystem();
     ~WheelSystem() override = default;
-    void Update(float dt) override;
+    void FixedUpdate(float dt) override;
     
+#ifdef BEE_INSPECTOR
     void OnPanel() override;
     [[nodiscard]] std::string GetName() const override { return "Wheel System"; }
     [[nodiscard]] std::string GetIcon() const override { return ICON_FA_WHEELCHAIR; }
+#endif
 };
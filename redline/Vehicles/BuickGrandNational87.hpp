@@ -9,6 +9,7 @@
 #include "../Components/WheelVisualComponent.hpp"
 #include "core/ecs.hpp"
 #include "core/engine.hpp"
+#include "core/name.hpp"
 #include "core/resources.hpp"
 #include "core/transform.hpp"
 #include "rendering/model.hpp"
@@ -17,7 +18,7 @@ inline void CreateCarBody(const bee::Entity entity)
 {
     const auto body = bee::Engine.ECS().CreateEntity();
     auto& transform = bee::Engine.ECS().CreateComponent<bee::Transform>(body);
-    transform.Name = "Buick_Grand_National_87_Body";
+    bee::Engine.ECS().CreateComponent<bee::Name>(body, "Buick_Grand_National_87_Body");
     transform.SetRotation(glm::quat(glm::radians(float3(90.0f, 0.0f, 180.0f))));
     transform.SetTranslation({0.0f, 0.0f, 0.15f});
     transform.SetParent(entity);
@@ -33,7 +34,7 @@ inline void CreateCarWheel(const bee::Entity parent, const bee::Entity car, cons
 {
     const auto entity = bee::Engine.ECS().CreateEntity();
     auto& transform = bee::Engine.ECS().CreateComponent<bee::Transform>(entity);
-    transform.Name = "Buick_Grand_National_87_Wheel_" + affix;
+    bee::Engine.ECS().CreateComponent<bee::Name>(entity, "Buick_Grand_National_87_Wheel_" + affix);
     transform.SetTranslation(position + float3{0.0f, 0.0f, 0.15f});
     transform.SetParent(parent);
 
@@ -55,8 +56,8 @@ inline bee::Entity Buick_GrandNational_87()
     bee::Entity car = ecs.CreateEntity();
     
     // ── Transform ────────────────────────────────────────────
-    auto& t = ecs.CreateComponent<bee::Transform>(car);
-    t.Name = "Buick|_Grand_National_87";
+    ecs.CreateComponent<bee::Transform>(car);
+    ecs.CreateComponent<bee::Name>(car, "Buick|_Grand_National_87");
     
     // ── Physics components ────────────────────────────────────
     auto& chassis = ecs.CreateComponent<Chassis>(car);
@@ -3,6 +3,7 @@
 #include <glm/glm.hpp>
 
 #include "core/engine.hpp"
+#include "core/name.hpp"
 #include "core/resources.hpp"
 #include "core/transform.hpp"
 #include "platform/opengl/mesh_gl.hpp"
@@ -12,8 +13,9 @@
 Floor::Floor(float size, const std::string& texturePath, float tiling)
 {
     ID = bee::Engine.ECS().CreateEntity();
-    auto& transform = bee::Engine.ECS().CreateComponent<bee::Transform>(ID);
-    transform.Name = "Floor";
+    bee::Engine.ECS().CreateComponent<bee::Transform>(ID);
+    bee::Engine.ECS().CreateComponent<bee::Name>(ID, "Floor");
+    bee::Engine.ECS().CreateComponent<bee::Static>(ID);
 
     std::vector<glm::vec3> positions = {
         {-size, -size, 0.0f},
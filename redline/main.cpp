@@ -4,12 +4,13 @@
 #include "core/engine.hpp"
 #include "redline.hpp"
 #include "vehicle.hpp"
-#include "platform/opengl/device_gl.hpp"
+#include "core/device.hpp"
 #include "Systems/ChassisSystem.hpp"
 #include "Systems/EngineSystem.hpp"
 #include "Systems/GearboxSystem.hpp"
 #include "Systems/InputSystem.hpp"
 #include "Systems/SteeringSystem.hpp"
+#include "Systems/TireEffectsSystem.hpp"
 #include "Systems/WheelSystem.hpp"
 
 using namespace bee;
@@ -18,6 +19,9 @@ int main(int, char**)
 {
     Engine.Initialize();
     Engine.Device().SetWindowSize(1280, 720);
+#ifdef BEE_GRAPHICS_NULL
+    Engine.Device().SetFrameLimit(1000);  // a fixed amount of work, to compare the CPU time of builds
+#endif
     Engine.ECS().CreateSystem<Redline>();
     Engine.ECS().CreateSystem<ChassisSystem>();
     Engine.ECS().CreateSystem<EngineSystem>();
@@ -25,6 +29,7 @@ int main(int, char**)
     Engine.ECS().CreateSystem<InputSystem>();
     Engine.ECS().CreateSystem<SteeringSystem>();
     Engine.ECS().CreateSystem<WheelSystem>();
+    Engine.ECS().CreateSystem<TireEffectsSystem>();
     Engine.Run();
     Engine.Shutdown();
 }
@@ -8,8 +8,9 @@
 #include "floor.hpp"
 #include "Components/ChassisComponent.hpp"
 #include "core/engine.hpp"
+#include "core/name.hpp"
 #include "core/transform.hpp"
-#include "platform/opengl/device_gl.hpp"
+#include "core/device.hpp"
 #include "platform/opengl/render_gl.hpp"
 #include "tools/log.hpp"
 #include "Vehicles/BuickGrandNational87.hpp"
@@ -25,13 +26,16 @@ Redline::Redline()
     // Create Camera
     {
         camera = bee::Engine.ECS().CreateEntity();
-        auto& camTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(camera);
-        camTransform.Name = "Camera";
+        bee::Engine.ECS().CreateComponent<bee::Transform>(camera);
+        bee::Engine.ECS().CreateComponent<bee::Name>(camera, "Camera");
         bee::Engine.ECS().CreateComponent<bee::Camera>(camera);
     }
     
     // Create floor
     Floor(20000.0f, "greybox_grey_grid.png", 20000.0f * 0.8f);
+
+    // Everything static has been created, merge it into a few draw calls
+    renderer.BakeStaticGeometry();
 }
 
 void Redline::Update(float)
@@ -65,7 +69,11 @@ void Redline::Update(float)
     );
 }
 
+#ifdef BEE_INSPECTOR
+
 void Redline::OnPanel()
 {
     ImGui::SliderFloat("Speed", &speed, 0.0f, 100.0f / 3.6f);
 }
+
+#endif
@@ -33,7 +33,9 @@ public:
     ~Redline() override = default;
     void Update(float dt) override;
     
+#ifdef BEE_INSPECTOR
     void OnPanel() override;
     [[nodiscard]] std::string GetName() const override { return "Vehicle"; }
     [[nodiscard]] std::string GetIcon() const override { return ICON_FA_ADN; }
+#endif
 };
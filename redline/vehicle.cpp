@@ -8,6 +8,7 @@
 #include "imgui_spline_helper.hpp"
 #include "core/ecs.hpp"
 #include "core/input.hpp"
+#include "core/name.hpp"
 #include "core/resources.hpp"
 #include "core/transform.hpp"
 #include "rendering/model.hpp"
@@ -36,14 +37,14 @@ bee::Entity BuickGrandNational87::CreateCarBody()
     
     const auto entity = bee::Engine.ECS().CreateEntity();
     bee::Engine.ECS().CreateComponent<Vehicle>(entity, vehicleData);
-    auto& transform = bee::Engine.ECS().CreateComponent<bee::Transform>(entity);
-    transform.Name = "Buick_Grand_National_87";
+    bee::Engine.ECS().CreateComponent<bee::Transform>(entity);
+    bee::Engine.ECS().CreateComponent<bee::Name>(entity, "Buick_Grand_National_87");
     // Vehicle entity has identity rotation: forward = +Y, up = +Z
 
     // Child pivot to convert glTF Y-up to game Z-up
     const auto pivot = bee::Engine.ECS().CreateEntity();
     auto& pivotTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(pivot);
-    pivotTransform.Name = "ModelPivot";
+    bee::Engine.ECS().CreateComponent<bee::Name>(pivot, "ModelPivot");
     pivotTransform.SetRotation(EulerDeg(90.0f, 0.0f, 180.0f));
     pivotTransform.SetTranslation({0.0f, 0.0f, 0.15f});
     pivotTransform.SetParent(entity);
@@ -61,14 +62,14 @@ void BuickGrandNational87::CreateCarWheel(const bee::Entity parent, const std::s
 {
     const auto entity = bee::Engine.ECS().CreateEntity();
     auto& transform = bee::Engine.ECS().CreateComponent<bee::Transform>(entity);
-    transform.Name = "Buick_Grand_National_87_Wheel_" + affix;
+    bee::Engine.ECS().CreateComponent<bee::Name>(entity, "Buick_Grand_National_87_Wheel_" + affix);
     transform.SetTranslation(position);
     transform.SetParent(parent);
 
     // Child pivot: convert glTF Y-up to game Z-up, and mirror if needed
     const auto pivot = bee::Engine.ECS().CreateEntity();
     auto& pivotTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(pivot);
-    pivotTransform.Name = "WheelPivot";
+    bee::Engine.ECS().CreateComponent<bee::Name>(pivot, "WheelPivot");
     pivotTransform.SetRotation(EulerDeg(90.0f, 0.0f, mirror ? 180.0f : 0.0f));
     pivotTransform.SetTranslation({0.0f, 0.0f, 0.15f});
     pivotTransform.SetParent(entity);
@@ -231,13 +232,15 @@ void VehicleSystem::Update(float dt)
     );
 }
 
+#ifdef BEE_INSPECTOR
+
 void VehicleSystem::OnPanel()
 {
-    bee::Engine.ECS().Registry.view<bee::Transform, Vehicle>().each(
-        [](bee::Transform& transform, Vehicle& vehicle)
+    bee::Engine.ECS().Registry.view<const bee::Name, Vehicle>().each(
+        [](const bee::Name& name, Vehicle& vehicle)
         {
             ImGui::Text("Top Speed  %.1f m/s  %.1f km/h", vehicle.TopSpeed(), vehicle.TopSpeed() * 3.6f);
-            ImGui::Text("%s  %.2f m/s  %.2f km/h", transform.Name.c_str(), vehicle.Speed(), vehicle.Speed() * 3.6f);
+            ImGui::Text("%s  %.2f m/s  %.2f km/h", name.CStr(), vehicle.Speed(), vehicle.Speed() * 3.6f);
 
             if (vehicle.activeGear < 0)
                 ImGui::Text("Gear: R  |  RPM: %.0f  |  SR: %.3f", vehicle.RPM(), vehicle.SlipRatio());
@@ -575,3 +578,5 @@ void VehicleSystem::OnPanel()
         }
     );
 }
+
+#endif
@@ -77,9 +77,11 @@ public:
     ~VehicleSystem() override = default;
     void Update(float dt) override;
     
+#ifdef BEE_INSPECTOR
     void OnPanel() override;
     [[nodiscard]] std::string GetName() const override { return "Vehicle Info"; }
     [[nodiscard]] std::string GetIcon() const override { return ICON_FA_AREA_CHART; }
+#endif
 };
 
 struct VehicleData